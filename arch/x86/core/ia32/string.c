@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Minimal libc memcpy() and memset() for IA-32
+ *
+ * The string instructions move a double word per iteration whatever the
+ * alignment of the buffers, and the remaining bytes one at a time. The
+ * direction flag is clear, as the ABI requires on function calls.
+ */
+
+#include <string.h>
+#include <stdint.h>
+
+void *memcpy(void *_MLIBC_RESTRICT d, const void *_MLIBC_RESTRICT s, size_t n)
+{
+	void *dest = d;
+	size_t count = n >> 2;
+
+	__asm__ volatile("rep movsl\n\t"
+			 "movl %[rest], %%ecx\n\t"
+			 "rep movsb"
+			 : "+D" (dest), "+S" (s), "+c" (count)
+			 : [rest] "r" (n & 3)
+			 : "memory");
+
+	return d;
+}
+
+void *memset(void *buf, int c, size_t n)
+{
+	void *dest = buf;
+	size_t count = n >> 2;
+	uint32_t c_word = (uint8_t)c * 0x01010101U;
+
+	__asm__ volatile("rep stosl\n\t"
+			 "movl %[rest], %%ecx\n\t"
+			 "rep stosb"
+			 : "+D" (dest), "+c" (count)
+			 : "a" (c_word), [rest] "r" (n & 3)
+			 : "memory");
+
+	return buf;
+}
@@ -55,6 +55,10 @@ struct eth_context {
 	k_tid_t rx_thread;
 	struct z_thread_stack_element *rx_stack;
 	size_t rx_stack_size;
+#if defined(CONFIG_NET_ETHERNET_RX_POLL)
+	/* Given when a poll drains the device, i.e. RX "interrupt" enable */
+	struct k_sem rx_irq;
+#endif
 	int dev_fd;
 	bool init_done;
 	bool status;
@@ -319,7 +323,7 @@ static struct net_pkt *prepare_non_vlan_pkt(struct eth_context *ctx,
 	return pkt;
 }
 
-static int read_data(struct eth_context *ctx, int fd)
+static struct net_pkt *read_pkt(struct eth_context *ctx, int fd)
 {
 	uint16_t vlan_tag = NET_VLAN_TAG_UNSPEC;
 	struct net_if *iface;
@@ -329,7 +333,7 @@ static int read_data(struct eth_context *ctx, int fd)
 
 	count = eth_read_data(fd, ctx->recv, sizeof(ctx->recv));
 	if (count <= 0) {
-		return 0;
+		return NULL;
 	}
 
 #if defined(CONFIG_NET_VLAN)
@@ -339,12 +343,12 @@ static int read_data(struct eth_context *ctx, int fd)
 		if (ntohs(hdr->type) == NET_ETH_PTYPE_VLAN) {
 			pkt = prepare_vlan_pkt(ctx, count, &vlan_tag, &status);
 			if (!pkt) {
-				return status;
+				return NULL;
 			}
 		} else {
 			pkt = prepare_non_vlan_pkt(ctx, count, &status);
 			if (!pkt) {
-				return status;
+				return NULL;
 			}
 
 			net_pkt_set_vlan_tci(pkt, 0);
@@ -354,39 +358,88 @@ static int read_data(struct eth_context *ctx, int fd)
 	{
 		pkt = prepare_non_vlan_pkt(ctx, count, &status);
 		if (!pkt) {
-			return status;
+			return NULL;
 		}
 	}
 #endif
 
 	iface = get_iface(ctx, vlan_tag);
+	net_pkt_set_iface(pkt, iface);
 
 	update_gptp(iface, pkt, false);
 
-	if (net_recv_data(iface, pkt) < 0) {
-		net_pkt_unref(pkt);
+	return pkt;
+}
+
+#if defined(CONFIG_NET_ETHERNET_RX_POLL)
+static int eth_rx_poll(const struct device *dev, struct net_pkt **pkts,
+		       int budget)
+{
+	struct eth_context *ctx = dev->data;
+	struct net_pkt *pkt;
+	int count = 0;
+	int tries;
+
+	/* Dropped frames use up the budget too */
+	for (tries = 0; tries < budget && !eth_wait_data(ctx->dev_fd);
+	     tries++) {
+		pkt = read_pkt(ctx, ctx->dev_fd);
+		if (pkt) {
+			pkts[count++] = pkt;
+		}
 	}
 
-	return 0;
+	if (count < budget) {
+		k_sem_give(&ctx->rx_irq);
+	}
+
+	return count;
+}
+
+static void rx_frames(struct eth_context *ctx)
+{
+	/* The RX thread plays the interrupt handler: it stays masked until
+	 * a poll finds the TAP device empty.
+	 */
+	net_eth_rx_poll_schedule(ctx->iface);
+	k_sem_take(&ctx->rx_irq, K_FOREVER);
 }
+#else
+static void rx_frames(struct eth_context *ctx)
+{
+	struct net_pkt *pkt;
+
+	do {
+		pkt = read_pkt(ctx, ctx->dev_fd);
+		if (pkt && net_recv_data(net_pkt_iface(pkt), pkt) < 0) {
+			net_pkt_unref(pkt);
+		}
+
+		k_yield();
+	} while (!eth_wait_data(ctx->dev_fd));
+}
+#endif /* CONFIG_NET_ETHERNET_RX_POLL */
+
+/* Sleep between checks of an idle TAP device. The period is short right
+ * after traffic and backs off while the device stays idle.
+ */
+#define RX_IDLE_MIN_MS 1
+#define RX_IDLE_MAX_MS (IS_ENABLED(CONFIG_NET_GPTP) ? 1 : 50)
 
 static void eth_rx(struct eth_context *ctx)
 {
+	int idle_ms = RX_IDLE_MAX_MS;
+
 	LOG_DBG("Starting ZETH RX thread");
 
 	while (1) {
-		if (net_if_is_up(ctx->iface)) {
-			while (!eth_wait_data(ctx->dev_fd)) {
-				read_data(ctx, ctx->dev_fd);
-				k_yield();
-			}
+		if (net_if_is_up(ctx->iface) && !eth_wait_data(ctx->dev_fd)) {
+			rx_frames(ctx);
+			idle_ms = RX_IDLE_MIN_MS;
 		}
 
-		if (IS_ENABLED(CONFIG_NET_GPTP)) {
-			k_sleep(K_MSEC(1));
-		} else {
-			k_sleep(K_MSEC(50));
-		}
+		k_sleep(K_MSEC(idle_ms));
+		idle_ms = MIN(idle_ms * 2, RX_IDLE_MAX_MS);
 	}
 }
 
@@ -398,6 +451,10 @@ static void eth_rx(struct eth_context *ctx)
 
 static void create_rx_handler(struct eth_context *ctx)
 {
+#if defined(CONFIG_NET_ETHERNET_RX_POLL)
+	k_sem_init(&ctx->rx_irq, 0, 1);
+#endif
+
 	k_thread_create(ctx->rx_thread,
 			ctx->rx_stack,
 			ctx->rx_stack_size,
@@ -619,6 +676,9 @@ static const struct ethernet_api eth_if_api = {
 #if defined(CONFIG_ETH_NATIVE_POSIX_PTP_CLOCK)
 	.get_ptp_clock = eth_get_ptp_clock,
 #endif
+#if defined(CONFIG_NET_ETHERNET_RX_POLL)
+	.rx_poll = eth_rx_poll,
+#endif
 };
 
 #define DEFINE_ETH_DEV_DATA(x, _)					     \
@@ -454,12 +454,17 @@ ssize_t bt_gatt_attr_read_service(struct bt_conn *conn,
 /** @def BT_GATT_SERVICE_DEFINE
  *  @brief Statically define and register a service.
  *
- *  Helper macro to statically define and register a service.
+ *  Helper macro to statically define and register a service. The
+ *  attributes of all static services are linked into one array in handle
+ *  order, which lets the handle of a static attribute be found from its
+ *  position.
  *
  *  @param _name Service name.
  */
 #define BT_GATT_SERVICE_DEFINE(_name, ...)				\
-	const struct bt_gatt_attr attr_##_name[] = { __VA_ARGS__ };	\
+	const Z_DECL_ALIGN(struct bt_gatt_attr) attr_##_name[]		\
+		__in_section(_bt_gatt_attr_static, static, _name) __used =	\
+						{ __VA_ARGS__ };	\
 	const Z_STRUCT_SECTION_ITERABLE(bt_gatt_service_static, _name) =\
 						BT_GATT_SERVICE(attr_##_name)
 
@@ -910,6 +915,12 @@ struct bt_gatt_notify_params {
  *  parameters, when using this method the attribute given is used as the
  *  start range when looking up for possible matches.
  *
+ *  When no connection is given the notification is sent to all the
+ *  subscribed connections, in turn. Sending stops at the first
+ *  connection that fails, and 0 is returned if at least one connection
+ *  has been notified before that. The callback is only called for the
+ *  connections that have been notified.
+ *
  *  @param conn Connection object.
  *  @param params Notification parameters.
  *
@@ -43,6 +43,9 @@ enum json_tokens {
 	JSON_TOK_COLON = ':',
 	JSON_TOK_COMMA = ',',
 	JSON_TOK_NUMBER = '0',
+	JSON_TOK_FLOAT = '1',
+	JSON_TOK_DOUBLE = '2',
+	JSON_TOK_INT64 = '3',
 	JSON_TOK_TRUE = 't',
 	JSON_TOK_FALSE = 'f',
 	JSON_TOK_NULL = 'n',
@@ -64,7 +67,8 @@ struct json_obj_descr {
 	uint32_t field_name_len : 7;
 
 	/* Valid values here (enum json_tokens): JSON_TOK_STRING,
-	 * JSON_TOK_NUMBER, JSON_TOK_TRUE, JSON_TOK_FALSE,
+	 * JSON_TOK_NUMBER, JSON_TOK_FLOAT, JSON_TOK_DOUBLE,
+	 * JSON_TOK_INT64, JSON_TOK_TRUE, JSON_TOK_FALSE,
 	 * JSON_TOK_OBJECT_START, JSON_TOK_LIST_START.  (All others
 	 * ignored.) Maximum value is '}' (125), so this has to be 7 bits
 	 * long.
@@ -115,7 +119,9 @@ typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
  *
  * @param type_ Token type for JSON value corresponding to a primitive
  * type. Must be one of: JSON_TOK_STRING for strings, JSON_TOK_NUMBER
- * for numbers, JSON_TOK_TRUE (or JSON_TOK_FALSE) for booleans.
+ * for int32_t numbers, JSON_TOK_INT64 for int64_t numbers,
+ * JSON_TOK_FLOAT for float numbers, JSON_TOK_DOUBLE for double
+ * numbers, JSON_TOK_TRUE (or JSON_TOK_FALSE) for booleans.
  *
  * Here's an example of use:
  *
@@ -571,7 +577,9 @@ typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
  * (1) strings are not unescaped (but only valid escape sequences are
  * accepted);
  * (2) no UTF-8 validation is performed; and
- * (3) only integer numbers are supported (no strtod() in the minimal libc).
+ * (3) JSON_TOK_NUMBER fields only accept integer numbers; JSON_TOK_FLOAT
+ * and JSON_TOK_DOUBLE fields accept fractions and exponents, but are not
+ * always rounded to the nearest representable value.
  *
  * @param json Pointer to JSON-encoded value to be parsed
  *
@@ -592,6 +600,122 @@ int json_obj_parse(char *json, size_t len,
 	const struct json_obj_descr *descr, size_t descr_len,
 	void *val);
 
+#ifdef CONFIG_JSON_STREAM_MAX_DEPTH
+#define JSON_STREAM_MAX_DEPTH CONFIG_JSON_STREAM_MAX_DEPTH
+#else
+#define JSON_STREAM_MAX_DEPTH 8
+#endif
+
+/* Longest key or number json_stream_feed() decodes, plus one */
+#define JSON_STREAM_TOKEN_SIZE 128
+
+/**
+ * @brief Object or array being decoded by a streaming parser
+ *
+ * This is an implementation detail of struct json_stream.
+ */
+struct json_stream_frame {
+	const struct json_obj_descr *descr;
+	void *val;
+	char *field;
+	size_t len;
+	size_t elem_size;
+	int32_t decoded;
+	int8_t member;
+	uint8_t type;
+};
+
+/**
+ * @brief State of a streaming JSON parser
+ *
+ * Its fields are only used by the json_stream_*() functions.
+ */
+struct json_stream {
+	struct json_stream_frame stack[JSON_STREAM_MAX_DEPTH];
+	const char *literal;
+	char *str_buf;
+	size_t str_buf_size;
+	size_t str_start;
+	size_t str_used;
+	int error;
+	uint8_t depth;
+	uint8_t skip;
+	uint8_t lexer;
+	uint8_t expect;
+	uint8_t sink;
+	uint8_t value_type;
+	uint8_t escape;
+	uint8_t token_len;
+	char token[JSON_STREAM_TOKEN_SIZE];
+};
+
+/**
+ * @brief Prepares a streaming parser for a JSON-encoded object
+ *
+ * The streaming parser decodes the same objects as json_obj_parse(), but
+ * takes the input in fragments of any size through json_stream_feed(),
+ * and stores each value in the struct pointed to by @a val as soon as
+ * it is complete. Only keys and numbers, which are at most
+ * JSON_STREAM_TOKEN_SIZE - 1 characters long, and the strings stored
+ * in the struct are kept, so the whole payload never has to be in
+ * memory.
+ *
+ * Strings are copied, still escaped and NUL-terminated, to @a str_buf,
+ * and the string fields point there. Values of keys that are not in the
+ * descriptor are skipped, whatever their type. Objects and arrays may
+ * not be nested more than CONFIG_JSON_STREAM_MAX_DEPTH levels deep,
+ * counting the outermost object.
+ *
+ * @param stream Parser state
+ *
+ * @param descr Pointer to the descriptor array
+ *
+ * @param descr_len Number of elements in the descriptor array. Must be less
+ * than 31, as for json_obj_parse()
+ *
+ * @param val Pointer to the struct to hold the decoded values
+ *
+ * @param str_buf Buffer to hold the decoded strings, may be NULL if the
+ * descriptor has no string
+ *
+ * @param str_buf_size Size of @a str_buf
+ */
+void json_stream_init(struct json_stream *stream,
+		      const struct json_obj_descr *descr, size_t descr_len,
+		      void *val, char *str_buf, size_t str_buf_size);
+
+/**
+ * @brief Feeds the next fragment of a JSON-encoded object to a
+ * streaming parser
+ *
+ * Fragments may end anywhere, even within a key or a value. Once an
+ * error is returned, it is returned again by all later calls.
+ *
+ * @param stream Parser state set up with json_stream_init()
+ *
+ * @param data Next fragment of the JSON-encoded object
+ *
+ * @param len Length of the fragment
+ *
+ * @return 0 if the fragment has been decoded, -EINVAL if the payload
+ * is not valid or does not match the descriptor, -ENOSPC if an array
+ * has more elements than it can hold, -ENOMEM if @a str_buf is full or
+ * the object is nested too deeply, -ERANGE if a number does not fit in
+ * its field.
+ */
+int json_stream_feed(struct json_stream *stream, const char *data,
+		     size_t len);
+
+/**
+ * @brief Completes streaming parsing of a JSON-encoded object
+ *
+ * @param stream Parser state set up with json_stream_init()
+ *
+ * @return < 0 if an error occurred or the object is incomplete, bitmap
+ * of decoded fields on success, as returned by json_obj_parse().
+ */
+int json_stream_finish(struct json_stream *stream);
+
 /**
  * @brief Escapes the string so it can be used to encode JSON objects
  *
@@ -654,6 +778,38 @@ ssize_t json_calc_encoded_len(const struct json_obj_descr *descr,
 int json_obj_encode_buf(const struct json_obj_descr *descr, size_t descr_len,
 			const void *val, char *buffer, size_t buf_size);
 
+/**
+ * @brief Encodes an object in a contiguous memory location and returns
+ * its length
+ *
+ * The object is encoded in a single pass, like json_obj_encode_buf(), but
+ * the length of the encoded object is returned, even if it does not fit
+ * in the buffer: the buffer then holds as much of the encoded object as
+ * fits, and a buffer of the returned length plus one byte holds all of
+ * it. A buffer sized for the usual payloads thus spares the
+ * json_calc_encoded_len() pass.
+ *
+ * @param descr Pointer to the descriptor array
+ *
+ * @param descr_len Number of elements in the descriptor array
+ *
+ * @param val Struct holding the values
+ *
+ * @param buffer Buffer to store the JSON data, may be NULL if @a buf_size
+ * is 0
+ *
+ * @param buf_size Size of buffer, in bytes, with space for the terminating
+ * NUL character
+ *
+ * @return Length of the encoded object, without the terminating NUL
+ * character, if >= 0. The object has been truncated if it is not less
+ * than @a buf_size. A negative value indicates an error (as defined on
+ * errno.h).
+ */
+ssize_t json_obj_encode_buf_len(const struct json_obj_descr *descr,
+				size_t descr_len, const void *val,
+				char *buffer, size_t buf_size);
+
 /**
  * @brief Encodes an array in a contiguous memory location
  *
@@ -247,6 +247,24 @@ size_t z_device_get_all_static(const struct device * *devices);
  */
 bool z_device_ready(const struct device *dev);
 
+/**
+ * @internal
+ * @brief Perfect hash table of the static device names
+ *
+ * Generated at build time by scripts/gen_device_hash.py when
+ * CONFIG_DEVICE_NAME_HASH is enabled, see z_impl_device_get_binding().
+ */
+struct z_device_name_hash {
+	/** Number of buckets, the table is not available if 0 */
+	uint16_t buckets;
+	/** Number of slots */
+	uint16_t slots;
+	/** Hash seed of the names of each bucket */
+	const uint16_t *seed;
+	/** Index of the device in each slot plus one, 0 if the slot is free */
+	const uint16_t *slot;
+};
+
 /**
  * @}
  */
@@ -60,6 +60,37 @@
  */
 #define DT_SUPPORTS_DEP_ORDS(node_id) DT_CAT(node_id, _SUPPORTS_ORDS)
 
+/**
+ * @brief Get a list of dependency ordinals of the device nodes a node
+ *        depends on, directly or indirectly
+ *
+ * Device nodes are the nodes with status "okay" and a "label" property,
+ * which device instances are bound to. Dependencies of the other nodes
+ * in between, like pin or clock configuration nodes, are followed.
+ *
+ * There is a comma after each ordinal in the expansion, **including**
+ * the last one:
+ *
+ *     DT_REQUIRES_DEVICE_DEP_ORDS(my_node) // device_ord_1, ..., device_ord_n,
+ *
+ * @param node_id Node identifier
+ * @return a list of dependency ordinals, with each ordinal followed
+ *         by a comma (<tt>,</tt>), or an empty expansion
+ */
+#define DT_REQUIRES_DEVICE_DEP_ORDS(node_id) \
+	DT_CAT(node_id, _REQUIRES_DEVICE_ORDS)
+
+/**
+ * @brief Call "fn" on all nodes with status "okay" and a "label" property
+ *
+ * The nodes are visited in dependency order: a node is visited after
+ * the nodes it depends on.
+ *
+ * @param fn macro to call for each node, with a node identifier as
+ *           argument
+ */
+#define DT_FOREACH_LABELED_STATUS_OKAY(fn) DT_FOREACH_OKAY_LABELED(fn)
+
 /**
  * @brief Get a DT_DRV_COMPAT instance's dependency ordinal
  *
@@ -93,6 +93,7 @@ extern "C" {
 
 struct k_thread;
 struct k_mutex;
+struct k_rwlock;
 struct k_sem;
 struct k_msgq;
 struct k_mbox;
@@ -3359,6 +3360,148 @@ __syscall int k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout);
  */
 __syscall int k_mutex_unlock(struct k_mutex *mutex);
 
+/**
+ * @}
+ */
+
+/**
+ * @defgroup rwlock_apis Reader-Writer Lock APIs
+ * @ingroup kernel_apis
+ * @{
+ */
+
+/**
+ * Reader-Writer Lock Structure
+ * @ingroup rwlock_apis
+ */
+struct k_rwlock {
+	/** Threads waiting for a read lock */
+	_wait_q_t rd_wait_q;
+	/** Threads waiting for the write lock */
+	_wait_q_t wr_wait_q;
+	/** Thread holding the write lock */
+	struct k_thread *writer;
+
+	/** Number of read locks held */
+	uint32_t readers;
+
+	_OBJECT_TRACING_NEXT_PTR(k_rwlock)
+	_OBJECT_TRACING_LINKED_FLAG
+};
+
+/**
+ * @cond INTERNAL_HIDDEN
+ */
+#define Z_RWLOCK_INITIALIZER(obj) \
+	{ \
+	.rd_wait_q = Z_WAIT_Q_INIT(&obj.rd_wait_q), \
+	.wr_wait_q = Z_WAIT_Q_INIT(&obj.wr_wait_q), \
+	.writer = NULL, \
+	.readers = 0, \
+	_OBJECT_TRACING_INIT \
+	}
+
+/**
+ * INTERNAL_HIDDEN @endcond
+ */
+
+/**
+ * @brief Statically define and initialize a reader-writer lock.
+ *
+ * The lock can be accessed outside the module where it is defined using:
+ *
+ * @code extern struct k_rwlock <name>; @endcode
+ *
+ * @param name Name of the reader-writer lock.
+ */
+#define K_RWLOCK_DEFINE(name) \
+	Z_STRUCT_SECTION_ITERABLE(k_rwlock, name) = \
+		Z_RWLOCK_INITIALIZER(name)
+
+/**
+ * @brief Initialize a reader-writer lock.
+ *
+ * This routine initializes a reader-writer lock object, prior to its first
+ * use.
+ *
+ * Upon completion, the lock is not held by any thread.
+ *
+ * @param rwlock Address of the reader-writer lock.
+ *
+ * @retval 0 Reader-writer lock object created
+ */
+__syscall int k_rwlock_init(struct k_rwlock *rwlock);
+
+/**
+ * @brief Lock a reader-writer lock for reading.
+ *
+ * This routine takes a read lock on @a rwlock. Any number of threads can hold
+ * a read lock at the same time, but not while a thread holds the write lock.
+ *
+ * Writers are preferred: the calling thread also waits while a thread of
+ * the same or a higher priority waits for the write lock, so readers
+ * arriving continuously cannot starve a writer. As a consequence, a thread
+ * must not take a read lock it already holds if writers may be waiting.
+ *
+ * Reader-writer locks may not be locked in ISRs.
+ *
+ * @param rwlock Address of the reader-writer lock.
+ * @param timeout Waiting period to lock the reader-writer lock,
+ *                or one of the special values K_NO_WAIT and
+ *                K_FOREVER.
+ *
+ * @retval 0 Read lock taken.
+ * @retval -EBUSY Returned without waiting.
+ * @retval -EAGAIN Waiting period timed out.
+ */
+__syscall int k_rwlock_read_lock(struct k_rwlock *rwlock,
+				 k_timeout_t timeout);
+
+/**
+ * @brief Lock a reader-writer lock for writing.
+ *
+ * This routine takes the write lock on @a rwlock, once no thread holds a
+ * read lock or the write lock. Waiting writers get the lock in priority
+ * order.
+ *
+ * The write lock is not recursive, and there is no priority inheritance.
+ *
+ * Reader-writer locks may not be locked in ISRs.
+ *
+ * @param rwlock Address of the reader-writer lock.
+ * @param timeout Waiting period to lock the reader-writer lock,
+ *                or one of the special values K_NO_WAIT and
+ *                K_FOREVER.
+ *
+ * @retval 0 Write lock taken.
+ * @retval -EBUSY Returned without waiting.
+ * @retval -EAGAIN Waiting period timed out.
+ * @retval -EDEADLK The calling thread already holds the write lock.
+ */
+__syscall int k_rwlock_write_lock(struct k_rwlock *rwlock,
+				  k_timeout_t timeout);
+
+/**
+ * @brief Unlock a reader-writer lock.
+ *
+ * This routine releases the write lock if the calling thread holds it, or
+ * one of the read locks otherwise. Read locks are not tied to the threads
+ * that took them.
+ *
+ * When the last lock is released, the highest priority waiting writer gets
+ * the write lock, unless higher priority readers are waiting, which then all
+ * get a read lock.
+ *
+ * Reader-writer locks may not be unlocked in ISRs.
+ *
+ * @param rwlock Address of the reader-writer lock.
+ *
+ * @retval 0 Reader-writer lock unlocked.
+ * @retval -EPERM Another thread holds the write lock.
+ * @retval -EINVAL The reader-writer lock is not locked.
+ */
+__syscall int k_rwlock_unlock(struct k_rwlock *rwlock);
+
 /**
  * @}
  */
@@ -191,6 +191,32 @@ struct coap_resource {
 	int age;
 };
 
+/**
+ * @brief Node of a CoAP resource table.
+ *
+ * Storage for coap_resource_table_init(); each distinct path segment
+ * of the registered resources uses one node, plus one for the root.
+ */
+struct coap_resource_node {
+	struct coap_resource_node *child; /* First child, sorted by hash */
+	struct coap_resource_node *next; /* Next sibling */
+	struct coap_resource_node *wildcard; /* Single-level '+' child */
+	struct coap_resource *resource; /* Resource ending at this node */
+	struct coap_resource *multi; /* Resource ending in '#' here */
+	const char *segment;
+	uint16_t hash;
+	uint8_t len;
+};
+
+/**
+ * @brief Prefix tree of CoAP resources, indexed by path segment.
+ */
+struct coap_resource_table {
+	struct coap_resource_node *nodes;
+	uint16_t node_count;
+	uint16_t used;
+};
+
 /**
  * @brief Represents a remote device that is observing a local resource.
  */
@@ -201,6 +227,18 @@ struct coap_observer {
 	uint8_t tkl;
 };
 
+/* Number of option numbers listed in enum coap_option_num */
+#define COAP_OPTION_NUM_COUNT 19
+
+/**
+ * @brief Location of one option inside a parsed CoAP packet.
+ */
+struct coap_option_index {
+	uint16_t num; /* Option number */
+	uint16_t offset; /* Offset of the option value in packet data */
+	uint16_t len; /* Length of the option value */
+};
+
 /**
  * @brief Representation of a CoAP Packet.
  */
@@ -211,6 +249,17 @@ struct coap_packet {
 	uint8_t hdr_len; /* CoAP header length */
 	uint16_t opt_len; /* Total options length (delta + len + value) */
 	uint16_t delta; /* Used for delta calculation in CoAP packet */
+#if defined(CONFIG_COAP_OPTION_INDEX_SIZE) && \
+	(CONFIG_COAP_OPTION_INDEX_SIZE > 0)
+	/* Options found by coap_packet_parse(), in packet order */
+	struct coap_option_index opt_index[CONFIG_COAP_OPTION_INDEX_SIZE];
+	uint8_t opt_count; /* Number of entries in opt_index */
+	/* 1 + opt_index position of the first option, for each option
+	 * number of enum coap_option_num, 0 if absent
+	 */
+	uint8_t opt_first[COAP_OPTION_NUM_COUNT];
+	bool opt_indexed; /* opt_index covers every option of the packet */
+#endif
 };
 
 struct coap_option {
@@ -468,6 +517,69 @@ int coap_handle_request(struct coap_packet *cpkt,
 			uint8_t opt_num,
 			struct sockaddr *addr, socklen_t addr_len);
 
+/**
+ * @brief Build a resource table for fast request dispatch.
+ *
+ * The table is a prefix tree keyed by path segment, so finding the
+ * resource of a request costs one lookup per Uri-Path segment instead of
+ * a comparison against every resource. With CONFIG_COAP_URI_WILDCARD,
+ * '+' matches any single segment and a trailing '#' matches one or more
+ * remaining segments. An exact segment match is preferred over '+',
+ * which is preferred over '#'; among identical paths the first resource
+ * in @a resources wins.
+ *
+ * @param table Table to initialize
+ * @param resources Array of resources terminated by an entry with a NULL
+ * path, must remain valid while @a table is used
+ * @param nodes Storage for the tree
+ * @param node_count Number of elements in @a nodes, at most one per path
+ * segment of @a resources plus one is needed
+ *
+ * @return 0 in case of success, -ENOMEM if @a nodes is too small or
+ * negative in case of other errors.
+ */
+int coap_resource_table_init(struct coap_resource_table *table,
+			     struct coap_resource *resources,
+			     struct coap_resource_node *nodes,
+			     size_t node_count);
+
+/**
+ * @brief Find the resource a request is addressed to.
+ *
+ * @param table Table built by coap_resource_table_init()
+ * @param options Parsed options from coap_packet_parse()
+ * @param opt_num Number of options
+ *
+ * @return The matching resource or NULL if there is none.
+ */
+struct coap_resource *coap_resource_table_find(
+				const struct coap_resource_table *table,
+				const struct coap_option *options,
+				uint8_t opt_num);
+
+/**
+ * @brief When a request is received, call the appropriate method of
+ * the matching resource in a resource table.
+ *
+ * Same as coap_handle_request(), but the resource is looked up with
+ * coap_resource_table_find().
+ *
+ * @param cpkt Packet received
+ * @param table Table built by coap_resource_table_init()
+ * @param options Parsed options from coap_packet_parse()
+ * @param opt_num Number of options
+ * @param addr Peer address
+ * @param addr_len Peer address length
+ *
+ * @return 0 in case of success or negative in case of error.
+ */
+int coap_resource_table_handle_request(struct coap_packet *cpkt,
+				       const struct coap_resource_table *table,
+				       struct coap_option *options,
+				       uint8_t opt_num,
+				       struct sockaddr *addr,
+				       socklen_t addr_len);
+
 /**
  * Represents the size of each block that will be transferred using
  * block-wise transfers [RFC7959]:
@@ -130,6 +130,16 @@ enum ethernet_hw_caps {
 
 	/** VLAN Tag stripping */
 	ETHERNET_HW_VLAN_TAG_STRIP	= BIT(14),
+
+	/** TCP segmentation offload. The driver splits a packet that has
+	 * a non-zero net_pkt_tcp_gso_size() into segments of that size.
+	 */
+	ETHERNET_HW_TSO			= BIT(15),
+
+	/** Large receive offload. The driver may pass coalesced TCP
+	 * segments to the stack.
+	 */
+	ETHERNET_HW_LRO			= BIT(16),
 };
 
 /** @cond INTERNAL_HIDDEN */
@@ -267,6 +277,29 @@ struct ethernet_api {
 
 	/** Send a network packet */
 	int (*send)(const struct device *dev, struct net_pkt *pkt);
+
+#if defined(CONFIG_NET_ETHERNET_RX_POLL)
+	/** Receive at most budget frames into pkts and return how many
+	 * were stored. Called by the L2 after the driver has requested a
+	 * poll with net_eth_rx_poll_schedule(). Returning budget keeps the
+	 * device in poll mode; a driver returning less must re-enable its
+	 * RX interrupt before returning. The driver may set the network
+	 * interface of each packet, otherwise the polled one is used.
+	 */
+	int (*rx_poll)(const struct device *dev, struct net_pkt **pkts,
+		       int budget);
+#endif /* CONFIG_NET_ETHERNET_RX_POLL */
+
+#if defined(CONFIG_NET_ETHERNET_TX_BATCH)
+	/** Send several network packets in one call. Return the number
+	 * of packets sent, the ones after that are counted as TX errors.
+	 * If set, the L2 collects the packets of a TX burst and calls this
+	 * instead of send(). The packets are accounted for in the
+	 * statistics when this returns, not when they are queued.
+	 */
+	int (*send_batch)(const struct device *dev, struct net_pkt **pkts,
+			  int count);
+#endif /* CONFIG_NET_ETHERNET_TX_BATCH */
 };
 
 /* Make sure that the network interface API is properly setup inside
@@ -358,6 +391,30 @@ struct ethernet_context {
 	struct ethernet_lldp lldp[NET_VLAN_MAX_COUNT];
 #endif
 
+#if defined(CONFIG_NET_ETHERNET_RX_POLL)
+	struct {
+		/** Poll worker, runs the driver rx_poll() in the RX poll
+		 * work queue.
+		 */
+		struct k_work work;
+
+		/** Network interface the device is polled for */
+		struct net_if *iface;
+	} rx_poll;
+#endif
+
+#if defined(CONFIG_NET_ETHERNET_TX_BATCH)
+	struct {
+		struct k_spinlock lock;
+
+		/** Packets with L2 header waiting for send_batch() */
+		struct net_pkt *pkts[CONFIG_NET_ETHERNET_TX_BATCH_SIZE];
+
+		/** Number of packets in pkts */
+		uint8_t count;
+	} tx_batch;
+#endif
+
 	/**
 	 * This tells what L2 features does ethernet support.
 	 */
@@ -648,6 +705,31 @@ static inline bool net_eth_get_vlan_status(struct net_if *iface)
 
 #endif /* CONFIG_NET_VLAN */
 
+#if defined(CONFIG_NET_ETHERNET_RX_POLL) || defined(__DOXYGEN__)
+/**
+ * @brief Switch an ethernet device from interrupt to poll mode.
+ *
+ * Called by the driver, typically from its RX interrupt handler after
+ * masking the RX interrupt. The L2 then calls the rx_poll() function of
+ * the driver until it returns less than the poll budget.
+ *
+ * @param iface Network interface
+ */
+void net_eth_rx_poll_schedule(struct net_if *iface);
+#endif
+
+#if defined(CONFIG_NET_ETHERNET_TX_BATCH) || defined(__DOXYGEN__)
+/**
+ * @brief Send the packets batched for a network interface.
+ *
+ * Called by the network stack when a TX burst ends. Does nothing if the
+ * driver has no send_batch() function or no packets are pending.
+ *
+ * @param iface Network interface
+ */
+void net_eth_tx_flush(struct net_if *iface);
+#endif
+
 /**
  * @brief Inform ethernet L2 driver that ethernet carrier is detected.
  * This happens when cable is connected.
@@ -23,6 +23,7 @@
 #include <kernel.h>
 #include <net/net_ip.h>
 #include <net/http_parser.h>
+#include <net/tls_credentials.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -176,6 +177,9 @@ struct http_client_internal_data {
 
 	/** Request timeout */
 	k_timeout_t timeout;
+
+	/** Connection is kept open after the response */
+	bool keep_alive;
 };
 
 /**
@@ -285,6 +289,54 @@ struct http_request {
 int http_client_req(int sock, struct http_request *req,
 		    int32_t timeout, void *user_data);
 
+/**
+ * @brief Send a chunk of a request body with chunked transfer coding.
+ * This can be called from the payload callback of a request that has
+ * the "Transfer-Encoding: chunked" header field and zero payload_len,
+ * to stream the body without knowing its length in advance.
+ *
+ * @param sock Socket id of the connection.
+ * @param data Chunk data
+ * @param len Length of the chunk. A zero length ends the body.
+ *
+ * @return <0 if error, 0 if the chunk was sent
+ */
+int http_client_send_chunk(int sock, const void *data, size_t len);
+
+/**
+ * @brief Do HTTP requests on a pooled connection. The connection to the
+ * host is opened by the function, and kept open for later requests to the
+ * same host if the server allows it. All the requests are sent before the
+ * responses are read, so several requests cost one round trip. The
+ * response callback of each request is called as the data of its response
+ * is received.
+ *
+ * A receive buffer may be shared by the requests, but each one must be able
+ * to hold the data that the server sends in one segment.
+ *
+ * @param reqs HTTP requests, all of them to the same host and port.
+ * @param count Number of requests.
+ * @param sec_tag_list TLS credentials of the connection, or NULL for
+ *        a TCP connection.
+ * @param sec_tag_count Number of entries in sec_tag_list.
+ * @param timeout Max time to send the requests and receive all the
+ *        responses in milliseconds, or SYS_FOREVER_MS. The connection is
+ *        closed when it expires.
+ * @param user_data User specified data that is passed to the callbacks.
+ *
+ * @return <0 if error, otherwise the number of requests that got a
+ *         complete response. The requests after them were not answered
+ *         and can be sent again.
+ */
+int http_client_pool_req(struct http_request **reqs, size_t count,
+			 const sec_tag_t *sec_tag_list, size_t sec_tag_count,
+			 int32_t timeout, void *user_data);
+
+/**
+ * @brief Close the idle connections of the HTTP client pool.
+ */
+void http_client_pool_close(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -519,6 +519,196 @@ int lwm2m_engine_set_float64(char *pathstr, float64_value_t *value);
  */
 int lwm2m_engine_set_objlnk(char *pathstr, struct lwm2m_objlnk *value);
 
+/**
+ * @brief Pre-resolved LwM2M resource (instance) handle
+ *
+ * Filled in by lwm2m_engine_resolve_path() and passed to the
+ * lwm2m_engine_handle_set_*() functions to update a resource without
+ * parsing the path string and looking the resource up on every call.
+ * A handle transparently resolves itself again if the object instance or
+ * resource instance it refers to has been deleted in the meantime.
+ */
+struct lwm2m_engine_res_handle {
+	/** @cond INTERNAL_HIDDEN */
+	struct lwm2m_engine_obj_inst *obj_inst;
+	struct lwm2m_engine_obj_field *obj_field;
+	struct lwm2m_engine_res *res;
+	struct lwm2m_engine_res_inst *res_inst;
+	uint32_t generation;
+	uint16_t obj_id;
+	uint16_t obj_inst_id;
+	uint16_t res_id;
+	uint16_t res_inst_id;
+	uint8_t level;
+	/** @endcond */
+};
+
+/**
+ * @brief Resolve a resource (instance) path into a handle
+ *
+ * @param[in] pathstr LwM2M path string "obj/obj-inst/res(/res-inst)"
+ * @param[out] handle Handle to fill in
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_resolve_path(char *pathstr,
+			      struct lwm2m_engine_res_handle *handle);
+
+/**
+ * @brief Set resource (instance) value (opaque buffer) using a resolved handle
+ *
+ * @param[in] handle Handle from lwm2m_engine_resolve_path()
+ * @param[in] data_ptr Data buffer
+ * @param[in] data_len Length of buffer
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_opaque(struct lwm2m_engine_res_handle *handle,
+				   char *data_ptr, uint16_t data_len);
+
+/**
+ * @brief Set resource (instance) value (string) using a resolved handle
+ *
+ * @param[in] handle Handle from lwm2m_engine_resolve_path()
+ * @param[in] data_ptr NULL terminated char buffer
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_string(struct lwm2m_engine_res_handle *handle,
+				   char *data_ptr);
+
+/**
+ * @brief Set resource (instance) value (u8) using a resolved handle
+ *
+ * @param[in] handle Handle from lwm2m_engine_resolve_path()
+ * @param[in] value u8 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_u8(struct lwm2m_engine_res_handle *handle,
+			       uint8_t value);
+
+/**
+ * @brief Set resource (instance) value (u16) using a resolved handle
+ *
+ * @param[in] handle Handle from lwm2m_engine_resolve_path()
+ * @param[in] value u16 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_u16(struct lwm2m_engine_res_handle *handle,
+				uint16_t value);
+
+/**
+ * @brief Set resource (instance) value (u32) using a resolved handle
+ *
+ * @param[in] handle Handle from lwm2m_engine_resolve_path()
+ * @param[in] value u32 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_u32(struct lwm2m_engine_res_handle *handle,
+				uint32_t value);
+
+/**
+ * @brief Set resource (instance) value (u64) using a resolved handle
+ *
+ * @param[in] handle Handle from lwm2m_engine_resolve_path()
+ * @param[in] value u64 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_u64(struct lwm2m_engine_res_handle *handle,
+				uint64_t value);
+
+/**
+ * @brief Set resource (instance) value (s8) using a resolved handle
+ *
+ * @param[in] handle Handle from lwm2m_engine_resolve_path()
+ * @param[in] value s8 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_s8(struct lwm2m_engine_res_handle *handle,
+			       int8_t value);
+
+/**
+ * @brief Set resource (instance) value (s16) using a resolved handle
+ *
+ * @param[in] handle Handle from lwm2m_engine_resolve_path()
+ * @param[in] value s16 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_s16(struct lwm2m_engine_res_handle *handle,
+				int16_t value);
+
+/**
+ * @brief Set resource (instance) value (s32) using a resolved handle
+ *
+ * @param[in] handle Handle from lwm2m_engine_resolve_path()
+ * @param[in] value s32 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_s32(struct lwm2m_engine_res_handle *handle,
+				int32_t value);
+
+/**
+ * @brief Set resource (instance) value (s64) using a resolved handle
+ *
+ * @param[in] handle Handle from lwm2m_engine_resolve_path()
+ * @param[in] value s64 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_s64(struct lwm2m_engine_res_handle *handle,
+				int64_t value);
+
+/**
+ * @brief Set resource (instance) value (bool) using a resolved handle
+ *
+ * @param[in] handle Handle from lwm2m_engine_resolve_path()
+ * @param[in] value bool value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_bool(struct lwm2m_engine_res_handle *handle,
+				 bool value);
+
+/**
+ * @brief Set resource (instance) value (float32) using a resolved handle
+ *
+ * @param[in] handle Handle from lwm2m_engine_resolve_path()
+ * @param[in] value float32 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_float32(struct lwm2m_engine_res_handle *handle,
+				    float32_value_t *value);
+
+/**
+ * @brief Set resource (instance) value (float64) using a resolved handle
+ *
+ * @param[in] handle Handle from lwm2m_engine_resolve_path()
+ * @param[in] value float64 value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_float64(struct lwm2m_engine_res_handle *handle,
+				    float64_value_t *value);
+
+/**
+ * @brief Set resource (instance) value (objlnk) using a resolved handle
+ *
+ * @param[in] handle Handle from lwm2m_engine_resolve_path()
+ * @param[in] value pointer to the lwm2m_objlnk structure
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_handle_set_objlnk(struct lwm2m_engine_res_handle *handle,
+				   struct lwm2m_objlnk *value);
+
 /**
  * @brief Get resource (instance) value (opaque buffer)
  *
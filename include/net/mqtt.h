@@ -84,7 +84,8 @@ enum mqtt_evt_type {
 /** @brief MQTT version protocol level. */
 enum mqtt_version {
 	MQTT_VERSION_3_1_0 = 3, /**< Protocol level for 3.1.0. */
-	MQTT_VERSION_3_1_1 = 4  /**< Protocol level for 3.1.1. */
+	MQTT_VERSION_3_1_1 = 4, /**< Protocol level for 3.1.1. */
+	MQTT_VERSION_5_0 = 5    /**< Protocol level for 5.0. */
 };
 
 /** @brief MQTT Quality of Service types. */
@@ -201,18 +202,46 @@ struct mqtt_connack_param {
 
 	/** The appropriate non-zero Connect return code indicates if the Server
 	 *  is unable to process a connection request for some reason.
+	 *  With MQTT 5.0 this is the Connect Reason Code.
 	 */
 	enum mqtt_conn_return_code return_code;
+
+#if defined(CONFIG_MQTT_VERSION_5_0)
+	/** Maximum number of unacknowledged QoS 1 and QoS 2 messages the
+	 *  server accepts (MQTT 5.0 Receive Maximum).
+	 */
+	uint16_t receive_max;
+
+	/** Highest topic alias the server accepts, 0 if none
+	 *  (MQTT 5.0 Topic Alias Maximum).
+	 */
+	uint16_t topic_alias_max;
+
+	/** Maximum packet size the server accepts, 0 if not limited
+	 *  (MQTT 5.0 Maximum Packet Size).
+	 */
+	uint32_t max_packet_size;
+#endif /* CONFIG_MQTT_VERSION_5_0 */
 };
 
 /** @brief Parameters for MQTT publish acknowledgment (PUBACK). */
 struct mqtt_puback_param {
 	uint16_t message_id;
+
+	/** MQTT 5.0 Reason Code, always 0 (success) with MQTT 3.1.x.
+	 *  A value of 0x80 or greater indicates a failure.
+	 */
+	uint8_t reason_code;
 };
 
 /** @brief Parameters for MQTT publish receive (PUBREC). */
 struct mqtt_pubrec_param {
 	uint16_t message_id;
+
+	/** MQTT 5.0 Reason Code, always 0 (success) with MQTT 3.1.x.
+	 *  A value of 0x80 or greater indicates a failure.
+	 */
+	uint8_t reason_code;
 };
 
 /** @brief Parameters for MQTT publish release (PUBREL). */
@@ -223,6 +252,11 @@ struct mqtt_pubrel_param {
 /** @brief Parameters for MQTT publish complete (PUBCOMP). */
 struct mqtt_pubcomp_param {
 	uint16_t message_id;
+
+	/** MQTT 5.0 Reason Code, always 0 (success) with MQTT 3.1.x.
+	 *  A value of 0x80 or greater indicates a failure.
+	 */
+	uint8_t reason_code;
 };
 
 /** @brief Parameters for MQTT subscription acknowledgment (SUBACK). */
@@ -450,6 +484,43 @@ struct mqtt_internal {
 
 	/** Internal. Remaining payload length to read. */
 	uint32_t remaining_payload;
+
+#if defined(CONFIG_MQTT_VERSION_5_0)
+	/** Internal. Receive Maximum of the server. */
+	uint16_t server_receive_max;
+
+	/** Internal. Topic Alias Maximum of the server. */
+	uint16_t server_topic_alias_max;
+
+	/** Internal. Maximum Packet Size of the server, 0 if not limited. */
+	uint32_t server_max_packet_size;
+
+	/** Internal. Number of topic aliases assigned on the connection. */
+	uint8_t topic_alias_count;
+
+	/** Internal. Topics of the assigned aliases, alias N is entry N - 1.
+	 */
+	struct {
+		uint8_t len;
+		uint8_t topic[CONFIG_MQTT_TOPIC_ALIAS_MAX_LEN];
+	} topic_alias[CONFIG_MQTT_TOPIC_ALIAS_MAX];
+#endif /* CONFIG_MQTT_VERSION_5_0 */
+
+#if defined(CONFIG_MQTT_PUBLISH_QUEUE)
+	/** Internal. Lock protecting the publish queue, producers do not
+	 *  take the client mutex.
+	 */
+	struct k_spinlock queue_lock;
+
+	/** Internal. Encoded messages waiting to be sent. */
+	sys_slist_t queue;
+
+	/** Internal. QoS 1 and QoS 2 messages sent and not completed. */
+	sys_slist_t inflight;
+
+	/** Internal. Number of messages in the in-flight list. */
+	uint8_t inflight_count;
+#endif /* CONFIG_MQTT_PUBLISH_QUEUE */
 };
 
 /**
@@ -569,7 +640,9 @@ int mqtt_client_set_proxy(struct mqtt_client *client,
  * @return 0 or a negative error code (errno.h) indicating reason of failure.
  *
  * @note Default protocol revision used for connection request is 3.1.1. Please
- *       set client.protocol_version = MQTT_VERSION_3_1_0 to use protocol 3.1.0.
+ *       set client.protocol_version = MQTT_VERSION_3_1_0 to use protocol 3.1.0,
+ *       or MQTT_VERSION_5_0 to use protocol 5.0 if
+ *       @option{CONFIG_MQTT_VERSION_5_0} is enabled.
  * @note
  *       Please modify @option{CONFIG_MQTT_KEEPALIVE} time to override default
  *       of 1 minute.
@@ -579,6 +652,10 @@ int mqtt_connect(struct mqtt_client *client);
 /**
  * @brief API to publish messages on topics.
  *
+ * With MQTT 5.0, a topic alias is assigned to the topic of the message if
+ * the broker allows it, and the later messages on the same topic are sent
+ * with the alias only.
+ *
  * @param[in] client Client instance for which the procedure is requested.
  *                   Shall not be NULL.
  * @param[in] param Parameters to be used for the publish message.
@@ -589,6 +666,56 @@ int mqtt_connect(struct mqtt_client *client);
 int mqtt_publish(struct mqtt_client *client,
 		 const struct mqtt_publish_param *param);
 
+#if defined(CONFIG_MQTT_PUBLISH_QUEUE)
+/**
+ * @brief API to queue a message for publishing without waiting for the
+ *        transport. May be called from any thread.
+ *
+ * The message, including the payload, is encoded into a queue buffer so
+ * the parameters are not referenced after the call. Queued messages are
+ * written by @ref mqtt_input, @ref mqtt_live and
+ * @ref mqtt_publish_queue_flush, several of them in a single transport
+ * write if possible.
+ *
+ * QoS 1 and QoS 2 messages are kept by the library until the broker has
+ * completed them, the library sends PUBREL on reception of
+ * @ref MQTT_EVT_PUBREC. At most @option{CONFIG_MQTT_PUBLISH_QUEUE_INFLIGHT}
+ * of them are unacknowledged at a time. The uncompleted messages are
+ * retransmitted after a new connection has been accepted.
+ *
+ * @param[in] client Client instance for which the procedure is requested.
+ *                   Shall not be NULL.
+ * @param[in] param Parameters to be used for the publish message.
+ *                  Shall not be NULL.
+ * @param[in] timeout Time to wait for a free queue buffer.
+ *
+ * @return 0 or a negative error code (errno.h) indicating reason of failure.
+ */
+int mqtt_publish_enqueue(struct mqtt_client *client,
+			 const struct mqtt_publish_param *param,
+			 k_timeout_t timeout);
+
+/**
+ * @brief API to write the queued messages allowed by the in-flight window.
+ *        Shall be called from the thread that services the connection.
+ *
+ * @param[in] client Client instance for which the procedure is requested.
+ *                   Shall not be NULL.
+ *
+ * @return 0 or a negative error code (errno.h) indicating reason of failure.
+ */
+int mqtt_publish_queue_flush(struct mqtt_client *client);
+
+/**
+ * @brief API to drop all the queued and in-flight messages, for instance
+ *        before connecting with a clean session.
+ *
+ * @param[in] client Client instance for which the procedure is requested.
+ *                   Shall not be NULL.
+ */
+void mqtt_publish_queue_clear(struct mqtt_client *client);
+#endif /* CONFIG_MQTT_PUBLISH_QUEUE */
+
 /**
  * @brief API used by client to send acknowledgment on receiving QoS1 publish
  *        message. Should be called on reception of @ref MQTT_EVT_PUBLISH with
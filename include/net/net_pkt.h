@@ -128,6 +128,11 @@ struct net_pkt {
 	/** Reference counter */
 	atomic_t atomic_ref;
 
+#if defined(CONFIG_NET_ETHERNET_TX_BATCH)
+	/* Is the packet waiting in a TX traffic class queue */
+	atomic_t tx_queued;
+#endif
+
 	/* Filled by layer 2 when network packet is received. */
 	struct net_linkaddr lladdr_src;
 	struct net_linkaddr lladdr_dst;
@@ -190,6 +195,20 @@ struct net_pkt {
 					*/
 #endif
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+	uint8_t ipv4_reassembled  : 1; /* Is this pkt reassembled from IPv4
+					* fragments. Such a pkt does not have
+					* link layer headers in it.
+					*/
+#endif
+
+#if defined(CONFIG_NET_TCP_GRO)
+	uint8_t tcp_chksum_ok     : 1; /* Has the TCP checksum of this pkt
+					* been verified already when received
+					* segments were coalesced.
+					*/
+#endif
+
 	union {
 		/* IPv6 hop limit or IPv4 ttl for this network packet.
 		 * The value is shared between IPv6 and IPv4.
@@ -212,6 +231,13 @@ struct net_pkt {
 	 */
 	uint8_t priority;
 
+#if defined(CONFIG_NET_TCP_GSO)
+	/* Segment size this TCP packet is split to before it is given to
+	 * the driver, 0 if the packet is sent as is.
+	 */
+	uint16_t tcp_gso_size;
+#endif /* CONFIG_NET_TCP_GSO */
+
 #if defined(CONFIG_NET_VLAN)
 	/* VLAN TCI (Tag Control Information). This contains the Priority
 	 * Code Point (PCP), Drop Eligible Indicator (DEI) and VLAN
@@ -600,6 +626,87 @@ static inline uint16_t net_pkt_ip_opts_len(struct net_pkt *pkt)
 #endif
 }
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+static inline bool net_pkt_ipv4_is_reassembled(struct net_pkt *pkt)
+{
+	return !!pkt->ipv4_reassembled;
+}
+
+static inline void net_pkt_set_ipv4_reassembled(struct net_pkt *pkt,
+						bool is_reassembled)
+{
+	pkt->ipv4_reassembled = is_reassembled;
+}
+#else /* CONFIG_NET_IPV4_FRAGMENT */
+static inline bool net_pkt_ipv4_is_reassembled(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return false;
+}
+
+static inline void net_pkt_set_ipv4_reassembled(struct net_pkt *pkt,
+						bool is_reassembled)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(is_reassembled);
+}
+#endif /* CONFIG_NET_IPV4_FRAGMENT */
+
+#if defined(CONFIG_NET_TCP_GSO)
+static inline uint16_t net_pkt_tcp_gso_size(struct net_pkt *pkt)
+{
+	return pkt->tcp_gso_size;
+}
+
+static inline void net_pkt_set_tcp_gso_size(struct net_pkt *pkt,
+					    uint16_t size)
+{
+	pkt->tcp_gso_size = size;
+}
+#else /* CONFIG_NET_TCP_GSO */
+static inline uint16_t net_pkt_tcp_gso_size(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return 0;
+}
+
+static inline void net_pkt_set_tcp_gso_size(struct net_pkt *pkt,
+					    uint16_t size)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(size);
+}
+#endif /* CONFIG_NET_TCP_GSO */
+
+#if defined(CONFIG_NET_TCP_GRO)
+static inline bool net_pkt_is_tcp_chksum_ok(struct net_pkt *pkt)
+{
+	return !!pkt->tcp_chksum_ok;
+}
+
+static inline void net_pkt_set_tcp_chksum_ok(struct net_pkt *pkt,
+					     bool is_ok)
+{
+	pkt->tcp_chksum_ok = is_ok;
+}
+#else /* CONFIG_NET_TCP_GRO */
+static inline bool net_pkt_is_tcp_chksum_ok(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return false;
+}
+
+static inline void net_pkt_set_tcp_chksum_ok(struct net_pkt *pkt,
+					     bool is_ok)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(is_ok);
+}
+#endif /* CONFIG_NET_TCP_GRO */
+
 #if defined(CONFIG_NET_IPV6_FRAGMENT)
 static inline uint16_t net_pkt_ipv6_fragment_start(struct net_pkt *pkt)
 {
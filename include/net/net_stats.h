@@ -72,6 +72,26 @@ struct net_stats_ip {
 	net_stats_t drop;
 };
 
+/**
+ * @brief IP fragmentation and reassembly statistics
+ */
+struct net_stats_ip_frag {
+	/** Number of received IP fragments. */
+	net_stats_t recv;
+
+	/** Number of sent IP fragments. */
+	net_stats_t sent;
+
+	/** Number of IP packets that were successfully reassembled. */
+	net_stats_t reassembled;
+
+	/** Number of reassemblies that timed out before completion. */
+	net_stats_t timeout;
+
+	/** Number of dropped IP fragments. */
+	net_stats_t drop;
+};
+
 /**
  * @brief IP layer error statistics
  */
@@ -283,6 +303,16 @@ struct net_stats {
 	struct net_stats_ip ipv4;
 #endif
 
+#if defined(CONFIG_NET_STATISTICS_IPV6_FRAGMENT)
+	/** IPv6 fragmentation statistics */
+	struct net_stats_ip_frag ipv6_frag;
+#endif
+
+#if defined(CONFIG_NET_STATISTICS_IPV4_FRAGMENT)
+	/** IPv4 fragmentation statistics */
+	struct net_stats_ip_frag ipv4_frag;
+#endif
+
 #if defined(CONFIG_NET_STATISTICS_ICMP)
 	/** ICMP statistics */
 	struct net_stats_icmp icmp;
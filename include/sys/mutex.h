@@ -11,9 +11,12 @@
  * sys_mutex behaves almost exactly like k_mutex, with the added advantage
  * that a sys_mutex instance can reside in user memory.
  *
- * Further enhancements will support locking/unlocking uncontended sys_mutexes
- * with simple atomic ops instead of syscalls, similar to Linux's
- * FUTEX_LOCK_PI and FUTEX_UNLOCK_PI
+ * With userspace enabled, an uncontended sys_mutex is locked and unlocked
+ * with atomic operations on its owner word, without system calls, similar
+ * to Linux's FUTEX_LOCK_PI and FUTEX_UNLOCK_PI. The kernel takes over the
+ * owner recorded in the word when another thread waits for the mutex, so
+ * priority inheritance works as with k_mutex, and hands the mutex back to
+ * user mode once it is unlocked with no thread waiting.
  */
 
 #ifdef __cplusplus
@@ -21,16 +24,22 @@ extern "C" {
 #endif
 
 #ifdef CONFIG_USERSPACE
+#include <kernel.h>
+#include <errno.h>
 #include <sys/atomic.h>
 #include <zephyr/types.h>
 #include <sys_clock.h>
 
+/* Set in the owner word while the mutex is managed in user mode. The word
+ * is then Z_SYS_MUTEX_USER if the mutex is unlocked, or the owner thread
+ * with Z_SYS_MUTEX_USER set. It is NULL while the mutex is managed by its
+ * kernel mutex, which is the initial state.
+ */
+#define Z_SYS_MUTEX_USER BIT(0)
+
 struct sys_mutex {
-	/* Currently unused, but will be used to store state for fast mutexes
-	 * that can be locked/unlocked with atomic ops if there is no
-	 * contention
-	 */
-	atomic_t val;
+	/* Owner word */
+	atomic_ptr_t owner;
 };
 
 #define SYS_MUTEX_DEFINE(name) \
@@ -64,6 +73,14 @@ __syscall int z_sys_mutex_kernel_lock(struct sys_mutex *mutex,
 
 __syscall int z_sys_mutex_kernel_unlock(struct sys_mutex *mutex);
 
+/* Lock and unlock the kernel mutex of a sys_mutex, after taking over the
+ * state of its owner word. Used by the system calls.
+ */
+int z_mutex_sys_lock(struct k_mutex *mutex, atomic_ptr_t *owner,
+		     k_timeout_t timeout);
+
+int z_mutex_sys_unlock(struct k_mutex *mutex, atomic_ptr_t *owner);
+
 /**
  * @brief Lock a mutex.
  *
@@ -74,6 +91,9 @@ __syscall int z_sys_mutex_kernel_unlock(struct sys_mutex *mutex);
  * A thread is permitted to lock a mutex it has already locked. The operation
  * completes immediately and the lock count is increased by 1.
  *
+ * A user thread that has no access to the mutex memory faults, as the
+ * uncontended case is handled without a system call.
+ *
  * @param mutex Address of the mutex, which may reside in user memory
  * @param timeout Waiting period to lock the mutex,
  *                or one of the special values K_NO_WAIT and K_FOREVER.
@@ -81,12 +101,32 @@ __syscall int z_sys_mutex_kernel_unlock(struct sys_mutex *mutex);
  * @retval 0 Mutex locked.
  * @retval -EBUSY Returned without waiting.
  * @retval -EAGAIN Waiting period timed out.
- * @retval -EACCESS Caller has no access to provided mutex address
- * @retval -EINVAL Provided mutex not recognized by the kernel
+ * @retval -EINVAL Provided mutex not recognized by the kernel, or its owner
+ *                 word names a thread that cannot access it
  */
 static inline int sys_mutex_lock(struct sys_mutex *mutex, k_timeout_t timeout)
 {
-	/* For now, make the syscall unconditionally */
+	void *self, *owner;
+
+	if (mutex == NULL) {
+		return -EINVAL;
+	}
+
+	self = (void *)((uintptr_t)k_current_get() | Z_SYS_MUTEX_USER);
+
+	if (atomic_ptr_cas(&mutex->owner, (void *)Z_SYS_MUTEX_USER, self)) {
+		return 0;
+	}
+
+	/* Locked by another thread in user mode */
+	owner = atomic_ptr_get(&mutex->owner);
+	if (K_TIMEOUT_EQ(timeout, K_NO_WAIT) &&
+	    (((uintptr_t)owner & Z_SYS_MUTEX_USER) != 0U) &&
+	    (owner != (void *)Z_SYS_MUTEX_USER) && (owner != self)) {
+		return -EBUSY;
+	}
+
+	/* Contended, locked again by its owner, or managed by the kernel */
 	return z_sys_mutex_kernel_lock(mutex, timeout);
 }
 
@@ -100,15 +140,28 @@ static inline int sys_mutex_lock(struct sys_mutex *mutex, k_timeout_t timeout)
  * the calling thread as many times as it was previously locked by that
  * thread.
  *
+ * A user thread that has no access to the mutex memory faults, as the
+ * uncontended case is handled without a system call.
+ *
  * @param mutex Address of the mutex, which may reside in user memory
- * @retval -EACCESS Caller has no access to provided mutex address
  * @retval -EINVAL Provided mutex not recognized by the kernel or mutex wasn't
  *                 locked
  * @retval -EPERM Caller does not own the mutex
  */
 static inline int sys_mutex_unlock(struct sys_mutex *mutex)
 {
-	/* For now, make the syscall unconditionally */
+	void *self;
+
+	if (mutex == NULL) {
+		return -EINVAL;
+	}
+
+	self = (void *)((uintptr_t)k_current_get() | Z_SYS_MUTEX_USER);
+
+	if (atomic_ptr_cas(&mutex->owner, self, (void *)Z_SYS_MUTEX_USER)) {
+		return 0;
+	}
+
 	return z_sys_mutex_kernel_unlock(mutex);
 }
 
@@ -0,0 +1,630 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+/** @file
+ *
+ * @brief Lock-free byte ring buffers.
+ *
+ * These ring buffers provide the same zero-copy claim/finish interface as
+ * @ref ring_buffer_apis but use atomic indexes instead of requiring callers
+ * to serialize access with an IRQ lock or spinlock. Two variants exist:
+ *
+ * - @ref ring_buf_spsc, for one producer and one consumer, which may run
+ *   concurrently on different CPUs or in thread and ISR context.
+ * - @ref ring_buf_mpsc, for any number of concurrent producers and a single
+ *   consumer.
+ * - @ref ring_buf_mpmc, for any number of concurrent producers and
+ *   consumers.
+ *
+ * Buffer size must be a power of 2. Indexes are free running and the whole
+ * buffer is usable (no slot is sacrificed to distinguish full from empty).
+ * Producer and consumer state are placed on separate cache lines (see
+ * CONFIG_RING_BUFFER_LOCKFREE_ALIGN) to avoid false sharing on SMP.
+ */
+
+#ifndef ZEPHYR_INCLUDE_SYS_RING_BUFFER_LOCKFREE_H_
+#define ZEPHYR_INCLUDE_SYS_RING_BUFFER_LOCKFREE_H_
+
+#include <kernel.h>
+#include <sys/atomic.h>
+#include <sys/util.h>
+#include <errno.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup ring_buffer_lockfree_apis Lock-free Ring Buffer APIs
+ * @ingroup kernel_apis
+ * @{
+ */
+
+/** @cond INTERNAL_HIDDEN */
+
+#define Z_RING_BUF_LF_ALIGN __aligned(CONFIG_RING_BUFFER_LOCKFREE_ALIGN)
+
+/* Multi-producer indexes wrap at 2^24, the upper 8 bits of the producer
+ * state word count outstanding claims.
+ */
+#define Z_RING_BUF_MP_IDX_MASK 0x00FFFFFFU
+#define Z_RING_BUF_MP_CNT_SHIFT 24U
+#define Z_RING_BUF_MP_MAX_SIZE BIT(23)
+
+struct z_ring_buf_lf_cons {
+	atomic_t head;		/**< Published read index */
+	uint32_t tmp_head;	/**< Claimed (not yet finished) read index */
+} Z_RING_BUF_LF_ALIGN;
+
+struct z_ring_buf_lf {
+	uint8_t *data;		/**< Storage area */
+	uint32_t mask;		/**< Storage size - 1 */
+	uint32_t idx_mask;	/**< Mask applied to free running indexes */
+} Z_RING_BUF_LF_ALIGN;
+
+/** @endcond */
+
+/**
+ * @brief Single-producer, single-consumer lock-free ring buffer.
+ */
+struct ring_buf_spsc {
+	/** @cond INTERNAL_HIDDEN */
+	struct z_ring_buf_lf buf;
+	struct {
+		atomic_t tail;		/**< Published write index */
+		uint32_t tmp_tail;	/**< Claimed write index */
+	} prod Z_RING_BUF_LF_ALIGN;
+	struct z_ring_buf_lf_cons cons;
+	/** @endcond */
+};
+
+/**
+ * @brief Multi-producer, single-consumer lock-free ring buffer.
+ */
+struct ring_buf_mpsc {
+	/** @cond INTERNAL_HIDDEN */
+	struct z_ring_buf_lf buf;
+	struct {
+		/** Reserved write index and outstanding claim count */
+		atomic_t state;
+		/** Published write index */
+		atomic_t tail;
+	} prod Z_RING_BUF_LF_ALIGN;
+	struct z_ring_buf_lf_cons cons;
+	/** @endcond */
+};
+
+/**
+ * @brief Multi-producer, multi-consumer lock-free ring buffer.
+ */
+struct ring_buf_mpmc {
+	/** @cond INTERNAL_HIDDEN */
+	struct z_ring_buf_lf buf;
+	struct {
+		/** Reserved write index and outstanding claim count */
+		atomic_t state;
+		/** Published write index */
+		atomic_t tail;
+	} prod Z_RING_BUF_LF_ALIGN;
+	struct {
+		/** Reserved read index and outstanding claim count */
+		atomic_t state;
+		/** Published read index */
+		atomic_t head;
+	} cons Z_RING_BUF_LF_ALIGN;
+	/** @endcond */
+};
+
+/** @cond INTERNAL_HIDDEN */
+#define Z_RING_BUF_LF_INITIALIZER(_data, _size, _idx_mask) \
+	{ \
+		.buf = { \
+			.data = _data, \
+			.mask = (_size) - 1U, \
+			.idx_mask = _idx_mask, \
+		}, \
+	}
+/** @endcond */
+
+/**
+ * @brief Statically define and initialize a SPSC lock-free ring buffer.
+ *
+ * @param name Name of the ring buffer.
+ * @param pow Ring buffer size exponent; the buffer holds 2^pow bytes.
+ */
+#define RING_BUF_SPSC_DECLARE_POW2(name, pow) \
+	static uint8_t _ring_buf_spsc_data_##name[BIT(pow)]; \
+	struct ring_buf_spsc name = \
+		Z_RING_BUF_LF_INITIALIZER(_ring_buf_spsc_data_##name, \
+					  BIT(pow), UINT32_MAX)
+
+/**
+ * @brief Statically define and initialize a MPSC lock-free ring buffer.
+ *
+ * @param name Name of the ring buffer.
+ * @param pow Ring buffer size exponent; the buffer holds 2^pow bytes.
+ *	      Must not exceed 23.
+ */
+#define RING_BUF_MPSC_DECLARE_POW2(name, pow) \
+	BUILD_ASSERT((pow) <= 23, "MPSC ring buffer too large"); \
+	static uint8_t _ring_buf_mpsc_data_##name[BIT(pow)]; \
+	struct ring_buf_mpsc name = \
+		Z_RING_BUF_LF_INITIALIZER(_ring_buf_mpsc_data_##name, \
+					  BIT(pow), Z_RING_BUF_MP_IDX_MASK)
+
+/**
+ * @brief Statically define and initialize a MPMC lock-free ring buffer.
+ *
+ * @param name Name of the ring buffer.
+ * @param pow Ring buffer size exponent; the buffer holds 2^pow bytes.
+ *	      Must not exceed 23.
+ */
+#define RING_BUF_MPMC_DECLARE_POW2(name, pow) \
+	BUILD_ASSERT((pow) <= 23, "MPMC ring buffer too large"); \
+	static uint8_t _ring_buf_mpmc_data_##name[BIT(pow)]; \
+	struct ring_buf_mpmc name = \
+		Z_RING_BUF_LF_INITIALIZER(_ring_buf_mpmc_data_##name, \
+					  BIT(pow), Z_RING_BUF_MP_IDX_MASK)
+
+/** @cond INTERNAL_HIDDEN */
+
+uint32_t z_ring_buf_lf_get_claim(struct z_ring_buf_lf *buf,
+				 struct z_ring_buf_lf_cons *cons,
+				 uint32_t tail, uint8_t **data, uint32_t size);
+
+int z_ring_buf_lf_get_finish(struct z_ring_buf_lf *buf,
+			     struct z_ring_buf_lf_cons *cons,
+			     uint32_t tail, uint32_t size);
+
+uint32_t z_ring_buf_lf_get(struct z_ring_buf_lf *buf,
+			   struct z_ring_buf_lf_cons *cons,
+			   atomic_t *tail, uint8_t *data, uint32_t size);
+
+static inline uint32_t z_ring_buf_lf_used(const struct z_ring_buf_lf *buf,
+					  uint32_t head, uint32_t tail)
+{
+	return (tail - head) & buf->idx_mask;
+}
+
+/** @endcond */
+
+/**
+ * @brief Initialize a SPSC lock-free ring buffer.
+ *
+ * @param rb Address of ring buffer.
+ * @param size Ring buffer size in bytes, must be a power of 2.
+ * @param data Ring buffer data area.
+ */
+static inline void ring_buf_spsc_init(struct ring_buf_spsc *rb,
+				      uint32_t size, uint8_t *data)
+{
+	__ASSERT(is_power_of_two(size), "Size must be a power of 2");
+
+	memset(rb, 0, sizeof(*rb));
+	rb->buf.data = data;
+	rb->buf.mask = size - 1U;
+	rb->buf.idx_mask = UINT32_MAX;
+}
+
+/**
+ * @brief Return ring buffer capacity.
+ *
+ * @param rb Address of ring buffer.
+ *
+ * @return Ring buffer capacity in bytes.
+ */
+static inline uint32_t ring_buf_spsc_capacity_get(struct ring_buf_spsc *rb)
+{
+	return rb->buf.mask + 1U;
+}
+
+/**
+ * @brief Determine if a ring buffer is empty.
+ *
+ * The result is a snapshot and may be stale by the time it is used if the
+ * other side is running concurrently.
+ *
+ * @param rb Address of ring buffer.
+ *
+ * @return true if the ring buffer is empty.
+ */
+static inline bool ring_buf_spsc_is_empty(struct ring_buf_spsc *rb)
+{
+	return atomic_get(&rb->cons.head) == atomic_get(&rb->prod.tail);
+}
+
+/**
+ * @brief Determine free space in a ring buffer.
+ *
+ * @param rb Address of ring buffer.
+ *
+ * @return Ring buffer free space in bytes (snapshot).
+ */
+static inline uint32_t ring_buf_spsc_space_get(struct ring_buf_spsc *rb)
+{
+	return ring_buf_spsc_capacity_get(rb) -
+	       z_ring_buf_lf_used(&rb->buf, atomic_get(&rb->cons.head),
+				  atomic_get(&rb->prod.tail));
+}
+
+/**
+ * @brief Allocate buffer for writing data to a SPSC ring buffer.
+ *
+ * Behaves like @ref ring_buf_put_claim. Must only be called by the single
+ * producer.
+ *
+ * @param[in]  rb   Address of ring buffer.
+ * @param[out] data Set to a location within the ring buffer.
+ * @param[in]  size Requested allocation size (in bytes).
+ *
+ * @return Size of allocated buffer which can be smaller than requested if
+ *	   there is not enough free space or buffer wraps.
+ */
+uint32_t ring_buf_spsc_put_claim(struct ring_buf_spsc *rb, uint8_t **data,
+				 uint32_t size);
+
+/**
+ * @brief Publish bytes written to claimed buffers to the consumer.
+ *
+ * Any claimed but unfinished bytes are returned to the ring buffer.
+ *
+ * @param rb   Address of ring buffer.
+ * @param size Number of valid bytes in the claimed buffers.
+ *
+ * @retval 0 Successful operation.
+ * @retval -EINVAL Provided @a size exceeds the claimed size.
+ */
+int ring_buf_spsc_put_finish(struct ring_buf_spsc *rb, uint32_t size);
+
+/**
+ * @brief Write (copy) data to a SPSC ring buffer.
+ *
+ * @param rb   Address of ring buffer.
+ * @param data Address of data.
+ * @param size Data size (in bytes).
+ *
+ * @return Number of bytes written.
+ */
+uint32_t ring_buf_spsc_put(struct ring_buf_spsc *rb, const uint8_t *data,
+			   uint32_t size);
+
+/**
+ * @brief Get address of valid data in a SPSC ring buffer.
+ *
+ * Behaves like @ref ring_buf_get_claim. Must only be called by the single
+ * consumer.
+ *
+ * @param[in]  rb   Address of ring buffer.
+ * @param[out] data Set to a location within the ring buffer.
+ * @param[in]  size Requested size (in bytes).
+ *
+ * @return Number of valid bytes at @a data.
+ */
+static inline uint32_t ring_buf_spsc_get_claim(struct ring_buf_spsc *rb,
+					       uint8_t **data, uint32_t size)
+{
+	return z_ring_buf_lf_get_claim(&rb->buf, &rb->cons,
+				       atomic_get(&rb->prod.tail), data, size);
+}
+
+/**
+ * @brief Release bytes read from claimed buffers back to the producer.
+ *
+ * @param rb   Address of ring buffer.
+ * @param size Number of bytes that can be freed.
+ *
+ * @retval 0 Successful operation.
+ * @retval -EINVAL Provided @a size exceeds valid bytes in the ring buffer.
+ */
+static inline int ring_buf_spsc_get_finish(struct ring_buf_spsc *rb,
+					   uint32_t size)
+{
+	return z_ring_buf_lf_get_finish(&rb->buf, &rb->cons,
+					atomic_get(&rb->prod.tail), size);
+}
+
+/**
+ * @brief Read data from a SPSC ring buffer.
+ *
+ * @param rb   Address of ring buffer.
+ * @param data Address of the output buffer.
+ * @param size Data size (in bytes).
+ *
+ * @return Number of bytes written to the output buffer.
+ */
+static inline uint32_t ring_buf_spsc_get(struct ring_buf_spsc *rb,
+					 uint8_t *data, uint32_t size)
+{
+	return z_ring_buf_lf_get(&rb->buf, &rb->cons, &rb->prod.tail,
+				 data, size);
+}
+
+/**
+ * @brief Initialize a MPSC lock-free ring buffer.
+ *
+ * @param rb Address of ring buffer.
+ * @param size Ring buffer size in bytes, must be a power of 2 no larger
+ *	       than 2^23.
+ * @param data Ring buffer data area.
+ */
+static inline void ring_buf_mpsc_init(struct ring_buf_mpsc *rb,
+				      uint32_t size, uint8_t *data)
+{
+	__ASSERT(is_power_of_two(size), "Size must be a power of 2");
+	__ASSERT(size <= Z_RING_BUF_MP_MAX_SIZE, "Size too large");
+
+	memset(rb, 0, sizeof(*rb));
+	rb->buf.data = data;
+	rb->buf.mask = size - 1U;
+	rb->buf.idx_mask = Z_RING_BUF_MP_IDX_MASK;
+}
+
+/**
+ * @brief Return ring buffer capacity.
+ *
+ * @param rb Address of ring buffer.
+ *
+ * @return Ring buffer capacity in bytes.
+ */
+static inline uint32_t ring_buf_mpsc_capacity_get(struct ring_buf_mpsc *rb)
+{
+	return rb->buf.mask + 1U;
+}
+
+/**
+ * @brief Determine if a ring buffer is empty.
+ *
+ * @param rb Address of ring buffer.
+ *
+ * @return true if no published data is pending (snapshot).
+ */
+static inline bool ring_buf_mpsc_is_empty(struct ring_buf_mpsc *rb)
+{
+	return atomic_get(&rb->cons.head) == atomic_get(&rb->prod.tail);
+}
+
+/**
+ * @brief Reserve buffer for writing data to a MPSC ring buffer.
+ *
+ * May be called concurrently by any number of producers, from thread or
+ * ISR context. Each non-zero claim must be followed by exactly one call to
+ * @ref ring_buf_mpsc_put_finish with the full claimed size. Claimed space
+ * cannot be partially returned because other producers may already have
+ * reserved space behind it.
+ *
+ * Published data becomes visible to the consumer once every claim that was
+ * outstanding at the same time has been finished, so claim/finish windows
+ * should be kept short.
+ *
+ * @param[in]  rb   Address of ring buffer.
+ * @param[out] data Set to a location within the ring buffer.
+ * @param[in]  size Requested allocation size (in bytes).
+ *
+ * @return Size of reserved buffer which can be smaller than requested if
+ *	   there is not enough free space or buffer wraps. Zero if nothing
+ *	   was reserved.
+ */
+uint32_t ring_buf_mpsc_put_claim(struct ring_buf_mpsc *rb, uint8_t **data,
+				 uint32_t size);
+
+/**
+ * @brief Finish a claim made with @ref ring_buf_mpsc_put_claim.
+ *
+ * @param rb   Address of ring buffer.
+ * @param size Size returned by the matching claim.
+ *
+ * @retval 0 Successful operation.
+ * @retval -EINVAL No claim is outstanding or @a size is invalid.
+ */
+int ring_buf_mpsc_put_finish(struct ring_buf_mpsc *rb, uint32_t size);
+
+/**
+ * @brief Write (copy) data to a MPSC ring buffer.
+ *
+ * Data is written as a single contiguous record: either all of @a size
+ * bytes are written or none are. Records never wrap around the end of the
+ * storage area, so large records may fail while the buffer is not full.
+ *
+ * @param rb   Address of ring buffer.
+ * @param data Address of data.
+ * @param size Data size (in bytes).
+ *
+ * @return Number of bytes written, @a size or 0.
+ */
+uint32_t ring_buf_mpsc_put(struct ring_buf_mpsc *rb, const uint8_t *data,
+			   uint32_t size);
+
+/**
+ * @brief Get address of valid data in a MPSC ring buffer.
+ *
+ * Must only be called by the single consumer.
+ *
+ * @param[in]  rb   Address of ring buffer.
+ * @param[out] data Set to a location within the ring buffer.
+ * @param[in]  size Requested size (in bytes).
+ *
+ * @return Number of valid bytes at @a data.
+ */
+static inline uint32_t ring_buf_mpsc_get_claim(struct ring_buf_mpsc *rb,
+					       uint8_t **data, uint32_t size)
+{
+	return z_ring_buf_lf_get_claim(&rb->buf, &rb->cons,
+				       atomic_get(&rb->prod.tail), data, size);
+}
+
+/**
+ * @brief Release bytes read from claimed buffers back to the producers.
+ *
+ * @param rb   Address of ring buffer.
+ * @param size Number of bytes that can be freed.
+ *
+ * @retval 0 Successful operation.
+ * @retval -EINVAL Provided @a size exceeds valid bytes in the ring buffer.
+ */
+static inline int ring_buf_mpsc_get_finish(struct ring_buf_mpsc *rb,
+					   uint32_t size)
+{
+	return z_ring_buf_lf_get_finish(&rb->buf, &rb->cons,
+					atomic_get(&rb->prod.tail), size);
+}
+
+/**
+ * @brief Read data from a MPSC ring buffer.
+ *
+ * @param rb   Address of ring buffer.
+ * @param data Address of the output buffer.
+ * @param size Data size (in bytes).
+ *
+ * @return Number of bytes written to the output buffer.
+ */
+static inline uint32_t ring_buf_mpsc_get(struct ring_buf_mpsc *rb,
+					 uint8_t *data, uint32_t size)
+{
+	return z_ring_buf_lf_get(&rb->buf, &rb->cons, &rb->prod.tail,
+				 data, size);
+}
+
+/**
+ * @brief Initialize a MPMC lock-free ring buffer.
+ *
+ * @param rb Address of ring buffer.
+ * @param size Ring buffer size in bytes, must be a power of 2 no larger
+ *	       than 2^23.
+ * @param data Ring buffer data area.
+ */
+static inline void ring_buf_mpmc_init(struct ring_buf_mpmc *rb,
+				      uint32_t size, uint8_t *data)
+{
+	__ASSERT(is_power_of_two(size), "Size must be a power of 2");
+	__ASSERT(size <= Z_RING_BUF_MP_MAX_SIZE, "Size too large");
+
+	memset(rb, 0, sizeof(*rb));
+	rb->buf.data = data;
+	rb->buf.mask = size - 1U;
+	rb->buf.idx_mask = Z_RING_BUF_MP_IDX_MASK;
+}
+
+/**
+ * @brief Return ring buffer capacity.
+ *
+ * @param rb Address of ring buffer.
+ *
+ * @return Ring buffer capacity in bytes.
+ */
+static inline uint32_t ring_buf_mpmc_capacity_get(struct ring_buf_mpmc *rb)
+{
+	return rb->buf.mask + 1U;
+}
+
+/**
+ * @brief Determine if a ring buffer is empty.
+ *
+ * @param rb Address of ring buffer.
+ *
+ * @return true if no published data is left to claim (snapshot).
+ */
+static inline bool ring_buf_mpmc_is_empty(struct ring_buf_mpmc *rb)
+{
+	return (atomic_get(&rb->cons.state) & Z_RING_BUF_MP_IDX_MASK) ==
+	       atomic_get(&rb->prod.tail);
+}
+
+/**
+ * @brief Reserve buffer for writing data to a MPMC ring buffer.
+ *
+ * Behaves like @ref ring_buf_mpsc_put_claim.
+ *
+ * @param[in]  rb   Address of ring buffer.
+ * @param[out] data Set to a location within the ring buffer.
+ * @param[in]  size Requested allocation size (in bytes).
+ *
+ * @return Size of reserved buffer, zero if nothing was reserved.
+ */
+uint32_t ring_buf_mpmc_put_claim(struct ring_buf_mpmc *rb, uint8_t **data,
+				 uint32_t size);
+
+/**
+ * @brief Finish a claim made with @ref ring_buf_mpmc_put_claim.
+ *
+ * @param rb   Address of ring buffer.
+ * @param size Size returned by the matching claim.
+ *
+ * @retval 0 Successful operation.
+ * @retval -EINVAL No claim is outstanding or @a size is invalid.
+ */
+int ring_buf_mpmc_put_finish(struct ring_buf_mpmc *rb, uint32_t size);
+
+/**
+ * @brief Write (copy) data to a MPMC ring buffer.
+ *
+ * Behaves like @ref ring_buf_mpsc_put: either all of @a size bytes are
+ * written as one contiguous record or none are.
+ *
+ * @param rb   Address of ring buffer.
+ * @param data Address of data.
+ * @param size Data size (in bytes).
+ *
+ * @return Number of bytes written, @a size or 0.
+ */
+uint32_t ring_buf_mpmc_put(struct ring_buf_mpmc *rb, const uint8_t *data,
+			   uint32_t size);
+
+/**
+ * @brief Reserve valid data for reading from a MPMC ring buffer.
+ *
+ * May be called concurrently by any number of consumers. Each non-zero
+ * claim must be followed by exactly one call to
+ * @ref ring_buf_mpmc_get_finish with the full claimed size. The space is
+ * returned to the producers once every claim that was outstanding at the
+ * same time has been finished.
+ *
+ * @param[in]  rb   Address of ring buffer.
+ * @param[out] data Set to a location within the ring buffer.
+ * @param[in]  size Requested size (in bytes).
+ *
+ * @return Number of valid bytes at @a data, which can be smaller than
+ *	   requested if there is not enough data or it wraps. Zero if
+ *	   nothing was reserved.
+ */
+uint32_t ring_buf_mpmc_get_claim(struct ring_buf_mpmc *rb, uint8_t **data,
+				 uint32_t size);
+
+/**
+ * @brief Finish a claim made with @ref ring_buf_mpmc_get_claim.
+ *
+ * @param rb   Address of ring buffer.
+ * @param size Size returned by the matching claim.
+ *
+ * @retval 0 Successful operation.
+ * @retval -EINVAL No claim is outstanding or @a size is invalid.
+ */
+int ring_buf_mpmc_get_finish(struct ring_buf_mpmc *rb, uint32_t size);
+
+/**
+ * @brief Read data from a MPMC ring buffer.
+ *
+ * Reads a single contiguous part of the valid data, so fewer than @a size
+ * bytes may be read when the data wraps around the end of the storage
+ * area.
+ *
+ * @param rb   Address of ring buffer.
+ * @param data Address of the output buffer.
+ * @param size Data size (in bytes).
+ *
+ * @return Number of bytes written to the output buffer.
+ */
+uint32_t ring_buf_mpmc_get(struct ring_buf_mpmc *rb, uint8_t *data,
+			   uint32_t size);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_SYS_RING_BUFFER_LOCKFREE_H_ */
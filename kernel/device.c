@@ -8,6 +8,7 @@
 #include <device.h>
 #include <sys/atomic.h>
 #include <syscall_handler.h>
+#include <kernel_internal.h>
 
 extern const struct init_entry __init_start[];
 extern const struct init_entry __init_PRE_KERNEL_1_start[];
@@ -25,12 +26,54 @@ extern const struct device __device_end[];
 
 extern uint32_t __device_init_status_start[];
 
+#ifdef CONFIG_BOOT_TIME_MEASUREMENT
+extern uint32_t __device_init_time_start[];
+#endif
+
 #ifdef CONFIG_DEVICE_POWER_MANAGEMENT
 extern uint32_t __device_busy_start[];
 extern uint32_t __device_busy_end[];
 #define DEVICE_BUSY_SIZE (__device_busy_end - __device_busy_start)
 #endif
 
+int z_sys_init_entry_run(const struct init_entry *entry)
+{
+	const struct device *dev = entry->dev;
+#ifdef CONFIG_BOOT_TIME_MEASUREMENT
+	uint32_t start = k_cycle_get_32();
+#endif
+	int ret;
+
+	if (dev != NULL) {
+		z_object_init(dev);
+	}
+
+	ret = entry->init(dev);
+
+#ifdef CONFIG_BOOT_TIME_MEASUREMENT
+	if (dev != NULL) {
+		__device_init_time_start[dev - __device_start] =
+			k_cycle_get_32() - start;
+	}
+#endif
+
+	return ret;
+}
+
+void z_device_init_failed(const struct device *dev)
+{
+	/* Set the init status bit so device is not declared ready */
+	sys_bitfield_set_bit((mem_addr_t) __device_init_status_start,
+			     (dev - __device_start));
+}
+
+#ifdef CONFIG_BOOT_TIME_MEASUREMENT
+uint32_t z_device_init_cycles(const struct device *dev)
+{
+	return __device_init_time_start[dev - __device_start];
+}
+#endif
+
 /**
  * @brief Execute all the init entry initialization functions at a given level
  *
@@ -57,28 +100,87 @@ void z_sys_init_run_level(int32_t level)
 	};
 	const struct init_entry *entry;
 
-	for (entry = levels[level]; entry < levels[level+1]; entry++) {
-		const struct device *dev = entry->dev;
+#ifdef CONFIG_DEVICE_INIT_PARALLEL
+	/* Worker threads can only be used once the kernel runs */
+	if (level == _SYS_INIT_LEVEL_POST_KERNEL ||
+	    level == _SYS_INIT_LEVEL_APPLICATION) {
+		z_device_init_parallel(levels[level], levels[level+1],
+				       level == _SYS_INIT_LEVEL_APPLICATION);
+		return;
+	}
+#endif
 
-		if (dev != NULL) {
-			z_object_init(dev);
+	for (entry = levels[level]; entry < levels[level+1]; entry++) {
+		if ((z_sys_init_entry_run(entry) != 0) &&
+		    (entry->dev != NULL)) {
+			/* Initialization failed */
+			z_device_init_failed(entry->dev);
 		}
+	}
+}
 
-		if ((entry->init(dev) != 0) && (dev != NULL)) {
-			/* Initialization failed.
-			 * Set the init status bit so device is not declared ready.
-			 */
-			sys_bitfield_set_bit(
-				(mem_addr_t) __device_init_status_start,
-				(dev - __device_start));
-		}
+#ifdef CONFIG_DEVICE_NAME_HASH
+extern const struct z_device_name_hash z_device_name_hash;
+
+/* Must match name_hash() in scripts/gen_device_hash.py */
+static uint32_t device_name_hash(uint32_t seed, const char *name)
+{
+	uint32_t h = 2166136261U ^ seed;
+
+	while (*name) {
+		h = (h ^ (uint8_t)*name++) * 16777619U;
 	}
+
+	h ^= h >> 16;
+	h *= 0x85ebca6bU;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35U;
+	h ^= h >> 16;
+
+	return h;
 }
 
+/* Find the first device with the name, or NULL if there is none */
+static const struct device *device_name_hash_find(const char *name)
+{
+	const struct z_device_name_hash *table = &z_device_name_hash;
+	const struct device *dev;
+	uint32_t bucket;
+	uint16_t index;
+
+	bucket = device_name_hash(0U, name) % table->buckets;
+	index = table->slot[device_name_hash(table->seed[bucket], name) %
+			    table->slots];
+	if (index == 0U) {
+		return NULL;
+	}
+
+	dev = &__device_start[index - 1U];
+	if ((dev->name != name) && (strcmp(name, dev->name) != 0)) {
+		return NULL;
+	}
+
+	return dev;
+}
+#endif /* CONFIG_DEVICE_NAME_HASH */
+
 const struct device *z_impl_device_get_binding(const char *name)
 {
 	const struct device *dev;
 
+#ifdef CONFIG_DEVICE_NAME_HASH
+	/* The table is empty in the first link of the kernel, before it is
+	 * generated. A device that failed to initialize may share its name
+	 * with a later one, which only the search below finds.
+	 */
+	if (z_device_name_hash.buckets > 0U) {
+		dev = device_name_hash_find(name);
+		if ((dev == NULL) || z_device_ready(dev)) {
+			return dev;
+		}
+	}
+#endif
+
 	/* Split the search into two loops: in the common scenario, where
 	 * device names are stored in ROM (and are referenced by the user
 	 * with CONFIG_* macros), only cheap pointer comparisons will be
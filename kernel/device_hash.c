@@ -0,0 +1,13 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <device.h>
+
+/* Placeholder for the first link of the kernel. The table generated by
+ * gen_device_hash.py from this first link replaces it in the final link,
+ * which does not pull this file out of the kernel library.
+ */
+const struct z_device_name_hash z_device_name_hash;
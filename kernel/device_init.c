@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Parallel device initialization
+ *
+ * The init entries of a level are started in order, as when they run
+ * sequentially, but the ones of devices bound to a devicetree node run in
+ * worker threads. Such a device is started once no device its node depends
+ * on is still initializing, so independent devices initialize at the same
+ * time. Other init entries are barriers: they run in the calling thread
+ * after all the previous entries completed, and before any later one starts.
+ */
+
+#include <kernel.h>
+#include <string.h>
+#include <device.h>
+#include <devicetree.h>
+#include <init.h>
+#include <sys/atomic.h>
+#include <kernel_internal.h>
+
+/* Terminates the dependency list of a node */
+#define DEP_ORD_END UINT16_MAX
+
+/* Devicetree node a device can be bound to */
+struct device_node {
+	/** Label, which is the name of the device */
+	const char *label;
+	/** Ordinals of the device nodes this one depends on */
+	const uint16_t *requires;
+	/** Dependency ordinal */
+	uint16_t ord;
+};
+
+#define DEVICE_NODE(node_id)					\
+	{							\
+		.label = DT_LABEL(node_id),			\
+		.requires = (const uint16_t[]) {		\
+			DT_REQUIRES_DEVICE_DEP_ORDS(node_id)	\
+			DEP_ORD_END				\
+		},						\
+		.ord = DT_DEP_ORD(node_id),			\
+	},
+
+static const struct device_node device_nodes[] = {
+	DT_FOREACH_LABELED_STATUS_OKAY(DEVICE_NODE)
+};
+
+struct init_worker {
+	struct k_thread thread;
+	/** Given when an entry is assigned to the worker */
+	struct k_sem start;
+	/** Entry being run, NULL when the worker is idle */
+	const struct init_entry *entry;
+	/** Devicetree node of the entry device */
+	const struct device_node *node;
+	/** Set by the worker once the entry has run */
+	atomic_t done;
+	/** Result of the init function */
+	int err;
+};
+
+static struct init_worker workers[CONFIG_DEVICE_INIT_PARALLEL_THREADS];
+static K_THREAD_STACK_ARRAY_DEFINE(worker_stacks,
+				   CONFIG_DEVICE_INIT_PARALLEL_THREADS,
+				   CONFIG_DEVICE_INIT_PARALLEL_STACK_SIZE);
+
+/* Given by the workers when an entry has run */
+static K_SEM_DEFINE(worker_done, 0, CONFIG_DEVICE_INIT_PARALLEL_THREADS);
+
+static bool workers_started;
+
+static void worker_main(void *p1, void *p2, void *p3)
+{
+	struct init_worker *w = p1;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	for (;;) {
+		k_sem_take(&w->start, K_FOREVER);
+
+		w->err = z_sys_init_entry_run(w->entry);
+
+		atomic_set(&w->done, 1);
+		k_sem_give(&worker_done);
+	}
+}
+
+static void workers_start(void)
+{
+	int prio = k_thread_priority_get(k_current_get());
+	int i;
+
+	/* The workers have the priority of the calling thread, they run
+	 * when it waits for them.
+	 */
+	for (i = 0; i < ARRAY_SIZE(workers); i++) {
+		k_sem_init(&workers[i].start, 0, 1);
+
+		k_thread_create(&workers[i].thread, worker_stacks[i],
+				K_THREAD_STACK_SIZEOF(worker_stacks[i]),
+				worker_main, &workers[i], NULL, NULL,
+				prio, 0, K_NO_WAIT);
+		k_thread_name_set(&workers[i].thread, "device_init");
+	}
+
+	workers_started = true;
+}
+
+static void workers_stop(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(workers); i++) {
+		k_thread_abort(&workers[i].thread);
+	}
+
+	workers_started = false;
+}
+
+static const struct device_node *device_node_find(const struct device *dev)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(device_nodes); i++) {
+		if (strcmp(device_nodes[i].label, dev->name) == 0) {
+			return &device_nodes[i];
+		}
+	}
+
+	return NULL;
+}
+
+static bool node_requires(const struct device_node *node, uint16_t ord)
+{
+	const uint16_t *dep;
+
+	for (dep = node->requires; *dep != DEP_ORD_END; dep++) {
+		if (*dep == ord) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* Release the workers whose entry has run, and return the number of
+ * workers still running one.
+ */
+static int workers_reap(void)
+{
+	struct init_worker *w;
+	int running = 0;
+
+	for (w = workers; w < &workers[ARRAY_SIZE(workers)]; w++) {
+		if (w->entry == NULL) {
+			continue;
+		}
+
+		if (!atomic_get(&w->done)) {
+			running++;
+			continue;
+		}
+
+		if (w->err != 0) {
+			z_device_init_failed(w->entry->dev);
+		}
+
+		atomic_clear(&w->done);
+		w->entry = NULL;
+		w->node = NULL;
+	}
+
+	return running;
+}
+
+static void workers_wait(void)
+{
+	while (workers_reap() > 0) {
+		k_sem_take(&worker_done, K_FOREVER);
+	}
+}
+
+/* Wait for an idle worker, and for the devices the node depends on to be
+ * initialized.
+ */
+static struct init_worker *worker_get(const struct device_node *node)
+{
+	struct init_worker *w, *idle;
+	bool blocked;
+
+	for (;;) {
+		(void)workers_reap();
+
+		idle = NULL;
+		blocked = false;
+
+		for (w = workers; w < &workers[ARRAY_SIZE(workers)]; w++) {
+			if (w->entry == NULL) {
+				idle = idle ? idle : w;
+			} else if (node_requires(node, w->node->ord)) {
+				blocked = true;
+				break;
+			}
+		}
+
+		if (idle != NULL && !blocked) {
+			return idle;
+		}
+
+		k_sem_take(&worker_done, K_FOREVER);
+	}
+}
+
+void z_device_init_parallel(const struct init_entry *start,
+			    const struct init_entry *end, bool last)
+{
+	const struct init_entry *entry;
+	const struct device_node *node;
+	struct init_worker *w;
+
+	if (!workers_started) {
+		workers_start();
+	}
+
+	for (entry = start; entry < end; entry++) {
+		node = NULL;
+		if (entry->dev != NULL) {
+			node = device_node_find(entry->dev);
+		}
+
+		if (node == NULL) {
+			workers_wait();
+
+			if ((z_sys_init_entry_run(entry) != 0) &&
+			    (entry->dev != NULL)) {
+				z_device_init_failed(entry->dev);
+			}
+
+			continue;
+		}
+
+		w = worker_get(node);
+		w->entry = entry;
+		w->node = node;
+		k_sem_give(&w->start);
+	}
+
+	workers_wait();
+
+	if (last) {
+		workers_stop();
+	}
+}
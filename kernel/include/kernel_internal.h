@@ -109,6 +109,26 @@ extern int z_stack_adjust_initialized;
 #ifdef CONFIG_BOOT_TIME_MEASUREMENT
 extern uint32_t z_timestamp_main; /* timestamp when main task starts */
 extern uint32_t z_timestamp_idle; /* timestamp when CPU goes idle */
+
+/* Cycles spent in the init function of a device */
+extern uint32_t z_device_init_cycles(const struct device *dev);
+#endif
+
+struct init_entry;
+
+/* Run an init entry, returns the result of its init function */
+extern int z_sys_init_entry_run(const struct init_entry *entry);
+
+/* Prevent a device which failed to initialize from being declared ready */
+extern void z_device_init_failed(const struct device *dev);
+
+#ifdef CONFIG_DEVICE_INIT_PARALLEL
+/* Run the init entries from start to end, running the ones of independent
+ * devices in parallel. The worker threads are released after the last
+ * level.
+ */
+extern void z_device_init_parallel(const struct init_entry *start,
+				   const struct init_entry *end, bool last);
 #endif
 
 extern struct k_thread z_main_thread;
@@ -34,6 +34,7 @@
 #include <errno.h>
 #include <init.h>
 #include <syscall_handler.h>
+#include <sys/mutex.h>
 #include <debug/object_tracing_common.h>
 #include <tracing/tracing.h>
 #include <sys/check.h>
@@ -116,17 +117,13 @@ static bool adjust_owner_prio(struct k_mutex *mutex, int32_t new_prio)
 	return false;
 }
 
-int z_impl_k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout)
+/* Lock a mutex, called with the lock held */
+static int mutex_lock(struct k_mutex *mutex, k_timeout_t timeout,
+		      k_spinlock_key_t key)
 {
 	int new_prio;
-	k_spinlock_key_t key;
 	bool resched = false;
 
-	__ASSERT(!arch_is_in_isr(), "mutexes cannot be used inside ISRs");
-
-	sys_trace_mutex_lock(mutex);
-	key = k_spin_lock(&lock);
-
 	if (likely((mutex->lock_count == 0U) || (mutex->owner == _current))) {
 
 		mutex->owner_orig_prio = (mutex->lock_count == 0U) ?
@@ -199,6 +196,18 @@ int z_impl_k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout)
 	return -EAGAIN;
 }
 
+int z_impl_k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout)
+{
+	k_spinlock_key_t key;
+
+	__ASSERT(!arch_is_in_isr(), "mutexes cannot be used inside ISRs");
+
+	sys_trace_mutex_lock(mutex);
+	key = k_spin_lock(&lock);
+
+	return mutex_lock(mutex, timeout, key);
+}
+
 #ifdef CONFIG_USERSPACE
 static inline int z_vrfy_k_mutex_lock(struct k_mutex *mutex,
 				      k_timeout_t timeout)
@@ -209,22 +218,14 @@ static inline int z_vrfy_k_mutex_lock(struct k_mutex *mutex,
 #include <syscalls/k_mutex_lock_mrsh.c>
 #endif
 
-int z_impl_k_mutex_unlock(struct k_mutex *mutex)
+/* Unlock a mutex owned by the current thread. Once it is unlocked with no
+ * thread waiting for it, the owner word of its sys_mutex, if any, hands it
+ * back to user mode.
+ */
+static void mutex_unlock(struct k_mutex *mutex, atomic_ptr_t *user_owner)
 {
 	struct k_thread *new_owner;
 
-	__ASSERT(!arch_is_in_isr(), "mutexes cannot be used inside ISRs");
-
-	CHECKIF(mutex->owner == NULL) {
-		return -EINVAL;
-	}
-	/*
-	 * The current thread does not own the mutex.
-	 */
-	CHECKIF(mutex->owner != _current) {
-		return -EPERM;
-	}
-
 	/*
 	 * Attempt to unlock a mutex which is unlocked. mutex->lock_count
 	 * cannot be zero if the current thread is equal to mutex->owner,
@@ -271,6 +272,12 @@ int z_impl_k_mutex_unlock(struct k_mutex *mutex)
 		z_reschedule(&lock, key);
 	} else {
 		mutex->lock_count = 0U;
+#ifdef CONFIG_USERSPACE
+		if (user_owner != NULL) {
+			(void)atomic_ptr_set(user_owner,
+					     (void *)Z_SYS_MUTEX_USER);
+		}
+#endif
 		k_spin_unlock(&lock, key);
 	}
 
@@ -278,6 +285,23 @@ int z_impl_k_mutex_unlock(struct k_mutex *mutex)
 k_mutex_unlock_return:
 	k_sched_unlock();
 	sys_trace_end_call(SYS_TRACE_ID_MUTEX_UNLOCK);
+}
+
+int z_impl_k_mutex_unlock(struct k_mutex *mutex)
+{
+	__ASSERT(!arch_is_in_isr(), "mutexes cannot be used inside ISRs");
+
+	CHECKIF(mutex->owner == NULL) {
+		return -EINVAL;
+	}
+	/*
+	 * The current thread does not own the mutex.
+	 */
+	CHECKIF(mutex->owner != _current) {
+		return -EPERM;
+	}
+
+	mutex_unlock(mutex, NULL);
 
 	return 0;
 }
@@ -290,3 +314,139 @@ static inline int z_vrfy_k_mutex_unlock(struct k_mutex *mutex)
 }
 #include <syscalls/k_mutex_unlock_mrsh.c>
 #endif
+
+#ifdef CONFIG_USERSPACE
+static bool sys_mutex_owner_valid(struct k_thread *thread)
+{
+	struct z_object *obj = z_object_find(thread);
+
+	return (obj != NULL) && (obj->type == K_OBJ_THREAD) &&
+		((obj->flags & K_OBJ_FLAG_INITIALIZED) != 0U);
+}
+
+/* Whether @a thread could have written @a word, that is, locked the
+ * sys_mutex in user mode. Supervisor threads can write anywhere, user
+ * threads only to their stack and to the writable partitions of their
+ * memory domain.
+ */
+static bool sys_mutex_owner_access(struct k_thread *thread, atomic_ptr_t *word)
+{
+	struct k_mem_domain *domain = thread->mem_domain_info.mem_domain;
+	uintptr_t start = (uintptr_t)word;
+	uintptr_t end = start + sizeof(*word);
+	int i;
+
+	if ((thread->base.user_options & K_USER) == 0U) {
+		return true;
+	}
+
+#ifdef CONFIG_THREAD_STACK_INFO
+	if (start >= thread->stack_info.start &&
+	    end <= thread->stack_info.start + thread->stack_info.size) {
+		return true;
+	}
+#endif
+
+	if (domain == NULL) {
+		return false;
+	}
+
+	for (i = 0; i < CONFIG_MAX_DOMAIN_PARTITIONS; i++) {
+		struct k_mem_partition *part = &domain->partitions[i];
+
+		if (part->size != 0U && start >= part->start &&
+		    end <= part->start + part->size &&
+		    K_MEM_PARTITION_IS_WRITABLE(part->attr)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* Make the kernel mutex manage a sys_mutex that may be managed in user
+ * mode, taking over the owner recorded in the owner word. Called with the
+ * lock held, which keeps the word from being handed back to user mode
+ * until the mutex is unlocked with no thread waiting for it.
+ */
+static int sys_mutex_adopt(struct k_mutex *mutex, atomic_ptr_t *user_owner)
+{
+	struct k_thread *owner;
+	void *word;
+
+	do {
+		word = atomic_ptr_get(user_owner);
+		if (((uintptr_t)word & Z_SYS_MUTEX_USER) == 0U) {
+			return 0;
+		}
+
+		/* The word is in user memory, it may not be what the
+		 * fast path stored in it. The named owner gets boosted, so
+		 * it must be a thread that could have locked the mutex.
+		 */
+		owner = (struct k_thread *)((uintptr_t)word &
+					    ~(uintptr_t)Z_SYS_MUTEX_USER);
+		if ((mutex->lock_count != 0U) ||
+		    ((owner != NULL) &&
+		     (!sys_mutex_owner_valid(owner) ||
+		      !sys_mutex_owner_access(owner, user_owner)))) {
+			return -EINVAL;
+		}
+	} while (!atomic_ptr_cas(user_owner, word, NULL));
+
+	if (owner != NULL) {
+		mutex->owner = owner;
+		mutex->owner_orig_prio = owner->base.prio;
+		mutex->lock_count = 1U;
+
+		LOG_DBG("%p took over mutex %p from user mode", owner, mutex);
+	}
+
+	return 0;
+}
+
+int z_mutex_sys_lock(struct k_mutex *mutex, atomic_ptr_t *owner,
+		     k_timeout_t timeout)
+{
+	k_spinlock_key_t key;
+	int ret;
+
+	__ASSERT(!arch_is_in_isr(), "mutexes cannot be used inside ISRs");
+
+	sys_trace_mutex_lock(mutex);
+	key = k_spin_lock(&lock);
+
+	ret = sys_mutex_adopt(mutex, owner);
+	if (ret != 0) {
+		k_spin_unlock(&lock, key);
+		sys_trace_end_call(SYS_TRACE_ID_MUTEX_LOCK);
+		return ret;
+	}
+
+	return mutex_lock(mutex, timeout, key);
+}
+
+int z_mutex_sys_unlock(struct k_mutex *mutex, atomic_ptr_t *owner)
+{
+	k_spinlock_key_t key;
+	int ret;
+
+	__ASSERT(!arch_is_in_isr(), "mutexes cannot be used inside ISRs");
+
+	key = k_spin_lock(&lock);
+	ret = sys_mutex_adopt(mutex, owner);
+	k_spin_unlock(&lock, key);
+
+	if (ret != 0 || mutex->lock_count == 0U) {
+		return -EINVAL;
+	}
+
+	if (mutex->owner != _current) {
+		return -EPERM;
+	}
+
+	mutex_unlock(mutex, owner);
+
+	return 0;
+}
+#endif /* CONFIG_USERSPACE */
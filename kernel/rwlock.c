@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file @brief reader-writer lock kernel services
+ *
+ * Readers and writers wait in separate wait queues, both ordered by thread
+ * priority. Writers are preferred: a thread asking for a read lock waits
+ * while the write lock is held, or while a thread that does not have a
+ * lower priority waits for it. Whenever the lock becomes free, the waiting
+ * readers with a higher priority than the first waiting writer all get a
+ * read lock, and otherwise the first waiting writer gets the write lock.
+ */
+
+#include <kernel.h>
+#include <kernel_structs.h>
+#include <toolchain.h>
+#include <ksched.h>
+#include <wait_q.h>
+#include <errno.h>
+#include <init.h>
+#include <syscall_handler.h>
+#include <debug/object_tracing_common.h>
+
+static struct k_spinlock lock;
+
+#ifdef CONFIG_OBJECT_TRACING
+
+struct k_rwlock *_trace_list_k_rwlock;
+
+/*
+ * Complete initialization of statically defined reader-writer locks.
+ */
+static int init_rwlock_module(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	Z_STRUCT_SECTION_FOREACH(k_rwlock, rwlock) {
+		SYS_TRACING_OBJ_INIT(k_rwlock, rwlock);
+	}
+	return 0;
+}
+
+SYS_INIT(init_rwlock_module, PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_OBJECTS);
+
+#endif /* CONFIG_OBJECT_TRACING */
+
+int z_impl_k_rwlock_init(struct k_rwlock *rwlock)
+{
+	rwlock->writer = NULL;
+	rwlock->readers = 0U;
+
+	z_waitq_init(&rwlock->rd_wait_q);
+	z_waitq_init(&rwlock->wr_wait_q);
+
+	SYS_TRACING_OBJ_INIT(k_rwlock, rwlock);
+	z_object_init(rwlock);
+
+	return 0;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_k_rwlock_init(struct k_rwlock *rwlock)
+{
+	Z_OOPS(Z_SYSCALL_OBJ_INIT(rwlock, K_OBJ_RWLOCK));
+	return z_impl_k_rwlock_init(rwlock);
+}
+#include <syscalls/k_rwlock_init_mrsh.c>
+#endif
+
+/* A reader does not wait for the writers of a lower priority */
+static bool reader_may_pass(struct k_rwlock *rwlock, struct k_thread *reader)
+{
+	struct k_thread *writer = z_waitq_head(&rwlock->wr_wait_q);
+
+	return writer == NULL || z_is_t1_higher_prio_than_t2(reader, writer);
+}
+
+/* Hand the lock to the threads waiting for it once the write lock is free.
+ * Returns true if a thread has been readied.
+ */
+static bool wake_waiters(struct k_rwlock *rwlock)
+{
+	struct k_thread *thread;
+	bool woken = false;
+
+	if (rwlock->writer != NULL) {
+		return false;
+	}
+
+	while ((thread = z_waitq_head(&rwlock->rd_wait_q)) != NULL &&
+	       reader_may_pass(rwlock, thread)) {
+		z_unpend_thread(thread);
+		arch_thread_return_value_set(thread, 0);
+		z_ready_thread(thread);
+		rwlock->readers++;
+		woken = true;
+	}
+
+	if (rwlock->readers == 0U) {
+		thread = z_unpend_first_thread(&rwlock->wr_wait_q);
+		if (thread != NULL) {
+			arch_thread_return_value_set(thread, 0);
+			z_ready_thread(thread);
+			rwlock->writer = thread;
+			woken = true;
+		}
+	}
+
+	return woken;
+}
+
+int z_impl_k_rwlock_read_lock(struct k_rwlock *rwlock, k_timeout_t timeout)
+{
+	k_spinlock_key_t key;
+
+	__ASSERT(!arch_is_in_isr(), "rwlocks cannot be used inside ISRs");
+
+	key = k_spin_lock(&lock);
+
+	if (likely(rwlock->writer == NULL &&
+		   reader_may_pass(rwlock, _current))) {
+		rwlock->readers++;
+		k_spin_unlock(&lock, key);
+		return 0;
+	}
+
+	if (K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
+		k_spin_unlock(&lock, key);
+		return -EBUSY;
+	}
+
+	return z_pend_curr(&lock, key, &rwlock->rd_wait_q, timeout);
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_k_rwlock_read_lock(struct k_rwlock *rwlock,
+					    k_timeout_t timeout)
+{
+	Z_OOPS(Z_SYSCALL_OBJ(rwlock, K_OBJ_RWLOCK));
+	return z_impl_k_rwlock_read_lock(rwlock, timeout);
+}
+#include <syscalls/k_rwlock_read_lock_mrsh.c>
+#endif
+
+int z_impl_k_rwlock_write_lock(struct k_rwlock *rwlock, k_timeout_t timeout)
+{
+	k_spinlock_key_t key;
+	int ret;
+
+	__ASSERT(!arch_is_in_isr(), "rwlocks cannot be used inside ISRs");
+
+	key = k_spin_lock(&lock);
+
+	if (likely(rwlock->writer == NULL && rwlock->readers == 0U)) {
+		rwlock->writer = _current;
+		k_spin_unlock(&lock, key);
+		return 0;
+	}
+
+	if (rwlock->writer == _current) {
+		k_spin_unlock(&lock, key);
+		return -EDEADLK;
+	}
+
+	if (K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
+		k_spin_unlock(&lock, key);
+		return -EBUSY;
+	}
+
+	ret = z_pend_curr(&lock, key, &rwlock->wr_wait_q, timeout);
+	if (ret == 0) {
+		return 0;
+	}
+
+	/* Readers held back by this writer may now get the lock */
+	key = k_spin_lock(&lock);
+
+	if (wake_waiters(rwlock)) {
+		z_reschedule(&lock, key);
+	} else {
+		k_spin_unlock(&lock, key);
+	}
+
+	return ret;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_k_rwlock_write_lock(struct k_rwlock *rwlock,
+					     k_timeout_t timeout)
+{
+	Z_OOPS(Z_SYSCALL_OBJ(rwlock, K_OBJ_RWLOCK));
+	return z_impl_k_rwlock_write_lock(rwlock, timeout);
+}
+#include <syscalls/k_rwlock_write_lock_mrsh.c>
+#endif
+
+int z_impl_k_rwlock_unlock(struct k_rwlock *rwlock)
+{
+	k_spinlock_key_t key;
+
+	__ASSERT(!arch_is_in_isr(), "rwlocks cannot be used inside ISRs");
+
+	key = k_spin_lock(&lock);
+
+	if (rwlock->writer == _current) {
+		rwlock->writer = NULL;
+	} else if (rwlock->writer != NULL) {
+		k_spin_unlock(&lock, key);
+		return -EPERM;
+	} else if (rwlock->readers > 0U) {
+		rwlock->readers--;
+	} else {
+		k_spin_unlock(&lock, key);
+		return -EINVAL;
+	}
+
+	if (wake_waiters(rwlock)) {
+		z_reschedule(&lock, key);
+	} else {
+		k_spin_unlock(&lock, key);
+	}
+
+	return 0;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_k_rwlock_unlock(struct k_rwlock *rwlock)
+{
+	Z_OOPS(Z_SYSCALL_OBJ(rwlock, K_OBJ_RWLOCK));
+	return z_impl_k_rwlock_unlock(rwlock);
+}
+#include <syscalls/k_rwlock_unlock_mrsh.c>
+#endif
@@ -8,8 +8,49 @@
 
 #include <string.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <sys/types.h>
 
+#define WORD_SIZE sizeof(mem_word_t)
+#define WORD_MASK (WORD_SIZE - 1)
+
+/* Words with all their bytes set to 0x01 and to 0x80 */
+#define WORD_ONES ((mem_word_t)-1 / 0xff)
+#define WORD_HIGHS (WORD_ONES << 7)
+
+/* Non zero if one of the bytes of the word is zero */
+#define WORD_HAS_ZERO(w) (((w) - WORD_ONES) & ~(w) & WORD_HIGHS)
+
+/*
+ * The word-at-a-time routines read whole aligned words, which may hold
+ * bytes before or after the buffers. These are in the same word, so
+ * they are readable as well, but the address sanitizer reports them.
+ */
+#ifdef __SANITIZE_ADDRESS__
+#define WORD_READS __attribute__((no_sanitize_address))
+#else
+#define WORD_READS
+#endif
+
+static inline bool word_aligned(const void *p)
+{
+	return ((uintptr_t)p & WORD_MASK) == 0;
+}
+
+/*
+ * Merge two consecutive aligned words into the word starting <off>
+ * bytes into the first one.
+ */
+static inline mem_word_t word_merge(mem_word_t first, mem_word_t second,
+				    unsigned int off)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	return (first << (8 * off)) | (second >> (8 * (WORD_SIZE - off)));
+#else
+	return (first >> (8 * off)) | (second << (8 * (WORD_SIZE - off)));
+#endif
+}
+
 /**
  *
  * @brief Copy a string
@@ -104,16 +145,37 @@ char *strrchr(const char *s, int c)
  * @return number of bytes in string <s>
  */
 
-size_t strlen(const char *s)
+WORD_READS size_t strlen(const char *s)
 {
-	size_t n = 0;
+	const char *p = s;
+	const mem_word_t *w;
 
-	while (*s != '\0') {
-		s++;
-		n++;
+	/* do byte-sized scanning until word-aligned */
+
+	while (!word_aligned(p)) {
+		if (*p == '\0') {
+			return p - s;
+		}
+		p++;
 	}
 
-	return n;
+	/* skip the words without a terminator */
+
+	w = (const mem_word_t *)p;
+
+	while (!WORD_HAS_ZERO(*w)) {
+		w++;
+	}
+
+	/* find the terminator in the last word */
+
+	p = (const char *)w;
+
+	while (*p != '\0') {
+		p++;
+	}
+
+	return p - s;
 }
 
 /**
@@ -142,8 +204,35 @@ size_t strnlen(const char *s, size_t maxlen)
  * @return negative # if <s1> < <s2>, 0 if <s1> == <s2>, else positive #
  */
 
-int strcmp(const char *s1, const char *s2)
+WORD_READS int strcmp(const char *s1, const char *s2)
 {
+	/* compare words only if strings have identical alignment */
+
+	if ((((uintptr_t)s1 ^ (uintptr_t)s2) & WORD_MASK) == 0) {
+		const mem_word_t *w1, *w2;
+
+		while (!word_aligned(s1)) {
+			if ((*s1 != *s2) || (*s1 == '\0')) {
+				return *s1 - *s2;
+			}
+			s1++;
+			s2++;
+		}
+
+		/* skip the equal words without a terminator */
+
+		w1 = (const mem_word_t *)s1;
+		w2 = (const mem_word_t *)s2;
+
+		while ((*w1 == *w2) && !WORD_HAS_ZERO(*w1)) {
+			w1++;
+			w2++;
+		}
+
+		s1 = (const char *)w1;
+		s2 = (const char *)w2;
+	}
+
 	while ((*s1 == *s2) && (*s1 != '\0')) {
 		s1++;
 		s2++;
@@ -253,6 +342,133 @@ int memcmp(const void *m1, const void *m2, size_t n)
 	return *c1 - *c2;
 }
 
+/*
+ * Copy forward, the destination may overlap the end of the source. The
+ * destination is word-aligned first, and the words of a misaligned source
+ * are read aligned and merged.
+ */
+static WORD_READS void copy_forward(unsigned char *d_byte,
+				    const unsigned char *s_byte, size_t n)
+{
+	/* do byte-sized copying until word-aligned or finished */
+
+	while (!word_aligned(d_byte)) {
+		if (n == 0) {
+			return;
+		}
+		*(d_byte++) = *(s_byte++);
+		n--;
+	}
+
+	mem_word_t *d_word = (mem_word_t *)d_byte;
+	unsigned int off = (uintptr_t)s_byte & WORD_MASK;
+
+	if (off == 0) {
+		const mem_word_t *s_word = (const mem_word_t *)s_byte;
+
+		/* do word-sized copying as long as possible */
+
+		while (n >= 4 * WORD_SIZE) {
+			d_word[0] = s_word[0];
+			d_word[1] = s_word[1];
+			d_word[2] = s_word[2];
+			d_word[3] = s_word[3];
+			d_word += 4;
+			s_word += 4;
+			n -= 4 * WORD_SIZE;
+		}
+
+		while (n >= WORD_SIZE) {
+			*(d_word++) = *(s_word++);
+			n -= WORD_SIZE;
+		}
+
+		s_byte = (const unsigned char *)s_word;
+	} else if (n >= WORD_SIZE) {
+		const mem_word_t *s_word =
+			(const mem_word_t *)(s_byte - off);
+		mem_word_t prev = *(s_word++), next;
+
+		/* shift and merge source words as long as possible */
+
+		while (n >= WORD_SIZE) {
+			next = *(s_word++);
+			*(d_word++) = word_merge(prev, next, off);
+			prev = next;
+			n -= WORD_SIZE;
+		}
+
+		s_byte = (const unsigned char *)s_word - WORD_SIZE + off;
+	}
+
+	d_byte = (unsigned char *)d_word;
+
+	/* do byte-sized copying until finished */
+
+	while (n > 0) {
+		*(d_byte++) = *(s_byte++);
+		n--;
+	}
+}
+
+/*
+ * Copy backward from the ends of the buffers, the destination may overlap
+ * the start of the source.
+ */
+static WORD_READS void copy_backward(unsigned char *d_end,
+				     const unsigned char *s_end, size_t n)
+{
+	/* do byte-sized copying until word-aligned or finished */
+
+	while (!word_aligned(d_end)) {
+		if (n == 0) {
+			return;
+		}
+		*(--d_end) = *(--s_end);
+		n--;
+	}
+
+	mem_word_t *d_word = (mem_word_t *)d_end;
+	unsigned int off = (uintptr_t)s_end & WORD_MASK;
+
+	if (off == 0) {
+		const mem_word_t *s_word = (const mem_word_t *)s_end;
+
+		/* do word-sized copying as long as possible */
+
+		while (n >= WORD_SIZE) {
+			*(--d_word) = *(--s_word);
+			n -= WORD_SIZE;
+		}
+
+		s_end = (const unsigned char *)s_word;
+	} else if (n >= WORD_SIZE) {
+		const mem_word_t *s_word =
+			(const mem_word_t *)(s_end - off);
+		mem_word_t next = *s_word, prev;
+
+		/* shift and merge source words as long as possible */
+
+		while (n >= WORD_SIZE) {
+			prev = *(--s_word);
+			*(--d_word) = word_merge(prev, next, off);
+			next = prev;
+			n -= WORD_SIZE;
+		}
+
+		s_end = (const unsigned char *)s_word + off;
+	}
+
+	d_end = (unsigned char *)d_word;
+
+	/* do byte-sized copying until finished */
+
+	while (n > 0) {
+		*(--d_end) = *(--s_end);
+		n--;
+	}
+}
+
 /**
  *
  * @brief Copy bytes in memory with overlapping areas
@@ -262,32 +478,24 @@ int memcmp(const void *m1, const void *m2, size_t n)
 
 void *memmove(void *d, const void *s, size_t n)
 {
-	char *dest = d;
-	const char *src  = s;
+	unsigned char *dest = d;
+	const unsigned char *src = s;
 
 	if ((size_t) (dest - src) < n) {
 		/*
 		 * The <src> buffer overlaps with the start of the <dest> buffer.
 		 * Copy backwards to prevent the premature corruption of <src>.
 		 */
-
-		while (n > 0) {
-			n--;
-			dest[n] = src[n];
-		}
+		copy_backward(dest + n, src + n, n);
 	} else {
 		/* It is safe to perform a forward-copy */
-		while (n > 0) {
-			*dest = *src;
-			dest++;
-			src++;
-			n--;
-		}
+		copy_forward(dest, src, n);
 	}
 
 	return d;
 }
 
+#ifndef CONFIG_ARCH_HAS_MEMCPY
 /**
  *
  * @brief Copy bytes in memory
@@ -297,48 +505,13 @@ void *memmove(void *d, const void *s, size_t n)
 
 void *memcpy(void *_MLIBC_RESTRICT d, const void *_MLIBC_RESTRICT s, size_t n)
 {
-	/* attempt word-sized copying only if buffers have identical alignment */
-
-	unsigned char *d_byte = (unsigned char *)d;
-	const unsigned char *s_byte = (const unsigned char *)s;
-	const uintptr_t mask = sizeof(mem_word_t) - 1;
-
-	if ((((uintptr_t)d ^ (uintptr_t)s_byte) & mask) == 0) {
-
-		/* do byte-sized copying until word-aligned or finished */
-
-		while (((uintptr_t)d_byte) & mask) {
-			if (n == 0) {
-				return d;
-			}
-			*(d_byte++) = *(s_byte++);
-			n--;
-		};
-
-		/* do word-sized copying as long as possible */
-
-		mem_word_t *d_word = (mem_word_t *)d_byte;
-		const mem_word_t *s_word = (const mem_word_t *)s_byte;
-
-		while (n >= sizeof(mem_word_t)) {
-			*(d_word++) = *(s_word++);
-			n -= sizeof(mem_word_t);
-		}
-
-		d_byte = (unsigned char *)d_word;
-		s_byte = (unsigned char *)s_word;
-	}
-
-	/* do byte-sized copying until finished */
-
-	while (n > 0) {
-		*(d_byte++) = *(s_byte++);
-		n--;
-	}
+	copy_forward(d, s, n);
 
 	return d;
 }
+#endif /* CONFIG_ARCH_HAS_MEMCPY */
 
+#ifndef CONFIG_ARCH_HAS_MEMSET
 /**
  *
  * @brief Set bytes in memory
@@ -372,6 +545,15 @@ void *memset(void *buf, int c, size_t n)
 	c_word |= c_word << 32;
 #endif
 
+	while (n >= 4 * sizeof(mem_word_t)) {
+		d_word[0] = c_word;
+		d_word[1] = c_word;
+		d_word[2] = c_word;
+		d_word[3] = c_word;
+		d_word += 4;
+		n -= 4 * sizeof(mem_word_t);
+	}
+
 	while (n >= sizeof(mem_word_t)) {
 		*(d_word++) = c_word;
 		n -= sizeof(mem_word_t);
@@ -388,6 +570,7 @@ void *memset(void *buf, int c, size_t n)
 
 	return buf;
 }
+#endif /* CONFIG_ARCH_HAS_MEMSET */
 
 /**
  *
@@ -398,15 +581,44 @@ void *memset(void *buf, int c, size_t n)
 
 void *memchr(const void *s, int c, size_t n)
 {
-	if (n != 0) {
-		const unsigned char *p = s;
+	const unsigned char *p = s;
+	unsigned char c_byte = (unsigned char)c;
 
-		do {
-			if (*p++ == (unsigned char)c) {
-				return ((void *)(p - 1));
-			}
+	/* do byte-sized scanning until word-aligned or finished */
+
+	while (!word_aligned(p)) {
+		if (n == 0) {
+			return NULL;
+		}
+		if (*p == c_byte) {
+			return (void *)p;
+		}
+		p++;
+		n--;
+	}
 
-		} while (--n != 0);
+	/* skip the words without the byte, which have no zero byte once
+	 * xored with it
+	 */
+
+	const mem_word_t *w = (const mem_word_t *)p;
+	mem_word_t c_word = WORD_ONES * c_byte;
+
+	while ((n >= WORD_SIZE) && !WORD_HAS_ZERO(*w ^ c_word)) {
+		w++;
+		n -= WORD_SIZE;
+	}
+
+	/* do byte-sized scanning until found or finished */
+
+	p = (const unsigned char *)w;
+
+	while (n > 0) {
+		if (*p == c_byte) {
+			return (void *)p;
+		}
+		p++;
+		n--;
 	}
 
 	return NULL;
@@ -7,6 +7,7 @@
 #include <sys/__assert.h>
 #include <ctype.h>
 #include <errno.h>
+#include <float.h>
 #include <limits.h>
 #include <sys/printk.h>
 #include <sys/util.h>
@@ -214,12 +215,18 @@ static void *lexer_null(struct lexer *lexer)
 	return lexer_json;
 }
 
+static bool number_char(int chr)
+{
+	return isdigit(chr) || chr == '.' || chr == 'e' || chr == 'E' ||
+	       chr == '+' || chr == '-';
+}
+
 static void *lexer_number(struct lexer *lexer)
 {
 	while (true) {
 		int chr = next(lexer);
 
-		if (isdigit(chr) || chr == '.') {
+		if (number_char(chr)) {
 			continue;
 		}
 
@@ -415,12 +422,378 @@ static int decode_num(const struct token *token, int32_t *num)
 	return 0;
 }
 
+static int decode_int64(const struct token *token, int64_t *num)
+{
+	const char *pos = token->start;
+	uint64_t limit = INT64_MAX;
+	uint64_t val = 0U;
+	bool negative = false;
+
+	if (pos < token->end && *pos == '-') {
+		negative = true;
+		limit++;
+		pos++;
+	}
+
+	if (pos == token->end) {
+		return -EINVAL;
+	}
+
+	for (; pos < token->end; pos++) {
+		unsigned int digit = *pos - '0';
+
+		if (digit > 9U) {
+			return -EINVAL;
+		}
+
+		if (val > (limit - digit) / 10U) {
+			return -ERANGE;
+		}
+
+		val = val * 10U + digit;
+	}
+
+	*num = negative ? (int64_t)(0U - val) : (int64_t)val;
+
+	return 0;
+}
+
+/* Powers of ten by which the decimal exponent of a number is estimated,
+ * for each bit of the exponent, up to 10^511.
+ */
+static const double pow10_bits[] = {
+	1e1, 1e2, 1e4, 1e8, 1e16, 1e32, 1e64, 1e128, 1e256,
+};
+
+#define POW10_MAX_EXP ((1 << ARRAY_SIZE(pow10_bits)) - 1)
+
+/* A number of 64 significant bits, mant * 2^exp, with the top bit of mant
+ * set. Scaling by powers of ten in this format keeps the result within a
+ * small fraction of a unit in the last place of a double.
+ */
+struct fp_ext {
+	uint64_t mant;
+	int exp;
+};
+
+/* 10^(2^i) and 10^-(2^i), rounded to the nearest fp_ext */
+static const struct fp_ext pow10_ext[] = {
+	{ 0xa000000000000000ULL, -60 },
+	{ 0xc800000000000000ULL, -57 },
+	{ 0x9c40000000000000ULL, -50 },
+	{ 0xbebc200000000000ULL, -37 },
+	{ 0x8e1bc9bf04000000ULL, -10 },
+	{ 0x9dc5ada82b70b59eULL, 43 },
+	{ 0xc2781f49ffcfa6d5ULL, 149 },
+	{ 0x93ba47c980e98ce0ULL, 362 },
+	{ 0xaa7eebfb9df9de8eULL, 787 },
+};
+
+static const struct fp_ext pow10_neg_ext[] = {
+	{ 0xcccccccccccccccdULL, -67 },
+	{ 0xa3d70a3d70a3d70aULL, -70 },
+	{ 0xd1b71758e219652cULL, -77 },
+	{ 0xabcc77118461cefdULL, -90 },
+	{ 0xe69594bec44de15bULL, -117 },
+	{ 0xcfb11ead453994baULL, -170 },
+	{ 0xa87fea27a539e9a5ULL, -276 },
+	{ 0xddd0467c64bce4a1ULL, -489 },
+	{ 0xc0314325637a193aULL, -914 },
+};
+
+union fp_bits {
+	double num;
+	uint64_t bits;
+};
+
+#define DBL_EXP_BIAS 1075
+#define DBL_EXP_MAX 2047
+
+static struct fp_ext fp_ext_from_u64(uint64_t num)
+{
+	int shift = __builtin_clzll(num);
+
+	return (struct fp_ext){ .mant = num << shift, .exp = -shift };
+}
+
+/* @a num must be finite and not zero */
+static struct fp_ext fp_ext_from_double(double num)
+{
+	union fp_bits u = { .num = num };
+	int exp = (u.bits >> (DBL_MANT_DIG - 1)) & DBL_EXP_MAX;
+	uint64_t mant = u.bits & ((1ULL << (DBL_MANT_DIG - 1)) - 1U);
+	struct fp_ext ext;
+
+	if (exp == 0) {
+		exp = 1;
+	} else {
+		mant |= 1ULL << (DBL_MANT_DIG - 1);
+	}
+
+	ext = fp_ext_from_u64(mant);
+	ext.exp += exp - DBL_EXP_BIAS;
+
+	return ext;
+}
+
+/* Rounds to the nearest double, even on a tie, or to infinity */
+static double fp_ext_to_double(struct fp_ext ext)
+{
+	int exp = ext.exp + 64 + DBL_EXP_BIAS - DBL_MANT_DIG;
+	int shift = 64 - DBL_MANT_DIG;
+	union fp_bits u;
+	uint64_t half, rest;
+
+	/* Subnormal numbers keep fewer bits */
+	if (exp < 1) {
+		shift += 1 - exp;
+		exp = 0;
+	}
+
+	if (shift > 64) {
+		return 0.0;
+	}
+
+	half = 1ULL << (shift - 1);
+	rest = shift == 64 ? ext.mant : ext.mant & (2 * half - 1U);
+	u.bits = shift == 64 ? 0U : ext.mant >> shift;
+	if (rest > half || (rest == half && (u.bits & 1U))) {
+		u.bits++;
+	}
+
+	/* The exponent field takes the carry out of the mantissa */
+	if (exp > 0) {
+		u.bits += (uint64_t)(exp - 1) << (DBL_MANT_DIG - 1);
+	}
+
+	if (u.bits >= (uint64_t)DBL_EXP_MAX << (DBL_MANT_DIG - 1)) {
+		u.bits = (uint64_t)DBL_EXP_MAX << (DBL_MANT_DIG - 1);
+	}
+
+	return u.num;
+}
+
+/* Rounds to the nearest integer, which must fit in 64 bits */
+static uint64_t fp_ext_to_u64(struct fp_ext ext)
+{
+	int shift = -ext.exp;
+
+	if (shift <= 0) {
+		return UINT64_MAX;
+	}
+
+	if (shift > 64) {
+		return 0U;
+	}
+
+	return (shift == 64 ? 0U : ext.mant >> shift) +
+	       ((ext.mant >> (shift - 1)) & 1U);
+}
+
+static struct fp_ext fp_ext_mul(struct fp_ext a, struct fp_ext b)
+{
+	uint64_t a_lo = (uint32_t)a.mant, a_hi = a.mant >> 32;
+	uint64_t b_lo = (uint32_t)b.mant, b_hi = b.mant >> 32;
+	uint64_t lo = a_lo * b_lo;
+	uint64_t mid1 = a_hi * b_lo;
+	uint64_t mid2 = a_lo * b_hi;
+	uint64_t hi = a_hi * b_hi;
+	uint64_t carry = ((lo >> 32) + (uint32_t)mid1 + (uint32_t)mid2) >> 32;
+	struct fp_ext ext = { .exp = a.exp + b.exp + 64 };
+
+	hi += (mid1 >> 32) + (mid2 >> 32) + carry;
+	lo = a.mant * b.mant;
+
+	/* The product of two mantissas has its top bit in one of the two
+	 * highest places.
+	 */
+	if ((hi >> 63) == 0U) {
+		hi = (hi << 1) | (lo >> 63);
+		lo <<= 1;
+		ext.exp--;
+	}
+
+	ext.mant = hi + (lo >> 63);
+	if (ext.mant == 0U) {
+		ext.mant = 1ULL << 63;
+		ext.exp++;
+	}
+
+	return ext;
+}
+
+/* Returns @a ext * 10^exp */
+static struct fp_ext fp_ext_scale10(struct fp_ext ext, int exp)
+{
+	const struct fp_ext *pow10 = exp < 0 ? pow10_neg_ext : pow10_ext;
+	unsigned int bits = exp < 0 ? -exp : exp;
+	int i;
+
+	for (i = 0; bits != 0U; i++, bits >>= 1) {
+		if (bits & 1U) {
+			ext = fp_ext_mul(ext, pow10[i]);
+		}
+	}
+
+	return ext;
+}
+
+/* Returns mantissa * 10^exp. When both the mantissa and the power of ten
+ * are exact doubles, a single operation rounds the result correctly, which
+ * covers most numbers exchanged in practice. Others are scaled with 64
+ * significant bits, then rounded.
+ */
+static double fp_value(uint64_t mantissa, int exp)
+{
+	double pow10 = 1.0;
+	int i;
+
+	if (mantissa == 0U) {
+		return 0.0;
+	}
+
+	/* The same number gives the same result however it is written */
+	while (mantissa % 10U == 0U) {
+		mantissa /= 10U;
+		exp++;
+	}
+
+	if (mantissa <= (1ULL << DBL_MANT_DIG) && exp >= -22 && exp <= 22) {
+		/* Powers of ten are exact up to 10^22 */
+		for (i = 0; i < ARRAY_SIZE(pow10_bits); i++) {
+			if ((exp < 0 ? -exp : exp) & (1 << i)) {
+				pow10 *= pow10_bits[i];
+			}
+		}
+
+		return exp < 0 ? (double)mantissa / pow10 :
+				 (double)mantissa * pow10;
+	}
+
+	exp = MAX(MIN(exp, POW10_MAX_EXP), -POW10_MAX_EXP);
+
+	return fp_ext_to_double(fp_ext_scale10(fp_ext_from_u64(mantissa), exp));
+}
+
+/* strtod() is not available in the minimal libc: the significant digits
+ * are gathered in a 64-bit integer, then scaled by the decimal exponent.
+ */
+static int decode_double(const struct token *token, double *num)
+{
+	const char *pos = token->start;
+	const char *end = token->end;
+	uint64_t mantissa = 0U;
+	bool negative = false;
+	bool digits = false;
+	int exp = 0;
+	int exp10 = 0;
+	double val;
+
+	if (pos < end && *pos == '-') {
+		negative = true;
+		pos++;
+	}
+
+	for (; pos < end && isdigit((unsigned char)*pos); pos++) {
+		digits = true;
+		if (mantissa <= (UINT64_MAX - 9U) / 10U) {
+			mantissa = mantissa * 10U + (*pos - '0');
+		} else {
+			exp10++;
+		}
+	}
+
+	if (pos < end && *pos == '.') {
+		pos++;
+		if (pos == end || !isdigit((unsigned char)*pos)) {
+			return -EINVAL;
+		}
+
+		for (; pos < end && isdigit((unsigned char)*pos); pos++) {
+			if (mantissa <= (UINT64_MAX - 9U) / 10U) {
+				mantissa = mantissa * 10U + (*pos - '0');
+				exp10--;
+			}
+		}
+	}
+
+	if (!digits) {
+		return -EINVAL;
+	}
+
+	if (pos < end && (*pos == 'e' || *pos == 'E')) {
+		bool exp_negative = false;
+
+		pos++;
+		if (pos < end && (*pos == '+' || *pos == '-')) {
+			exp_negative = *pos == '-';
+			pos++;
+		}
+
+		if (pos == end) {
+			return -EINVAL;
+		}
+
+		for (; pos < end && isdigit((unsigned char)*pos); pos++) {
+			if (exp <= POW10_MAX_EXP * 2) {
+				exp = exp * 10 + (*pos - '0');
+			}
+		}
+
+		if (exp_negative) {
+			exp = -exp;
+		}
+	}
+
+	if (pos != end) {
+		return -EINVAL;
+	}
+
+	val = fp_value(mantissa, exp + exp10);
+	if (val > DBL_MAX) {
+		return -ERANGE;
+	}
+
+	*num = negative ? -val : val;
+
+	return 0;
+}
+
+/* Values up to half an ULP above FLT_MAX still round to it, only those
+ * from here on overflow to infinity.
+ */
+#define FLT_OVERFLOW 0x1.ffffffp127
+
+static int decode_float(const struct token *token, float *num)
+{
+	double val;
+	int ret;
+
+	ret = decode_double(token, &val);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (val >= FLT_OVERFLOW || val <= -FLT_OVERFLOW) {
+		return -ERANGE;
+	}
+
+	*num = (float)val;
+
+	return 0;
+}
+
 static bool equivalent_types(enum json_tokens type1, enum json_tokens type2)
 {
 	if (type1 == JSON_TOK_TRUE || type1 == JSON_TOK_FALSE) {
 		return type2 == JSON_TOK_TRUE || type2 == JSON_TOK_FALSE;
 	}
 
+	if (type1 == JSON_TOK_NUMBER) {
+		return type2 == JSON_TOK_NUMBER || type2 == JSON_TOK_FLOAT ||
+		       type2 == JSON_TOK_DOUBLE || type2 == JSON_TOK_INT64;
+	}
+
 	return type1 == type2;
 }
 
@@ -461,6 +834,12 @@ static int decode_value(struct json_obj *obj,
 
 		return decode_num(value, num);
 	}
+	case JSON_TOK_FLOAT:
+		return decode_float(value, field);
+	case JSON_TOK_DOUBLE:
+		return decode_double(value, field);
+	case JSON_TOK_INT64:
+		return decode_int64(value, field);
 	case JSON_TOK_STRING: {
 		char **str = field;
 
@@ -479,6 +858,12 @@ static ptrdiff_t get_elem_size(const struct json_obj_descr *descr)
 	switch (descr->type) {
 	case JSON_TOK_NUMBER:
 		return sizeof(int32_t);
+	case JSON_TOK_FLOAT:
+		return sizeof(float);
+	case JSON_TOK_DOUBLE:
+		return sizeof(double);
+	case JSON_TOK_INT64:
+		return sizeof(int64_t);
 	case JSON_TOK_STRING:
 		return sizeof(char *);
 	case JSON_TOK_TRUE:
@@ -599,110 +984,1130 @@ int json_obj_parse(char *payload, size_t len,
 	return obj_parse(&obj, descr, descr_len, val);
 }
 
-static char escape_as(char chr)
+enum stream_lexer {
+	STREAM_LEX_JSON,
+	STREAM_LEX_STRING,
+	STREAM_LEX_NUMBER,
+	STREAM_LEX_LITERAL,
+};
+
+/* Tokens the streaming parser accepts next */
+enum stream_expect {
+	STREAM_EXPECT_OBJECT,
+	STREAM_EXPECT_KEY_OR_END,
+	STREAM_EXPECT_KEY,
+	STREAM_EXPECT_COLON,
+	STREAM_EXPECT_VALUE_OR_END,
+	STREAM_EXPECT_VALUE,
+	STREAM_EXPECT_NEXT,
+	STREAM_EXPECT_NOTHING,
+};
+
+/* Where the characters of the current string or number go */
+enum stream_sink {
+	STREAM_SINK_NONE,
+	STREAM_SINK_KEY,
+	STREAM_SINK_VALUE,
+};
+
+/* Escape state right after a backslash, 1 to 4 are the number of hex
+ * digits still expected after \u.
+ */
+#define STREAM_ESCAPE_START 5U
+
+static struct json_stream_frame *stream_top(struct json_stream *stream)
 {
-	switch (chr) {
-	case '"':
-		return '"';
-	case '\\':
-		return '\\';
-	case '\b':
-		return 'b';
-	case '\f':
-		return 'f';
-	case '\n':
-		return 'n';
-	case '\r':
-		return 'r';
-	case '\t':
-		return 't';
+	return &stream->stack[stream->depth - 1];
+}
+
+/* Returns the descriptor of the next value of the current object or
+ * array and sets @a field to where it is stored, or returns NULL if the
+ * value is to be skipped.
+ */
+static const struct json_obj_descr *
+stream_target(struct json_stream_frame *frame, void **field)
+{
+	if (frame->type == JSON_TOK_LIST_START) {
+		*field = frame->field;
+		return frame->descr;
 	}
 
-	return 0;
+	if (frame->member < 0) {
+		return NULL;
+	}
+
+	*field = (char *)frame->val + frame->descr[frame->member].offset;
+	return &frame->descr[frame->member];
 }
 
-static int json_escape_internal(const char *str,
-				json_append_bytes_t append_bytes,
-				void *data)
+static void stream_value_done(struct json_stream *stream)
 {
-	const char *cur;
-	int ret = 0;
+	struct json_stream_frame *frame = stream_top(stream);
 
-	for (cur = str; ret == 0 && *cur; cur++) {
-		char escaped = escape_as(*cur);
+	if (frame->type == JSON_TOK_LIST_START) {
+		size_t *elements = (size_t *)((char *)frame->val +
+					      frame->descr->offset);
 
-		if (escaped) {
-			char bytes[2] = { '\\', escaped };
-
-			ret = append_bytes(bytes, 2, data);
-		} else {
-			ret = append_bytes(cur, 1, data);
-		}
+		(*elements)++;
+		frame->field += frame->elem_size;
+		frame->len--;
+	} else if (frame->member >= 0) {
+		frame->decoded |= 1 << frame->member;
 	}
 
-	return ret;
+	stream->expect = STREAM_EXPECT_NEXT;
 }
 
-size_t json_calc_escaped_len(const char *str, size_t len)
+static int stream_push(struct json_stream *stream,
+		       const struct json_obj_descr *descr, void *field)
 {
-	size_t escaped_len = len;
-	size_t pos;
+	struct json_stream_frame *parent = stream_top(stream);
+	struct json_stream_frame *frame;
 
-	for (pos = 0; pos < len; pos++) {
-		if (escape_as(str[pos])) {
-			escaped_len++;
-		}
+	if (stream->depth == JSON_STREAM_MAX_DEPTH) {
+		return -ENOMEM;
 	}
 
-	return escaped_len;
+	frame = &stream->stack[stream->depth++];
+	frame->type = descr->type;
+
+	if (descr->type == JSON_TOK_OBJECT_START) {
+		frame->descr = descr->object.sub_descr;
+		frame->len = descr->object.sub_descr_len;
+		frame->val = field;
+		frame->decoded = 0;
+		frame->member = -1;
+
+		stream->expect = STREAM_EXPECT_KEY_OR_END;
+	} else {
+		frame->descr = descr->array.element_descr;
+		frame->len = descr->array.n_elements;
+		frame->val = parent->val;
+		frame->field = field;
+		frame->elem_size = get_elem_size(frame->descr);
+
+		__ASSERT_NO_MSG(frame->elem_size > 0);
+
+		*(size_t *)((char *)frame->val + frame->descr->offset) = 0;
+
+		stream->expect = STREAM_EXPECT_VALUE_OR_END;
+	}
+
+	return 0;
 }
 
-ssize_t json_escape(char *str, size_t *len, size_t buf_size)
+static int stream_container_end(struct json_stream *stream)
 {
-	char *next; /* Points after next character to escape. */
-	char *dest; /* Points after next place to write escaped character. */
-	size_t escaped_len = json_calc_escaped_len(str, *len);
-
-	if (escaped_len == *len) {
-		/*
-		 * If no escape is necessary, there is nothing to do.
-		 */
+	if (stream->depth == 1U) {
+		stream->expect = STREAM_EXPECT_NOTHING;
 		return 0;
 	}
 
-	if (escaped_len >= buf_size) {
-		return -ENOMEM;
+	stream->depth--;
+	stream_value_done(stream);
+
+	return 0;
+}
+
+static int stream_value_begin(struct json_stream *stream,
+			      enum json_tokens type)
+{
+	struct json_stream_frame *frame = stream_top(stream);
+	const struct json_obj_descr *descr;
+	void *field;
+
+	descr = stream_target(frame, &field);
+	if (!descr) {
+		switch (type) {
+		case JSON_TOK_OBJECT_START:
+		case JSON_TOK_LIST_START:
+			stream->skip = 1U;
+			return 0;
+		case JSON_TOK_STRING:
+		case JSON_TOK_NUMBER:
+		case JSON_TOK_TRUE:
+		case JSON_TOK_FALSE:
+		case JSON_TOK_NULL:
+			return 0;
+		default:
+			return -EINVAL;
+		}
 	}
 
-	/*
-	 * By walking backwards in the buffer from the end positions
-	 * of both the original and escaped strings, we avoid using
-	 * extra space. Characters in the original string are
-	 * overwritten only after they have already been escaped.
-	 */
-	str[escaped_len] = '\0';
-	for (next = &str[*len], dest = &str[escaped_len]; next != str;) {
-		char next_c = *(--next);
-		char escape = escape_as(next_c);
+	if (frame->type == JSON_TOK_LIST_START && frame->len == 0U) {
+		return -ENOSPC;
+	}
 
-		if (escape) {
-			*(--dest) = escape;
-			*(--dest) = '\\';
-		} else {
-			*(--dest) = next_c;
+	if (!equivalent_types(type, descr->type)) {
+		return -EINVAL;
+	}
+
+	switch (type) {
+	case JSON_TOK_OBJECT_START:
+	case JSON_TOK_LIST_START:
+		return stream_push(stream, descr, field);
+	case JSON_TOK_STRING:
+		/* Room is needed at least for the terminating NUL */
+		if (stream->str_used >= stream->str_buf_size) {
+			return -ENOMEM;
 		}
+
+		stream->str_start = stream->str_used;
+		break;
+	case JSON_TOK_NUMBER:
+		stream->token_len = 0U;
+		break;
+	default:
+		break;
 	}
-	*len = escaped_len;
+
+	stream->sink = STREAM_SINK_VALUE;
+	stream->value_type = type;
 
 	return 0;
 }
 
-static int encode(const struct json_obj_descr *descr, const void *val,
-		  json_append_bytes_t append_bytes, void *data);
-
-static int arr_encode(const struct json_obj_descr *elem_descr,
-		      const void *field, const void *val,
-		      json_append_bytes_t append_bytes, void *data)
+static int stream_key(struct json_stream *stream)
+{
+	struct json_stream_frame *frame = stream_top(stream);
+	size_t i;
+
+	frame->member = -1;
+
+	for (i = 0; i < frame->len; i++) {
+		/* Field has been decoded already, skip */
+		if (frame->decoded & (1 << i)) {
+			continue;
+		}
+
+		if (stream->token_len != frame->descr[i].field_name_len) {
+			continue;
+		}
+
+		if (!memcmp(stream->token, frame->descr[i].field_name,
+			    stream->token_len)) {
+			frame->member = i;
+			break;
+		}
+	}
+
+	stream->expect = STREAM_EXPECT_COLON;
+
+	return 0;
+}
+
+/* Called once a string, number or literal is complete */
+static int stream_value_end(struct json_stream *stream)
+{
+	struct json_stream_frame *frame = stream_top(stream);
+	const struct json_obj_descr *descr;
+	struct token token;
+	void *field;
+	int ret;
+
+	if (stream->skip) {
+		return 0;
+	}
+
+	if (stream->sink == STREAM_SINK_KEY) {
+		return stream_key(stream);
+	}
+
+	if (stream->sink == STREAM_SINK_VALUE) {
+		descr = stream_target(frame, &field);
+
+		token.type = stream->value_type;
+		if (token.type == JSON_TOK_STRING) {
+			/* decode_value() terminates the string in place */
+			token.start = &stream->str_buf[stream->str_start];
+			token.end = &stream->str_buf[stream->str_used++];
+		} else {
+			if (stream->token_len == sizeof(stream->token)) {
+				return -EINVAL;
+			}
+
+			token.start = stream->token;
+			token.end = &stream->token[stream->token_len];
+		}
+
+		ret = decode_value(NULL, descr, &token, field, frame->val);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	stream_value_done(stream);
+
+	return 0;
+}
+
+static int stream_token(struct json_stream *stream, enum json_tokens type)
+{
+	struct json_stream_frame *frame;
+
+	stream->sink = STREAM_SINK_NONE;
+
+	if (stream->skip) {
+		if (type == JSON_TOK_OBJECT_START ||
+		    type == JSON_TOK_LIST_START) {
+			if (stream->skip == UINT8_MAX) {
+				return -ENOMEM;
+			}
+
+			stream->skip++;
+		} else if (type == JSON_TOK_OBJECT_END ||
+			   type == JSON_TOK_LIST_END) {
+			if (--stream->skip == 0U) {
+				stream_value_done(stream);
+			}
+		}
+
+		return 0;
+	}
+
+	switch (stream->expect) {
+	case STREAM_EXPECT_OBJECT:
+		if (type != JSON_TOK_OBJECT_START) {
+			return -EINVAL;
+		}
+
+		stream->depth = 1U;
+		stream->expect = STREAM_EXPECT_KEY_OR_END;
+		return 0;
+	case STREAM_EXPECT_KEY_OR_END:
+		if (type == JSON_TOK_OBJECT_END) {
+			return stream_container_end(stream);
+		}
+
+		__fallthrough;
+	case STREAM_EXPECT_KEY:
+		if (type != JSON_TOK_STRING) {
+			return -EINVAL;
+		}
+
+		stream->sink = STREAM_SINK_KEY;
+		stream->token_len = 0U;
+		return 0;
+	case STREAM_EXPECT_COLON:
+		if (type != JSON_TOK_COLON) {
+			return -EINVAL;
+		}
+
+		stream->expect = STREAM_EXPECT_VALUE;
+		return 0;
+	case STREAM_EXPECT_VALUE_OR_END:
+		if (type == JSON_TOK_LIST_END) {
+			return stream_container_end(stream);
+		}
+
+		__fallthrough;
+	case STREAM_EXPECT_VALUE:
+		return stream_value_begin(stream, type);
+	case STREAM_EXPECT_NEXT:
+		frame = stream_top(stream);
+
+		if (type == JSON_TOK_COMMA) {
+			stream->expect = frame->type == JSON_TOK_LIST_START ?
+					 STREAM_EXPECT_VALUE : STREAM_EXPECT_KEY;
+			return 0;
+		}
+
+		if (type == (frame->type == JSON_TOK_LIST_START ?
+			     JSON_TOK_LIST_END : JSON_TOK_OBJECT_END)) {
+			return stream_container_end(stream);
+		}
+
+		return -EINVAL;
+	default:
+		return -EINVAL;
+	}
+}
+
+/* Keys and numbers longer than the token buffer mark it as overflowed by
+ * filling it, as no key or number of a descriptor can be that long.
+ */
+static void stream_token_append(struct json_stream *stream, const char *data,
+				size_t len)
+{
+	if (len >= sizeof(stream->token) - stream->token_len) {
+		stream->token_len = sizeof(stream->token);
+		return;
+	}
+
+	memcpy(&stream->token[stream->token_len], data, len);
+	stream->token_len += len;
+}
+
+static int stream_append(struct json_stream *stream, const char *data,
+			 size_t len)
+{
+	if (stream->skip || stream->sink == STREAM_SINK_NONE) {
+		return 0;
+	}
+
+	if (stream->sink == STREAM_SINK_VALUE &&
+	    stream->value_type == JSON_TOK_STRING) {
+		if (len >= stream->str_buf_size - stream->str_used) {
+			return -ENOMEM;
+		}
+
+		memcpy(&stream->str_buf[stream->str_used], data, len);
+		stream->str_used += len;
+
+		return 0;
+	}
+
+	stream_token_append(stream, data, len);
+
+	return 0;
+}
+
+static int stream_escape(struct json_stream *stream, char chr)
+{
+	if (stream->escape != STREAM_ESCAPE_START) {
+		if (!isxdigit((unsigned char)chr)) {
+			return -EINVAL;
+		}
+
+		stream->escape--;
+		return 0;
+	}
+
+	switch (chr) {
+	case '"':
+	case '\\':
+	case '/':
+	case 'b':
+	case 'f':
+	case 'n':
+	case 'r':
+	case 't':
+		stream->escape = 0U;
+		return 0;
+	case 'u':
+		stream->escape = 4U;
+		return 0;
+	default:
+		return -EINVAL;
+	}
+}
+
+/* The stream_lex_*() functions return the number of characters consumed,
+ * or a negative error code.
+ */
+static int stream_lex_string(struct json_stream *stream, const char *data,
+			     size_t len)
+{
+	size_t run = 1;
+	int ret;
+
+	if (stream->escape) {
+		ret = stream_escape(stream, *data);
+		if (ret < 0) {
+			return ret;
+		}
+	} else if (*data == '"') {
+		stream->lexer = STREAM_LEX_JSON;
+
+		ret = stream_value_end(stream);
+		return ret < 0 ? ret : 1;
+	} else if (*data == '\\') {
+		stream->escape = STREAM_ESCAPE_START;
+	} else {
+		/* Copy the run of characters up to the next quote or
+		 * escape at once.
+		 */
+		while (run < len && data[run] != '"' && data[run] != '\\') {
+			run++;
+		}
+	}
+
+	ret = stream_append(stream, data, run);
+
+	return ret < 0 ? ret : (int)MIN(run, INT_MAX);
+}
+
+static int stream_lex_number(struct json_stream *stream, const char *data,
+			     size_t len)
+{
+	size_t run = 0;
+	int ret;
+
+	while (run < len && number_char(data[run])) {
+		run++;
+	}
+
+	ret = stream_append(stream, data, run);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* The number may go on in the next fragment */
+	if (run < len) {
+		stream->lexer = STREAM_LEX_JSON;
+
+		ret = stream_value_end(stream);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return (int)MIN(run, INT_MAX);
+}
+
+static int stream_lex_literal(struct json_stream *stream, char chr)
+{
+	if (chr != *stream->literal) {
+		return -EINVAL;
+	}
+
+	if (*++stream->literal == '\0') {
+		int ret;
+
+		stream->lexer = STREAM_LEX_JSON;
+
+		ret = stream_value_end(stream);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return 1;
+}
+
+static int stream_lex_json(struct json_stream *stream, char chr)
+{
+	enum json_tokens type;
+	int ret;
+
+	switch (chr) {
+	case '}':
+	case '{':
+	case '[':
+	case ']':
+	case ',':
+	case ':':
+		type = (enum json_tokens)chr;
+		break;
+	case '"':
+		stream->lexer = STREAM_LEX_STRING;
+		stream->escape = 0U;
+		type = JSON_TOK_STRING;
+		break;
+	case 't':
+		stream->lexer = STREAM_LEX_LITERAL;
+		stream->literal = "rue";
+		type = JSON_TOK_TRUE;
+		break;
+	case 'f':
+		stream->lexer = STREAM_LEX_LITERAL;
+		stream->literal = "alse";
+		type = JSON_TOK_FALSE;
+		break;
+	case 'n':
+		stream->lexer = STREAM_LEX_LITERAL;
+		stream->literal = "ull";
+		type = JSON_TOK_NULL;
+		break;
+	default:
+		if (isspace((unsigned char)chr)) {
+			return 1;
+		}
+
+		if (chr != '-' && !isdigit((unsigned char)chr)) {
+			return -EINVAL;
+		}
+
+		/* The number lexer consumes the first character */
+		stream->lexer = STREAM_LEX_NUMBER;
+
+		return stream_token(stream, JSON_TOK_NUMBER);
+	}
+
+	ret = stream_token(stream, type);
+
+	return ret < 0 ? ret : 1;
+}
+
+void json_stream_init(struct json_stream *stream,
+		      const struct json_obj_descr *descr, size_t descr_len,
+		      void *val, char *str_buf, size_t str_buf_size)
+{
+	__ASSERT_NO_MSG(descr_len < (sizeof(stream->error) * CHAR_BIT - 1));
+
+	(void)memset(stream, 0, sizeof(*stream));
+
+	stream->stack[0].descr = descr;
+	stream->stack[0].len = descr_len;
+	stream->stack[0].val = val;
+	stream->stack[0].member = -1;
+	stream->stack[0].type = JSON_TOK_OBJECT_START;
+
+	stream->str_buf = str_buf;
+	stream->str_buf_size = str_buf_size;
+	stream->lexer = STREAM_LEX_JSON;
+	stream->expect = STREAM_EXPECT_OBJECT;
+	stream->sink = STREAM_SINK_NONE;
+}
+
+int json_stream_feed(struct json_stream *stream, const char *data,
+		     size_t len)
+{
+	const char *end = data + len;
+	int ret;
+
+	while (!stream->error && data < end) {
+		switch (stream->lexer) {
+		case STREAM_LEX_STRING:
+			ret = stream_lex_string(stream, data, end - data);
+			break;
+		case STREAM_LEX_NUMBER:
+			ret = stream_lex_number(stream, data, end - data);
+			break;
+		case STREAM_LEX_LITERAL:
+			ret = stream_lex_literal(stream, *data);
+			break;
+		default:
+			ret = stream_lex_json(stream, *data);
+			break;
+		}
+
+		if (ret < 0) {
+			stream->error = ret;
+		} else {
+			data += ret;
+		}
+	}
+
+	return stream->error;
+}
+
+int json_stream_finish(struct json_stream *stream)
+{
+	if (stream->error) {
+		return stream->error;
+	}
+
+	if (stream->expect != STREAM_EXPECT_NOTHING) {
+		return -EINVAL;
+	}
+
+	return stream->stack[0].decoded;
+}
+
+static char escape_as(char chr)
+{
+	switch (chr) {
+	case '"':
+		return '"';
+	case '\\':
+		return '\\';
+	case '\b':
+		return 'b';
+	case '\f':
+		return 'f';
+	case '\n':
+		return 'n';
+	case '\r':
+		return 'r';
+	case '\t':
+		return 't';
+	}
+
+	return 0;
+}
+
+/* Characters above the quote, except the backslash, are never escaped,
+ * which spares the escape_as() lookup for most characters.
+ */
+static inline bool plain_char(char chr)
+{
+	return (unsigned char)chr > '"' && chr != '\\';
+}
+
+/* Returns the length of the run of characters at the start of @a str
+ * that are copied as they are, up to the NUL terminator or the next
+ * character to escape.
+ */
+static size_t plain_run(const char *str)
+{
+	const char *cur = str;
+
+	while (plain_char(*cur) || (*cur != '\0' && !escape_as(*cur))) {
+		cur++;
+	}
+
+	return (size_t)(cur - str);
+}
+
+size_t json_calc_escaped_len(const char *str, size_t len)
+{
+	size_t escaped_len = len;
+	size_t pos;
+
+	for (pos = 0; pos < len; pos++) {
+		if (!plain_char(str[pos]) && escape_as(str[pos])) {
+			escaped_len++;
+		}
+	}
+
+	return escaped_len;
+}
+
+ssize_t json_escape(char *str, size_t *len, size_t buf_size)
+{
+	char *next; /* Points after next character to escape. */
+	char *dest; /* Points after next place to write escaped character. */
+	size_t escaped_len = json_calc_escaped_len(str, *len);
+
+	if (escaped_len == *len) {
+		/*
+		 * If no escape is necessary, there is nothing to do.
+		 */
+		return 0;
+	}
+
+	if (escaped_len >= buf_size) {
+		return -ENOMEM;
+	}
+
+	/*
+	 * By walking backwards in the buffer from the end positions
+	 * of both the original and escaped strings, we avoid using
+	 * extra space. Characters in the original string are
+	 * overwritten only after they have already been escaped.
+	 */
+	str[escaped_len] = '\0';
+	for (next = &str[*len], dest = &str[escaped_len]; next != str;) {
+		char next_c = *(--next);
+		char escape = escape_as(next_c);
+
+		if (escape) {
+			*(--dest) = escape;
+			*(--dest) = '\\';
+		} else {
+			*(--dest) = next_c;
+		}
+	}
+	*len = escaped_len;
+
+	return 0;
+}
+
+/* Bytes json_obj_encode() gathers before calling append_bytes */
+#define ENCODE_CHUNK_SIZE 64
+
+/*
+ * The encoder writes straight to memory: to the caller's buffer for the
+ * json_*_buf() functions, or to a chunk on the stack that is handed to
+ * append_bytes whenever it is full. Without a callback, bytes that do not
+ * fit are only counted, so the encoded length is exact even when the
+ * output is truncated, and measuring is encoding into no buffer.
+ */
+struct encoder {
+	char *pos;
+	/* Bytes that can still be written at pos */
+	size_t room;
+	/* Length of everything encoded so far */
+	size_t len;
+	json_append_bytes_t append_bytes;
+	void *data;
+	char *chunk;
+	int ret;
+};
+
+static void encoder_flush(struct encoder *enc)
+{
+	size_t used = (size_t)(enc->pos - enc->chunk);
+
+	if (used && !enc->ret) {
+		enc->ret = enc->append_bytes(enc->chunk, used, enc->data);
+	}
+
+	enc->pos = enc->chunk;
+	enc->room = ENCODE_CHUNK_SIZE;
+}
+
+static void encoder_overflow(struct encoder *enc, const char *bytes, size_t len)
+{
+	if (!enc->append_bytes) {
+		/* Truncated: fill the buffer, then only count */
+		if (enc->room > 0) {
+			memcpy(enc->pos, bytes, enc->room);
+			enc->pos += enc->room;
+			enc->room = 0;
+		}
+		return;
+	}
+
+	encoder_flush(enc);
+
+	if (len > enc->room) {
+		if (!enc->ret) {
+			enc->ret = enc->append_bytes(bytes, len, enc->data);
+		}
+		return;
+	}
+
+	memcpy(enc->pos, bytes, len);
+	enc->pos += len;
+	enc->room -= len;
+}
+
+/* Never called with len 0, so pos may be NULL when measuring */
+static inline void put(struct encoder *enc, const char *bytes, size_t len)
+{
+	enc->len += len;
+
+	if (len > enc->room) {
+		encoder_overflow(enc, bytes, len);
+		return;
+	}
+
+	memcpy(enc->pos, bytes, len);
+	enc->pos += len;
+	enc->room -= len;
+}
+
+static void put_escaped(struct encoder *enc, const char *str)
+{
+	while (true) {
+		size_t run = plain_run(str);
+		char bytes[2];
+
+		/* Characters that need no escaping go out at once */
+		if (run) {
+			put(enc, str, run);
+			str += run;
+		}
+
+		if (*str == '\0') {
+			return;
+		}
+
+		bytes[0] = '\\';
+		bytes[1] = escape_as(*str++);
+		put(enc, bytes, 2);
+	}
+}
+
+static void str_encode(struct encoder *enc, const char *str)
+{
+	put(enc, "\"", 1);
+	put_escaped(enc, str);
+	put(enc, "\"", 1);
+}
+
+/* Writes the quoted key and the colon that start a member. Field names
+ * seldom need escaping, so the name is usually copied as one run.
+ */
+static void key_encode(struct encoder *enc, const struct json_obj_descr *descr)
+{
+	size_t len = descr->field_name_len;
+
+	put(enc, "\"", 1);
+
+	if (len > 0 && plain_run(descr->field_name) == len) {
+		put(enc, descr->field_name, len);
+	} else {
+		put_escaped(enc, descr->field_name);
+	}
+
+	put(enc, "\":", 2);
+}
+
+/* Formats @a num in decimal ending at @a end, returns where it starts */
+static char *dec_format(char *end, int64_t num)
+{
+	uint64_t val = num < 0 ? 0U - (uint64_t)num : (uint64_t)num;
+	uint32_t val32;
+
+	/* Stick to 32-bit divisions as soon as possible */
+	while (val > UINT32_MAX) {
+		*--end = '0' + val % 10U;
+		val /= 10U;
+	}
+
+	val32 = (uint32_t)val;
+	do {
+		*--end = '0' + val32 % 10U;
+		val32 /= 10U;
+	} while (val32 != 0U);
+
+	if (num < 0) {
+		*--end = '-';
+	}
+
+	return end;
+}
+
+static void num_encode(struct encoder *enc, int64_t num)
+{
+	char buf[sizeof("-9223372036854775808") - 1];
+	char *start = dec_format(buf + sizeof(buf), num);
+
+	put(enc, start, (size_t)(buf + sizeof(buf) - start));
+}
+
+/* Significant digits that always tell apart two numbers of a type */
+#ifndef FLT_DECIMAL_DIG
+#define FLT_DECIMAL_DIG 9
+#endif
+#ifndef DBL_DECIMAL_DIG
+#define DBL_DECIMAL_DIG 17
+#endif
+
+#define FP_FORMAT_SIZE (sizeof("-0.0000e-308") + DBL_DECIMAL_DIG)
+
+/* How far from the nearest 17 digit mantissa the one that decodes back to
+ * the number is looked for, for the few numbers that the decoder rounds
+ * the other way.
+ */
+#define FP_NUDGE_MAX 8
+
+/* Whether mantissa * 10^exp decodes back to @a num, of type float if
+ * @a single is set.
+ */
+static bool fp_round_trips(double num, bool single, uint64_t mantissa,
+			   int exp)
+{
+	double val = fp_value(mantissa, exp);
+
+	if (single) {
+		return val < FLT_OVERFLOW && (float)val == (float)num;
+	}
+
+	return val == num;
+}
+
+/* Formats a number with the fewest significant digits that decode back to
+ * it, which is what was written in a payload the number was decoded from.
+ * Returns the length written to @a buf, which has FP_FORMAT_SIZE bytes.
+ */
+static int fp_format(char *buf, double num, bool single)
+{
+	int min_digits = single ? FLT_DIG : DBL_DIG;
+	int max_digits = single ? FLT_DECIMAL_DIG : DBL_DECIMAL_DIG;
+	char digit[DBL_DECIMAL_DIG];
+	char *pos = buf;
+	uint64_t limit = 1U;
+	uint64_t mantissa = 0U;
+	struct fp_ext ext;
+	double scaled;
+	int digits, exp = 0;
+	int i, n;
+
+	if (__builtin_isnan(num) || __builtin_isinf(num)) {
+		return -EINVAL;
+	}
+
+	if (num == 0.0) {
+		*pos = '0';
+		return 1;
+	}
+
+	if (num < 0.0) {
+		*pos++ = '-';
+		num = -num;
+	}
+
+	/* Estimate the decimal exponent, so num / 10^exp is in [1, 10) */
+	scaled = num;
+	for (i = ARRAY_SIZE(pow10_bits) - 1; i >= 0; i--) {
+		if (scaled >= pow10_bits[i]) {
+			scaled /= pow10_bits[i];
+			exp += 1 << i;
+		}
+	}
+
+	for (i = ARRAY_SIZE(pow10_bits) - 1; i >= 0 && scaled < 1.0; i--) {
+		if (scaled * pow10_bits[i] < 10.0) {
+			scaled *= pow10_bits[i];
+			exp -= 1 << i;
+		}
+	}
+
+	for (i = 0; i < max_digits; i++) {
+		limit *= 10U;
+	}
+
+	/* Then fix it up from the digits, which are rounded only once */
+	ext = fp_ext_from_double(num);
+	mantissa = fp_ext_to_u64(fp_ext_scale10(ext, max_digits - 1 - exp));
+	if (mantissa >= limit) {
+		exp++;
+	} else if (mantissa < limit / 10U) {
+		exp--;
+	}
+
+	/* A number that round trips with fewer digits than its type
+	 * guarantees comes out of the rounding to that many digits followed
+	 * by zeros, which are dropped below. Only the digits between both
+	 * bounds need to be tried.
+	 */
+	for (digits = min_digits; digits <= max_digits; digits++) {
+		limit = 1U;
+		for (i = 0; i < digits; i++) {
+			limit *= 10U;
+		}
+
+		mantissa = fp_ext_to_u64(fp_ext_scale10(ext, digits - 1 - exp));
+		if (mantissa >= limit) {
+			/* Rounded up to the next power of ten */
+			if (fp_round_trips(num, single, limit / 10U,
+					   exp - digits + 2)) {
+				mantissa = limit / 10U;
+				exp++;
+				break;
+			}
+
+			continue;
+		}
+
+		if (fp_round_trips(num, single, mantissa, exp - digits + 1)) {
+			break;
+		}
+	}
+
+	if (digits > max_digits) {
+		uint64_t nearest = MIN(mantissa, limit - 1U);
+
+		digits = max_digits;
+		for (i = 1; i <= FP_NUDGE_MAX; i++) {
+			mantissa = nearest + i;
+			if (mantissa < limit &&
+			    fp_round_trips(num, single, mantissa,
+					   exp - digits + 1)) {
+				break;
+			}
+
+			mantissa = nearest - i;
+			if (fp_round_trips(num, single, mantissa,
+					   exp - digits + 1)) {
+				break;
+			}
+		}
+
+		/* Failing that, no finite number may encode as a value that
+		 * the decoder rejects as out of range.
+		 */
+		if (i > FP_NUDGE_MAX) {
+			mantissa = nearest;
+			while (fp_value(mantissa, exp - digits + 1) >
+			       (single ? FLT_MAX : DBL_MAX)) {
+				mantissa--;
+			}
+		}
+	}
+
+	for (i = digits - 1; i >= 0; i--) {
+		digit[i] = '0' + mantissa % 10U;
+		mantissa /= 10U;
+	}
+
+	n = digits;
+	while (n > 1 && digit[n - 1] == '0') {
+		n--;
+	}
+
+	if (exp < -4 || exp >= max_digits) {
+		*pos++ = digit[0];
+		if (n > 1) {
+			*pos++ = '.';
+			memcpy(pos, &digit[1], n - 1);
+			pos += n - 1;
+		}
+
+		*pos++ = 'e';
+		if (exp < 0) {
+			*pos++ = '-';
+			exp = -exp;
+		}
+
+		if (exp >= 100) {
+			*pos++ = '0' + exp / 100;
+		}
+
+		if (exp >= 10) {
+			*pos++ = '0' + exp / 10 % 10;
+		}
+
+		*pos++ = '0' + exp % 10;
+	} else if (exp < 0) {
+		*pos++ = '0';
+		*pos++ = '.';
+		for (i = exp + 1; i < 0; i++) {
+			*pos++ = '0';
+		}
+
+		memcpy(pos, digit, n);
+		pos += n;
+	} else {
+		for (i = 0; i <= exp; i++) {
+			*pos++ = i < n ? digit[i] : '0';
+		}
+
+		if (n > exp + 1) {
+			*pos++ = '.';
+			memcpy(pos, &digit[exp + 1], n - exp - 1);
+			pos += n - exp - 1;
+		}
+	}
+
+	return (int)(pos - buf);
+}
+
+static int fp_encode(struct encoder *enc, double num, bool single)
+{
+	char buf[FP_FORMAT_SIZE];
+	int len = fp_format(buf, num, single);
+
+	if (len < 0) {
+		return len;
+	}
+
+	put(enc, buf, (size_t)len);
+
+	return 0;
+}
+
+static int encode(struct encoder *enc, const struct json_obj_descr *descr,
+		  const void *val);
+
+static int obj_encode(struct encoder *enc, const struct json_obj_descr *descr,
+		      size_t descr_len, const void *val)
+{
+	size_t i;
+	int ret;
+
+	put(enc, "{", 1);
+
+	for (i = 0; i < descr_len; i++) {
+		if (i > 0) {
+			put(enc, ",", 1);
+		}
+
+		key_encode(enc, &descr[i]);
+
+		ret = encode(enc, &descr[i], val);
+		if (ret < 0) {
+			return ret;
+		}
+
+		/* Stop at the first member once append_bytes has failed */
+		if (enc->ret) {
+			return enc->ret;
+		}
+	}
+
+	put(enc, "}", 1);
+
+	return 0;
+}
+
+static int arr_encode(struct encoder *enc,
+		      const struct json_obj_descr *elem_descr,
+		      const void *field, const void *val)
 {
 	ptrdiff_t elem_size = get_elem_size(elem_descr);
 	/*
@@ -715,12 +2120,13 @@ static int arr_encode(const struct json_obj_descr *elem_descr,
 	size_t i;
 	int ret;
 
-	ret = append_bytes("[", 1, data);
-	if (ret < 0) {
-		return ret;
-	}
+	put(enc, "[", 1);
 
 	for (i = 0; i < n_elem; i++) {
+		if (i > 0) {
+			put(enc, ",", 1);
+		}
+
 		/*
 		 * Though "field" points at the next element in the
 		 * array which we need to encode, the value in
@@ -736,203 +2142,184 @@ static int arr_encode(const struct json_obj_descr *elem_descr,
 		 * offset to the length field in the parent struct,
 		 * but that would add a size_t to every descriptor.
 		 */
-		ret = encode(elem_descr, (char *)field - elem_descr->offset,
-			     append_bytes, data);
+		ret = encode(enc, elem_descr,
+			     (char *)field - elem_descr->offset);
 		if (ret < 0) {
 			return ret;
 		}
 
-		if (i < n_elem - 1) {
-			ret = append_bytes(",", 1, data);
-			if (ret < 0) {
-				return ret;
-			}
+		if (enc->ret) {
+			return enc->ret;
 		}
 
 		field = (char *)field + elem_size;
 	}
 
-	return append_bytes("]", 1, data);
-}
-
-static int str_encode(const char **str, json_append_bytes_t append_bytes,
-		      void *data)
-{
-	int ret;
-
-	ret = append_bytes("\"", 1, data);
-	if (ret < 0) {
-		return ret;
-	}
-
-	ret = json_escape_internal(*str, append_bytes, data);
-	if (!ret) {
-		return append_bytes("\"", 1, data);
-	}
-
-	return ret;
-}
-
-static int num_encode(const int32_t *num, json_append_bytes_t append_bytes,
-		      void *data)
-{
-	char buf[3 * sizeof(int32_t)];
-	int ret;
-
-	ret = snprintk(buf, sizeof(buf), "%d", *num);
-	if (ret < 0) {
-		return ret;
-	}
-	if (ret >= (int)sizeof(buf)) {
-		return -ENOMEM;
-	}
-
-	return append_bytes(buf, (size_t)ret, data);
-}
-
-static int bool_encode(const bool *value, json_append_bytes_t append_bytes,
-		       void *data)
-{
-	if (*value) {
-		return append_bytes("true", 4, data);
-	}
+	put(enc, "]", 1);
 
-	return append_bytes("false", 5, data);
+	return 0;
 }
 
-static int encode(const struct json_obj_descr *descr, const void *val,
-		  json_append_bytes_t append_bytes, void *data)
+static int encode(struct encoder *enc, const struct json_obj_descr *descr,
+		  const void *val)
 {
 	void *ptr = (char *)val + descr->offset;
 
 	switch (descr->type) {
 	case JSON_TOK_FALSE:
 	case JSON_TOK_TRUE:
-		return bool_encode(ptr, append_bytes, data);
+		if (*(bool *)ptr) {
+			put(enc, "true", 4);
+		} else {
+			put(enc, "false", 5);
+		}
+		return 0;
 	case JSON_TOK_STRING:
-		return str_encode(ptr, append_bytes, data);
+		str_encode(enc, *(const char **)ptr);
+		return 0;
 	case JSON_TOK_LIST_START:
-		return arr_encode(descr->array.element_descr, ptr,
-				  val, append_bytes, data);
+		return arr_encode(enc, descr->array.element_descr, ptr, val);
 	case JSON_TOK_OBJECT_START:
-		return json_obj_encode(descr->object.sub_descr,
-				       descr->object.sub_descr_len,
-				       ptr, append_bytes, data);
+		return obj_encode(enc, descr->object.sub_descr,
+				  descr->object.sub_descr_len, ptr);
 	case JSON_TOK_NUMBER:
-		return num_encode(ptr, append_bytes, data);
+		num_encode(enc, *(int32_t *)ptr);
+		return 0;
+	case JSON_TOK_INT64:
+		num_encode(enc, *(int64_t *)ptr);
+		return 0;
+	case JSON_TOK_FLOAT:
+		return fp_encode(enc, *(float *)ptr, true);
+	case JSON_TOK_DOUBLE:
+		return fp_encode(enc, *(double *)ptr, false);
 	default:
 		return -EINVAL;
 	}
 }
 
+static void encoder_init_cb(struct encoder *enc, char *chunk,
+			    json_append_bytes_t append_bytes, void *data)
+{
+	enc->pos = chunk;
+	enc->room = ENCODE_CHUNK_SIZE;
+	enc->len = 0;
+	enc->append_bytes = append_bytes;
+	enc->data = data;
+	enc->chunk = chunk;
+	enc->ret = 0;
+}
+
+static int encoder_finish_cb(struct encoder *enc, int ret)
+{
+	encoder_flush(enc);
+
+	return ret < 0 ? ret : enc->ret;
+}
+
 int json_obj_encode(const struct json_obj_descr *descr, size_t descr_len,
 		    const void *val, json_append_bytes_t append_bytes,
 		    void *data)
 {
-	size_t i;
+	char chunk[ENCODE_CHUNK_SIZE];
+	struct encoder enc;
 	int ret;
 
-	ret = append_bytes("{", 1, data);
-	if (ret < 0) {
-		return ret;
-	}
-
-	for (i = 0; i < descr_len; i++) {
-		ret = str_encode((const char **)&descr[i].field_name,
-				 append_bytes, data);
-		if (ret < 0) {
-			return ret;
-		}
-
-		ret = append_bytes(":", 1, data);
-		if (ret < 0) {
-			return ret;
-		}
-
-		ret = encode(&descr[i], val, append_bytes, data);
-		if (ret < 0) {
-			return ret;
-		}
+	encoder_init_cb(&enc, chunk, append_bytes, data);
 
-		if (i < descr_len - 1) {
-			ret = append_bytes(",", 1, data);
-			if (ret < 0) {
-				return ret;
-			}
-		}
-	}
+	ret = obj_encode(&enc, descr, descr_len, val);
 
-	return append_bytes("}", 1, data);
+	return encoder_finish_cb(&enc, ret);
 }
 
 int json_arr_encode(const struct json_obj_descr *descr, const void *val,
 		    json_append_bytes_t append_bytes, void *data)
 {
 	void *ptr = (char *)val + descr->offset;
+	char chunk[ENCODE_CHUNK_SIZE];
+	struct encoder enc;
+	int ret;
+
+	encoder_init_cb(&enc, chunk, append_bytes, data);
 
-	return arr_encode(descr->array.element_descr, ptr, val, append_bytes,
-			  data);
+	ret = arr_encode(&enc, descr->array.element_descr, ptr, val);
+
+	return encoder_finish_cb(&enc, ret);
 }
 
-struct appender {
-	char *buffer;
-	size_t used;
-	size_t size;
-};
+static void encoder_init_buf(struct encoder *enc, char *buffer,
+			     size_t buf_size)
+{
+	enc->pos = buffer;
+	/* Room is kept for the terminating NUL */
+	enc->room = buf_size > 0 ? buf_size - 1 : 0;
+	enc->len = 0;
+	enc->append_bytes = NULL;
+	enc->ret = 0;
+}
 
-static int append_bytes_to_buf(const char *bytes, size_t len, void *data)
+static ssize_t encoder_finish_buf(struct encoder *enc, size_t buf_size,
+				  int ret)
 {
-	struct appender *appender = data;
+	if (buf_size > 0) {
+		*enc->pos = '\0';
+	}
 
-	if (len >= appender->size - appender->used) {
-		return -ENOMEM;
+	if (ret < 0) {
+		return ret;
 	}
 
-	memcpy(appender->buffer + appender->used, bytes, len);
-	appender->used += len;
-	appender->buffer[appender->used] = '\0';
+	return (ssize_t)enc->len;
+}
 
-	return 0;
+ssize_t json_obj_encode_buf_len(const struct json_obj_descr *descr,
+				size_t descr_len, const void *val,
+				char *buffer, size_t buf_size)
+{
+	struct encoder enc;
+	int ret;
+
+	encoder_init_buf(&enc, buffer, buf_size);
+
+	ret = obj_encode(&enc, descr, descr_len, val);
+
+	return encoder_finish_buf(&enc, buf_size, ret);
 }
 
 int json_obj_encode_buf(const struct json_obj_descr *descr, size_t descr_len,
 			const void *val, char *buffer, size_t buf_size)
 {
-	struct appender appender = { .buffer = buffer, .size = buf_size };
+	ssize_t len = json_obj_encode_buf_len(descr, descr_len, val, buffer,
+					      buf_size);
+
+	if (len < 0) {
+		return len;
+	}
 
-	return json_obj_encode(descr, descr_len, val, append_bytes_to_buf,
-			       &appender);
+	return (size_t)len < buf_size ? 0 : -ENOMEM;
 }
 
 int json_arr_encode_buf(const struct json_obj_descr *descr, const void *val,
 			char *buffer, size_t buf_size)
 {
-	struct appender appender = { .buffer = buffer, .size = buf_size };
-
-	return json_arr_encode(descr, val, append_bytes_to_buf, &appender);
-}
+	void *ptr = (char *)val + descr->offset;
+	struct encoder enc;
+	ssize_t len;
+	int ret;
 
-static int measure_bytes(const char *bytes, size_t len, void *data)
-{
-	ssize_t *total = data;
+	encoder_init_buf(&enc, buffer, buf_size);
 
-	*total += (ssize_t)len;
+	ret = arr_encode(&enc, descr->array.element_descr, ptr, val);
 
-	ARG_UNUSED(bytes);
+	len = encoder_finish_buf(&enc, buf_size, ret);
+	if (len < 0) {
+		return len;
+	}
 
-	return 0;
+	return (size_t)len < buf_size ? 0 : -ENOMEM;
 }
 
 ssize_t json_calc_encoded_len(const struct json_obj_descr *descr,
 			      size_t descr_len, const void *val)
 {
-	ssize_t total = 0;
-	int ret;
-
-	ret = json_obj_encode(descr, descr_len, val, measure_bytes, &total);
-	if (ret < 0) {
-		return ret;
-	}
-
-	return total;
+	return json_obj_encode_buf_len(descr, descr_len, val, NULL, 0);
 }
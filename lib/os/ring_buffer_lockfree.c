@@ -0,0 +1,349 @@
+/* ring_buffer_lockfree.c: Lock-free SPSC, MPSC and MPMC byte ring buffers */
+
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <sys/ring_buffer_lockfree.h>
+#include <string.h>
+
+/*
+ * Indexes are free running and masked with idx_mask (all ones for SPSC,
+ * 24 bits for MPSC). The storage offset of an index is (index & mask).
+ *
+ * Ordering relies on atomic_get()/atomic_set()/atomic_cas() being full
+ * barriers: data is written before the tail index is published and read
+ * only after the published tail has been loaded, and symmetrically for the
+ * head index.
+ */
+
+static inline uint32_t lf_claim_size(const struct z_ring_buf_lf *buf,
+				     uint32_t idx, uint32_t avail,
+				     uint32_t size)
+{
+	uint32_t trail_size = (buf->mask + 1U) - (idx & buf->mask);
+
+	return MIN(MIN(size, avail), trail_size);
+}
+
+uint32_t z_ring_buf_lf_get_claim(struct z_ring_buf_lf *buf,
+				 struct z_ring_buf_lf_cons *cons,
+				 uint32_t tail, uint8_t **data, uint32_t size)
+{
+	uint32_t avail = z_ring_buf_lf_used(buf, cons->tmp_head, tail);
+	uint32_t granted_size = lf_claim_size(buf, cons->tmp_head, avail, size);
+
+	*data = &buf->data[cons->tmp_head & buf->mask];
+	cons->tmp_head = (cons->tmp_head + granted_size) & buf->idx_mask;
+
+	return granted_size;
+}
+
+int z_ring_buf_lf_get_finish(struct z_ring_buf_lf *buf,
+			     struct z_ring_buf_lf_cons *cons,
+			     uint32_t tail, uint32_t size)
+{
+	uint32_t head = (uint32_t)atomic_get(&cons->head);
+
+	if (size > z_ring_buf_lf_used(buf, head, tail)) {
+		return -EINVAL;
+	}
+
+	head = (head + size) & buf->idx_mask;
+	cons->tmp_head = head;
+	(void)atomic_set(&cons->head, (atomic_val_t)head);
+
+	return 0;
+}
+
+uint32_t z_ring_buf_lf_get(struct z_ring_buf_lf *buf,
+			   struct z_ring_buf_lf_cons *cons,
+			   atomic_t *tail, uint8_t *data, uint32_t size)
+{
+	uint32_t snapshot = (uint32_t)atomic_get(tail);
+	uint8_t *src;
+	uint32_t partial_size;
+	uint32_t total_size = 0U;
+	int err;
+
+	do {
+		partial_size = z_ring_buf_lf_get_claim(buf, cons, snapshot,
+						       &src, size);
+		memcpy(data, src, partial_size);
+		total_size += partial_size;
+		size -= partial_size;
+		data += partial_size;
+	} while (size && partial_size);
+
+	err = z_ring_buf_lf_get_finish(buf, cons, snapshot, total_size);
+	__ASSERT_NO_MSG(err == 0);
+
+	return total_size;
+}
+
+uint32_t ring_buf_spsc_put_claim(struct ring_buf_spsc *rb, uint8_t **data,
+				 uint32_t size)
+{
+	struct z_ring_buf_lf *buf = &rb->buf;
+	uint32_t head = (uint32_t)atomic_get(&rb->cons.head);
+	uint32_t space = (buf->mask + 1U) -
+			 z_ring_buf_lf_used(buf, head, rb->prod.tmp_tail);
+	uint32_t allocated = lf_claim_size(buf, rb->prod.tmp_tail, space, size);
+
+	*data = &buf->data[rb->prod.tmp_tail & buf->mask];
+	rb->prod.tmp_tail += allocated;
+
+	return allocated;
+}
+
+int ring_buf_spsc_put_finish(struct ring_buf_spsc *rb, uint32_t size)
+{
+	uint32_t tail = (uint32_t)atomic_get(&rb->prod.tail);
+
+	if (size > rb->prod.tmp_tail - tail) {
+		return -EINVAL;
+	}
+
+	tail += size;
+	rb->prod.tmp_tail = tail;
+	(void)atomic_set(&rb->prod.tail, (atomic_val_t)tail);
+
+	return 0;
+}
+
+uint32_t ring_buf_spsc_put(struct ring_buf_spsc *rb, const uint8_t *data,
+			   uint32_t size)
+{
+	uint8_t *dst;
+	uint32_t partial_size;
+	uint32_t total_size = 0U;
+	int err;
+
+	do {
+		partial_size = ring_buf_spsc_put_claim(rb, &dst, size);
+		memcpy(dst, data, partial_size);
+		total_size += partial_size;
+		size -= partial_size;
+		data += partial_size;
+	} while (size && partial_size);
+
+	err = ring_buf_spsc_put_finish(rb, total_size);
+	__ASSERT_NO_MSG(err == 0);
+
+	return total_size;
+}
+
+/*
+ * The state of a side with several users (the MPSC and MPMC producers and
+ * the MPMC consumers) packs the reserved index (lower 24 bits) and the
+ * number of outstanding claims (upper 8 bits) into one atomic word so both
+ * are updated by a single CAS. The user that finishes the last outstanding
+ * claim publishes the reserved index, as the tail for producers and the
+ * head for consumers; since no claim is outstanding at that point every
+ * byte before it has been written or read. Publication is monotonic so a
+ * user that was preempted after its final CAS can never move the published
+ * index backwards.
+ */
+#define MP_IDX(state) ((uint32_t)(state) & Z_RING_BUF_MP_IDX_MASK)
+#define MP_CNT(state) ((uint32_t)(state) >> Z_RING_BUF_MP_CNT_SHIFT)
+#define MP_STATE(cnt, idx) \
+	((atomic_val_t)(((cnt) << Z_RING_BUF_MP_CNT_SHIFT) | \
+			((idx) & Z_RING_BUF_MP_IDX_MASK)))
+#define MP_CNT_MAX (UINT32_MAX >> Z_RING_BUF_MP_CNT_SHIFT)
+
+static void mp_publish(const struct z_ring_buf_lf *buf, atomic_t *pub,
+		       uint32_t idx)
+{
+	uint32_t capacity = buf->mask + 1U;
+	atomic_val_t old;
+
+	do {
+		old = atomic_get(pub);
+		if (z_ring_buf_lf_used(buf, (uint32_t)old, idx) > capacity) {
+			/* Somebody already published a newer index. */
+			return;
+		}
+	} while (!atomic_cas(pub, old, (atomic_val_t)idx));
+}
+
+/* Reserve up to @a size bytes from the index in @a state. @a other is the
+ * index published by the other side: the head for producers, which limits
+ * the free space, or the tail for consumers, which limits the valid data.
+ * With @a all set, either @a size bytes are reserved or none are.
+ */
+static uint32_t mp_claim(const struct z_ring_buf_lf *buf, atomic_t *state,
+			 atomic_t *other, bool put, bool all, uint32_t size,
+			 uint32_t *idx)
+{
+	uint32_t capacity = buf->mask + 1U;
+	uint32_t allocated, avail, cnt, other_idx;
+	atomic_val_t old;
+
+	do {
+		old = atomic_get(state);
+		*idx = MP_IDX(old);
+		cnt = MP_CNT(old);
+		other_idx = (uint32_t)atomic_get(other);
+
+		if (put) {
+			avail = capacity -
+				z_ring_buf_lf_used(buf, other_idx, *idx);
+		} else {
+			avail = z_ring_buf_lf_used(buf, *idx, other_idx);
+		}
+
+		allocated = lf_claim_size(buf, *idx, avail, size);
+		if (allocated == 0U || (all && allocated != size) ||
+		    cnt == MP_CNT_MAX) {
+			return 0;
+		}
+	} while (!atomic_cas(state, old, MP_STATE(cnt + 1U,
+						 *idx + allocated)));
+
+	return allocated;
+}
+
+static int mp_finish(const struct z_ring_buf_lf *buf, atomic_t *state,
+		     atomic_t *pub, uint32_t size)
+{
+	atomic_val_t old, new_state;
+	uint32_t cnt;
+
+	if (size == 0U || size > buf->mask + 1U) {
+		return -EINVAL;
+	}
+
+	do {
+		old = atomic_get(state);
+		cnt = MP_CNT(old);
+		if (cnt == 0U) {
+			return -EINVAL;
+		}
+
+		new_state = MP_STATE(cnt - 1U, MP_IDX(old));
+	} while (!atomic_cas(state, old, new_state));
+
+	if (cnt == 1U) {
+		mp_publish(buf, pub, MP_IDX(old));
+	}
+
+	return 0;
+}
+
+uint32_t ring_buf_mpsc_put_claim(struct ring_buf_mpsc *rb, uint8_t **data,
+				 uint32_t size)
+{
+	uint32_t allocated, idx;
+
+	allocated = mp_claim(&rb->buf, &rb->prod.state, &rb->cons.head, true,
+			     false, size, &idx);
+	if (allocated) {
+		*data = &rb->buf.data[idx & rb->buf.mask];
+	}
+
+	return allocated;
+}
+
+int ring_buf_mpsc_put_finish(struct ring_buf_mpsc *rb, uint32_t size)
+{
+	return mp_finish(&rb->buf, &rb->prod.state, &rb->prod.tail, size);
+}
+
+uint32_t ring_buf_mpsc_put(struct ring_buf_mpsc *rb, const uint8_t *data,
+			   uint32_t size)
+{
+	uint32_t idx;
+	int err;
+
+	/* Reserve all or nothing so the record is contiguous. */
+	if (size == 0U || !mp_claim(&rb->buf, &rb->prod.state, &rb->cons.head,
+				    true, true, size, &idx)) {
+		return 0;
+	}
+
+	memcpy(&rb->buf.data[idx & rb->buf.mask], data, size);
+
+	err = ring_buf_mpsc_put_finish(rb, size);
+	__ASSERT_NO_MSG(err == 0);
+
+	return size;
+}
+
+uint32_t ring_buf_mpmc_put_claim(struct ring_buf_mpmc *rb, uint8_t **data,
+				 uint32_t size)
+{
+	uint32_t allocated, idx;
+
+	allocated = mp_claim(&rb->buf, &rb->prod.state, &rb->cons.head, true,
+			     false, size, &idx);
+	if (allocated) {
+		*data = &rb->buf.data[idx & rb->buf.mask];
+	}
+
+	return allocated;
+}
+
+int ring_buf_mpmc_put_finish(struct ring_buf_mpmc *rb, uint32_t size)
+{
+	return mp_finish(&rb->buf, &rb->prod.state, &rb->prod.tail, size);
+}
+
+uint32_t ring_buf_mpmc_put(struct ring_buf_mpmc *rb, const uint8_t *data,
+			   uint32_t size)
+{
+	uint32_t idx;
+	int err;
+
+	if (size == 0U || !mp_claim(&rb->buf, &rb->prod.state, &rb->cons.head,
+				    true, true, size, &idx)) {
+		return 0;
+	}
+
+	memcpy(&rb->buf.data[idx & rb->buf.mask], data, size);
+
+	err = ring_buf_mpmc_put_finish(rb, size);
+	__ASSERT_NO_MSG(err == 0);
+
+	return size;
+}
+
+uint32_t ring_buf_mpmc_get_claim(struct ring_buf_mpmc *rb, uint8_t **data,
+				 uint32_t size)
+{
+	uint32_t granted, idx;
+
+	granted = mp_claim(&rb->buf, &rb->cons.state, &rb->prod.tail, false,
+			   false, size, &idx);
+	if (granted) {
+		*data = &rb->buf.data[idx & rb->buf.mask];
+	}
+
+	return granted;
+}
+
+int ring_buf_mpmc_get_finish(struct ring_buf_mpmc *rb, uint32_t size)
+{
+	return mp_finish(&rb->buf, &rb->cons.state, &rb->cons.head, size);
+}
+
+uint32_t ring_buf_mpmc_get(struct ring_buf_mpmc *rb, uint8_t *data,
+			   uint32_t size)
+{
+	uint8_t *src;
+	uint32_t granted;
+	int err;
+
+	granted = ring_buf_mpmc_get_claim(rb, &src, size);
+	if (granted == 0U) {
+		return 0;
+	}
+
+	memcpy(data, src, granted);
+
+	err = ring_buf_mpmc_get_finish(rb, granted);
+	__ASSERT_NO_MSG(err == 0);
+
+	return granted;
+}
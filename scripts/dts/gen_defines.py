@@ -95,6 +95,7 @@ def main():
 
         write_chosen(edt)
         write_global_compat_info(edt)
+        write_global_device_info(edt)
 
     if args.edt_pickle_out:
         write_pickled_edt(edt, args.edt_pickle_out)
@@ -473,6 +474,40 @@ def write_dep_info(node):
     out_dt_define(f"{node.z_path_id}_SUPPORTS_ORDS",
                   fmt_dep_list(node.required_by))
 
+    out_comment("Ordinals for the devices this node depends on, "
+                "directly or not:")
+    out_dt_define(f"{node.z_path_id}_REQUIRES_DEVICE_ORDS",
+                  fmt_dep_list(device_deps(node)))
+
+
+def is_device_node(node):
+    # True if 'node' can have a device instance: devices are bound to
+    # enabled nodes through their "label" property
+
+    return node.status == "okay" and "label" in node.props
+
+
+def device_deps(node):
+    # Returns the device nodes that 'node' depends on, following the
+    # dependencies of nodes that are not devices, like pin and clock
+    # configuration, as well as the ones of devices
+
+    deps = set()
+    visited = set()
+    stack = list(node.depends_on)
+
+    while stack:
+        dep = stack.pop()
+        if dep in visited:
+            continue
+        visited.add(dep)
+
+        if is_device_node(dep):
+            deps.add(dep)
+        stack.extend(dep.depends_on)
+
+    return deps
+
 
 def prop2value(prop):
     # Gets the macro value for property 'prop', if there is
@@ -652,6 +687,17 @@ def write_global_compat_info(edt):
             out_define(
                 f"DT_COMPAT_{str2ident(compat)}_BUS_{str2ident(bus)}", 1)
 
+def write_global_device_info(edt):
+    # Tree-wide information about the nodes devices can be bound to is
+    # printed here.
+
+    out_comment('Status "okay" nodes with a label, in dependency order\n')
+    out_define("DT_FOREACH_OKAY_LABELED(fn)",
+               " ".join(f"fn(DT_{node.z_path_id})" for node in
+                        sorted(edt.nodes, key=lambda node: node.dep_ordinal)
+                        if is_device_node(node)))
+
+
 def str2ident(s):
     # Converts 's' to a form suitable for (part of) an identifier
 
@@ -0,0 +1,245 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2020 Intel Corporation
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""
+Generate a perfect hash table of the static device names
+
+This script reads the devices from the first link of the kernel, and
+generates a C source defining z_device_name_hash, which
+device_get_binding() uses to find a device from its name without looking
+through the whole device list.
+
+The table is built with the hash and displace method: the names are first
+split in buckets, then a seed is searched for each bucket, largest first,
+that puts the names of the bucket in free slots of the table. A lookup
+hashes the name twice, once for its bucket and once with the seed of the
+bucket for its slot, and compares the name of the device in the slot.
+
+The devices are in the same order in the final link, so the table holds
+the device indexes. Only the first of devices sharing a name is in the
+table.
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+from elftools.elf.elffile import ELFFile
+from elftools.elf.sections import SymbolTableSection
+
+# Largest seed, seeds are stored on 16 bits
+SEED_MAX = 0xffff
+
+# Average number of names per bucket
+BUCKET_LOAD = 2
+
+def debug(text):
+    if args.debug:
+        sys.stdout.write(os.path.basename(sys.argv[0]) + ": " + text + "\n")
+
+def error(text):
+    sys.exit(os.path.basename(sys.argv[0]) + ": error: " + text + "\n")
+
+def name_hash(seed, name):
+    """Must match device_name_hash() in kernel/device.c"""
+    h = 2166136261 ^ seed
+
+    for c in name:
+        h = ((h ^ c) * 16777619) & 0xffffffff
+
+    h ^= h >> 16
+    h = (h * 0x85ebca6b) & 0xffffffff
+    h ^= h >> 13
+    h = (h * 0xc2b2ae35) & 0xffffffff
+    h ^= h >> 16
+
+    return h
+
+def get_symbols(elf):
+    for section in elf.iter_sections():
+        if isinstance(section, SymbolTableSection):
+            return section
+
+    error("Could not find symbol table")
+
+def read_mem(elf, addr, size):
+    for section in elf.iter_sections():
+        start = section["sh_addr"]
+        if (section["sh_type"] == "SHT_NOBITS" or start == 0 or
+                not start <= addr < start + section["sh_size"]):
+            continue
+
+        offset = addr - start
+        return section.data()[offset:offset + size]
+
+    error("Address {} not in any section".format(hex(addr)))
+
+def read_string(elf, addr):
+    # Device names are short, read them in chunks until the terminator
+    data = b""
+    while b"\0" not in data:
+        data += read_mem(elf, addr + len(data), 32)
+
+    return data[:data.index(b"\0")]
+
+def get_device_names(elf):
+    """Return the name of each device, in the order of the device list"""
+    symtab = get_symbols(elf)
+    syms = {sym.name: sym for sym in symtab.iter_symbols()}
+
+    for name in ("__device_start", "__device_end"):
+        if name not in syms:
+            error("Could not find symbol " + name)
+
+    start = syms["__device_start"].entry.st_value
+    end = syms["__device_end"].entry.st_value
+
+    # The device instances are objects of the device list, which all have
+    # the size of struct device
+    sizes = {sym.entry.st_size for sym in symtab.iter_symbols()
+             if sym.entry.st_info.type == "STT_OBJECT" and
+             sym.entry.st_size > 0 and
+             start <= sym.entry.st_value < end}
+
+    if not sizes:
+        return []
+
+    if len(sizes) != 1 or (end - start) % min(sizes) != 0:
+        error("Could not find the size of struct device")
+
+    dev_size = sizes.pop()
+
+    if elf.elfclass == 64:
+        ptr_fmt = "Q"
+    else:
+        ptr_fmt = "I"
+
+    ptr_fmt = ("<" if elf.little_endian else ">") + ptr_fmt
+
+    names = []
+    for addr in range(start, end, dev_size):
+        # The name is the first member of struct device
+        name_ptr, = struct.unpack(ptr_fmt,
+                                  read_mem(elf, addr, struct.calcsize(ptr_fmt)))
+        names.append(read_string(elf, name_ptr) if name_ptr else None)
+
+        debug("device {}: {}".format(len(names) - 1, names[-1]))
+
+    return names
+
+def build_table(names, slot_count):
+    """Return the bucket seeds and the slots, or None if no seed places
+    all the names of a bucket"""
+    keys = {}
+    for index, name in enumerate(names):
+        # Devices are looked up in order, the first of a name wins
+        if name is not None and name not in keys:
+            keys[name] = index
+
+    bucket_count = max(1, (len(keys) + BUCKET_LOAD - 1) // BUCKET_LOAD)
+    buckets = [[] for _ in range(bucket_count)]
+
+    for name in keys:
+        buckets[name_hash(0, name) % bucket_count].append(name)
+
+    seeds = [0] * bucket_count
+    slots = [0] * slot_count
+
+    for bucket in sorted(range(bucket_count), key=lambda b: -len(buckets[b])):
+        if not buckets[bucket]:
+            break
+
+        for seed in range(1, SEED_MAX + 1):
+            taken = [name_hash(seed, name) % slot_count
+                     for name in buckets[bucket]]
+
+            if (len(set(taken)) == len(taken) and
+                    all(slots[slot] == 0 for slot in taken)):
+                break
+        else:
+            return None
+
+        seeds[bucket] = seed
+        for name, slot in zip(buckets[bucket], taken):
+            slots[slot] = keys[name] + 1
+
+    return seeds, slots
+
+source_header = """
+/* AUTO-GENERATED by gen_device_hash.py, do not edit! */
+
+#include <device.h>
+
+"""
+
+def write_array(fp, name, values):
+    fp.write("static const uint16_t {}[] = {{".format(name))
+
+    for i, value in enumerate(values):
+        fp.write("\n\t" if i % 8 == 0 else " ")
+        fp.write("{:#06x},".format(value))
+
+    fp.write("\n};\n\n")
+
+def write_source(fp, seeds, slots):
+    fp.write(source_header)
+
+    write_array(fp, "device_name_seeds", seeds)
+    write_array(fp, "device_name_slots", slots)
+
+    fp.write("const struct z_device_name_hash z_device_name_hash = {\n")
+    fp.write("\t.buckets = {},\n".format(len(seeds)))
+    fp.write("\t.slots = {},\n".format(len(slots)))
+    fp.write("\t.seed = device_name_seeds,\n")
+    fp.write("\t.slot = device_name_slots,\n")
+    fp.write("};\n")
+
+def parse_args():
+    global args
+
+    parser = argparse.ArgumentParser(description=__doc__,
+            formatter_class=argparse.RawDescriptionHelpFormatter)
+
+    parser.add_argument("-k", "--kernel", required=True,
+            help="Zephyr kernel image")
+    parser.add_argument("-o", "--output-source", required=True,
+            help="Output source file")
+    parser.add_argument("-d", "--debug", action="store_true",
+            help="Print additional debugging information")
+
+    args = parser.parse_args()
+
+def main():
+    parse_args()
+
+    with open(args.kernel, "rb") as fp:
+        names = get_device_names(ELFFile(fp))
+
+    if len(names) > 0xfffe:
+        error("Too many devices")
+
+    # A minimal table is tried first, a slot is added until every bucket
+    # finds a seed.
+    slot_count = max(1, len({name for name in names if name is not None}))
+
+    while True:
+        table = build_table(names, slot_count)
+        if table is not None:
+            break
+
+        slot_count += 1
+
+    seeds, slots = table
+
+    debug("{} devices, {} buckets, {} slots".format(len(names), len(seeds),
+                                                   len(slots)))
+
+    with open(args.output_source, "w") as fp:
+        write_source(fp, seeds, slots)
+
+if __name__ == "__main__":
+    main()
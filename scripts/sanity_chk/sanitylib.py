@@ -1022,6 +1022,7 @@ class SizeCalculator:
         "sw_isr_table",
         "k_sem_area",
         "k_mutex_area",
+        "k_rwlock_area",
         "app_shmem_regions",
         "_k_fifo_area",
         "_k_lifo_area",
@@ -1075,6 +1076,7 @@ class SizeCalculator:
         "bt_l2cap_fixed_chan_area",
         "bt_l2cap_br_fixed_chan_area",
         "bt_gatt_service_static_area",
+        "bt_gatt_attr_static_area",
         "vectors",
         "net_socket_register_area",
         "net_ppp_proto",
@@ -52,6 +52,16 @@
 
 static uint16_t last_static_handle;
 
+/* The attributes of the static services are linked into one array in the
+ * order of the services, so the handle of a static attribute is its index
+ * in the array plus one.
+ */
+extern const struct bt_gatt_attr _bt_gatt_attr_static_list_start[];
+extern const struct bt_gatt_attr _bt_gatt_attr_static_list_end[];
+
+BUILD_ASSERT(sizeof(struct bt_gatt_attr) % 4 == 0,
+	     "Static attributes cannot be linked without padding");
+
 /* Persistent storage format for GATT CCC */
 struct ccc_store {
 	uint16_t handle;
@@ -1046,6 +1056,10 @@ static void bt_gatt_service_init(void)
 	}
 
 	Z_STRUCT_SECTION_FOREACH(bt_gatt_service_static, svc) {
+		__ASSERT(svc->attrs ==
+			 &_bt_gatt_attr_static_list_start[last_static_handle],
+			 "Static service attributes are not linked in order");
+
 		last_static_handle += svc->attr_count;
 	}
 }
@@ -1312,8 +1326,6 @@ static uint8_t get_service_handles(const struct bt_gatt_attr *attr,
 
 uint16_t bt_gatt_attr_get_handle(const struct bt_gatt_attr *attr)
 {
-	uint16_t handle = 1;
-
 	if (!attr) {
 		return 0;
 	}
@@ -1322,19 +1334,9 @@ uint16_t bt_gatt_attr_get_handle(const struct bt_gatt_attr *attr)
 		return attr->handle;
 	}
 
-	Z_STRUCT_SECTION_FOREACH(bt_gatt_service_static, static_svc) {
-		/* Skip ahead if start is not within service attributes array */
-		if ((attr < &static_svc->attrs[0]) ||
-		    (attr > &static_svc->attrs[static_svc->attr_count - 1])) {
-			handle += static_svc->attr_count;
-			continue;
-		}
-
-		for (size_t i = 0; i < static_svc->attr_count; i++, handle++) {
-			if (attr == &static_svc->attrs[i]) {
-				return handle;
-			}
-		}
+	if (attr >= _bt_gatt_attr_static_list_start &&
+	    attr < _bt_gatt_attr_static_list_end) {
+		return attr - _bt_gatt_attr_static_list_start + 1;
 	}
 
 	return 0;
@@ -1467,6 +1469,29 @@ static uint8_t gatt_foreach_iter(const struct bt_gatt_attr *attr,
 	return result;
 }
 
+#if defined(CONFIG_BT_GATT_DYNAMIC_DB)
+/* Index of the first attribute of the service whose handle is not lower
+ * than the given handle. The handles of a service are in ascending order.
+ */
+static size_t attr_find_index(const struct bt_gatt_service *svc,
+			      uint16_t handle)
+{
+	size_t lo = 0, hi = svc->attr_count;
+
+	while (lo < hi) {
+		size_t mid = (lo + hi) / 2;
+
+		if (svc->attrs[mid].handle < handle) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return lo;
+}
+#endif /* CONFIG_BT_GATT_DYNAMIC_DB */
+
 static void foreach_attr_type_dyndb(uint16_t start_handle, uint16_t end_handle,
 				    const struct bt_uuid *uuid,
 				    const void *attr_data, uint16_t num_matches,
@@ -1477,17 +1502,13 @@ static void foreach_attr_type_dyndb(uint16_t start_handle, uint16_t end_handle,
 	struct bt_gatt_service *svc;
 
 	SYS_SLIST_FOR_EACH_CONTAINER(&db, svc, node) {
-		struct bt_gatt_service *next;
-
-		next = SYS_SLIST_PEEK_NEXT_CONTAINER(svc, node);
-		if (next) {
-			/* Skip ahead if start is not within service handles */
-			if (next->attrs[0].handle <= start_handle) {
-				continue;
-			}
+		/* Skip ahead if start is not within service handles */
+		if (svc->attrs[svc->attr_count - 1].handle < start_handle) {
+			continue;
 		}
 
-		for (i = 0; i < svc->attr_count; i++) {
+		for (i = attr_find_index(svc, start_handle);
+		     i < svc->attr_count; i++) {
 			struct bt_gatt_attr *attr = &svc->attrs[i];
 
 			if (gatt_foreach_iter(attr, attr->handle,
@@ -1516,24 +1537,15 @@ void bt_gatt_foreach_attr_type(uint16_t start_handle, uint16_t end_handle,
 	}
 
 	if (start_handle <= last_static_handle) {
-		uint16_t handle = 1;
-
-		Z_STRUCT_SECTION_FOREACH(bt_gatt_service_static, static_svc) {
-			/* Skip ahead if start is not within service handles */
-			if (handle + static_svc->attr_count < start_handle) {
-				handle += static_svc->attr_count;
-				continue;
-			}
-
-			for (i = 0; i < static_svc->attr_count; i++, handle++) {
-				if (gatt_foreach_iter(&static_svc->attrs[i],
-						      handle, start_handle,
-						      end_handle, uuid,
-						      attr_data, &num_matches,
-						      func, user_data) ==
-				    BT_GATT_ITER_STOP) {
-					return;
-				}
+		/* Static attributes are indexed by handle */
+		for (i = MAX(start_handle, 1U) - 1U; i < last_static_handle;
+		     i++) {
+			if (gatt_foreach_iter(&_bt_gatt_attr_static_list_start[i],
+					      i + 1, start_handle, end_handle,
+					      uuid, attr_data, &num_matches,
+					      func, user_data) ==
+			    BT_GATT_ITER_STOP) {
+				return;
 			}
 		}
 	}
@@ -1870,8 +1882,11 @@ static int gatt_notify(struct bt_conn *conn, uint16_t handle,
 	if (gatt_cf_notify_multi(conn)) {
 		int err;
 
+		/* Fall back to a single notification only if there is no
+		 * buffer for a Multiple Handle Value Notification.
+		 */
 		err = gatt_notify_mult(conn, handle, params);
-		if (err && err != -ENOMEM) {
+		if (err != -ENOMEM) {
 			return err;
 		}
 	}
@@ -98,13 +98,103 @@ static bool check_dup(struct net_buf_simple *data)
 	return false;
 }
 
-static bool msg_cache_match(struct net_buf_simple *pdu)
+#if defined(CONFIG_BT_MESH_HASH_LOOKUP)
+/* Hash set over the message cache using linear probing. Each slot holds the
+ * message cache index plus one, zero marks an empty slot. The table is kept
+ * at most half full so that probe sequences stay short.
+ */
+#define MSG_CACHE_INDEX_SIZE (2 * CONFIG_BT_MESH_MSG_CACHE_SIZE)
+
+static uint16_t msg_cache_index[MSG_CACHE_INDEX_SIZE];
+
+static size_t msg_cache_hash(uint16_t src, uint32_t seq)
+{
+	uint32_t key = ((uint32_t)src << 17) | (seq & BIT_MASK(17));
+
+	/* The low bits of the product only depend on the low bits of the
+	 * key, i.e. the sequence number, so the high bits are used.
+	 */
+	return ((key * 2654435761U) >> 16) % MSG_CACHE_INDEX_SIZE;
+}
+
+static size_t msg_cache_entry_hash(uint16_t idx)
+{
+	return msg_cache_hash(msg_cache[idx].src, msg_cache[idx].seq);
+}
+
+bool bt_mesh_msg_cache_check(uint16_t src, uint32_t seq)
+{
+	size_t i, pos = msg_cache_hash(src, seq);
+
+	seq &= BIT_MASK(17);
+
+	for (i = 0; i < MSG_CACHE_INDEX_SIZE && msg_cache_index[pos]; i++) {
+		uint16_t idx = msg_cache_index[pos] - 1;
+
+		if (msg_cache[idx].src == src && msg_cache[idx].seq == seq) {
+			return true;
+		}
+
+		pos = (pos + 1) % MSG_CACHE_INDEX_SIZE;
+	}
+
+	return false;
+}
+
+static void msg_cache_index_remove(uint16_t idx)
+{
+	size_t pos = msg_cache_entry_hash(idx);
+	size_t next, home;
+
+	while (msg_cache_index[pos] != idx + 1) {
+		if (!msg_cache_index[pos]) {
+			return;
+		}
+
+		pos = (pos + 1) % MSG_CACHE_INDEX_SIZE;
+	}
+
+	/* Move back the entries after the removed one that would otherwise
+	 * no longer be reachable from their home slot.
+	 */
+	for (next = (pos + 1) % MSG_CACHE_INDEX_SIZE; msg_cache_index[next];
+	     next = (next + 1) % MSG_CACHE_INDEX_SIZE) {
+		home = msg_cache_entry_hash(msg_cache_index[next] - 1);
+
+		if ((next > pos && (home <= pos || home > next)) ||
+		    (next < pos && home <= pos && home > next)) {
+			msg_cache_index[pos] = msg_cache_index[next];
+			pos = next;
+		}
+	}
+
+	msg_cache_index[pos] = 0U;
+}
+
+static void msg_cache_index_add(uint16_t idx)
+{
+	size_t pos;
+
+	/* There is always a free slot, the table is twice the cache size */
+	for (pos = msg_cache_entry_hash(idx); msg_cache_index[pos];
+	     pos = (pos + 1) % MSG_CACHE_INDEX_SIZE) {
+	}
+
+	msg_cache_index[pos] = idx + 1;
+}
+
+static void msg_cache_index_clear(void)
+{
+	(void)memset(msg_cache_index, 0, sizeof(msg_cache_index));
+}
+#else
+bool bt_mesh_msg_cache_check(uint16_t src, uint32_t seq)
 {
 	uint16_t i;
 
 	for (i = 0U; i < ARRAY_SIZE(msg_cache); i++) {
-		if (msg_cache[i].src == SRC(pdu->data) &&
-		    msg_cache[i].seq == (SEQ(pdu->data) & BIT_MASK(17))) {
+		if (msg_cache[i].src == src &&
+		    msg_cache[i].seq == (seq & BIT_MASK(17))) {
 			return true;
 		}
 	}
@@ -112,12 +202,48 @@ static bool msg_cache_match(struct net_buf_simple *pdu)
 	return false;
 }
 
-static void msg_cache_add(struct bt_mesh_net_rx *rx)
+static inline void msg_cache_index_remove(uint16_t idx)
+{
+}
+
+static inline void msg_cache_index_add(uint16_t idx)
+{
+}
+
+static inline void msg_cache_index_clear(void)
+{
+}
+#endif /* CONFIG_BT_MESH_HASH_LOOKUP */
+
+static void msg_cache_remove(uint16_t idx)
 {
-	rx->msg_cache_idx = msg_cache_next++;
-	msg_cache[rx->msg_cache_idx].src = rx->ctx.addr;
-	msg_cache[rx->msg_cache_idx].seq = rx->seq;
+	msg_cache_index_remove(idx);
+	msg_cache[idx].src = BT_MESH_ADDR_UNASSIGNED;
+}
+
+uint16_t bt_mesh_msg_cache_add(uint16_t src, uint32_t seq)
+{
+	uint16_t idx = msg_cache_next++;
+
 	msg_cache_next %= ARRAY_SIZE(msg_cache);
+
+	/* Evict the oldest entry */
+	if (msg_cache[idx].src != BT_MESH_ADDR_UNASSIGNED) {
+		msg_cache_index_remove(idx);
+	}
+
+	msg_cache[idx].src = src;
+	msg_cache[idx].seq = seq;
+	msg_cache_index_add(idx);
+
+	return idx;
+}
+
+void bt_mesh_msg_cache_clear(void)
+{
+	(void)memset(msg_cache, 0, sizeof(msg_cache));
+	msg_cache_index_clear();
+	msg_cache_next = 0U;
 }
 
 int bt_mesh_net_create(uint16_t idx, uint8_t flags, const uint8_t key[16],
@@ -140,8 +266,7 @@ int bt_mesh_net_create(uint16_t idx, uint8_t flags, const uint8_t key[16],
 		return err;
 	}
 
-	(void)memset(msg_cache, 0, sizeof(msg_cache));
-	msg_cache_next = 0U;
+	bt_mesh_msg_cache_clear();
 
 	bt_mesh.iv_index = iv_index;
 	atomic_set_bit_to(bt_mesh.flags, BT_MESH_IVU_IN_PROGRESS,
@@ -572,7 +697,8 @@ static bool net_decrypt(struct bt_mesh_net_rx *rx, struct net_buf_simple *in,
 		return false;
 	}
 
-	if (rx->net_if == BT_MESH_NET_IF_ADV && msg_cache_match(out)) {
+	if (rx->net_if == BT_MESH_NET_IF_ADV &&
+	    bt_mesh_msg_cache_check(rx->ctx.addr, SEQ(out->data))) {
 		BT_DBG("Duplicate found in Network Message Cache");
 		return false;
 	}
@@ -741,7 +867,7 @@ int bt_mesh_net_decode(struct net_buf_simple *in, enum bt_mesh_net_if net_if,
 	       rx->ctx.recv_ttl);
 	BT_DBG("PDU: %s", bt_hex(out->data, out->len));
 
-	msg_cache_add(rx);
+	rx->msg_cache_idx = bt_mesh_msg_cache_add(rx->ctx.addr, rx->seq);
 
 	return 0;
 }
@@ -789,7 +915,7 @@ void bt_mesh_net_recv(struct net_buf_simple *data, int8_t rssi,
 	 */
 	if (bt_mesh_trans_recv(&buf, &rx) == -EAGAIN) {
 		BT_WARN("Removing rejected message from Network Message Cache");
-		msg_cache[rx.msg_cache_idx].src = BT_MESH_ADDR_UNASSIGNED;
+		msg_cache_remove(rx.msg_cache_idx);
 		/* Rewind the next index now that we're not using this entry */
 		msg_cache_next = rx.msg_cache_idx;
 	}
@@ -268,6 +268,10 @@ void bt_mesh_net_recv(struct net_buf_simple *data, int8_t rssi,
 
 void bt_mesh_net_loopback_clear(uint16_t net_idx);
 
+bool bt_mesh_msg_cache_check(uint16_t src, uint32_t seq);
+uint16_t bt_mesh_msg_cache_add(uint16_t src, uint32_t seq);
+void bt_mesh_msg_cache_clear(void);
+
 uint32_t bt_mesh_next_seq(void);
 
 void bt_mesh_net_start(void);
@@ -32,10 +32,140 @@
 
 static struct bt_mesh_rpl replay_list[CONFIG_BT_MESH_CRPL];
 
+#if defined(CONFIG_BT_MESH_HASH_LOOKUP)
+/* Open addressing index of the replay list, keyed by source address. Each
+ * slot holds the replay list index plus one, zero marks an empty slot. The
+ * table is kept at most half full so that probe sequences stay short.
+ *
+ * Entries may be cleared without the index being told (e.g. by the
+ * settings code), so a slot is only trusted if the entry it points to
+ * still has the source address that is looked up. Such stale slots are
+ * dropped whenever the index is rebuilt.
+ */
+#define RPL_INDEX_SIZE (2 * CONFIG_BT_MESH_CRPL)
+
+static uint16_t rpl_index[RPL_INDEX_SIZE];
+
+static inline size_t rpl_hash(uint16_t src)
+{
+	/* Unicast addresses are usually assigned in sequence, which a
+	 * plain modulo spreads evenly over the table.
+	 */
+	return src % RPL_INDEX_SIZE;
+}
+
+static struct bt_mesh_rpl *rpl_index_find(uint16_t src)
+{
+	size_t i, pos = rpl_hash(src);
+
+	for (i = 0; i < RPL_INDEX_SIZE && rpl_index[pos]; i++) {
+		struct bt_mesh_rpl *rpl = &replay_list[rpl_index[pos] - 1];
+
+		if (rpl->src == src) {
+			return rpl;
+		}
+
+		pos = (pos + 1) % RPL_INDEX_SIZE;
+	}
+
+	return NULL;
+}
+
+static bool rpl_index_insert(struct bt_mesh_rpl *rpl)
+{
+	size_t i, pos = rpl_hash(rpl->src);
+
+	for (i = 0; i < RPL_INDEX_SIZE; i++) {
+		if (!rpl_index[pos]) {
+			rpl_index[pos] = rpl - replay_list + 1;
+			return true;
+		}
+
+		pos = (pos + 1) % RPL_INDEX_SIZE;
+	}
+
+	return false;
+}
+
+static void rpl_index_rebuild(void)
+{
+	int i;
+
+	(void)memset(rpl_index, 0, sizeof(rpl_index));
+
+	for (i = 0; i < ARRAY_SIZE(replay_list); i++) {
+		if (replay_list[i].src) {
+			(void)rpl_index_insert(&replay_list[i]);
+		}
+	}
+}
+
+static void rpl_index_add(struct bt_mesh_rpl *rpl)
+{
+	/* The table only fills up with stale slots, which a rebuild drops.
+	 * There is always room after it as the table is twice the size of
+	 * the replay list.
+	 */
+	if (!rpl_index_insert(rpl)) {
+		rpl_index_rebuild();
+	}
+}
+
+static void rpl_index_clear(void)
+{
+	(void)memset(rpl_index, 0, sizeof(rpl_index));
+}
+#else
+static struct bt_mesh_rpl *rpl_index_find(uint16_t src)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(replay_list); i++) {
+		if (replay_list[i].src == src) {
+			return &replay_list[i];
+		}
+	}
+
+	return NULL;
+}
+
+static inline void rpl_index_rebuild(void)
+{
+}
+
+static inline void rpl_index_add(struct bt_mesh_rpl *rpl)
+{
+}
+
+static inline void rpl_index_clear(void)
+{
+}
+#endif /* CONFIG_BT_MESH_HASH_LOOKUP */
+
+static struct bt_mesh_rpl *rpl_free_entry(void)
+{
+	int i;
+
+	/* Only new sources get here, which is rare compared to the lookups
+	 * done for every received message.
+	 */
+	for (i = 0; i < ARRAY_SIZE(replay_list); i++) {
+		if (!replay_list[i].src) {
+			return &replay_list[i];
+		}
+	}
+
+	return NULL;
+}
+
 void bt_mesh_rpl_update(struct bt_mesh_rpl *rpl,
 		struct bt_mesh_net_rx *rx)
 {
-	rpl->src = rx->ctx.addr;
+	if (rpl->src != rx->ctx.addr) {
+		rpl->src = rx->ctx.addr;
+		rpl_index_add(rpl);
+	}
+
 	rpl->seq = rx->seq;
 	rpl->old_iv = rx->old_iv;
 
@@ -52,7 +182,7 @@ void bt_mesh_rpl_update(struct bt_mesh_rpl *rpl,
 bool bt_mesh_rpl_check(struct bt_mesh_net_rx *rx,
 		struct bt_mesh_rpl **match)
 {
-	int i;
+	struct bt_mesh_rpl *rpl;
 
 	/* Don't bother checking messages from ourselves */
 	if (rx->net_if == BT_MESH_NET_IF_LOCAL) {
@@ -64,42 +194,40 @@ bool bt_mesh_rpl_check(struct bt_mesh_net_rx *rx,
 		return false;
 	}
 
-	for (i = 0; i < ARRAY_SIZE(replay_list); i++) {
-		struct bt_mesh_rpl *rpl = &replay_list[i];
+	rpl = rpl_index_find(rx->ctx.addr);
+	if (!rpl) {
+		rpl = rpl_free_entry();
+		if (!rpl) {
+			BT_ERR("RPL is full!");
+			return true;
+		}
 
 		/* Empty slot */
-		if (!rpl->src) {
-			if (match) {
-				*match = rpl;
-			} else {
-				bt_mesh_rpl_update(rpl, rx);
-			}
-
-			return false;
+		if (match) {
+			*match = rpl;
+		} else {
+			bt_mesh_rpl_update(rpl, rx);
 		}
 
-		/* Existing slot for given address */
-		if (rpl->src == rx->ctx.addr) {
-			if (rx->old_iv && !rpl->old_iv) {
-				return true;
-			}
+		return false;
+	}
 
-			if ((!rx->old_iv && rpl->old_iv) ||
-			    rpl->seq < rx->seq) {
-				if (match) {
-					*match = rpl;
-				} else {
-					bt_mesh_rpl_update(rpl, rx);
-				}
+	/* Existing slot for given address */
+	if (rx->old_iv && !rpl->old_iv) {
+		return true;
+	}
 
-				return false;
-			} else {
-				return true;
-			}
+	if ((!rx->old_iv && rpl->old_iv) ||
+	    rpl->seq < rx->seq) {
+		if (match) {
+			*match = rpl;
+		} else {
+			bt_mesh_rpl_update(rpl, rx);
 		}
+
+		return false;
 	}
 
-	BT_ERR("RPL is full!");
 	return true;
 }
 
@@ -111,34 +239,26 @@ void bt_mesh_rpl_clear(void)
 		bt_mesh_clear_rpl();
 	} else {
 		(void)memset(replay_list, 0, sizeof(replay_list));
+		rpl_index_clear();
 	}
 }
 
 struct bt_mesh_rpl *bt_mesh_rpl_find(uint16_t src)
 {
-	int i;
-
-	for (i = 0; i < ARRAY_SIZE(replay_list); i++) {
-		if (replay_list[i].src == src) {
-			return &replay_list[i];
-		}
-	}
-
-	return NULL;
+	return rpl_index_find(src);
 }
 
 struct bt_mesh_rpl *bt_mesh_rpl_alloc(uint16_t src)
 {
-	int i;
+	struct bt_mesh_rpl *rpl;
 
-	for (i = 0; i < ARRAY_SIZE(replay_list); i++) {
-		if (!replay_list[i].src) {
-			replay_list[i].src = src;
-			return &replay_list[i];
-		}
+	rpl = rpl_free_entry();
+	if (rpl) {
+		rpl->src = src;
+		rpl_index_add(rpl);
 	}
 
-	return NULL;
+	return rpl;
 }
 
 void bt_mesh_rpl_foreach(bt_mesh_rpl_func_t func, void *user_data)
@@ -148,6 +268,9 @@ void bt_mesh_rpl_foreach(bt_mesh_rpl_func_t func, void *user_data)
 	for (i = 0; i < ARRAY_SIZE(replay_list); i++) {
 		func(&replay_list[i], user_data);
 	}
+
+	/* The callback may have cleared entries */
+	rpl_index_rebuild();
 }
 
 void bt_mesh_rpl_reset(void)
@@ -172,4 +295,6 @@ void bt_mesh_rpl_reset(void)
 			}
 		}
 	}
+
+	rpl_index_rebuild();
 }
@@ -14,6 +14,13 @@ struct bt_mesh_rpl {
 	bool  store;
 #endif
 	uint32_t seq;
+#if defined(CONFIG_BT_MESH_RPL_STORE_BATCH)
+	/* Sequence number written to storage */
+	uint32_t stored_seq:24,
+		 stored:1,
+		 /* seq still holds the window skipped on load */
+		 window:1;
+#endif
 };
 
 typedef void (*bt_mesh_rpl_func_t)(struct bt_mesh_rpl *rpl,
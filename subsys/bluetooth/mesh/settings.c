@@ -99,6 +99,16 @@ struct rpl_val {
 	      old_iv:1;
 };
 
+/* Replay Protection List block storage entry */
+struct rpl_block_val {
+	uint16_t src;
+	struct rpl_val rpl;
+} __packed;
+
+/* Number of RPL entries stored in one settings entry */
+#define RPL_BLOCK_SIZE 16
+#define RPL_BLOCK_COUNT DIV_ROUND_UP(CONFIG_BT_MESH_CRPL, RPL_BLOCK_SIZE)
+
 /* NetKey storage information */
 struct net_key_val {
 	uint8_t kr_flag:1,
@@ -283,6 +293,74 @@ static int seq_set(const char *name, size_t len_rd, settings_read_cb read_cb,
 	return 0;
 }
 
+#if defined(CONFIG_BT_MESH_RPL_STORE_BATCH)
+/* RPL entries are not stored in the same place after loading them, so all
+ * blocks are written on the first store. Entries stored one by one are
+ * deleted at the same time.
+ */
+static bool rpl_store_all;
+static bool rpl_single_loaded;
+static uint16_t rpl_dirty;
+static uint32_t rpl_writes_saved;
+
+static uint32_t rpl_window_seq(uint32_t seq)
+{
+	return MIN(seq + CONFIG_BT_MESH_RPL_STORE_SEQ_WINDOW, BIT_MASK(24));
+}
+
+/* Last sequence number accepted from the source. The window skipped on
+ * load only lives in RAM, storing it would grow it on every reboot.
+ */
+static uint32_t rpl_accepted_seq(const struct bt_mesh_rpl *entry)
+{
+	if (entry->window && entry->seq == rpl_window_seq(entry->stored_seq)) {
+		return entry->stored_seq;
+	}
+
+	return entry->seq;
+}
+#endif
+
+static int rpl_load(uint16_t src, const struct rpl_val *rpl)
+{
+	struct bt_mesh_rpl *entry;
+	uint32_t seq = rpl->seq;
+
+	entry = bt_mesh_rpl_find(src);
+	if (!entry) {
+		entry = bt_mesh_rpl_alloc(src);
+		if (!entry) {
+			BT_ERR("Unable to allocate RPL entry for 0x%04x", src);
+			return -ENOMEM;
+		}
+	}
+
+#if defined(CONFIG_BT_MESH_RPL_STORE_BATCH)
+	/* Stored both one by one and in a block, keep the newest */
+	if (entry->stored && entry->stored_seq > seq) {
+		return 0;
+	}
+
+	entry->stored_seq = seq;
+	entry->stored = 1U;
+	entry->window = 1U;
+	rpl_store_all = true;
+
+	/* Skip the sequence numbers that may have been received after the
+	 * entry was stored.
+	 */
+	seq = rpl_window_seq(seq);
+#endif
+
+	entry->seq = seq;
+	entry->old_iv = rpl->old_iv;
+
+	BT_DBG("RPL entry for 0x%04x: Seq 0x%06x old_iv %u", entry->src,
+	       entry->seq, entry->old_iv);
+
+	return 0;
+}
+
 static int rpl_set(const char *name, size_t len_rd,
 		   settings_read_cb read_cb, void *cb_arg)
 {
@@ -297,10 +375,10 @@ static int rpl_set(const char *name, size_t len_rd,
 	}
 
 	src = strtol(name, NULL, 16);
-	entry = bt_mesh_rpl_find(src);
 
 	if (len_rd == 0) {
 		BT_DBG("val (null)");
+		entry = bt_mesh_rpl_find(src);
 		if (entry) {
 			(void)memset(entry, 0, sizeof(*entry));
 		} else {
@@ -310,28 +388,57 @@ static int rpl_set(const char *name, size_t len_rd,
 		return 0;
 	}
 
-	if (!entry) {
-		entry = bt_mesh_rpl_alloc(src);
-		if (!entry) {
-			BT_ERR("Unable to allocate RPL entry for 0x%04x", src);
-			return -ENOMEM;
-		}
-	}
-
 	err = mesh_x_set(read_cb, cb_arg, &rpl, sizeof(rpl));
 	if (err) {
 		BT_ERR("Failed to set `net`");
 		return err;
 	}
 
-	entry->seq = rpl.seq;
-	entry->old_iv = rpl.old_iv;
+#if defined(CONFIG_BT_MESH_RPL_STORE_BATCH)
+	rpl_single_loaded = true;
+#endif
 
-	BT_DBG("RPL entry for 0x%04x: Seq 0x%06x old_iv %u", entry->src,
-	       entry->seq, entry->old_iv);
+	return rpl_load(src, &rpl);
+}
+
+#if defined(CONFIG_BT_MESH_RPL_STORE_BATCH)
+static int rpl_block_set(const char *name, size_t len_rd,
+			 settings_read_cb read_cb, void *cb_arg)
+{
+	struct rpl_block_val block[RPL_BLOCK_SIZE];
+	size_t i;
+	int err;
+
+	if (len_rd == 0) {
+		BT_DBG("val (null)");
+		return 0;
+	}
+
+	if (len_rd > sizeof(block) || len_rd % sizeof(block[0])) {
+		BT_ERR("Invalid RPL block length %zu", len_rd);
+		return -EINVAL;
+	}
+
+	err = mesh_x_set(read_cb, cb_arg, block, len_rd);
+	if (err) {
+		BT_ERR("Failed to set RPL block");
+		return err;
+	}
+
+	for (i = 0; i < len_rd / sizeof(block[0]); i++) {
+		if (block[i].src == BT_MESH_ADDR_UNASSIGNED) {
+			continue;
+		}
+
+		err = rpl_load(block[i].src, &block[i].rpl);
+		if (err) {
+			return err;
+		}
+	}
 
 	return 0;
 }
+#endif
 
 static int net_key_set(const char *name, size_t len_rd,
 		       settings_read_cb read_cb, void *cb_arg)
@@ -942,6 +1049,9 @@ const struct mesh_setting {
 	{ "IV", iv_set },
 	{ "Seq", seq_set },
 	{ "RPL", rpl_set },
+#if defined(CONFIG_BT_MESH_RPL_STORE_BATCH)
+	{ "RPLB", rpl_block_set },
+#endif
 	{ "NetKey", net_key_set },
 	{ "AppKey", app_key_set },
 	{ "HBPub", hb_pub_set },
@@ -1243,6 +1353,157 @@ static void store_pending_rpl(struct bt_mesh_rpl *rpl, void *user_data)
 	}
 }
 
+#if defined(CONFIG_BT_MESH_RPL_STORE_BATCH)
+struct rpl_block {
+	struct bt_mesh_rpl *entries[RPL_BLOCK_SIZE];
+	uint16_t count;
+	uint16_t index;
+	uint16_t changed;
+	uint16_t writes;
+};
+
+static void rpl_block_delete_single(struct rpl_block *block)
+{
+	char path[18];
+	int i;
+
+	for (i = 0; i < block->count; i++) {
+		if (!block->entries[i]->src) {
+			continue;
+		}
+
+		snprintk(path, sizeof(path), "bt/mesh/RPL/%x",
+			 block->entries[i]->src);
+		(void)settings_delete(path);
+	}
+}
+
+static void rpl_block_store(struct rpl_block *block)
+{
+	struct rpl_block_val val[RPL_BLOCK_SIZE];
+	uint16_t changed = 0U;
+	char path[18];
+	int i, err;
+
+	for (i = 0; i < block->count; i++) {
+		struct bt_mesh_rpl *entry = block->entries[i];
+
+		if (entry->store) {
+			changed++;
+		}
+
+		val[i].src = entry->src;
+		val[i].rpl.seq = rpl_accepted_seq(entry);
+		val[i].rpl.old_iv = entry->old_iv;
+	}
+
+	if (!changed && !rpl_store_all) {
+		goto done;
+	}
+
+	snprintk(path, sizeof(path), "bt/mesh/RPLB/%x", block->index);
+
+	err = settings_save_one(path, val, block->count * sizeof(val[0]));
+	if (err) {
+		BT_ERR("Failed to store RPL %s value", log_strdup(path));
+		goto done;
+	}
+
+	if (rpl_single_loaded) {
+		rpl_block_delete_single(block);
+	}
+
+	for (i = 0; i < block->count; i++) {
+		struct bt_mesh_rpl *entry = block->entries[i];
+
+		if (!entry->src) {
+			continue;
+		}
+
+		entry->store = false;
+		entry->stored_seq = val[i].rpl.seq;
+		entry->stored = 1U;
+		entry->window = (val[i].rpl.seq != entry->seq);
+	}
+
+	block->changed += changed;
+	block->writes++;
+
+done:
+	block->index++;
+	block->count = 0U;
+}
+
+static void store_rpl_block(struct bt_mesh_rpl *rpl, void *user_data)
+{
+	struct rpl_block *block = user_data;
+
+	block->entries[block->count++] = rpl;
+
+	if (block->count == ARRAY_SIZE(block->entries)) {
+		rpl_block_store(block);
+	}
+}
+
+static void store_pending_rpl_blocks(void)
+{
+	struct rpl_block block = { 0 };
+
+	bt_mesh_rpl_foreach(store_rpl_block, &block);
+
+	if (block.count) {
+		rpl_block_store(&block);
+	}
+
+	/* Changes made while storing are kept for the next store */
+	rpl_dirty = 0U;
+	rpl_store_all = false;
+	rpl_single_loaded = false;
+
+	if (block.changed > block.writes) {
+		rpl_writes_saved += block.changed - block.writes;
+	}
+
+	BT_DBG("Stored %u RPL entries in %u writes (%u writes saved)",
+	       block.changed, block.writes, rpl_writes_saved);
+}
+
+static void clear_rpl_entry(struct bt_mesh_rpl *rpl, void *user_data)
+{
+	(void)memset(rpl, 0, sizeof(*rpl));
+}
+
+static void clear_rpl_blocks(void)
+{
+	char path[18];
+	int i, err;
+
+	for (i = 0; i < RPL_BLOCK_COUNT; i++) {
+		snprintk(path, sizeof(path), "bt/mesh/RPLB/%x", i);
+		err = settings_delete(path);
+		if (err) {
+			BT_ERR("Failed to clear RPL");
+		}
+	}
+
+	/* Entries stored one by one are only replaced on the first store */
+	if (rpl_single_loaded) {
+		bt_mesh_rpl_foreach(clear_rpl, NULL);
+	} else {
+		bt_mesh_rpl_foreach(clear_rpl_entry, NULL);
+	}
+
+	rpl_dirty = 0U;
+	rpl_store_all = false;
+	rpl_single_loaded = false;
+}
+
+uint32_t bt_mesh_rpl_writes_saved(void)
+{
+	return rpl_writes_saved;
+}
+#endif /* CONFIG_BT_MESH_RPL_STORE_BATCH */
+
 static void store_pending_hb_pub(void)
 {
 	struct bt_mesh_hb_pub *pub = bt_mesh_hb_pub_get();
@@ -1844,7 +2105,13 @@ static void store_pending(struct k_work *work)
 	BT_DBG("");
 
 	if (atomic_test_and_clear_bit(bt_mesh.flags, BT_MESH_RPL_PENDING)) {
-		if (atomic_test_bit(bt_mesh.flags, BT_MESH_VALID)) {
+		if (IS_ENABLED(CONFIG_BT_MESH_RPL_STORE_BATCH)) {
+			if (atomic_test_bit(bt_mesh.flags, BT_MESH_VALID)) {
+				store_pending_rpl_blocks();
+			} else {
+				clear_rpl_blocks();
+			}
+		} else if (atomic_test_bit(bt_mesh.flags, BT_MESH_VALID)) {
 			bt_mesh_rpl_foreach(store_pending_rpl, NULL);
 		} else {
 			bt_mesh_rpl_foreach(clear_rpl, NULL);
@@ -1920,7 +2187,29 @@ static void store_pending(struct k_work *work)
 
 void bt_mesh_store_rpl(struct bt_mesh_rpl *entry)
 {
+#if defined(CONFIG_BT_MESH_RPL_STORE_BATCH)
+	if (!entry->store) {
+		entry->store = true;
+		rpl_dirty++;
+	}
+
+	/* Store right away if a reset could allow a replay that the
+	 * sequence number window skipped after loading does not cover.
+	 * Sources that are not stored yet wait for the next batch, like
+	 * every source does without batching.
+	 */
+	if (rpl_dirty >= CONFIG_BT_MESH_RPL_STORE_WATERMARK ||
+	    (entry->stored &&
+	     ((rpl_accepted_seq(entry) - entry->stored_seq) & BIT_MASK(24)) >=
+	     CONFIG_BT_MESH_RPL_STORE_SEQ_WINDOW / 2)) {
+		atomic_set_bit(bt_mesh.flags, BT_MESH_RPL_PENDING);
+		k_delayed_work_submit(&pending_store, K_NO_WAIT);
+		return;
+	}
+#else
 	entry->store = true;
+#endif
+
 	schedule_store(BT_MESH_RPL_PENDING);
 }
 
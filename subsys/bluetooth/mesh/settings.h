@@ -30,3 +30,8 @@ void bt_mesh_clear_cdb_subnet(struct bt_mesh_cdb_subnet *sub);
 void bt_mesh_clear_cdb_app_key(struct bt_mesh_cdb_app_key *app);
 
 void bt_mesh_settings_init(void);
+
+#if defined(CONFIG_BT_MESH_RPL_STORE_BATCH)
+/* Number of RPL flash writes saved by storing the RPL in blocks */
+uint32_t bt_mesh_rpl_writes_saved(void);
+#endif
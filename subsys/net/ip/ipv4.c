@@ -291,6 +291,17 @@ enum net_verdict net_ipv4_input(struct net_pkt *pkt)
 
 	net_pkt_set_family(pkt, PF_INET);
 
+	if (IS_ENABLED(CONFIG_NET_IPV4_FRAGMENT) &&
+	    (ntohs(UNALIGNED_GET((uint16_t *)&hdr->offset)) &
+	     (NET_IPV4_MORE_FRAG_MASK | NET_IPV4_FRAG_OFFSET_MASK))) {
+		verdict = net_ipv4_handle_fragment(pkt, hdr);
+		if (verdict == NET_DROP) {
+			goto drop;
+		}
+
+		return verdict;
+	}
+
 	NET_DBG("IPv4 packet received from %s to %s",
 		log_strdup(net_sprint_ipv4_addr(&hdr->src)),
 		log_strdup(net_sprint_ipv4_addr(&hdr->dst)));
@@ -35,6 +35,11 @@
 
 #define NET_IPV4_HDR_OPTNS_MAX_LEN 40
 
+/* IPv4 flags and fragment offset, in host byte order */
+#define NET_IPV4_DO_NOT_FRAG_MASK  0x4000 /* Don't fragment */
+#define NET_IPV4_MORE_FRAG_MASK    0x2000 /* More fragments */
+#define NET_IPV4_FRAG_OFFSET_MASK  0x1FFF /* Offset in 8 byte units */
+
 /**
  * @brief Create IPv4 packet in provided net_pkt.
  *
@@ -132,4 +137,53 @@ static inline int net_ipv4_parse_hdr_options(struct net_pkt *pkt,
 }
 #endif
 
+/**
+ * @brief Handles IPv4 fragmented packets.
+ *
+ * @details The fragment is stored until the whole packet has been
+ * received, after which the reassembled packet is fed back to the
+ * IP stack.
+ *
+ * @param pkt Network head packet, the cursor must be after the
+ * IPv4 header and options.
+ * @param hdr The IPv4 header of the current packet
+ *
+ * @return Return verdict about the packet
+ */
+#if defined(CONFIG_NET_IPV4_FRAGMENT) && defined(CONFIG_NET_NATIVE_IPV4)
+enum net_verdict net_ipv4_handle_fragment(struct net_pkt *pkt,
+					  struct net_ipv4_hdr *hdr);
+#else
+static inline enum net_verdict net_ipv4_handle_fragment(
+						struct net_pkt *pkt,
+						struct net_ipv4_hdr *hdr)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(hdr);
+
+	return NET_DROP;
+}
+#endif
+
+/**
+ * @brief Fragment the IPv4 packet if it does not fit into the MTU of
+ * the network interface.
+ *
+ * @param pkt Network packet to send
+ *
+ * @return NET_OK if the packet can be sent as is, NET_CONTINUE if it
+ * was fragmented and the fragments were sent instead, NET_DROP if the
+ * packet must be dropped.
+ */
+#if defined(CONFIG_NET_IPV4_FRAGMENT) && defined(CONFIG_NET_NATIVE_IPV4)
+enum net_verdict net_ipv4_prepare_for_send(struct net_pkt *pkt);
+#else
+static inline enum net_verdict net_ipv4_prepare_for_send(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return NET_OK;
+}
+#endif
+
 #endif /* __IPV4_H */
@@ -0,0 +1,344 @@
+/** @file
+ * @brief IPv4 Fragment related functions
+ */
+
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_ipv4, CONFIG_NET_IPV4_LOG_LEVEL);
+
+#include <errno.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_stats.h>
+#include <net/net_context.h>
+#include <random/rand32.h>
+#include "net_private.h"
+#include "net_stats.h"
+#include "ipv4.h"
+#include "reassembly.h"
+
+#define BUF_ALLOC_TIMEOUT K_MSEC(100)
+
+static inline uint16_t ipv4_frag_flags(struct net_ipv4_hdr *hdr)
+{
+	return ntohs(UNALIGNED_GET((uint16_t *)&hdr->offset));
+}
+
+static uint16_t fragment_hdr_len(struct net_pkt *pkt)
+{
+	return net_pkt_ip_hdr_len(pkt) + net_pkt_ipv4_opts_len(pkt);
+}
+
+static void reassemble_packet(struct net_reassembly *reass)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	struct net_ipv4_hdr *hdr;
+	struct net_pkt *pkt;
+	size_t len;
+
+	pkt = net_reassembly_finish(reass, fragment_hdr_len);
+	if (!pkt) {
+		return;
+	}
+
+	len = net_pkt_get_len(pkt);
+	if (len > UINT16_MAX) {
+		NET_DBG("Reassembled IPv4 pkt %p too long (%zu)", pkt, len);
+		goto error;
+	}
+
+	/* The first fragment has the header of the whole packet, only the
+	 * length, the fragment offset and the checksum need to be fixed.
+	 */
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	hdr = (struct net_ipv4_hdr *)net_pkt_get_data(pkt, &ipv4_access);
+	if (!hdr) {
+		goto error;
+	}
+
+	hdr->len = htons(len);
+	hdr->offset[0] = 0U;
+	hdr->offset[1] = 0U;
+	hdr->chksum = 0U;
+	hdr->chksum = net_calc_chksum_ipv4(pkt);
+
+	net_pkt_set_data(pkt, &ipv4_access);
+
+	NET_DBG("New pkt %p IPv4 len is %zu bytes", pkt, len);
+
+	/* As with IPv6, the packet is fed back through the RX queue and
+	 * must not be passed to L2 as it has no link layer header.
+	 */
+	net_pkt_set_ipv4_reassembled(pkt, true);
+
+	if (net_recv_data(net_pkt_iface(pkt), pkt) >= 0) {
+		return;
+	}
+error:
+	net_pkt_unref(pkt);
+}
+
+enum net_verdict net_ipv4_handle_fragment(struct net_pkt *pkt,
+					  struct net_ipv4_hdr *hdr)
+{
+	struct net_reassembly *reass;
+	struct net_addr src, dst;
+	uint16_t flags;
+	uint16_t len;
+	bool more;
+	int ret;
+
+	net_stats_update_ipv4_frag_recv(net_pkt_iface(pkt));
+
+	flags = ipv4_frag_flags(hdr);
+	more = flags & NET_IPV4_MORE_FRAG_MASK;
+	len = net_pkt_get_len(pkt) - fragment_hdr_len(pkt);
+
+	src.family = AF_INET;
+	net_ipaddr_copy(&src.in_addr, &hdr->src);
+	dst.family = AF_INET;
+	net_ipaddr_copy(&dst.in_addr, &hdr->dst);
+
+	reass = net_reassembly_get(net_pkt_iface(pkt), &src, &dst,
+				   (hdr->id[0] << 8) | hdr->id[1],
+				   hdr->proto);
+	if (!reass) {
+		NET_DBG("Cannot get reassembly slot, dropping pkt %p", pkt);
+		goto drop;
+	}
+
+	if (more && (len % 8)) {
+		/* All but the last fragment must carry a multiple of
+		 * 8 bytes of data (RFC 791).
+		 */
+		net_reassembly_cancel(reass);
+		goto drop;
+	}
+
+	ret = net_reassembly_add(reass, pkt,
+				 (flags & NET_IPV4_FRAG_OFFSET_MASK) * 8U,
+				 len, more);
+	if (ret < 0) {
+		NET_DBG("Cannot store pkt %p to 0x%x (%d)", pkt, reass->id,
+			ret);
+
+		/* A duplicate does not invalidate the other fragments,
+		 * everything else discards the whole packet.
+		 */
+		if (ret != -EALREADY) {
+			net_reassembly_cancel(reass);
+		}
+
+		goto drop;
+	}
+
+	if (ret > 0) {
+		/* The last fragment received, reassemble the packet */
+		reassemble_packet(reass);
+	}
+
+	return NET_OK;
+
+drop:
+	net_stats_update_ipv4_frag_drop(net_pkt_iface(pkt));
+
+	return NET_DROP;
+}
+
+static int send_ipv4_fragment(struct net_pkt *pkt, uint16_t hdr_len,
+			      uint16_t copy_hdr_len, uint16_t fit_len,
+			      uint16_t frag_offset, uint16_t id, bool final)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	struct net_ipv4_hdr *frag_hdr;
+	struct net_pkt *frag_pkt;
+	int ret = -ENOBUFS;
+
+	frag_pkt = net_pkt_alloc_with_buffer(net_pkt_iface(pkt), fit_len +
+					     copy_hdr_len -
+					     sizeof(struct net_ipv4_hdr),
+					     AF_INET, 0, BUF_ALLOC_TIMEOUT);
+	if (!frag_pkt) {
+		return -ENOMEM;
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	/* Copy the header, and the options if this is the first fragment,
+	 * followed by the payload part of this fragment.
+	 */
+	if (net_pkt_copy(frag_pkt, pkt, copy_hdr_len) ||
+	    net_pkt_skip(pkt, hdr_len - copy_hdr_len + frag_offset) ||
+	    net_pkt_copy(frag_pkt, pkt, fit_len)) {
+		goto fail;
+	}
+
+	net_pkt_set_ip_hdr_len(frag_pkt, sizeof(struct net_ipv4_hdr));
+	net_pkt_set_ipv4_opts_len(frag_pkt,
+				  copy_hdr_len - sizeof(struct net_ipv4_hdr));
+	net_pkt_set_priority(frag_pkt, net_pkt_priority(pkt));
+
+	net_pkt_cursor_init(frag_pkt);
+	net_pkt_set_overwrite(frag_pkt, true);
+
+	frag_hdr = (struct net_ipv4_hdr *)net_pkt_get_data(frag_pkt,
+							   &ipv4_access);
+	if (!frag_hdr) {
+		goto fail;
+	}
+
+	frag_hdr->vhl = 0x40 | (copy_hdr_len / 4U);
+	frag_hdr->len = htons(copy_hdr_len + fit_len);
+	frag_hdr->id[0] = id >> 8;
+	frag_hdr->id[1] = id;
+	frag_hdr->offset[0] = ((frag_offset / 8U) >> 8) |
+			      (final ? 0 : NET_IPV4_MORE_FRAG_MASK >> 8);
+	frag_hdr->offset[1] = frag_offset / 8U;
+	frag_hdr->chksum = 0U;
+
+	if (net_if_need_calc_tx_checksum(net_pkt_iface(frag_pkt))) {
+		frag_hdr->chksum = net_calc_chksum_ipv4(frag_pkt);
+	}
+
+	if (net_pkt_set_data(frag_pkt, &ipv4_access)) {
+		goto fail;
+	}
+
+	ret = net_send_data(frag_pkt);
+	if (ret < 0) {
+		goto fail;
+	}
+
+	net_stats_update_ipv4_frag_sent(net_pkt_iface(pkt));
+
+	/* Let this packet to be sent and hopefully it will release
+	 * the memory that can be utilized for next sent IPv4 fragment.
+	 */
+	k_yield();
+
+	return 0;
+
+fail:
+	NET_DBG("Cannot send fragment (%d)", ret);
+	net_pkt_unref(frag_pkt);
+
+	return ret;
+}
+
+static int send_fragmented_pkt(struct net_pkt *pkt, struct net_ipv4_hdr *hdr,
+			       uint16_t mtu)
+{
+	uint16_t hdr_len = (hdr->vhl & NET_IPV4_IHL_MASK) * 4U;
+	uint16_t frag_offset = 0U;
+	uint16_t copy_hdr_len;
+	size_t length;
+	uint16_t id;
+	int fit_len;
+	int ret;
+
+	id = (hdr->id[0] << 8) | hdr->id[1];
+	if (id == 0U) {
+		id = sys_rand32_get();
+	}
+
+	length = net_pkt_get_len(pkt) - hdr_len;
+
+	while (length) {
+		bool final = false;
+
+		/* Options are not copied to the later fragments as the
+		 * only ones we support (Record Route and Timestamp) must
+		 * appear in the first fragment only (RFC 791).
+		 */
+		copy_hdr_len = frag_offset ? sizeof(struct net_ipv4_hdr) :
+			       hdr_len;
+
+		fit_len = (mtu - copy_hdr_len) & ~7;
+		if (fit_len <= 0) {
+			NET_DBG("No room for IPv4 payload MTU %d hdr_len %d",
+				mtu, copy_hdr_len);
+			return -EINVAL;
+		}
+
+		if (fit_len >= length) {
+			final = true;
+			fit_len = length;
+		}
+
+		ret = send_ipv4_fragment(pkt, hdr_len, copy_hdr_len, fit_len,
+					 frag_offset, id, final);
+		if (ret < 0) {
+			return ret;
+		}
+
+		length -= fit_len;
+		frag_offset += fit_len;
+	}
+
+	return 0;
+}
+
+enum net_verdict net_ipv4_prepare_for_send(struct net_pkt *pkt)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	uint16_t mtu = net_if_get_mtu(net_pkt_iface(pkt));
+	struct net_ipv4_hdr *hdr;
+	int ret;
+
+	/* A TCP segmentation offload packet is split into segments by L2 */
+	if (mtu == 0U || net_pkt_get_len(pkt) <= mtu ||
+	    net_pkt_tcp_gso_size(pkt)) {
+		return NET_OK;
+	}
+
+	hdr = (struct net_ipv4_hdr *)net_pkt_get_data(pkt, &ipv4_access);
+	if (!hdr) {
+		return NET_DROP;
+	}
+
+	if (ipv4_frag_flags(hdr) & NET_IPV4_DO_NOT_FRAG_MASK) {
+		NET_DBG("pkt %p too long for MTU %d but DF is set", pkt, mtu);
+		net_stats_update_ipv4_frag_drop(net_pkt_iface(pkt));
+		return NET_DROP;
+	}
+
+	ret = send_fragmented_pkt(pkt, hdr, mtu);
+	if (ret < 0) {
+		NET_DBG("Cannot fragment IPv4 pkt (%d)", ret);
+
+		if (ret == -ENOMEM) {
+			/* Try to send the packet if we could not allocate
+			 * enough network packets and hope the original large
+			 * packet can be sent ok.
+			 */
+			net_pkt_cursor_init(pkt);
+			return NET_OK;
+		}
+	}
+
+	/* We "fake" the sending of the packet here so that TCP will
+	 * increase the ref count when re-sending the packet, see the
+	 * IPv6 counterpart in net_ipv6_prepare_for_send().
+	 */
+	if (IS_ENABLED(CONFIG_NET_TCP)) {
+		net_pkt_set_sent(pkt, true);
+	}
+
+	/* We need to unref here because we simulate the packet
+	 * sending.
+	 */
+	net_pkt_unref(pkt);
+
+	/* No need to continue with the sending as the packet
+	 * is now split and its fragments will be sent
+	 * separately to network.
+	 */
+	return NET_CONTINUE;
+}
@@ -55,6 +55,44 @@ LOG_MODULE_REGISTER(net_core, CONFIG_NET_CORE_LOG_LEVEL);
 
 #include "net_stats.h"
 
+static enum net_verdict process_ip(struct net_pkt *pkt, bool is_loopback)
+{
+	/* L2 has modified the buffer starting point, it is easier
+	 * to re-initialize the cursor rather than updating it.
+	 */
+	net_pkt_cursor_init(pkt);
+
+	/* IP version and header length. */
+	switch (NET_IPV6_HDR(pkt)->vtc & 0xf0) {
+#if defined(CONFIG_NET_IPV6)
+	case 0x60:
+		return net_ipv6_input(pkt, is_loopback);
+#endif
+#if defined(CONFIG_NET_IPV4)
+	case 0x40:
+		return net_ipv4_input(pkt);
+#endif
+	}
+
+	NET_DBG("Unknown IP family packet (0x%x)",
+		NET_IPV6_HDR(pkt)->vtc & 0xf0);
+	net_stats_update_ip_errors_protoerr(net_pkt_iface(pkt));
+	net_stats_update_ip_errors_vhlerr(net_pkt_iface(pkt));
+
+	return NET_DROP;
+}
+
+#if defined(CONFIG_NET_TCP_GRO)
+/* Called for the packets that were held for TCP receive coalescing */
+static void gro_deliver(struct net_pkt *pkt)
+{
+	if (process_ip(pkt, false) != NET_OK) {
+		NET_DBG("Dropping pkt %p", pkt);
+		net_pkt_unref(pkt);
+	}
+}
+#endif
+
 static inline enum net_verdict process_data(struct net_pkt *pkt,
 					    bool is_loopback)
 {
@@ -76,6 +114,11 @@ static inline enum net_verdict process_data(struct net_pkt *pkt,
 	}
 #endif
 
+	/* Same thing for a reassembled IPv4 packet. */
+	if (net_pkt_ipv4_is_reassembled(pkt)) {
+		locally_routed = true;
+	}
+
 	/* If there is no data, then drop the packet. */
 	if (!pkt->frags) {
 		NET_DBG("Corrupted packet (frags %p)", pkt->frags);
@@ -102,29 +145,18 @@ static inline enum net_verdict process_data(struct net_pkt *pkt,
 		return ret;
 	}
 
-	/* L2 has modified the buffer starting point, it is easier
-	 * to re-initialize the cursor rather than updating it.
-	 */
-	net_pkt_cursor_init(pkt);
-
-	/* IP version and header length. */
-	switch (NET_IPV6_HDR(pkt)->vtc & 0xf0) {
-#if defined(CONFIG_NET_IPV6)
-	case 0x60:
-		return net_ipv6_input(pkt, is_loopback);
-#endif
-#if defined(CONFIG_NET_IPV4)
-	case 0x40:
-		return net_ipv4_input(pkt);
-#endif
+#if defined(CONFIG_NET_TCP_GRO)
+	if (!is_loopback && !locally_routed) {
+		ret = net_tcp_gro_receive(pkt,
+					  net_rx_priority2tc(net_pkt_priority(pkt)),
+					  gro_deliver);
+		if (ret != NET_CONTINUE) {
+			return ret;
+		}
 	}
+#endif
 
-	NET_DBG("Unknown IP family packet (0x%x)",
-		NET_IPV6_HDR(pkt)->vtc & 0xf0);
-	net_stats_update_ip_errors_protoerr(net_pkt_iface(pkt));
-	net_stats_update_ip_errors_vhlerr(net_pkt_iface(pkt));
-
-	return NET_DROP;
+	return process_ip(pkt, is_loopback);
 }
 
 static void processing_data(struct net_pkt *pkt, bool is_loopback)
@@ -347,12 +379,28 @@ static void net_rx(struct net_if *iface, struct net_pkt *pkt)
 static void process_rx_packet(struct k_work *work)
 {
 	struct net_pkt *pkt;
+#if defined(CONFIG_NET_TCP_GRO)
+	uint8_t tc;
+#endif
 
 	pkt = CONTAINER_OF(work, struct net_pkt, work);
 
+#if defined(CONFIG_NET_TCP_GRO)
+	tc = net_rx_priority2tc(net_pkt_priority(pkt));
+#endif
+
 	net_pkt_set_rx_stats_tick(pkt, k_cycle_get_32());
 
 	net_rx(net_pkt_iface(pkt), pkt);
+
+#if defined(CONFIG_NET_TCP_GRO)
+	/* Coalesced segments are not held longer than there are packets
+	 * waiting in the queue.
+	 */
+	if (net_tc_rx_queue_is_empty(tc)) {
+		net_tcp_gro_flush(tc, gro_deliver);
+	}
+#endif
 }
 
 static void net_queue_rx(struct net_if *iface, struct net_pkt *pkt)
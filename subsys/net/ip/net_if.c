@@ -22,6 +22,7 @@ LOG_MODULE_REGISTER(net_if, CONFIG_NET_IF_LOG_LEVEL);
 
 #include "net_private.h"
 #include "ipv6.h"
+#include "ipv4.h"
 #include "ipv4_autoconf_internal.h"
 
 #include "net_stats.h"
@@ -344,12 +345,20 @@ static bool net_if_tx(struct net_if *iface, struct net_pkt *pkt)
 	return true;
 }
 
-static void process_tx_packet(struct k_work *work)
+#if defined(CONFIG_NET_ETHERNET_TX_BATCH)
+static void tx_batch_flush(struct net_if *iface, void *user_data)
 {
-	struct net_if *iface;
-	struct net_pkt *pkt;
+	ARG_UNUSED(user_data);
 
-	pkt = CONTAINER_OF(work, struct net_pkt, work);
+	if (net_if_l2(iface) == &NET_L2_GET_NAME(ETHERNET)) {
+		net_eth_tx_flush(iface);
+	}
+}
+#endif
+
+static void tx_packet(struct net_pkt *pkt)
+{
+	struct net_if *iface;
 
 	net_pkt_set_tx_stats_tick(pkt, k_cycle_get_32());
 
@@ -362,12 +371,45 @@ static void process_tx_packet(struct k_work *work)
 #endif
 }
 
+#if defined(CONFIG_NET_ETHERNET_TX_BATCH)
+/* Called by the work item of TX traffic class tc */
+void net_if_tx_burst(uint8_t tc)
+{
+	struct net_pkt *pkt;
+	int count = 0;
+
+	/* Send a burst per wakeup instead of waking up and yielding once
+	 * per packet.
+	 */
+	while (count++ < CONFIG_NET_ETHERNET_TX_BATCH_SIZE &&
+	       (pkt = net_tc_tx_queue_get(tc)) != NULL) {
+		tx_packet(pkt);
+	}
+
+	/* End of the burst, hand the batched packets to the drivers */
+	if (net_tc_tx_queue_is_empty(tc)) {
+		net_if_foreach(tx_batch_flush, NULL);
+	}
+}
+#else
+static void process_tx_packet(struct k_work *work)
+{
+	struct net_pkt *pkt;
+
+	pkt = CONTAINER_OF(work, struct net_pkt, work);
+
+	tx_packet(pkt);
+}
+#endif
+
 void net_if_queue_tx(struct net_if *iface, struct net_pkt *pkt)
 {
 	uint8_t prio = net_pkt_priority(pkt);
 	uint8_t tc = net_tx_priority2tc(prio);
 
+#if !defined(CONFIG_NET_ETHERNET_TX_BATCH)
 	k_work_init(net_pkt_work(pkt), process_tx_packet);
+#endif
 
 	net_stats_update_tc_sent_pkt(iface, tc);
 	net_stats_update_tc_sent_bytes(iface, tc, net_pkt_get_len(pkt));
@@ -478,6 +520,11 @@ enum net_verdict net_if_send_data(struct net_if *iface, struct net_pkt *pkt)
 		verdict = net_ipv6_prepare_for_send(pkt);
 	}
 
+	if (IS_ENABLED(CONFIG_NET_IPV4_FRAGMENT) &&
+	    net_pkt_family(pkt) == AF_INET) {
+		verdict = net_ipv4_prepare_for_send(pkt);
+	}
+
 done:
 	/*   NET_OK in which case packet has checked successfully. In this case
 	 *   the net_context callback is called after successful delivery in
@@ -37,6 +37,7 @@ LOG_MODULE_REGISTER(net_shell, LOG_LEVEL_DBG);
 #endif
 
 #include "ipv6.h"
+#include "reassembly.h"
 
 #if defined(CONFIG_NET_ARP)
 #include "ethernet/arp.h"
@@ -238,6 +239,8 @@ static struct ethernet_capabilities eth_hw_caps[] = {
 	EC(ETHERNET_HW_RX_CHKSUM_OFFLOAD, "RX checksum offload"),
 	EC(ETHERNET_HW_VLAN,              "Virtual LAN"),
 	EC(ETHERNET_HW_VLAN_TAG_STRIP,    "VLAN Tag stripping"),
+	EC(ETHERNET_HW_TSO,               "TCP segmentation offload"),
+	EC(ETHERNET_HW_LRO,               "Large receive offload"),
 	EC(ETHERNET_AUTO_NEGOTIATION_SET, "Auto negotiation"),
 	EC(ETHERNET_LINK_10BASE_T,        "10 Mbits"),
 	EC(ETHERNET_LINK_100BASE_T,       "100 Mbits"),
@@ -1071,6 +1074,15 @@ static void net_shell_print_statistics(struct net_if *iface, void *user_data)
 	   GET_STAT(iface, ipv6_mld.sent),
 	   GET_STAT(iface, ipv6_mld.drop));
 #endif /* CONFIG_NET_STATISTICS_MLD */
+#if defined(CONFIG_NET_STATISTICS_IPV6_FRAGMENT)
+	PR("IPv6 frag recv  %d\tsent\t%d\tdrop\t%d\treassembled\t%d\t"
+	   "timeout\t%d\n",
+	   GET_STAT(iface, ipv6_frag.recv),
+	   GET_STAT(iface, ipv6_frag.sent),
+	   GET_STAT(iface, ipv6_frag.drop),
+	   GET_STAT(iface, ipv6_frag.reassembled),
+	   GET_STAT(iface, ipv6_frag.timeout));
+#endif /* CONFIG_NET_STATISTICS_IPV6_FRAGMENT */
 #endif /* CONFIG_NET_STATISTICS_IPV6 */
 
 #if defined(CONFIG_NET_STATISTICS_IPV4) && defined(CONFIG_NET_NATIVE_IPV4)
@@ -1079,6 +1091,15 @@ static void net_shell_print_statistics(struct net_if *iface, void *user_data)
 	   GET_STAT(iface, ipv4.sent),
 	   GET_STAT(iface, ipv4.drop),
 	   GET_STAT(iface, ipv4.forwarded));
+#if defined(CONFIG_NET_STATISTICS_IPV4_FRAGMENT)
+	PR("IPv4 frag recv  %d\tsent\t%d\tdrop\t%d\treassembled\t%d\t"
+	   "timeout\t%d\n",
+	   GET_STAT(iface, ipv4_frag.recv),
+	   GET_STAT(iface, ipv4_frag.sent),
+	   GET_STAT(iface, ipv4_frag.drop),
+	   GET_STAT(iface, ipv4_frag.reassembled),
+	   GET_STAT(iface, ipv4_frag.timeout));
+#endif /* CONFIG_NET_STATISTICS_IPV4_FRAGMENT */
 #endif /* CONFIG_NET_STATISTICS_IPV4 */
 
 	PR("IP vhlerr      %d\thblener\t%d\tlblener\t%d\n",
@@ -1390,9 +1411,8 @@ static void tcp_sent_list_cb(struct net_tcp *tcp, void *user_data)
 #endif /* CONFIG_NET_TCP_LOG_LEVEL >= LOG_LEVEL_DBG */
 #endif
 
-#if defined(CONFIG_NET_IPV6_FRAGMENT)
-static void ipv6_frag_cb(struct net_ipv6_reassembly *reass,
-			 void *user_data)
+#if defined(CONFIG_NET_IP_REASSEMBLY)
+static void ip_frag_cb(struct net_reassembly *reass, void *user_data)
 {
 	struct net_shell_user_data *data = user_data;
 	const struct shell *shell = data->shell;
@@ -1401,39 +1421,40 @@ static void ipv6_frag_cb(struct net_ipv6_reassembly *reass,
 	int i;
 
 	if (!*count) {
-		PR("\nIPv6 reassembly Id         Remain "
-		   "Src             \tDst\n");
+		PR("\n%s reassembly Id         Remain "
+		   "Src             \tDst\n",
+		   reass->src.family == AF_INET ? "IPv4" : "IPv6");
 	}
 
-	snprintk(src, ADDR_LEN, "%s", net_sprint_ipv6_addr(&reass->src));
+	snprintk(src, ADDR_LEN, "%s",
+		 net_sprint_addr(reass->src.family, &reass->src.in6_addr));
 
 	PR("%p      0x%08x  %5d %16s\t%16s\n",
 	   reass, reass->id,
 	   k_delayed_work_remaining_get(&reass->timer),
-	   src, net_sprint_ipv6_addr(&reass->dst));
+	   src, net_sprint_addr(reass->dst.family, &reass->dst.in6_addr));
 
-	for (i = 0; i < NET_IPV6_FRAGMENTS_MAX_PKT; i++) {
-		if (reass->pkt[i]) {
-			struct net_buf *frag = reass->pkt[i]->frags;
+	for (i = 0; i < reass->count; i++) {
+		struct net_buf *frag = reass->pkt[i]->frags;
 
-			PR("[%d] pkt %p->", i, reass->pkt[i]);
+		PR("[%d] pkt %p offset %u len %u->", i, reass->pkt[i],
+		   reass->offset[i], reass->len[i]);
 
-			while (frag) {
-				PR("%p", frag);
+		while (frag) {
+			PR("%p", frag);
 
-				frag = frag->frags;
-				if (frag) {
-					PR("->");
-				}
+			frag = frag->frags;
+			if (frag) {
+				PR("->");
 			}
-
-			PR("\n");
 		}
+
+		PR("\n");
 	}
 
 	(*count)++;
 }
-#endif /* CONFIG_NET_IPV6_FRAGMENT */
+#endif /* CONFIG_NET_IP_REASSEMBLY */
 
 #if defined(CONFIG_NET_DEBUG_NET_PKT_ALLOC)
 static void allocs_cb(struct net_pkt *pkt,
@@ -1651,10 +1672,14 @@ static int cmd_net_conn(const struct shell *shell, size_t argc, char *argv[])
 
 #endif
 
-#if defined(CONFIG_NET_IPV6_FRAGMENT)
+#if defined(CONFIG_NET_IP_REASSEMBLY)
+	count = 0;
+
+	net_reassembly_foreach(AF_INET6, ip_frag_cb, &user_data);
+
 	count = 0;
 
-	net_ipv6_frag_foreach(ipv6_frag_cb, &user_data);
+	net_reassembly_foreach(AF_INET, ip_frag_cb, &user_data);
 
 	/* Do not print anything if no fragments are pending atm */
 #endif
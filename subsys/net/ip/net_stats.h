@@ -113,6 +113,43 @@ static inline void net_stats_update_ipv6_nd_drop(struct net_if *iface)
 #define net_stats_update_ipv6_nd_drop(iface)
 #endif /* CONFIG_NET_STATISTICS_IPV6_ND */
 
+#if defined(CONFIG_NET_STATISTICS_IPV6_FRAGMENT) && \
+	defined(CONFIG_NET_NATIVE_IPV6)
+/* IPv6 fragmentation stats */
+
+static inline void net_stats_update_ipv6_frag_recv(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv6_frag.recv++);
+}
+
+static inline void net_stats_update_ipv6_frag_sent(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv6_frag.sent++);
+}
+
+static inline void net_stats_update_ipv6_frag_reassembled(
+							struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv6_frag.reassembled++);
+}
+
+static inline void net_stats_update_ipv6_frag_timeout(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv6_frag.timeout++);
+}
+
+static inline void net_stats_update_ipv6_frag_drop(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv6_frag.drop++);
+}
+#else
+#define net_stats_update_ipv6_frag_recv(iface)
+#define net_stats_update_ipv6_frag_sent(iface)
+#define net_stats_update_ipv6_frag_reassembled(iface)
+#define net_stats_update_ipv6_frag_timeout(iface)
+#define net_stats_update_ipv6_frag_drop(iface)
+#endif /* CONFIG_NET_STATISTICS_IPV6_FRAGMENT */
+
 #if defined(CONFIG_NET_STATISTICS_IPV4) && defined(CONFIG_NET_NATIVE_IPV4)
 /* IPv4 stats */
 
@@ -136,6 +173,43 @@ static inline void net_stats_update_ipv4_recv(struct net_if *iface)
 #define net_stats_update_ipv4_recv(iface)
 #endif /* CONFIG_NET_STATISTICS_IPV4 */
 
+#if defined(CONFIG_NET_STATISTICS_IPV4_FRAGMENT) && \
+	defined(CONFIG_NET_NATIVE_IPV4)
+/* IPv4 fragmentation stats */
+
+static inline void net_stats_update_ipv4_frag_recv(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv4_frag.recv++);
+}
+
+static inline void net_stats_update_ipv4_frag_sent(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv4_frag.sent++);
+}
+
+static inline void net_stats_update_ipv4_frag_reassembled(
+							struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv4_frag.reassembled++);
+}
+
+static inline void net_stats_update_ipv4_frag_timeout(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv4_frag.timeout++);
+}
+
+static inline void net_stats_update_ipv4_frag_drop(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.ipv4_frag.drop++);
+}
+#else
+#define net_stats_update_ipv4_frag_recv(iface)
+#define net_stats_update_ipv4_frag_sent(iface)
+#define net_stats_update_ipv4_frag_reassembled(iface)
+#define net_stats_update_ipv4_frag_timeout(iface)
+#define net_stats_update_ipv4_frag_drop(iface)
+#endif /* CONFIG_NET_STATISTICS_IPV4_FRAGMENT */
+
 #if defined(CONFIG_NET_STATISTICS_ICMP) && defined(CONFIG_NET_NATIVE_IPV4)
 /* Common ICMPv4/ICMPv6 stats */
 static inline void net_stats_update_icmp_sent(struct net_if *iface)
@@ -35,6 +35,65 @@ K_KERNEL_STACK_ARRAY_DEFINE(rx_stack, NET_TC_RX_COUNT,
 static struct net_traffic_class tx_classes[NET_TC_TX_COUNT];
 static struct net_traffic_class rx_classes[NET_TC_RX_COUNT];
 
+#if defined(CONFIG_NET_ETHERNET_TX_BATCH)
+/* Packets of a TX traffic class, sent in bursts by one work item */
+struct tx_fifo {
+	struct k_fifo fifo;
+	struct k_work work;
+};
+
+static struct tx_fifo tx_fifos[NET_TC_TX_COUNT];
+
+static void tx_fifo_work(struct k_work *work)
+{
+	struct tx_fifo *q = CONTAINER_OF(work, struct tx_fifo, work);
+	uint8_t tc = q - tx_fifos;
+
+	net_if_tx_burst(tc);
+
+	/* Packets beyond one burst go behind other pending work */
+	if (!k_fifo_is_empty(&q->fifo)) {
+		k_work_submit_to_queue(&tx_classes[tc].work_q, work);
+	}
+}
+
+bool net_tc_submit_to_tx_queue(uint8_t tc, struct net_pkt *pkt)
+{
+	/* The packet may still be queued, e.g. on TCP resend */
+	if (!atomic_cas(&pkt->tx_queued, 0, 1)) {
+		return false;
+	}
+
+	net_pkt_set_tx_stats_tick(pkt, k_cycle_get_32());
+
+	k_fifo_put(&tx_fifos[tc].fifo, pkt);
+	k_work_submit_to_queue(&tx_classes[tc].work_q, &tx_fifos[tc].work);
+
+	return true;
+}
+
+bool net_tc_tx_pending(struct net_pkt *pkt)
+{
+	return atomic_get(&pkt->tx_queued) != 0;
+}
+
+struct net_pkt *net_tc_tx_queue_get(uint8_t tc)
+{
+	struct net_pkt *pkt;
+
+	pkt = k_fifo_get(&tx_fifos[tc].fifo, K_NO_WAIT);
+	if (pkt) {
+		atomic_clear(&pkt->tx_queued);
+	}
+
+	return pkt;
+}
+
+bool net_tc_tx_queue_is_empty(uint8_t tc)
+{
+	return k_fifo_is_empty(&tx_fifos[tc].fifo);
+}
+#else
 bool net_tc_submit_to_tx_queue(uint8_t tc, struct net_pkt *pkt)
 {
 	if (k_work_pending(net_pkt_work(pkt))) {
@@ -48,6 +107,12 @@ bool net_tc_submit_to_tx_queue(uint8_t tc, struct net_pkt *pkt)
 	return true;
 }
 
+bool net_tc_tx_pending(struct net_pkt *pkt)
+{
+	return k_work_pending(net_pkt_work(pkt));
+}
+#endif /* CONFIG_NET_ETHERNET_TX_BATCH */
+
 void net_tc_submit_to_rx_queue(uint8_t tc, struct net_pkt *pkt)
 {
 	net_pkt_set_rx_stats_tick(pkt, k_cycle_get_32());
@@ -55,6 +120,11 @@ void net_tc_submit_to_rx_queue(uint8_t tc, struct net_pkt *pkt)
 	k_work_submit_to_queue(&rx_classes[tc].work_q, net_pkt_work(pkt));
 }
 
+bool net_tc_rx_queue_is_empty(uint8_t tc)
+{
+	return k_queue_is_empty(&rx_classes[tc].work_q.queue);
+}
+
 int net_tx_priority2tc(enum net_priority prio)
 {
 	if (prio > NET_PRIORITY_NC) {
@@ -247,6 +317,11 @@ void net_tc_tx_init(void)
 			K_KERNEL_STACK_SIZEOF(tx_stack[i]),
 			thread_priority, K_PRIO_COOP(thread_priority));
 
+#if defined(CONFIG_NET_ETHERNET_TX_BATCH)
+		k_fifo_init(&tx_fifos[i].fifo);
+		k_work_init(&tx_fifos[i].work, tx_fifo_work);
+#endif
+
 		k_work_q_start(&tx_classes[i].work_q,
 			       tx_stack[i],
 			       K_KERNEL_STACK_SIZEOF(tx_stack[i]),
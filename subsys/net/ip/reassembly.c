@@ -0,0 +1,355 @@
+/** @file
+ * @brief IP fragment reassembly shared by IPv4 and IPv6
+ */
+
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_reassembly, CONFIG_NET_CORE_LOG_LEVEL);
+
+#include <errno.h>
+#include <string.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_stats.h>
+#include "net_private.h"
+#include "net_stats.h"
+#include "reassembly.h"
+
+#if defined(CONFIG_NET_IPV4_FRAGMENT_TIMEOUT)
+#define IPV4_REASSEMBLY_TIMEOUT K_SECONDS(CONFIG_NET_IPV4_FRAGMENT_TIMEOUT)
+#else
+#define IPV4_REASSEMBLY_TIMEOUT K_SECONDS(5)
+#endif /* CONFIG_NET_IPV4_FRAGMENT_TIMEOUT */
+
+#if defined(CONFIG_NET_IPV6_FRAGMENT_TIMEOUT)
+#define IPV6_REASSEMBLY_TIMEOUT K_SECONDS(CONFIG_NET_IPV6_FRAGMENT_TIMEOUT)
+#else
+#define IPV6_REASSEMBLY_TIMEOUT K_SECONDS(5)
+#endif /* CONFIG_NET_IPV6_FRAGMENT_TIMEOUT */
+
+static void reassembly_timeout(struct k_work *work);
+static bool reassembly_init_done;
+
+static struct net_reassembly reassembly[NET_REASSEMBLY_COUNT];
+
+static void reassembly_init(void)
+{
+	int i;
+
+	if (reassembly_init_done) {
+		return;
+	}
+
+	/* Static initializing does not work here because of the array
+	 * so we must do it at runtime.
+	 */
+	for (i = 0; i < NET_REASSEMBLY_COUNT; i++) {
+		k_delayed_work_init(&reassembly[i].timer, reassembly_timeout);
+	}
+
+	reassembly_init_done = true;
+}
+
+static bool addr_cmp(const struct net_addr *a, const struct net_addr *b)
+{
+	if (a->family != b->family) {
+		return false;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_IPV4_FRAGMENT) && a->family == AF_INET) {
+		return net_ipv4_addr_cmp(&a->in_addr, &b->in_addr);
+	}
+
+	return net_ipv6_addr_cmp(&a->in6_addr, &b->in6_addr);
+}
+
+static void stats_update_drop(struct net_reassembly *reass)
+{
+	if (reass->src.family == AF_INET) {
+		net_stats_update_ipv4_frag_drop(reass->iface);
+	} else {
+		net_stats_update_ipv6_frag_drop(reass->iface);
+	}
+}
+
+static void reassembly_release(struct net_reassembly *reass)
+{
+	int i;
+
+	k_delayed_work_cancel(&reass->timer);
+
+	for (i = 0; i < reass->count; i++) {
+		if (!reass->pkt[i]) {
+			continue;
+		}
+
+		NET_DBG("[%d] reassembly pkt %p %zd bytes data", i,
+			reass->pkt[i], net_pkt_get_len(reass->pkt[i]));
+
+		stats_update_drop(reass);
+
+		net_pkt_unref(reass->pkt[i]);
+		reass->pkt[i] = NULL;
+	}
+
+	reass->count = 0U;
+	reass->src.family = AF_UNSPEC;
+}
+
+static void reassembly_timeout(struct k_work *work)
+{
+	struct net_reassembly *reass =
+		CONTAINER_OF(work, struct net_reassembly, timer);
+
+	NET_DBG("Reassembly id 0x%x timed out with %d fragments", reass->id,
+		reass->count);
+
+	if (reass->src.family == AF_INET) {
+		net_stats_update_ipv4_frag_timeout(reass->iface);
+	} else {
+		net_stats_update_ipv6_frag_timeout(reass->iface);
+	}
+
+	reassembly_release(reass);
+}
+
+struct net_reassembly *net_reassembly_get(struct net_if *iface,
+					  const struct net_addr *src,
+					  const struct net_addr *dst,
+					  uint32_t id, uint8_t proto)
+{
+	struct net_reassembly *avail = NULL;
+	k_timeout_t timeout;
+	int slots, max_pkt;
+	int i, used = 0;
+
+	if (IS_ENABLED(CONFIG_NET_IPV4_FRAGMENT) && src->family == AF_INET) {
+		slots = NET_REASSEMBLY_IPV4_COUNT;
+		max_pkt = NET_REASSEMBLY_IPV4_MAX_PKT;
+		timeout = IPV4_REASSEMBLY_TIMEOUT;
+	} else if (IS_ENABLED(CONFIG_NET_IPV6_FRAGMENT) &&
+		   src->family == AF_INET6) {
+		slots = NET_REASSEMBLY_IPV6_COUNT;
+		max_pkt = NET_REASSEMBLY_IPV6_MAX_PKT;
+		timeout = IPV6_REASSEMBLY_TIMEOUT;
+	} else {
+		return NULL;
+	}
+
+	reassembly_init();
+
+	for (i = 0; i < NET_REASSEMBLY_COUNT; i++) {
+		struct net_reassembly *reass = &reassembly[i];
+
+		if (reass->src.family == AF_UNSPEC) {
+			if (!avail) {
+				avail = reass;
+			}
+
+			continue;
+		}
+
+		if (reass->src.family != src->family) {
+			continue;
+		}
+
+		if (reass->id == id && reass->proto == proto &&
+		    addr_cmp(src, &reass->src) && addr_cmp(dst, &reass->dst)) {
+			return reass;
+		}
+
+		used++;
+	}
+
+	/* Each family has its own share of the slots so that one of them
+	 * cannot starve the other.
+	 */
+	if (!avail || used >= slots) {
+		return NULL;
+	}
+
+	memcpy(&avail->src, src, sizeof(avail->src));
+	memcpy(&avail->dst, dst, sizeof(avail->dst));
+	avail->iface = iface;
+	avail->id = id;
+	avail->proto = proto;
+	avail->count = 0U;
+	avail->max_pkt = max_pkt;
+	avail->total_len = 0U;
+	avail->last_seen = false;
+
+	k_delayed_work_submit(&avail->timer, timeout);
+
+	return avail;
+}
+
+static bool reassembly_complete(struct net_reassembly *reass)
+{
+	uint16_t expected = 0U;
+	int i;
+
+	if (!reass->last_seen) {
+		return false;
+	}
+
+	for (i = 0; i < reass->count; i++) {
+		if (reass->offset[i] != expected) {
+			return false;
+		}
+
+		expected += reass->len[i];
+	}
+
+	return expected == reass->total_len;
+}
+
+int net_reassembly_add(struct net_reassembly *reass, struct net_pkt *pkt,
+		       uint16_t offset, uint16_t len, bool more)
+{
+	uint32_t end = (uint32_t)offset + len;
+	int i;
+
+	if (end > UINT16_MAX || (more && len == 0U)) {
+		return -EINVAL;
+	}
+
+	/* Find the place of the fragment in the offset sorted list */
+	for (i = 0; i < reass->count; i++) {
+		if (reass->offset[i] >= offset) {
+			break;
+		}
+	}
+
+	if (i < reass->count && reass->offset[i] == offset &&
+	    reass->len[i] == len) {
+		/* A retransmitted fragment, keep the one we have */
+		return -EALREADY;
+	}
+
+	/* Overlapping fragments are not accepted (RFC 5722, RFC 1858) */
+	if ((i > 0 && reass->offset[i - 1] + reass->len[i - 1] > offset) ||
+	    (i < reass->count && end > reass->offset[i])) {
+		NET_DBG("Fragment %u..%u of 0x%x overlaps", offset, end,
+			reass->id);
+		return -EINVAL;
+	}
+
+	if (!more) {
+		if (reass->last_seen ||
+		    (reass->count &&
+		     reass->offset[reass->count - 1] +
+		     reass->len[reass->count - 1] > end)) {
+			return -EINVAL;
+		}
+	} else if (reass->last_seen && end > reass->total_len) {
+		return -EINVAL;
+	}
+
+	if (reass->count >= reass->max_pkt) {
+		NET_DBG("No room for fragment of 0x%x", reass->id);
+		return -ENOMEM;
+	}
+
+	memmove(&reass->pkt[i + 1], &reass->pkt[i],
+		(reass->count - i) * sizeof(reass->pkt[0]));
+	memmove(&reass->offset[i + 1], &reass->offset[i],
+		(reass->count - i) * sizeof(reass->offset[0]));
+	memmove(&reass->len[i + 1], &reass->len[i],
+		(reass->count - i) * sizeof(reass->len[0]));
+
+	reass->pkt[i] = pkt;
+	reass->offset[i] = offset;
+	reass->len[i] = len;
+	reass->count++;
+
+	if (!more) {
+		reass->last_seen = true;
+		reass->total_len = end;
+	}
+
+	NET_DBG("Stored pkt %p to slot %d offset %u len %u of 0x%x", pkt, i,
+		offset, len, reass->id);
+
+	return reassembly_complete(reass) ? 1 : 0;
+}
+
+struct net_pkt *net_reassembly_finish(struct net_reassembly *reass,
+				      net_reassembly_hdr_len_t hdr_len)
+{
+	struct net_pkt *first, *pkt;
+	struct net_buf *last;
+	int i;
+
+	NET_ASSERT(reass->count > 0 && reass->offset[0] == 0U);
+
+	k_delayed_work_cancel(&reass->timer);
+
+	first = reass->pkt[0];
+	last = net_buf_frag_last(first->buffer);
+
+	/* We start from 2nd packet which is then appended to
+	 * the first one.
+	 */
+	for (i = 1; i < reass->count; i++) {
+		pkt = reass->pkt[i];
+
+		net_pkt_cursor_init(pkt);
+
+		/* Get rid of the IP headers which are at the beginning
+		 * of the fragment.
+		 */
+		if (net_pkt_pull(pkt, hdr_len(pkt))) {
+			NET_ERR("Failed to pull headers");
+			reassembly_release(reass);
+			return NULL;
+		}
+
+		/* Attach the data to previous pkt */
+		last->frags = pkt->buffer;
+		last = net_buf_frag_last(pkt->buffer);
+
+		pkt->buffer = NULL;
+		reass->pkt[i] = NULL;
+
+		net_pkt_unref(pkt);
+	}
+
+	reass->pkt[0] = NULL;
+	reass->count = 0U;
+
+	if (reass->src.family == AF_INET) {
+		net_stats_update_ipv4_frag_reassembled(reass->iface);
+	} else {
+		net_stats_update_ipv6_frag_reassembled(reass->iface);
+	}
+
+	reass->src.family = AF_UNSPEC;
+
+	return first;
+}
+
+void net_reassembly_cancel(struct net_reassembly *reass)
+{
+	NET_DBG("Cancel 0x%x", reass->id);
+
+	reassembly_release(reass);
+}
+
+void net_reassembly_foreach(sa_family_t family, net_reassembly_cb_t cb,
+			    void *user_data)
+{
+	int i;
+
+	for (i = 0; reassembly_init_done && i < NET_REASSEMBLY_COUNT; i++) {
+		if (reassembly[i].src.family != family) {
+			continue;
+		}
+
+		cb(&reassembly[i], user_data);
+	}
+}
@@ -0,0 +1,197 @@
+/** @file
+ * @brief IP fragment reassembly shared by IPv4 and IPv6
+ *
+ * The received fragments are kept as they are and, once all of them
+ * are present, their data buffers are chained after the first fragment
+ * so that the payload is never copied.
+ */
+
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __REASSEMBLY_H
+#define __REASSEMBLY_H
+
+#include <zephyr/types.h>
+#include <sys/util.h>
+
+#include <net/net_ip.h>
+#include <net/net_pkt.h>
+#include <net/net_if.h>
+
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+#define NET_REASSEMBLY_IPV4_COUNT CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT
+#define NET_REASSEMBLY_IPV4_MAX_PKT CONFIG_NET_IPV4_FRAGMENT_MAX_PKT
+#else
+#define NET_REASSEMBLY_IPV4_COUNT 0
+#define NET_REASSEMBLY_IPV4_MAX_PKT 0
+#endif
+
+/* We do not have to accept larger than 1500 byte IPv6 packet (RFC 2460 ch 5).
+ * This means that we should receive everything within first two fragments.
+ * The first one being 1280 bytes and the second one 220 bytes.
+ */
+#if !defined(NET_IPV6_FRAGMENTS_MAX_PKT)
+#define NET_IPV6_FRAGMENTS_MAX_PKT 2
+#endif
+
+#if defined(CONFIG_NET_IPV6_FRAGMENT)
+#define NET_REASSEMBLY_IPV6_COUNT CONFIG_NET_IPV6_FRAGMENT_MAX_COUNT
+#define NET_REASSEMBLY_IPV6_MAX_PKT NET_IPV6_FRAGMENTS_MAX_PKT
+#else
+#define NET_REASSEMBLY_IPV6_COUNT 0
+#define NET_REASSEMBLY_IPV6_MAX_PKT 0
+#endif
+
+/** Number of reassembly slots, each IP family has its own share of them */
+#define NET_REASSEMBLY_COUNT \
+	(NET_REASSEMBLY_IPV4_COUNT + NET_REASSEMBLY_IPV6_COUNT)
+
+/** Maximum number of fragments a reassembly slot can hold */
+#define NET_REASSEMBLY_MAX_PKT \
+	MAX(NET_REASSEMBLY_IPV4_MAX_PKT, NET_REASSEMBLY_IPV6_MAX_PKT)
+
+/** Store pending IP fragment information that is needed for reassembly. */
+struct net_reassembly {
+	/**
+	 * Source address of the fragments. The address family is
+	 * AF_UNSPEC when the slot is not in use.
+	 */
+	struct net_addr src;
+
+	/** Destination address of the fragments */
+	struct net_addr dst;
+
+	/** Timeout for cancelling the reassembly. */
+	struct k_delayed_work timer;
+
+	/** Network interface where the first fragment was received */
+	struct net_if *iface;
+
+	/** Pending fragments, sorted by fragment offset */
+	struct net_pkt *pkt[NET_REASSEMBLY_MAX_PKT];
+
+	/** Payload offset of each pending fragment */
+	uint16_t offset[NET_REASSEMBLY_MAX_PKT];
+
+	/** Payload length of each pending fragment */
+	uint16_t len[NET_REASSEMBLY_MAX_PKT];
+
+	/** Total payload length, valid only when last_seen is set */
+	uint16_t total_len;
+
+	/** Fragment identification */
+	uint32_t id;
+
+	/** Upper layer protocol, part of the IPv4 datagram key */
+	uint8_t proto;
+
+	/** Number of pending fragments */
+	uint8_t count;
+
+	/** How many fragments this reassembly can hold */
+	uint8_t max_pkt;
+
+	/** Has the fragment without the more fragments flag been received */
+	bool last_seen;
+};
+
+/**
+ * @typedef net_reassembly_cb_t
+ * @brief Callback used while iterating over pending reassemblies.
+ *
+ * @param reass Fragment reassembly struct
+ * @param user_data A valid pointer on some user data or NULL
+ */
+typedef void (*net_reassembly_cb_t)(struct net_reassembly *reass,
+				    void *user_data);
+
+/**
+ * @typedef net_reassembly_hdr_len_t
+ * @brief Callback returning how many bytes of IP headers there are in
+ * front of the fragment payload.
+ *
+ * @param pkt Network packet containing one fragment
+ *
+ * @return Length of the headers to remove from the fragment
+ */
+typedef uint16_t (*net_reassembly_hdr_len_t)(struct net_pkt *pkt);
+
+/**
+ * @brief Find the reassembly a fragment belongs to, or start a new one.
+ *
+ * @details A new reassembly is started only if the IP family of the
+ * addresses still has a free slot. The reassembly is cancelled if it is
+ * not completed within the configured timeout of the family.
+ *
+ * @param iface Network interface where the fragment was received
+ * @param src Source address of the fragment
+ * @param dst Destination address of the fragment
+ * @param id Fragment identification
+ * @param proto Upper layer protocol, or 0 if it is not part of the key
+ *
+ * @return Reassembly slot or NULL if none is available.
+ */
+struct net_reassembly *net_reassembly_get(struct net_if *iface,
+					  const struct net_addr *src,
+					  const struct net_addr *dst,
+					  uint32_t id, uint8_t proto);
+
+/**
+ * @brief Store a fragment in the reassembly.
+ *
+ * @details The reassembly takes the ownership of the packet only if
+ * the return value is 0 or 1.
+ *
+ * @param reass Fragment reassembly struct
+ * @param pkt Network packet containing the fragment
+ * @param offset Offset of the fragment payload in the original packet
+ * @param len Length of the fragment payload
+ * @param more Are there more fragments after this one
+ *
+ * @return 0 if more fragments are needed, 1 if the packet is complete,
+ * -EALREADY if the fragment was already received, -ENOMEM if there is
+ * no room for the fragment, -EINVAL if the fragment overlaps others
+ * or is otherwise inconsistent with them.
+ */
+int net_reassembly_add(struct net_reassembly *reass, struct net_pkt *pkt,
+		       uint16_t offset, uint16_t len, bool more);
+
+/**
+ * @brief Chain the payload of all fragments after the first one.
+ *
+ * @details Must be called only after net_reassembly_add() returned 1.
+ * The headers of the second and later fragments are removed and their
+ * data buffers are appended to the first fragment. The caller is
+ * responsible for fixing the IP header of the returned packet. The
+ * reassembly slot is released in every case.
+ *
+ * @param reass Fragment reassembly struct
+ * @param hdr_len Callback returning the header length of a fragment
+ *
+ * @return The reassembled packet or NULL on error.
+ */
+struct net_pkt *net_reassembly_finish(struct net_reassembly *reass,
+				      net_reassembly_hdr_len_t hdr_len);
+
+/**
+ * @brief Drop the pending fragments and release the reassembly slot.
+ *
+ * @param reass Fragment reassembly struct
+ */
+void net_reassembly_cancel(struct net_reassembly *reass);
+
+/**
+ * @brief Go through all the currently pending reassemblies of a family.
+ *
+ * @param family IP family, AF_INET or AF_INET6
+ * @param cb Callback to call for each pending reassembly.
+ * @param user_data User specified data or NULL.
+ */
+void net_reassembly_foreach(sa_family_t family, net_reassembly_cb_t cb,
+			    void *user_data);
+
+#endif /* __REASSEMBLY_H */
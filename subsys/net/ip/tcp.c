@@ -234,7 +234,7 @@ static void tcp_retry_expired(struct k_work *work)
 		pkt = CONTAINER_OF(sys_slist_peek_head(&tcp->sent_list),
 				   struct net_pkt, sent_list);
 
-		if (k_work_pending(net_pkt_work(pkt))) {
+		if (net_tc_tx_pending(pkt)) {
 			/* If the packet is still pending in TX queue, then do
 			 * not try to resend it again. This can happen if the
 			 * device is so busy that the TX thread has not yet
@@ -391,7 +391,7 @@ int net_tcp_release(struct net_tcp *tcp)
 			 * it go as it will be released by L2 after it is
 			 * sent.
 			 */
-			if (k_work_pending(net_pkt_work(pkt)) ||
+			if (net_tc_tx_pending(pkt) ||
 			    net_pkt_sent(pkt)) {
 				refcount--;
 			}
@@ -25,6 +25,12 @@ LOG_MODULE_REGISTER(net_tcp, CONFIG_NET_TCP_LOG_LEVEL);
 #define FIN_TIMEOUT_MS MSEC_PER_SEC
 #define FIN_TIMEOUT K_MSEC(FIN_TIMEOUT_MS)
 
+#if defined(CONFIG_NET_TCP_GSO)
+#define TCP_GSO_MAX_SIZE CONFIG_NET_TCP_GSO_MAX_SIZE
+#else
+#define TCP_GSO_MAX_SIZE 0
+#endif
+
 static int tcp_rto = CONFIG_NET_TCP_INIT_RETRANSMISSION_TIMEOUT;
 static int tcp_retries = CONFIG_NET_TCP_RETRY_COUNT;
 static int tcp_window = NET_IPV6_MTU;
@@ -703,6 +709,8 @@ static int tcp_out_ext(struct tcp *conn, uint8_t flags, struct net_pkt *data,
 		/* Append the data buffer to the pkt */
 		net_pkt_append_buffer(pkt, data->buffer);
 		data->buffer = NULL;
+
+		net_pkt_set_tcp_gso_size(pkt, net_pkt_tcp_gso_size(data));
 	}
 
 	ret = ip_header_add(conn, pkt);
@@ -803,8 +811,24 @@ static int tcp_unsent_len(struct tcp *conn)
 	return unsent_len;
 }
 
+/* Segment size of a TCP segmentation offload packet, or 0 if the data
+ * must be sent in MSS sized packets.
+ */
+static uint16_t tcp_gso_size(struct tcp *conn)
+{
+#if defined(CONFIG_NET_TCP_GSO)
+	/* The Ethernet L2 splits the packet, or lets the driver do it */
+	if (!tcp_send_cb && conn->iface &&
+	    net_if_l2(conn->iface) == &NET_L2_GET_NAME(ETHERNET)) {
+		return conn_mss(conn);
+	}
+#endif
+	return 0;
+}
+
 static int tcp_send_data(struct tcp *conn)
 {
+	uint16_t gso_size = tcp_gso_size(conn);
 	int ret = 0;
 	int pos, len;
 	struct net_pkt *pkt;
@@ -812,7 +836,7 @@ static int tcp_send_data(struct tcp *conn)
 	pos = conn->unacked_len;
 	len = MIN3(conn->send_data_total - conn->unacked_len,
 		   conn->send_win - conn->unacked_len,
-		   conn_mss(conn));
+		   gso_size ? TCP_GSO_MAX_SIZE : conn_mss(conn));
 
 	pkt = tcp_pkt_alloc(conn, len);
 	if (!pkt) {
@@ -828,6 +852,10 @@ static int tcp_send_data(struct tcp *conn)
 		goto out;
 	}
 
+	if (gso_size && len > gso_size) {
+		net_pkt_set_tcp_gso_size(pkt, gso_size);
+	}
+
 	ret = tcp_out_ext(conn, PSH | ACK, pkt, conn->seq + conn->unacked_len);
 	if (ret == 0) {
 		conn->unacked_len += len;
@@ -1894,8 +1922,10 @@ struct net_tcp_hdr *net_tcp_input(struct net_pkt *pkt,
 {
 	struct net_tcp_hdr *tcp_hdr;
 
+	/* Coalesced segments have been verified one by one already */
 	if (IS_ENABLED(CONFIG_NET_TCP_CHECKSUM) &&
 			net_if_need_calc_rx_checksum(net_pkt_iface(pkt)) &&
+			!net_pkt_is_tcp_chksum_ok(pkt) &&
 			net_calc_chksum_tcp(pkt) != 0U) {
 		NET_DBG("DROP: checksum mismatch");
 		goto drop;
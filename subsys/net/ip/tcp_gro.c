@@ -0,0 +1,347 @@
+/** @file
+ * @brief Software TCP receive coalescing
+ *
+ * Consecutive in-order data segments of a TCP connection that are waiting
+ * in the same RX queue are merged into one packet before TCP input. The
+ * data buffers of the later segments are chained after the first segment
+ * so the payload is not copied.
+ */
+
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_tcp_gro, CONFIG_NET_TCP_LOG_LEVEL);
+
+#include <errno.h>
+#include <string.h>
+#include <sys/byteorder.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_if.h>
+#include <net/ethernet.h>
+
+#include "net_private.h"
+#include "ipv4.h"
+#include "tcp_internal.h"
+
+struct gro_flow {
+	/** Coalesced packet, NULL if the entry is not in use */
+	struct net_pkt *pkt;
+
+	/** Last data buffer of the packet, new data is chained after it */
+	struct net_buf *last;
+
+	/** Sequence number the next segment must have */
+	uint32_t next_seq;
+
+	/** IP length of the coalesced packet */
+	uint16_t len;
+
+	/** TCP flags of all the coalesced segments */
+	uint8_t flags;
+
+	/** Number of coalesced segments */
+	uint8_t count;
+};
+
+struct gro_seg {
+	struct net_tcp_hdr *tcp;
+	uint16_t hdr_len;
+	uint16_t data_len;
+	uint32_t seq;
+};
+
+static struct gro_flow gro_flows[NET_TC_RX_COUNT][CONFIG_NET_TCP_GRO_MAX_FLOWS];
+
+/* Find the TCP header of a packet. All the headers must be in the
+ * first buffer, and IPv4 options and IPv6 extension headers are not
+ * supported, which is the case for most of the bulk data segments.
+ */
+static bool gro_parse(struct net_pkt *pkt, struct gro_seg *seg)
+{
+	struct net_buf *buf = pkt->buffer;
+	size_t len = net_pkt_get_len(pkt);
+	uint16_t ip_len;
+
+	if (!buf || buf->len < sizeof(struct net_ipv4_hdr)) {
+		return false;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && (buf->data[0] & 0xf0) == 0x40) {
+		struct net_ipv4_hdr *hdr = NET_IPV4_HDR(pkt);
+
+		if (hdr->vhl != 0x45 || hdr->proto != IPPROTO_TCP ||
+		    ntohs(hdr->len) != len ||
+		    (ntohs(UNALIGNED_GET((uint16_t *)hdr->offset)) &
+		     ~NET_IPV4_DO_NOT_FRAG_MASK)) {
+			return false;
+		}
+
+		ip_len = sizeof(struct net_ipv4_hdr);
+
+		net_pkt_set_family(pkt, AF_INET);
+		net_pkt_set_ipv4_opts_len(pkt, 0);
+	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
+		   (buf->data[0] & 0xf0) == 0x60 &&
+		   buf->len >= sizeof(struct net_ipv6_hdr)) {
+		struct net_ipv6_hdr *hdr = NET_IPV6_HDR(pkt);
+
+		if (hdr->nexthdr != IPPROTO_TCP ||
+		    ntohs(hdr->len) + sizeof(struct net_ipv6_hdr) != len) {
+			return false;
+		}
+
+		ip_len = sizeof(struct net_ipv6_hdr);
+
+		net_pkt_set_family(pkt, AF_INET6);
+		net_pkt_set_ipv6_ext_len(pkt, 0);
+	} else {
+		return false;
+	}
+
+	if (buf->len < ip_len + sizeof(struct net_tcp_hdr)) {
+		return false;
+	}
+
+	net_pkt_set_ip_hdr_len(pkt, ip_len);
+
+	seg->tcp = (struct net_tcp_hdr *)(buf->data + ip_len);
+	seg->hdr_len = ip_len + (seg->tcp->offset >> 4) * 4U;
+	seg->seq = sys_get_be32(seg->tcp->seq);
+	seg->data_len = len > seg->hdr_len ? len - seg->hdr_len : 0U;
+
+	return true;
+}
+
+/* Only plain data segments are merged */
+static bool gro_can_merge(struct gro_seg *seg)
+{
+	return seg->data_len > 0U && (seg->tcp->offset >> 4) == 5U &&
+		(seg->tcp->flags & ~NET_TCP_PSH) == NET_TCP_ACK;
+}
+
+static struct net_tcp_hdr *gro_tcp_hdr(struct net_pkt *pkt)
+{
+	return (struct net_tcp_hdr *)(pkt->buffer->data +
+				      net_pkt_ip_hdr_len(pkt));
+}
+
+static bool gro_same_flow(struct net_pkt *held, struct net_pkt *pkt,
+			  struct gro_seg *seg)
+{
+	struct net_tcp_hdr *tcp = gro_tcp_hdr(held);
+
+	if (net_pkt_iface(held) != net_pkt_iface(pkt) ||
+	    net_pkt_family(held) != net_pkt_family(pkt) ||
+	    tcp->src_port != seg->tcp->src_port ||
+	    tcp->dst_port != seg->tcp->dst_port) {
+		return false;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
+		return net_ipv4_addr_cmp(&NET_IPV4_HDR(held)->src,
+					 &NET_IPV4_HDR(pkt)->src) &&
+			net_ipv4_addr_cmp(&NET_IPV4_HDR(held)->dst,
+					  &NET_IPV4_HDR(pkt)->dst);
+	}
+
+	return net_ipv6_addr_cmp(&NET_IPV6_HDR(held)->src,
+				 &NET_IPV6_HDR(pkt)->src) &&
+		net_ipv6_addr_cmp(&NET_IPV6_HDR(held)->dst,
+				  &NET_IPV6_HDR(pkt)->dst);
+}
+
+static bool gro_can_append(struct gro_flow *flow, struct gro_seg *seg)
+{
+	struct net_tcp_hdr *tcp = gro_tcp_hdr(flow->pkt);
+
+	return seg->seq == flow->next_seq &&
+		!memcmp(tcp->ack, seg->tcp->ack, sizeof(tcp->ack)) &&
+		!memcmp(tcp->wnd, seg->tcp->wnd, sizeof(tcp->wnd)) &&
+		flow->len + seg->data_len <= CONFIG_NET_TCP_GRO_MAX_SIZE &&
+		flow->count < UINT8_MAX;
+}
+
+/* The checksums of the segments are verified here as they cannot be
+ * verified anymore after the segments have been merged.
+ */
+static bool gro_chksum_ok(struct net_pkt *pkt)
+{
+	if (!net_if_need_calc_rx_checksum(net_pkt_iface(pkt))) {
+		return true;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET &&
+	    net_calc_chksum_ipv4(pkt) != 0U) {
+		return false;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_TCP_CHECKSUM) &&
+	    net_calc_chksum_tcp(pkt) != 0U) {
+		return false;
+	}
+
+	return true;
+}
+
+static void gro_hold(struct gro_flow *flow, struct net_pkt *pkt,
+		     struct gro_seg *seg)
+{
+	flow->pkt = pkt;
+	flow->last = net_buf_frag_last(pkt->buffer);
+	flow->next_seq = seg->seq + seg->data_len;
+	flow->len = net_pkt_get_len(pkt);
+	flow->flags = seg->tcp->flags;
+	flow->count = 1U;
+}
+
+static void gro_append(struct gro_flow *flow, struct net_pkt *pkt,
+		       struct gro_seg *seg)
+{
+	struct net_buf *buf = pkt->buffer;
+
+	flow->flags |= seg->tcp->flags;
+	flow->next_seq += seg->data_len;
+	flow->len += seg->data_len;
+	flow->count++;
+
+	/* Get rid of the headers, and of the first buffer if there is
+	 * no data left in it.
+	 */
+	net_buf_pull(buf, seg->hdr_len);
+
+	if (!buf->len) {
+		pkt->buffer = buf->frags;
+		buf->frags = NULL;
+		net_pkt_frag_unref(buf);
+	}
+
+	flow->last->frags = pkt->buffer;
+	flow->last = net_buf_frag_last(pkt->buffer);
+
+	pkt->buffer = NULL;
+	net_pkt_unref(pkt);
+}
+
+static void gro_flush_flow(struct gro_flow *flow,
+			   net_tcp_gro_deliver_t deliver)
+{
+	struct net_pkt *pkt = flow->pkt;
+
+	flow->pkt = NULL;
+
+	if (flow->count > 1U) {
+		gro_tcp_hdr(pkt)->flags |= flow->flags & NET_TCP_PSH;
+
+		if (IS_ENABLED(CONFIG_NET_IPV4) &&
+		    net_pkt_family(pkt) == AF_INET) {
+			struct net_ipv4_hdr *hdr = NET_IPV4_HDR(pkt);
+
+			hdr->len = htons(flow->len);
+			hdr->chksum = 0U;
+			hdr->chksum = net_calc_chksum_ipv4(pkt);
+		} else {
+			NET_IPV6_HDR(pkt)->len =
+				htons(flow->len - sizeof(struct net_ipv6_hdr));
+		}
+
+		NET_DBG("pkt %p has %u segments, len %u", pkt, flow->count,
+			flow->len);
+	}
+
+	net_pkt_set_tcp_chksum_ok(pkt, true);
+
+	deliver(pkt);
+}
+
+enum net_verdict net_tcp_gro_receive(struct net_pkt *pkt, uint8_t tc,
+				     net_tcp_gro_deliver_t deliver)
+{
+	struct gro_flow *flow = NULL, *avail = NULL;
+	struct gro_seg seg;
+	bool merge;
+	int i;
+
+	if (tc >= NET_TC_RX_COUNT) {
+		return NET_CONTINUE;
+	}
+
+#if defined(CONFIG_NET_L2_ETHERNET)
+	/* The driver has coalesced the segments already */
+	if (net_if_l2(net_pkt_iface(pkt)) == &NET_L2_GET_NAME(ETHERNET) &&
+	    (net_eth_get_hw_capabilities(net_pkt_iface(pkt)) &
+	     ETHERNET_HW_LRO)) {
+		return NET_CONTINUE;
+	}
+#endif
+
+	if (!gro_parse(pkt, &seg)) {
+		return NET_CONTINUE;
+	}
+
+	for (i = 0; i < CONFIG_NET_TCP_GRO_MAX_FLOWS; i++) {
+		if (!gro_flows[tc][i].pkt) {
+			if (!avail) {
+				avail = &gro_flows[tc][i];
+			}
+
+			continue;
+		}
+
+		if (gro_same_flow(gro_flows[tc][i].pkt, pkt, &seg)) {
+			flow = &gro_flows[tc][i];
+			break;
+		}
+	}
+
+	merge = gro_can_merge(&seg);
+
+	if (flow && merge && gro_can_append(flow, &seg) &&
+	    gro_chksum_ok(pkt)) {
+		gro_append(flow, pkt, &seg);
+
+		/* Pushed data is passed to the application without delay */
+		if ((flow->flags & NET_TCP_PSH) ||
+		    flow->len + seg.data_len > CONFIG_NET_TCP_GRO_MAX_SIZE) {
+			gro_flush_flow(flow, deliver);
+		}
+
+		return NET_OK;
+	}
+
+	if (flow) {
+		/* The pending segments must be processed before this one
+		 * so that TCP sees them in the same order as they arrived.
+		 */
+		gro_flush_flow(flow, deliver);
+		avail = flow;
+	}
+
+	if (!merge || !avail || (seg.tcp->flags & NET_TCP_PSH) ||
+	    !gro_chksum_ok(pkt)) {
+		return NET_CONTINUE;
+	}
+
+	gro_hold(avail, pkt, &seg);
+
+	return NET_OK;
+}
+
+void net_tcp_gro_flush(uint8_t tc, net_tcp_gro_deliver_t deliver)
+{
+	int i;
+
+	if (tc >= NET_TC_RX_COUNT) {
+		return;
+	}
+
+	for (i = 0; i < CONFIG_NET_TCP_GRO_MAX_FLOWS; i++) {
+		if (gro_flows[tc][i].pkt) {
+			gro_flush_flow(&gro_flows[tc][i], deliver);
+		}
+	}
+}
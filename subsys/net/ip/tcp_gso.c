@@ -0,0 +1,330 @@
+/** @file
+ * @brief Software TCP segmentation offload
+ *
+ * TCP builds one packet for several MSS sized segments. The packet is
+ * split here, as late as possible, by copying the headers to each
+ * segment and updating only the fields that differ. The payload buffers
+ * are chained to the segments, not copied into them.
+ */
+
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_tcp_gso, CONFIG_NET_TCP_LOG_LEVEL);
+
+#include <errno.h>
+#include <string.h>
+#include <sys/byteorder.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_if.h>
+
+#include "net_private.h"
+#include "tcp_internal.h"
+
+#define SEG_ALLOC_TIMEOUT K_MSEC(100)
+
+/* Update a checksum when one 16-bit word covered by it changes,
+ * see RFC 1624 eqn. 3. All the values are in network byte order.
+ */
+static uint16_t chksum_update(uint16_t chksum, uint16_t old, uint16_t new)
+{
+	uint32_t sum;
+
+	sum = (uint16_t)~chksum + (uint16_t)~old + new;
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+
+	return ~sum;
+}
+
+static uint16_t ip_hdr_len(struct net_pkt *pkt)
+{
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
+		return net_pkt_ip_hdr_len(pkt) + net_pkt_ipv4_opts_len(pkt);
+	}
+
+	return net_pkt_ip_hdr_len(pkt) + net_pkt_ipv6_ext_len(pkt);
+}
+
+static int update_ip_hdr(struct net_pkt *seg, uint16_t len, uint16_t id_inc)
+{
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(seg) == AF_INET) {
+		NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access,
+						      struct net_ipv4_hdr);
+		struct net_ipv4_hdr *hdr;
+		uint16_t old_id, new_id;
+		uint16_t new_len;
+
+		hdr = (struct net_ipv4_hdr *)net_pkt_get_data(seg,
+							      &ipv4_access);
+		if (!hdr) {
+			return -ENOBUFS;
+		}
+
+		new_len = htons(len);
+		old_id = UNALIGNED_GET((uint16_t *)hdr->id);
+		new_id = htons(ntohs(old_id) + id_inc);
+
+		/* Only the length and the identification change, so there
+		 * is no need to go through the whole header again.
+		 */
+		if (net_if_need_calc_tx_checksum(net_pkt_iface(seg))) {
+			hdr->chksum = chksum_update(hdr->chksum, hdr->len,
+						    new_len);
+			hdr->chksum = chksum_update(hdr->chksum, old_id,
+						    new_id);
+		}
+
+		hdr->len = new_len;
+		UNALIGNED_PUT(new_id, (uint16_t *)hdr->id);
+
+		return net_pkt_set_data(seg, &ipv4_access);
+	}
+
+	if (IS_ENABLED(CONFIG_NET_IPV6) && net_pkt_family(seg) == AF_INET6) {
+		NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv6_access,
+						      struct net_ipv6_hdr);
+		struct net_ipv6_hdr *hdr;
+
+		hdr = (struct net_ipv6_hdr *)net_pkt_get_data(seg,
+							      &ipv6_access);
+		if (!hdr) {
+			return -ENOBUFS;
+		}
+
+		hdr->len = htons(len - sizeof(struct net_ipv6_hdr));
+
+		return net_pkt_set_data(seg, &ipv6_access);
+	}
+
+	return -EINVAL;
+}
+
+static int update_tcp_hdr(struct net_pkt *seg, uint32_t seq, uint8_t flags)
+{
+	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct net_tcp_hdr);
+	struct net_pkt_cursor backup;
+	struct net_tcp_hdr *tcp_hdr;
+	int ret;
+
+	net_pkt_cursor_backup(seg, &backup);
+
+	tcp_hdr = (struct net_tcp_hdr *)net_pkt_get_data(seg, &tcp_access);
+	if (!tcp_hdr) {
+		return -ENOBUFS;
+	}
+
+	sys_put_be32(seq, tcp_hdr->seq);
+	tcp_hdr->flags = flags;
+
+	ret = net_pkt_set_data(seg, &tcp_access);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* The payload is different in every segment so the TCP checksum
+	 * is calculated from scratch.
+	 */
+	net_pkt_cursor_restore(seg, &backup);
+
+	return net_tcp_finalize(seg);
+}
+
+/* Chain the len bytes of payload at the cursor to the segment, and move
+ * the cursor after them. The buffers of the original packet are cloned,
+ * which shares their data when their pool supports data references
+ * (e.g. CONFIG_NET_BUF_VARIABLE_DATA_SIZE) and copies it otherwise.
+ */
+static int append_payload(struct net_pkt *seg, struct net_pkt_cursor *payload,
+			  uint16_t len)
+{
+	struct net_buf *buf = payload->buf;
+	size_t skip = payload->pos - buf->data;
+
+	while (len) {
+		struct net_buf *frag;
+		size_t take;
+
+		if (!buf) {
+			return -ENOBUFS;
+		}
+
+		if (skip >= buf->len) {
+			buf = buf->frags;
+			skip = 0;
+			continue;
+		}
+
+		take = MIN(buf->len - skip, len);
+
+		frag = net_buf_clone(buf, SEG_ALLOC_TIMEOUT);
+		if (!frag) {
+			return -ENOBUFS;
+		}
+
+		net_buf_pull(frag, skip);
+		frag->len = take;
+
+		net_pkt_append_buffer(seg, frag);
+
+		len -= take;
+		skip += take;
+	}
+
+	payload->buf = buf;
+	payload->pos = buf->data + skip;
+
+	return 0;
+}
+
+static struct net_pkt *build_segment(struct net_pkt *pkt,
+				     struct net_pkt_cursor *payload,
+				     uint16_t hdr_len, uint16_t len)
+{
+	struct net_pkt *seg;
+
+	seg = net_pkt_alloc_with_buffer(net_pkt_iface(pkt), hdr_len,
+					AF_UNSPEC, 0, SEG_ALLOC_TIMEOUT);
+	if (!seg) {
+		return NULL;
+	}
+
+	net_pkt_set_family(seg, net_pkt_family(pkt));
+	net_pkt_set_ip_hdr_len(seg, net_pkt_ip_hdr_len(pkt));
+	net_pkt_set_priority(seg, net_pkt_priority(pkt));
+	net_pkt_set_vlan_tci(seg, net_pkt_vlan_tci(pkt));
+
+	/* The link layer addresses point to the interface and to the
+	 * neighbor cache, not to the packet data, so they can be shared.
+	 */
+	memcpy(net_pkt_lladdr_src(seg), net_pkt_lladdr_src(pkt),
+	       sizeof(struct net_linkaddr));
+	memcpy(net_pkt_lladdr_dst(seg), net_pkt_lladdr_dst(pkt),
+	       sizeof(struct net_linkaddr));
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
+		net_pkt_set_ipv4_ttl(seg, net_pkt_ipv4_ttl(pkt));
+		net_pkt_set_ipv4_opts_len(seg, net_pkt_ipv4_opts_len(pkt));
+	} else {
+		net_pkt_set_ipv6_hop_limit(seg, net_pkt_ipv6_hop_limit(pkt));
+		net_pkt_set_ipv6_ext_len(seg, net_pkt_ipv6_ext_len(pkt));
+	}
+
+	/* Headers are copied from the beginning of the original packet, as
+	 * they are updated in every segment. The payload is chained from
+	 * where the previous segment ended.
+	 */
+	net_pkt_cursor_init(pkt);
+
+	if (net_pkt_copy(seg, pkt, hdr_len)) {
+		goto fail;
+	}
+
+	if (append_payload(seg, payload, len)) {
+		goto fail;
+	}
+
+	return seg;
+
+fail:
+	net_pkt_unref(seg);
+
+	return NULL;
+}
+
+int net_tcp_gso_segment(struct net_pkt *pkt, net_tcp_gso_cb_t cb,
+			void *user_data)
+{
+	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct net_tcp_hdr);
+	uint16_t mss = net_pkt_tcp_gso_size(pkt);
+	struct net_pkt_cursor payload;
+	struct net_tcp_hdr *tcp_hdr;
+	uint16_t ip_len, hdr_len;
+	size_t len, offset;
+	uint16_t count = 0U;
+	uint8_t flags;
+	uint32_t seq;
+	int ret;
+
+	if (!mss) {
+		return -EINVAL;
+	}
+
+	ip_len = ip_hdr_len(pkt);
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	if (net_pkt_skip(pkt, ip_len)) {
+		return -EINVAL;
+	}
+
+	tcp_hdr = (struct net_tcp_hdr *)net_pkt_get_data(pkt, &tcp_access);
+	if (!tcp_hdr) {
+		return -ENOBUFS;
+	}
+
+	hdr_len = ip_len + (tcp_hdr->offset >> 4) * 4U;
+	seq = sys_get_be32(tcp_hdr->seq);
+	flags = tcp_hdr->flags;
+
+	len = net_pkt_get_len(pkt);
+	if (len <= hdr_len) {
+		return -EINVAL;
+	}
+
+	len -= hdr_len;
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_skip(pkt, hdr_len);
+	net_pkt_cursor_backup(pkt, &payload);
+
+	NET_DBG("pkt %p %zd bytes to %u byte segments", pkt, len, mss);
+
+	for (offset = 0; offset < len; offset += mss, count++) {
+		uint16_t seg_len = MIN(len - offset, mss);
+		bool last = offset + seg_len == len;
+		struct net_pkt *seg;
+
+		seg = build_segment(pkt, &payload, hdr_len, seg_len);
+		if (!seg) {
+			NET_DBG("Cannot allocate segment %u", count);
+			return -ENOMEM;
+		}
+
+		net_pkt_cursor_init(seg);
+		net_pkt_set_overwrite(seg, true);
+
+		ret = update_ip_hdr(seg, hdr_len + seg_len, count);
+		if (!ret) {
+			/* Skip the IP options or extension headers */
+			ret = net_pkt_skip(seg, ip_len - net_pkt_ip_hdr_len(seg));
+		}
+
+		/* FIN and PSH belong to the last segment only */
+		if (!ret) {
+			ret = update_tcp_hdr(seg, seq + offset,
+					     last ? flags :
+					     flags & ~(NET_TCP_FIN | NET_TCP_PSH));
+		}
+
+		if (ret < 0) {
+			net_pkt_unref(seg);
+			return ret;
+		}
+
+		net_pkt_cursor_init(seg);
+
+		ret = cb(seg, user_data);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return 0;
+}
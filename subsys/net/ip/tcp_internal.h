@@ -792,6 +792,102 @@ void net_tcp_init(void);
 #define net_tcp_init(...)
 #endif
 
+/**
+ * @typedef net_tcp_gso_cb_t
+ * @brief Callback used to send the segments of a TCP segmentation offload
+ * packet.
+ *
+ * @param seg Network packet containing one segment. The callback takes the
+ * ownership of the segment also when it returns an error.
+ * @param user_data User data given to net_tcp_gso_segment()
+ *
+ * @return 0 if ok, < 0 on error
+ */
+typedef int (*net_tcp_gso_cb_t)(struct net_pkt *seg, void *user_data);
+
+/**
+ * @brief Split a TCP segmentation offload packet into segments
+ *
+ * @details The IP and TCP headers of the packet are copied to each
+ * segment and only the fields that differ between the segments are
+ * updated. The payload buffers of the packet are cloned into the
+ * segments, which shares their data if their pool supports data
+ * references. The original packet is not modified and it is still owned
+ * by the caller when this function returns.
+ *
+ * @param pkt IP packet with a non-zero net_pkt_tcp_gso_size()
+ * @param cb Callback that is called for each segment in order
+ * @param user_data User data passed to the callback
+ *
+ * @return 0 if all the segments were passed to the callback, < 0 on error
+ */
+#if defined(CONFIG_NET_TCP_GSO)
+int net_tcp_gso_segment(struct net_pkt *pkt, net_tcp_gso_cb_t cb,
+			void *user_data);
+#else
+static inline int net_tcp_gso_segment(struct net_pkt *pkt,
+				      net_tcp_gso_cb_t cb, void *user_data)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(cb);
+	ARG_UNUSED(user_data);
+
+	return -ENOTSUP;
+}
+#endif
+
+/**
+ * @typedef net_tcp_gro_deliver_t
+ * @brief Callback used to pass a coalesced packet to IP input.
+ *
+ * @param pkt Network packet, the callback takes the ownership of it
+ */
+typedef void (*net_tcp_gro_deliver_t)(struct net_pkt *pkt);
+
+/**
+ * @brief Try to coalesce a received packet with earlier TCP segments
+ *
+ * @details Called for every IP packet after L2 processing. If the packet
+ * is an in-order data segment of a connection that has a pending
+ * coalesced packet, its payload is appended to that packet. Pending
+ * packets that the new packet cannot be merged with are delivered first
+ * so the order of the segments of a connection is kept.
+ *
+ * @param pkt Received IP packet
+ * @param tc RX traffic class (queue) the packet is processed in
+ * @param deliver Callback for delivering pending packets
+ *
+ * @return NET_OK if the packet was taken, NET_CONTINUE if the caller
+ * must process it as usual.
+ */
+#if defined(CONFIG_NET_TCP_GRO)
+enum net_verdict net_tcp_gro_receive(struct net_pkt *pkt, uint8_t tc,
+				     net_tcp_gro_deliver_t deliver);
+#else
+static inline enum net_verdict net_tcp_gro_receive(struct net_pkt *pkt,
+						   uint8_t tc,
+						   net_tcp_gro_deliver_t deliver)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(tc);
+	ARG_UNUSED(deliver);
+
+	return NET_CONTINUE;
+}
+#endif
+
+/**
+ * @brief Deliver all the pending coalesced packets of an RX queue
+ *
+ * @param tc RX traffic class (queue)
+ * @param deliver Callback for delivering the packets
+ */
+#if defined(CONFIG_NET_TCP_GRO)
+void net_tcp_gro_flush(uint8_t tc, net_tcp_gro_deliver_t deliver);
+#else
+#define net_tcp_gro_flush(...)
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -28,9 +28,14 @@ LOG_MODULE_REGISTER(net_ethernet, CONFIG_NET_L2_ETHERNET_LOG_LEVEL);
 #include "arp.h"
 #include "eth_stats.h"
 #include "net_private.h"
+#include "net_stats.h"
 #include "ipv6.h"
 #include "ipv4_autoconf_internal.h"
 
+#if defined(CONFIG_NET_TCP_GSO)
+#include "tcp_internal.h"
+#endif
+
 #define NET_BUF_TIMEOUT K_MSEC(100)
 
 static const struct net_eth_addr multicast_eth_addr __unused = {
@@ -566,6 +571,149 @@ static void ethernet_remove_l2_header(struct net_pkt *pkt)
 	net_pkt_frag_unref(buf);
 }
 
+#if defined(CONFIG_NET_ETHERNET_TX_BATCH)
+void net_eth_tx_flush(struct net_if *iface)
+{
+	const struct device *dev = net_if_get_device(iface);
+	const struct ethernet_api *api = dev->api;
+	struct ethernet_context *ctx = net_if_l2_data(iface);
+	struct net_pkt *pkts[CONFIG_NET_ETHERNET_TX_BATCH_SIZE];
+	k_spinlock_key_t key;
+	int count, sent, i;
+
+	if (!api || !api->send_batch) {
+		return;
+	}
+
+	key = k_spin_lock(&ctx->tx_batch.lock);
+	count = ctx->tx_batch.count;
+	memcpy(pkts, ctx->tx_batch.pkts, count * sizeof(pkts[0]));
+	ctx->tx_batch.count = 0U;
+	k_spin_unlock(&ctx->tx_batch.lock, key);
+
+	if (!count) {
+		return;
+	}
+
+	sent = api->send_batch(dev, pkts, count);
+	if (sent < count) {
+		NET_DBG("iface %p sent %d of %d batched pkts", iface,
+			MAX(sent, 0), count);
+	}
+
+	/* ethernet_send() returned 0 for these, so the byte count and the
+	 * errors are accounted here.
+	 */
+	for (i = 0; i < count; i++) {
+		if (i < sent) {
+			ethernet_update_tx_stats(iface, pkts[i]);
+			net_stats_update_bytes_sent(iface,
+						    net_pkt_get_len(pkts[i]));
+		} else {
+			eth_stats_update_errors_tx(iface);
+		}
+
+		ethernet_remove_l2_header(pkts[i]);
+		net_pkt_unref(pkts[i]);
+	}
+}
+
+static bool tx_batch_has(struct ethernet_context *ctx, struct net_pkt *pkt)
+{
+	k_spinlock_key_t key = k_spin_lock(&ctx->tx_batch.lock);
+	bool found = false;
+	int i;
+
+	for (i = 0; i < ctx->tx_batch.count; i++) {
+		if (ctx->tx_batch.pkts[i] == pkt) {
+			found = true;
+			break;
+		}
+	}
+
+	k_spin_unlock(&ctx->tx_batch.lock, key);
+
+	return found;
+}
+
+/* Returns true if the batch is full and must be flushed */
+static bool tx_batch_add(struct ethernet_context *ctx, struct net_pkt *pkt)
+{
+	k_spinlock_key_t key = k_spin_lock(&ctx->tx_batch.lock);
+	bool full;
+
+	ctx->tx_batch.pkts[ctx->tx_batch.count++] = pkt;
+	full = ctx->tx_batch.count == ARRAY_SIZE(ctx->tx_batch.pkts);
+
+	k_spin_unlock(&ctx->tx_batch.lock, key);
+
+	return full;
+}
+#endif /* CONFIG_NET_ETHERNET_TX_BATCH */
+
+static int ethernet_send(struct net_if *iface, struct net_pkt *pkt);
+
+#if defined(CONFIG_NET_TCP_GSO)
+struct gso_send_ctx {
+	struct net_if *iface;
+
+	/* Bytes returned by ethernet_send() for the segments */
+	int sent;
+
+	/* Number of segments handed to ethernet_send() */
+	int count;
+};
+
+static int gso_send_segment(struct net_pkt *seg, void *user_data)
+{
+	struct gso_send_ctx *gso = user_data;
+	int ret;
+
+	ret = ethernet_send(gso->iface, seg);
+	if (ret < 0) {
+		net_pkt_unref(seg);
+		return ret;
+	}
+
+	/* 0 for a batched segment, it is counted when flushed */
+	gso->sent += ret;
+	gso->count++;
+
+	return 0;
+}
+
+static int gso_send(struct net_if *iface, struct net_pkt *pkt)
+{
+	struct gso_send_ctx gso = {
+		.iface = iface,
+	};
+	int ret;
+
+	/* Each segment goes through the normal path below so they get
+	 * their own link layer header, and are batched if the driver
+	 * supports it.
+	 */
+	ret = net_tcp_gso_segment(pkt, gso_send_segment, &gso);
+	if (ret < 0) {
+		NET_DBG("pkt %p GSO stopped after %d segments (%d)", pkt,
+			gso.count, ret);
+
+		/* Nothing went out, the caller drops the packet */
+		if (!gso.count) {
+			return ret;
+		}
+
+		/* Segments already sent cannot be taken back: report them,
+		 * TCP retransmits the rest.
+		 */
+	}
+
+	net_pkt_unref(pkt);
+
+	return gso.sent;
+}
+#endif /* CONFIG_NET_TCP_GSO */
+
 static int ethernet_send(struct net_if *iface, struct net_pkt *pkt)
 {
 	const struct ethernet_api *api = net_if_get_device(iface)->api;
@@ -578,6 +726,22 @@ static int ethernet_send(struct net_if *iface, struct net_pkt *pkt)
 		goto error;
 	}
 
+#if defined(CONFIG_NET_TCP_GSO)
+	if (net_pkt_tcp_gso_size(pkt) &&
+	    !(net_eth_get_hw_capabilities(iface) & ETHERNET_HW_TSO)) {
+		return gso_send(iface, pkt);
+	}
+#endif
+
+#if defined(CONFIG_NET_ETHERNET_TX_BATCH)
+	/* A resent packet (TCP) must not get a second L2 header while the
+	 * first one is still waiting to be sent.
+	 */
+	if (api->send_batch && tx_batch_has(ctx, pkt)) {
+		net_eth_tx_flush(iface);
+	}
+#endif
+
 	if (IS_ENABLED(CONFIG_NET_IPV4) &&
 	    net_pkt_family(pkt) == AF_INET) {
 		struct net_pkt *tmp;
@@ -670,6 +834,19 @@ static int ethernet_send(struct net_if *iface, struct net_pkt *pkt)
 	net_pkt_cursor_init(pkt);
 
 send:
+#if defined(CONFIG_NET_ETHERNET_TX_BATCH)
+	if (api->send_batch) {
+		/* The batch keeps our reference until it is flushed. Nothing
+		 * has been sent yet, net_eth_tx_flush() accounts for the frame.
+		 */
+		if (tx_batch_add(ctx, pkt)) {
+			net_eth_tx_flush(iface);
+		}
+
+		return 0;
+	}
+#endif
+
 	ret = api->send(net_if_get_device(iface), pkt);
 	if (ret != 0) {
 		eth_stats_update_errors_tx(iface);
@@ -1039,6 +1216,72 @@ static void handle_carrier(struct ethernet_context *ctx,
 	k_work_submit(&ctx->carrier_mgmt.work);
 }
 
+#if defined(CONFIG_NET_ETHERNET_RX_POLL)
+static K_KERNEL_STACK_DEFINE(rx_poll_stack,
+			     CONFIG_NET_ETHERNET_RX_POLL_STACK_SIZE);
+static struct k_work_q rx_poll_q;
+
+static void rx_poll_handler(struct k_work *work)
+{
+	struct ethernet_context *ctx = CONTAINER_OF(work,
+						    struct ethernet_context,
+						    rx_poll.work);
+	struct net_if *iface = ctx->rx_poll.iface;
+	const struct device *dev = net_if_get_device(iface);
+	const struct ethernet_api *api = dev->api;
+	struct net_pkt *pkts[CONFIG_NET_ETHERNET_RX_POLL_BUDGET];
+	int count, i;
+
+	count = api->rx_poll(dev, pkts, ARRAY_SIZE(pkts));
+
+	for (i = 0; i < count; i++) {
+		struct net_if *pkt_iface = net_pkt_iface(pkts[i]);
+
+		if (net_recv_data(pkt_iface ? pkt_iface : iface,
+				  pkts[i]) < 0) {
+			net_pkt_unref(pkts[i]);
+		}
+	}
+
+	/* Budget exhausted, more frames are likely pending. Requeue so
+	 * that other devices sharing the queue get their turn.
+	 */
+	if (count == ARRAY_SIZE(pkts)) {
+		k_work_submit_to_queue(&rx_poll_q, work);
+	}
+}
+
+void net_eth_rx_poll_schedule(struct net_if *iface)
+{
+	struct ethernet_context *ctx = net_if_l2_data(iface);
+
+	k_work_submit_to_queue(&rx_poll_q, &ctx->rx_poll.work);
+}
+
+static void rx_poll_init(struct ethernet_context *ctx, struct net_if *iface)
+{
+	static bool started;
+	const struct ethernet_api *api = net_if_get_device(iface)->api;
+
+	if (!api->rx_poll || ctx->rx_poll.iface) {
+		return;
+	}
+
+	if (!started) {
+		k_work_q_start(&rx_poll_q, rx_poll_stack,
+			       K_KERNEL_STACK_SIZEOF(rx_poll_stack),
+			       K_PRIO_COOP(CONFIG_NET_ETHERNET_RX_POLL_PRIO));
+		k_thread_name_set(&rx_poll_q.thread, "eth_rx_poll");
+		started = true;
+	}
+
+	k_work_init(&ctx->rx_poll.work, rx_poll_handler);
+	ctx->rx_poll.iface = iface;
+}
+#else
+#define rx_poll_init(...)
+#endif /* CONFIG_NET_ETHERNET_RX_POLL */
+
 void net_eth_carrier_on(struct net_if *iface)
 {
 	struct ethernet_context *ctx = net_if_l2_data(iface);
@@ -1154,6 +1397,8 @@ void ethernet_init(struct net_if *iface)
 		ctx->ethernet_l2_flags |= NET_L2_PROMISC_MODE;
 	}
 
+	rx_poll_init(ctx, iface);
+
 #if defined(CONFIG_NET_VLAN)
 	if (!(net_eth_get_hw_capabilities(iface) & ETHERNET_HW_VLAN)) {
 		return;
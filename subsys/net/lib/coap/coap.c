@@ -235,6 +235,121 @@ static int encode_option(struct coap_packet *cpkt, uint16_t code,
 	return  (1 + delta_size + len_size + len);
 }
 
+#if CONFIG_COAP_OPTION_INDEX_SIZE > 0
+/* 1 + opt_first slot of each option number of enum coap_option_num */
+static const uint8_t option_slot[COAP_OPTION_SIZE1 + 1] = {
+	[COAP_OPTION_IF_MATCH] = 1,
+	[COAP_OPTION_URI_HOST] = 2,
+	[COAP_OPTION_ETAG] = 3,
+	[COAP_OPTION_IF_NONE_MATCH] = 4,
+	[COAP_OPTION_OBSERVE] = 5,
+	[COAP_OPTION_URI_PORT] = 6,
+	[COAP_OPTION_LOCATION_PATH] = 7,
+	[COAP_OPTION_URI_PATH] = 8,
+	[COAP_OPTION_CONTENT_FORMAT] = 9,
+	[COAP_OPTION_MAX_AGE] = 10,
+	[COAP_OPTION_URI_QUERY] = 11,
+	[COAP_OPTION_ACCEPT] = 12,
+	[COAP_OPTION_LOCATION_QUERY] = 13,
+	[COAP_OPTION_BLOCK2] = 14,
+	[COAP_OPTION_BLOCK1] = 15,
+	[COAP_OPTION_SIZE2] = 16,
+	[COAP_OPTION_PROXY_URI] = 17,
+	[COAP_OPTION_PROXY_SCHEME] = 18,
+	[COAP_OPTION_SIZE1] = COAP_OPTION_NUM_COUNT,
+};
+
+static inline int option_slot_get(uint16_t num)
+{
+	return num < ARRAY_SIZE(option_slot) ? option_slot[num] - 1 : -1;
+}
+
+static void option_index_reset(struct coap_packet *cpkt)
+{
+	cpkt->opt_count = 0U;
+	cpkt->opt_indexed = false;
+	(void)memset(cpkt->opt_first, 0, sizeof(cpkt->opt_first));
+}
+
+static void option_index_add(struct coap_packet *cpkt,
+			     const struct coap_option_index *entry,
+			     bool *overflow)
+{
+	int slot;
+
+	if (cpkt->opt_count == ARRAY_SIZE(cpkt->opt_index)) {
+		*overflow = true;
+		return;
+	}
+
+	slot = option_slot_get(entry->num);
+	if (slot >= 0 && cpkt->opt_first[slot] == 0U) {
+		cpkt->opt_first[slot] = cpkt->opt_count + 1U;
+	}
+
+	cpkt->opt_index[cpkt->opt_count++] = *entry;
+}
+
+static void option_index_done(struct coap_packet *cpkt, bool overflow)
+{
+	cpkt->opt_indexed = !overflow;
+}
+
+/* Options are stored in ascending number order, find the first of code */
+static int option_index_find(const struct coap_packet *cpkt, uint16_t code,
+			     struct coap_option *options, uint16_t veclen)
+{
+	const struct coap_option_index *entry;
+	uint8_t lo = 0U, hi = cpkt->opt_count, mid;
+	uint16_t num = 0U;
+	int slot;
+
+	/* registered option numbers are looked up directly */
+	slot = option_slot_get(code);
+	if (slot >= 0) {
+		if (cpkt->opt_first[slot] == 0U) {
+			return 0;
+		}
+
+		lo = cpkt->opt_first[slot] - 1U;
+		hi = lo;
+	}
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2U;
+		if (cpkt->opt_index[mid].num < code) {
+			lo = mid + 1U;
+		} else {
+			hi = mid;
+		}
+	}
+
+	for (entry = &cpkt->opt_index[lo];
+	     entry < &cpkt->opt_index[cpkt->opt_count] &&
+	     entry->num == code && num < veclen; entry++, num++) {
+		if (entry->len > sizeof(options[num].value)) {
+			NET_ERR("%u is > sizeof(coap_option->value)(%zu)!",
+				entry->len, sizeof(options[num].value));
+			return -EINVAL;
+		}
+
+		options[num].delta = entry->num;
+		options[num].len = entry->len;
+		memcpy(options[num].value, cpkt->data + entry->offset,
+		       entry->len);
+	}
+
+	return num;
+}
+#else
+static inline void option_index_reset(struct coap_packet *cpkt) {}
+static inline void option_index_add(struct coap_packet *cpkt,
+				    const struct coap_option_index *entry,
+				    bool *overflow) {}
+static inline void option_index_done(struct coap_packet *cpkt,
+				     bool overflow) {}
+#endif /* CONFIG_COAP_OPTION_INDEX_SIZE > 0 */
+
 /* TODO Add support for inserting options in proper place
  * and modify other option's delta accordingly.
  */
@@ -266,6 +381,9 @@ int coap_packet_append_option(struct coap_packet *cpkt, uint16_t code,
 		return -EINVAL;
 	}
 
+	/* the index no longer covers every option */
+	option_index_reset(cpkt);
+
 	cpkt->opt_len += r;
 	cpkt->delta += code;
 
@@ -430,7 +548,8 @@ static int decode_delta(uint8_t *data, uint16_t offset, uint16_t *pos, uint16_t
 
 static int parse_option(uint8_t *data, uint16_t offset, uint16_t *pos,
 			uint16_t max_len, uint16_t *opt_delta, uint16_t *opt_len,
-			struct coap_option *option)
+			struct coap_option *option,
+			struct coap_option_index *index)
 {
 	uint16_t hdr_len;
 	uint16_t delta;
@@ -501,6 +620,12 @@ static int parse_option(uint8_t *data, uint16_t offset, uint16_t *pos,
 		return -EINVAL;
 	}
 
+	if (index) {
+		index->num = *opt_delta;
+		index->offset = *pos;
+		index->len = len;
+	}
+
 	if (option) {
 		/*
 		 * Make sure the option data will fit into the value field of
@@ -535,6 +660,8 @@ static int parse_option(uint8_t *data, uint16_t offset, uint16_t *pos,
 int coap_packet_parse(struct coap_packet *cpkt, uint8_t *data, uint16_t len,
 		      struct coap_option *options, uint8_t opt_num)
 {
+	struct coap_option_index entry;
+	bool overflow = false;
 	uint16_t opt_len;
 	uint16_t offset;
 	uint16_t delta;
@@ -560,6 +687,7 @@ int coap_packet_parse(struct coap_packet *cpkt, uint8_t *data, uint16_t len,
 	cpkt->opt_len = 0U;
 	cpkt->hdr_len = 0U;
 	cpkt->delta = 0U;
+	option_index_reset(cpkt);
 
 	/* Token lengths 9-15 are reserved. */
 	tkl = cpkt->data[0] & 0x0f;
@@ -574,6 +702,7 @@ int coap_packet_parse(struct coap_packet *cpkt, uint8_t *data, uint16_t len,
 
 	cpkt->offset = cpkt->hdr_len;
 	if (cpkt->hdr_len == len) {
+		option_index_done(cpkt, false);
 		return 0;
 	}
 
@@ -584,13 +713,20 @@ int coap_packet_parse(struct coap_packet *cpkt, uint8_t *data, uint16_t len,
 
 	while (1) {
 		struct coap_option *option;
+		bool marker = cpkt->data[offset] == COAP_MARKER;
 
 		option = num < opt_num ? &options[num++] : NULL;
 		ret = parse_option(cpkt->data, offset, &offset, cpkt->max_len,
-				   &delta, &opt_len, option);
+				   &delta, &opt_len, option, &entry);
 		if (ret < 0) {
 			return ret;
-		} else if (ret == 0) {
+		}
+
+		if (!marker) {
+			option_index_add(cpkt, &entry, &overflow);
+		}
+
+		if (ret == 0) {
 			break;
 		}
 	}
@@ -598,6 +734,7 @@ int coap_packet_parse(struct coap_packet *cpkt, uint8_t *data, uint16_t len,
 	cpkt->opt_len = opt_len;
 	cpkt->delta = delta;
 	cpkt->offset = offset;
+	option_index_done(cpkt, overflow);
 
 	return 0;
 }
@@ -611,6 +748,12 @@ int coap_find_options(const struct coap_packet *cpkt, uint16_t code,
 	uint8_t num;
 	int r;
 
+#if CONFIG_COAP_OPTION_INDEX_SIZE > 0
+	if (cpkt->opt_indexed) {
+		return option_index_find(cpkt, code, options, veclen);
+	}
+#endif
+
 	offset = cpkt->hdr_len;
 	opt_len = 0U;
 	delta = 0U;
@@ -619,7 +762,7 @@ int coap_find_options(const struct coap_packet *cpkt, uint16_t code,
 	while (delta <= code && num < veclen) {
 		r = parse_option(cpkt->data, offset, &offset,
 				 cpkt->max_len, &delta, &opt_len,
-				 &options[num]);
+				 &options[num], NULL);
 		if (r < 0) {
 			return -EINVAL;
 		}
@@ -822,6 +965,20 @@ static bool is_request(const struct coap_packet *cpkt)
 	return !(code & ~COAP_REQUEST_MASK);
 }
 
+static int resource_dispatch(struct coap_resource *resource,
+			     struct coap_packet *cpkt,
+			     struct sockaddr *addr, socklen_t addr_len)
+{
+	coap_method_t method;
+
+	method = method_from_code(resource, coap_header_get_code(cpkt));
+	if (!method) {
+		return -EPERM;
+	}
+
+	return method(resource, cpkt, addr, addr_len);
+}
+
 int coap_handle_request(struct coap_packet *cpkt,
 			struct coap_resource *resources,
 			struct coap_option *options,
@@ -834,28 +991,233 @@ int coap_handle_request(struct coap_packet *cpkt,
 		return 0;
 	}
 
-	/* FIXME: deal with hierarchical resources */
+	/* See coap_resource_table_handle_request() for large resource sets */
 	for (resource = resources; resource && resource->path; resource++) {
-		coap_method_t method;
-		uint8_t code;
-
 		if (!uri_path_eq(cpkt, resource->path, options, opt_num)) {
 			continue;
 		}
 
-		code = coap_header_get_code(cpkt);
-		method = method_from_code(resource, code);
-		if (!method) {
-			return -EPERM;
-		}
-
-		return method(resource, cpkt, addr, addr_len);
+		return resource_dispatch(resource, cpkt, addr, addr_len);
 	}
 
 	NET_DBG("%d", __LINE__);
 	return -ENOENT;
 }
 
+static uint16_t segment_hash(const uint8_t *segment, uint16_t len)
+{
+	uint32_t hash = 2166136261U;
+
+	/* FNV-1a, folded to 16 bits */
+	while (len--) {
+		hash = (hash ^ *segment++) * 16777619U;
+	}
+
+	return (uint16_t)(hash ^ (hash >> 16));
+}
+
+static struct coap_resource_node *node_alloc(struct coap_resource_table *table,
+					     const char *segment, uint8_t len)
+{
+	struct coap_resource_node *node;
+
+	if (table->used == table->node_count) {
+		return NULL;
+	}
+
+	node = &table->nodes[table->used++];
+	(void)memset(node, 0, sizeof(*node));
+	node->segment = segment;
+	node->len = len;
+	node->hash = segment_hash((const uint8_t *)segment, len);
+
+	return node;
+}
+
+/* Find or insert the child for segment, children are sorted by hash */
+static struct coap_resource_node *node_child(struct coap_resource_table *table,
+					     struct coap_resource_node *parent,
+					     const char *segment, uint8_t len)
+{
+	struct coap_resource_node **link = &parent->child;
+	struct coap_resource_node *node;
+	uint16_t hash = segment_hash((const uint8_t *)segment, len);
+
+	for (node = *link; node && node->hash <= hash; node = *link) {
+		if (node->hash == hash && node->len == len &&
+		    !memcmp(node->segment, segment, len)) {
+			return node;
+		}
+
+		link = &node->next;
+	}
+
+	node = node_alloc(table, segment, len);
+	if (node) {
+		node->next = *link;
+		*link = node;
+	}
+
+	return node;
+}
+
+int coap_resource_table_init(struct coap_resource_table *table,
+			     struct coap_resource *resources,
+			     struct coap_resource_node *nodes,
+			     size_t node_count)
+{
+	struct coap_resource *resource;
+	struct coap_resource_node *node;
+	const char * const *segment;
+	size_t len;
+
+	if (!table || !nodes || node_count == 0 || node_count > UINT16_MAX) {
+		return -EINVAL;
+	}
+
+	table->nodes = nodes;
+	table->node_count = node_count;
+	table->used = 0U;
+
+	/* root */
+	(void)node_alloc(table, "", 0U);
+
+	for (resource = resources; resource && resource->path; resource++) {
+		node = &table->nodes[0];
+
+		for (segment = resource->path; *segment; segment++) {
+			len = strlen(*segment);
+			if (len > UINT8_MAX) {
+				return -EINVAL;
+			}
+
+			if (IS_ENABLED(CONFIG_COAP_URI_WILDCARD) && len == 1U) {
+				if (**segment == '#') {
+					break;
+				}
+
+				if (**segment == '+') {
+					if (!node->wildcard) {
+						node->wildcard = node_alloc(
+							table, *segment, 1U);
+					}
+
+					node = node->wildcard;
+					if (!node) {
+						return -ENOMEM;
+					}
+
+					continue;
+				}
+			}
+
+			node = node_child(table, node, *segment, len);
+			if (!node) {
+				return -ENOMEM;
+			}
+		}
+
+		/* first resource registered for a path wins */
+		if (*segment) {
+			if (!node->multi) {
+				node->multi = resource;
+			}
+		} else if (!node->resource) {
+			node->resource = resource;
+		}
+	}
+
+	return 0;
+}
+
+static struct coap_resource *node_match(const struct coap_resource_node *node,
+					const struct coap_option *segments,
+					uint8_t count)
+{
+	const struct coap_resource_node *child;
+	struct coap_resource *resource;
+	uint16_t hash;
+
+	if (count == 0U) {
+		return node->resource;
+	}
+
+	hash = segment_hash(segments->value, segments->len);
+
+	for (child = node->child; child && child->hash <= hash;
+	     child = child->next) {
+		if (child->hash != hash || child->len != segments->len ||
+		    memcmp(child->segment, segments->value, child->len)) {
+			continue;
+		}
+
+		resource = node_match(child, segments + 1, count - 1U);
+		if (resource) {
+			return resource;
+		}
+
+		break;
+	}
+
+	if (node->wildcard) {
+		resource = node_match(node->wildcard, segments + 1,
+				      count - 1U);
+		if (resource) {
+			return resource;
+		}
+	}
+
+	return node->multi;
+}
+
+struct coap_resource *coap_resource_table_find(
+				const struct coap_resource_table *table,
+				const struct coap_option *options,
+				uint8_t opt_num)
+{
+	uint8_t first, count;
+
+	if (!table || !table->used) {
+		return NULL;
+	}
+
+	/* Uri-Path options are consecutive, options being sorted */
+	for (first = 0U; first < opt_num; first++) {
+		if (options[first].delta == COAP_OPTION_URI_PATH) {
+			break;
+		}
+	}
+
+	for (count = 0U; first + count < opt_num; count++) {
+		if (options[first + count].delta != COAP_OPTION_URI_PATH) {
+			break;
+		}
+	}
+
+	return node_match(&table->nodes[0], &options[first], count);
+}
+
+int coap_resource_table_handle_request(struct coap_packet *cpkt,
+				       const struct coap_resource_table *table,
+				       struct coap_option *options,
+				       uint8_t opt_num,
+				       struct sockaddr *addr,
+				       socklen_t addr_len)
+{
+	struct coap_resource *resource;
+
+	if (!is_request(cpkt)) {
+		return 0;
+	}
+
+	resource = coap_resource_table_find(table, options, opt_num);
+	if (!resource) {
+		return -ENOENT;
+	}
+
+	return resource_dispatch(resource, cpkt, addr, addr_len);
+}
+
 int coap_block_transfer_init(struct coap_block_context *ctx,
 			      enum coap_block_size block_size,
 			      size_t total_size)
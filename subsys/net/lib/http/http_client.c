@@ -25,8 +25,10 @@ LOG_MODULE_REGISTER(net_http, CONFIG_NET_HTTP_LOG_LEVEL);
 #include <net/http_client.h>
 
 #include "net_private.h"
+#include "http_client_internal.h"
 
-#define HTTP_CONTENT_LEN_SIZE 6
+#define HTTP_CONTENT_LEN_SIZE 11
+#define HTTP_CHUNK_HDR_SIZE 11
 #define MAX_SEND_BUF_LEN 192
 
 static ssize_t sendall(int sock, const void *buf, size_t len)
@@ -303,7 +305,11 @@ static int on_headers_complete(struct http_parser *parser)
 		req->internal.response.http_cb->on_headers_complete(parser);
 	}
 
-	if (parser->status_code >= 500 && parser->status_code < 600) {
+	/* On a persistent connection the body must be parsed to find
+	 * where the next response starts.
+	 */
+	if (parser->status_code >= 500 && parser->status_code < 600 &&
+	    !req->internal.keep_alive) {
 		NET_DBG("Status %d, skipping body", parser->status_code);
 		return 1;
 	}
@@ -358,6 +364,11 @@ static int on_message_complete(struct http_parser *parser)
 					  req->internal.user_data);
 	}
 
+	/* Any data after this belongs to the next response */
+	if (req->internal.keep_alive) {
+		http_parser_pause(parser, 1);
+	}
+
 	return 0;
 }
 
@@ -461,22 +472,46 @@ static void http_timeout(struct k_work *work)
 	(void)close(data->sock);
 }
 
-int http_client_req(int sock, struct http_request *req,
-		    int32_t timeout, void *user_data)
+int http_client_send_chunk(int sock, const void *data, size_t len)
+{
+	char chunk_hdr[HTTP_CHUNK_HDR_SIZE];
+	int ret;
+
+	/* The last chunk is followed by an empty trailer */
+	if (len == 0) {
+		return sendall(sock, "0" HTTP_CRLF HTTP_CRLF,
+			       sizeof("0" HTTP_CRLF HTTP_CRLF) - 1);
+	}
+
+	ret = snprintk(chunk_hdr, sizeof(chunk_hdr), "%zx" HTTP_CRLF, len);
+	if (ret <= 0 || ret >= sizeof(chunk_hdr)) {
+		return -ENOMEM;
+	}
+
+	ret = sendall(sock, chunk_hdr, ret);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = sendall(sock, data, len);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return sendall(sock, HTTP_CRLF, sizeof(HTTP_CRLF) - 1);
+}
+
+int http_client_send_req(int sock, struct http_request *req,
+			 void *user_data)
 {
 	/* Utilize the network usage by sending data in bigger blocks */
 	char send_buf[MAX_SEND_BUF_LEN];
 	const size_t send_buf_max_len = sizeof(send_buf);
 	size_t send_buf_pos = 0;
 	int total_sent = 0;
-	int ret, total_recv, i;
+	int ret, i;
 	const char *method;
 
-	if (sock < 0 || req == NULL || req->response == NULL ||
-	    req->recv_buf == NULL || req->recv_buf_len == 0) {
-		return -EINVAL;
-	}
-
 	memset(&req->internal.response, 0, sizeof(req->internal.response));
 
 	req->internal.response.http_cb = req->http_cb;
@@ -485,7 +520,9 @@ int http_client_req(int sock, struct http_request *req,
 	req->internal.response.recv_buf_len = req->recv_buf_len;
 	req->internal.user_data = user_data;
 	req->internal.sock = sock;
-	req->internal.timeout = SYS_TIMEOUT_MS(timeout);
+
+	http_client_init_parser(&req->internal.parser,
+				&req->internal.parser_settings);
 
 	method = http_method_str(req->method);
 
@@ -647,8 +684,29 @@ int http_client_req(int sock, struct http_request *req,
 
 	NET_DBG("Sent %d bytes", total_sent);
 
-	http_client_init_parser(&req->internal.parser,
-				&req->internal.parser_settings);
+	return total_sent;
+
+out:
+	return ret;
+}
+
+int http_client_req(int sock, struct http_request *req,
+		    int32_t timeout, void *user_data)
+{
+	int total_sent, total_recv;
+
+	if (sock < 0 || req == NULL || req->response == NULL ||
+	    req->recv_buf == NULL || req->recv_buf_len == 0) {
+		return -EINVAL;
+	}
+
+	req->internal.timeout = SYS_TIMEOUT_MS(timeout);
+	req->internal.keep_alive = false;
+
+	total_sent = http_client_send_req(sock, req, user_data);
+	if (total_sent < 0) {
+		return total_sent;
+	}
 
 	if (!K_TIMEOUT_EQ(req->internal.timeout, K_FOREVER) &&
 	    !K_TIMEOUT_EQ(req->internal.timeout, K_NO_WAIT)) {
@@ -671,7 +729,4 @@ int http_client_req(int sock, struct http_request *req,
 	}
 
 	return total_sent;
-
-out:
-	return ret;
 }
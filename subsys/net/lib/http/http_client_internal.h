@@ -0,0 +1,29 @@
+/** @file
+ * @brief HTTP client internal API
+ */
+
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_SUBSYS_NET_LIB_HTTP_HTTP_CLIENT_INTERNAL_H_
+#define ZEPHYR_SUBSYS_NET_LIB_HTTP_HTTP_CLIENT_INTERNAL_H_
+
+#include <net/http_client.h>
+
+/**
+ * @brief Send a HTTP request and prepare the request for parsing the
+ * response.
+ *
+ * @param sock Socket id of the connection.
+ * @param req HTTP request information
+ * @param user_data User specified data that is passed to the callbacks.
+ *
+ * @return <0 if error, >=0 amount of data sent to the server
+ */
+int http_client_send_req(int sock, struct http_request *req,
+			 void *user_data);
+
+#endif /* ZEPHYR_SUBSYS_NET_LIB_HTTP_HTTP_CLIENT_INTERNAL_H_ */
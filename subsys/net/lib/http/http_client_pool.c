@@ -0,0 +1,510 @@
+/** @file
+ * @brief HTTP client connection pool
+ *
+ * Connections to HTTP servers are kept open after a request and reused for
+ * later requests to the same host, which saves the TCP and TLS handshakes.
+ * The requests of one call are pipelined: all of them are sent before the
+ * responses are read, and the responses are matched to the requests in
+ * order.
+ */
+
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_http, CONFIG_NET_HTTP_LOG_LEVEL);
+
+#include <kernel.h>
+#include <string.h>
+#include <errno.h>
+#include <stdbool.h>
+
+#include <net/socket.h>
+#include <net/tls_credentials.h>
+#include <net/http_client.h>
+
+#include "net_private.h"
+#include "http_client_internal.h"
+
+#define HTTP_PORT "80"
+#define HTTPS_PORT "443"
+#define PORT_STR_LEN sizeof("65535")
+
+struct pool_conn {
+	/** Host and port the connection is to */
+	char host[CONFIG_HTTP_CLIENT_POOL_HOST_LEN];
+	char port[PORT_STR_LEN];
+
+	/** Data received after the previous response. It is stored in the
+	 * receive buffer of the previous request.
+	 */
+	const uint8_t *pending;
+	size_t pending_len;
+
+	/** Uptime when the connection was last used */
+	int64_t last_used;
+
+	/** Closes the socket when the request timeout expires */
+	struct k_delayed_work timeout_work;
+
+	/** Given when the timeout work has run */
+	struct k_sem timeout_done;
+
+	/** Socket of the connection */
+	int sock;
+
+	/** Socket is connected */
+	bool connected;
+
+	/** Connection is used by a http_client_pool_req() call */
+	bool busy;
+
+	/** Connection uses TLS */
+	bool tls;
+
+	/** Socket has been closed by the timeout work */
+	bool timed_out;
+};
+
+static struct pool_conn pool_conns[CONFIG_HTTP_CLIENT_POOL_CONNECTIONS];
+static K_MUTEX_DEFINE(pool_lock);
+
+static void pool_conn_close(struct pool_conn *conn)
+{
+	NET_DBG("Closing connection %p", conn);
+
+	(void)close(conn->sock);
+	conn->connected = false;
+}
+
+static void pool_timeout(struct k_work *work)
+{
+	struct pool_conn *conn = CONTAINER_OF(work, struct pool_conn,
+					      timeout_work);
+
+	NET_DBG("Connection %p timed out", conn);
+
+	/* A send blocked on the socket fails once it is closed */
+	conn->timed_out = true;
+	(void)close(conn->sock);
+
+	k_sem_give(&conn->timeout_done);
+}
+
+/* Check that an idle connection can be used for a new request */
+static bool pool_conn_usable(struct pool_conn *conn)
+{
+	struct pollfd fds = {
+		.fd = conn->sock,
+		.events = POLLIN,
+	};
+
+	if (k_uptime_get() - conn->last_used >
+	    CONFIG_HTTP_CLIENT_POOL_IDLE_TIMEOUT) {
+		return false;
+	}
+
+	/* There is nothing to read from an idle connection unless the
+	 * server has closed it.
+	 */
+	return poll(&fds, 1, 0) == 0;
+}
+
+static bool pool_conn_match(struct pool_conn *conn, const char *host,
+			    const char *port, bool tls)
+{
+	return conn->connected && conn->tls == tls &&
+		strcmp(conn->host, host) == 0 && strcmp(conn->port, port) == 0;
+}
+
+/* Get an open connection to the host, or the entry that has been idle
+ * longest for a new connection.
+ */
+static struct pool_conn *pool_get(const char *host, const char *port,
+				  bool tls)
+{
+	struct pool_conn *conn = NULL, *avail = NULL;
+	int i;
+
+	k_mutex_lock(&pool_lock, K_FOREVER);
+
+	for (i = 0; i < ARRAY_SIZE(pool_conns); i++) {
+		if (pool_conns[i].busy) {
+			continue;
+		}
+
+		if (pool_conn_match(&pool_conns[i], host, port, tls)) {
+			if (pool_conn_usable(&pool_conns[i])) {
+				conn = &pool_conns[i];
+				break;
+			}
+
+			pool_conn_close(&pool_conns[i]);
+		}
+
+		if (!avail || (avail->connected &&
+			       (!pool_conns[i].connected ||
+				pool_conns[i].last_used < avail->last_used))) {
+			avail = &pool_conns[i];
+		}
+	}
+
+	if (!conn && avail) {
+		conn = avail;
+
+		if (conn->connected) {
+			pool_conn_close(conn);
+		}
+
+		strcpy(conn->host, host);
+		strcpy(conn->port, port);
+		conn->tls = tls;
+	}
+
+	if (conn) {
+		conn->busy = true;
+	}
+
+	k_mutex_unlock(&pool_lock);
+
+	return conn;
+}
+
+static void pool_put(struct pool_conn *conn, bool keep_alive)
+{
+	if (!keep_alive && conn->connected) {
+		pool_conn_close(conn);
+	}
+
+	conn->pending_len = 0;
+	conn->last_used = k_uptime_get();
+
+	k_mutex_lock(&pool_lock, K_FOREVER);
+	conn->busy = false;
+	k_mutex_unlock(&pool_lock);
+}
+
+static int pool_connect(struct pool_conn *conn, const char *host,
+			const char *port, const sec_tag_t *sec_tag_list,
+			size_t sec_tag_count)
+{
+	struct addrinfo hints = {
+		.ai_socktype = SOCK_STREAM,
+	};
+	struct addrinfo *res;
+	int ret, sock;
+
+	ret = getaddrinfo(host, port, &hints, &res);
+	if (ret != 0) {
+		NET_DBG("Cannot resolve %s (%d)", log_strdup(host), ret);
+		return -EHOSTUNREACH;
+	}
+
+	sock = socket(res->ai_family, SOCK_STREAM,
+		      conn->tls ? IPPROTO_TLS_1_2 : IPPROTO_TCP);
+	if (sock < 0) {
+		ret = -errno;
+		goto out;
+	}
+
+#if defined(CONFIG_NET_SOCKETS_SOCKOPT_TLS)
+	if (conn->tls) {
+		if (setsockopt(sock, SOL_TLS, TLS_SEC_TAG_LIST, sec_tag_list,
+			       sec_tag_count * sizeof(sec_tag_t)) < 0 ||
+		    setsockopt(sock, SOL_TLS, TLS_HOSTNAME, host,
+			       strlen(host)) < 0) {
+			ret = -errno;
+			(void)close(sock);
+			goto out;
+		}
+	}
+#endif
+
+	if (connect(sock, res->ai_addr, res->ai_addrlen) < 0) {
+		ret = -errno;
+		(void)close(sock);
+		goto out;
+	}
+
+	NET_DBG("Connection %p to %s:%s", conn, log_strdup(host),
+		log_strdup(port));
+
+	conn->sock = sock;
+	conn->connected = true;
+
+out:
+	freeaddrinfo(res);
+
+	return ret;
+}
+
+static int pool_recv(struct pool_conn *conn, uint8_t *buf, size_t len,
+		     int64_t end)
+{
+	struct pollfd fds = {
+		.fd = conn->sock,
+		.events = POLLIN,
+	};
+	int timeout = SYS_FOREVER_MS;
+	int ret;
+
+	if (end >= 0) {
+		timeout = MAX(end - k_uptime_get(), 0);
+	}
+
+	ret = poll(&fds, 1, timeout);
+	if (ret < 0) {
+		return -errno;
+	}
+
+	if (ret == 0) {
+		return -ETIMEDOUT;
+	}
+
+	ret = recv(conn->sock, buf, len, 0);
+	if (ret < 0) {
+		return -errno;
+	}
+
+	return ret;
+}
+
+static int pool_parse(struct pool_conn *conn, struct http_request *req,
+		      const uint8_t *data, size_t len)
+{
+	struct http_parser *parser = &req->internal.parser;
+	size_t parsed;
+
+	req->internal.response.data_len += len;
+
+	parsed = http_parser_execute(parser, &req->internal.parser_settings,
+				     data, len);
+
+	/* The parser is paused when the response is complete */
+	if (HTTP_PARSER_ERRNO(parser) == HPE_PAUSED) {
+		conn->pending = data + parsed;
+		conn->pending_len = len - parsed;
+
+		return 0;
+	}
+
+	if (HTTP_PARSER_ERRNO(parser) != HPE_OK) {
+		NET_DBG("Invalid response (%s)",
+			http_errno_name(HTTP_PARSER_ERRNO(parser)));
+		return -EBADMSG;
+	}
+
+	return 0;
+}
+
+static int pool_recv_rsp(struct pool_conn *conn, struct http_request *req,
+			 int64_t end)
+{
+	struct http_response *rsp = &req->internal.response;
+	size_t offset = 0;
+	int ret, len;
+
+	/* The data received after the previous response starts this one.
+	 * Responses after it may be in the same data, so it is all moved
+	 * at once.
+	 */
+	if (conn->pending_len > 0) {
+		if (conn->pending_len > rsp->recv_buf_len) {
+			NET_DBG("Receive buffer too small for pipelined data");
+			return -ENOMEM;
+		}
+
+		offset = conn->pending_len;
+		conn->pending_len = 0;
+
+		memmove(rsp->recv_buf, conn->pending, offset);
+
+		ret = pool_parse(conn, req, rsp->recv_buf, offset);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	while (!rsp->message_complete) {
+		if (offset >= rsp->recv_buf_len) {
+			offset = 0;
+		}
+
+		len = pool_recv(conn, rsp->recv_buf + offset,
+				rsp->recv_buf_len - offset, end);
+		if (len < 0) {
+			NET_DBG("Connection error (%d)", len);
+			return len;
+		}
+
+		if (len == 0) {
+			/* A body without a length ends when the connection
+			 * is closed.
+			 */
+			(void)pool_parse(conn, req, NULL, 0);
+
+			return rsp->message_complete ? 0 : -ECONNRESET;
+		}
+
+		ret = pool_parse(conn, req, rsp->recv_buf + offset, len);
+		if (ret < 0) {
+			return ret;
+		}
+
+		offset += len;
+	}
+
+	return 0;
+}
+
+int http_client_pool_req(struct http_request **reqs, size_t count,
+			 const sec_tag_t *sec_tag_list, size_t sec_tag_count,
+			 int32_t timeout, void *user_data)
+{
+	struct pool_conn unpooled = { 0 };
+	struct pool_conn *conn;
+	bool tls = sec_tag_count > 0;
+	bool keep_alive = false;
+	const char *host, *port;
+	int64_t end = -1;
+	size_t i, done = 0;
+	int ret = 0;
+
+	if (reqs == NULL || count == 0 || reqs[0] == NULL ||
+	    reqs[0]->host == NULL) {
+		return -EINVAL;
+	}
+
+	if (tls && (sec_tag_list == NULL ||
+		    !IS_ENABLED(CONFIG_NET_SOCKETS_SOCKOPT_TLS))) {
+		return -ENOTSUP;
+	}
+
+	host = reqs[0]->host;
+	port = reqs[0]->port ? reqs[0]->port : (tls ? HTTPS_PORT : HTTP_PORT);
+
+	for (i = 0; i < count; i++) {
+		if (reqs[i] == NULL || reqs[i]->response == NULL ||
+		    reqs[i]->recv_buf == NULL || reqs[i]->recv_buf_len == 0) {
+			return -EINVAL;
+		}
+
+		/* All the requests are sent on the same connection */
+		if (reqs[i]->host == NULL || strcmp(reqs[i]->host, host) ||
+		    (reqs[i]->port != reqs[0]->port &&
+		     (!reqs[i]->port || !reqs[0]->port ||
+		      strcmp(reqs[i]->port, reqs[0]->port)))) {
+			return -EINVAL;
+		}
+	}
+
+	if (strlen(port) >= PORT_STR_LEN) {
+		return -EINVAL;
+	}
+
+	if (strlen(host) < sizeof(unpooled.host)) {
+		conn = pool_get(host, port, tls);
+		if (!conn) {
+			return -EAGAIN;
+		}
+	} else {
+		/* The connection is only used for this call */
+		conn = &unpooled;
+		conn->tls = tls;
+	}
+
+	if (!conn->connected) {
+		ret = pool_connect(conn, host, port, sec_tag_list,
+				   sec_tag_count);
+		if (ret < 0) {
+			goto out;
+		}
+	}
+
+	/* The wait for the responses is bounded by poll(), the requests
+	 * are bounded by closing the socket as http_client_req() does.
+	 */
+	if (timeout != SYS_FOREVER_MS) {
+		end = k_uptime_get() + timeout;
+	}
+
+	if (timeout > 0) {
+		k_delayed_work_init(&conn->timeout_work, pool_timeout);
+		k_sem_init(&conn->timeout_done, 0, 1);
+		(void)k_delayed_work_submit(&conn->timeout_work,
+					    K_MSEC(timeout));
+	}
+
+	for (i = 0; i < count; i++) {
+		reqs[i]->internal.keep_alive = true;
+		reqs[i]->internal.timeout = SYS_TIMEOUT_MS(timeout);
+
+		ret = http_client_send_req(conn->sock, reqs[i], user_data);
+		if (ret < 0) {
+			goto out;
+		}
+	}
+
+	while (done < count) {
+		ret = pool_recv_rsp(conn, reqs[done], end);
+		if (ret < 0) {
+			goto out;
+		}
+
+		/* The server closes the connection after this response, the
+		 * rest of the requests are not answered.
+		 */
+		if (!http_should_keep_alive(&reqs[done++]->internal.parser)) {
+			goto out;
+		}
+	}
+
+	/* Nothing is expected after the last response */
+	keep_alive = conn->pending_len == 0 && conn != &unpooled;
+
+out:
+	/* The work cannot be cancelled once it has been taken by the work
+	 * queue. Wait for it to finish so that it does not close the socket
+	 * of a later request, nor use the connection after it is released.
+	 */
+	if (end >= 0 && timeout > 0 &&
+	    k_delayed_work_cancel(&conn->timeout_work) != 0) {
+		k_sem_take(&conn->timeout_done, K_FOREVER);
+	}
+
+	if (conn->timed_out) {
+		conn->timed_out = false;
+		conn->connected = false;
+		keep_alive = false;
+
+		if (ret < 0) {
+			ret = -ETIMEDOUT;
+		}
+	}
+
+	pool_put(conn, keep_alive);
+
+	if (done == 0 && ret < 0) {
+		return ret;
+	}
+
+	return done;
+}
+
+void http_client_pool_close(void)
+{
+	int i;
+
+	k_mutex_lock(&pool_lock, K_FOREVER);
+
+	for (i = 0; i < ARRAY_SIZE(pool_conns); i++) {
+		if (!pool_conns[i].busy && pool_conns[i].connected) {
+			pool_conn_close(&pool_conns[i]);
+		}
+	}
+
+	k_mutex_unlock(&pool_lock);
+}
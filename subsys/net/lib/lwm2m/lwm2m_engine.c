@@ -45,6 +45,9 @@ LOG_MODULE_REGISTER(LOG_MODULE_NAME);
 #ifdef CONFIG_LWM2M_RW_JSON_SUPPORT
 #include "lwm2m_rw_json.h"
 #endif
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+#include "lwm2m_rw_senml_cbor.h"
+#endif
 #ifdef CONFIG_LWM2M_RD_CLIENT_SUPPORT
 #include "lwm2m_rd_client.h"
 #endif
@@ -90,8 +93,11 @@ struct observe_node {
 	int64_t last_timestamp;
 	uint32_t min_period_sec;
 	uint32_t max_period_sec;
+	int64_t deadline;
 	uint32_t counter;
 	uint16_t format;
+	/* 1-based position in observer_heap, 0 if not scheduled */
+	uint16_t heap_idx;
 	uint8_t  tkl;
 };
 
@@ -107,6 +113,13 @@ struct notification_attrs {
 
 static struct observe_node observe_node_data[CONFIG_LWM2M_ENGINE_MAX_OBSERVER];
 
+/* Observers ordered by their next notification deadline (binary min-heap),
+ * so the engine only looks at observers which are actually due.
+ */
+static struct observe_node *observer_heap[CONFIG_LWM2M_ENGINE_MAX_OBSERVER];
+static uint16_t observer_heap_len;
+static struct k_spinlock observer_heap_lock;
+
 #define MAX_PERIODIC_SERVICE	10
 
 struct service_node {
@@ -116,12 +129,31 @@ struct service_node {
 	uint64_t last_timestamp; /* ms */
 };
 
+#define SERVICE_DUE(srv) ((srv)->last_timestamp + (srv)->min_call_period)
+
 static struct service_node service_node_data[MAX_PERIODIC_SERVICE];
 
 static sys_slist_t engine_obj_list;
 static sys_slist_t engine_obj_inst_list;
+
+#define LOOKUP_HASH_SIZE BIT(CONFIG_LWM2M_ENGINE_LOOKUP_HASH_BITS)
+#define LOOKUP_HASH_MASK (LOOKUP_HASH_SIZE - 1)
+
+/* Hashed lookup of objects by obj_id and of object instances by
+ * obj_id/obj_inst_id. The lists above keep registration order for
+ * discovery and iteration.
+ */
+static sys_slist_t engine_obj_hash[LOOKUP_HASH_SIZE];
+static sys_slist_t engine_obj_inst_hash[LOOKUP_HASH_SIZE];
+
+/* Incremented whenever an object, object instance or resource instance
+ * is removed, so pre-resolved resource handles know to resolve again.
+ */
+static uint32_t engine_generation;
 static sys_slist_t engine_observer_list;
+/* sorted by next due time, earliest first */
 static sys_slist_t engine_service_list;
+static struct k_spinlock engine_service_lock;
 
 static K_KERNEL_STACK_DEFINE(engine_thread_stack,
 			      CONFIG_LWM2M_ENGINE_STACK_SIZE);
@@ -355,6 +387,188 @@ static void clear_attrs(void *ref)
 	}
 }
 
+/* observer notification scheduling */
+
+static int64_t observer_deadline(const struct observe_node *obs)
+{
+	uint32_t period_ms;
+
+	/* pending value change: notify as soon as pmin allows */
+	if (obs->event_timestamp > obs->last_timestamp) {
+		return obs->last_timestamp +
+		       MSEC_PER_SEC * obs->min_period_sec;
+	}
+
+	/* otherwise notify when pmax expires */
+	period_ms = MSEC_PER_SEC * obs->max_period_sec;
+	if (period_ms == 0U) {
+		period_ms = ENGINE_UPDATE_INTERVAL_MS;
+	}
+
+	return obs->last_timestamp + period_ms;
+}
+
+static void observer_heap_set(uint16_t idx, struct observe_node *obs)
+{
+	observer_heap[idx] = obs;
+	obs->heap_idx = idx + 1;
+}
+
+static void observer_heap_sift_up(uint16_t idx)
+{
+	struct observe_node *obs = observer_heap[idx];
+	uint16_t parent;
+
+	while (idx > 0) {
+		parent = (idx - 1) / 2;
+		if (observer_heap[parent]->deadline <= obs->deadline) {
+			break;
+		}
+
+		observer_heap_set(idx, observer_heap[parent]);
+		idx = parent;
+	}
+
+	observer_heap_set(idx, obs);
+}
+
+static void observer_heap_sift_down(uint16_t idx)
+{
+	struct observe_node *obs = observer_heap[idx];
+	uint16_t child;
+
+	while ((child = 2 * idx + 1) < observer_heap_len) {
+		if (child + 1 < observer_heap_len &&
+		    observer_heap[child + 1]->deadline <
+		    observer_heap[child]->deadline) {
+			child++;
+		}
+
+		if (obs->deadline <= observer_heap[child]->deadline) {
+			break;
+		}
+
+		observer_heap_set(idx, observer_heap[child]);
+		idx = child;
+	}
+
+	observer_heap_set(idx, obs);
+}
+
+/* (Re)compute the observer deadline and move it into place. */
+static void observer_schedule(struct observe_node *obs)
+{
+	k_spinlock_key_t key = k_spin_lock(&observer_heap_lock);
+	uint16_t idx;
+
+	obs->deadline = observer_deadline(obs);
+
+	if (obs->heap_idx == 0U) {
+		idx = observer_heap_len++;
+		observer_heap_set(idx, obs);
+	} else {
+		idx = obs->heap_idx - 1;
+	}
+
+	observer_heap_sift_up(idx);
+	observer_heap_sift_down(obs->heap_idx - 1);
+
+	k_spin_unlock(&observer_heap_lock, key);
+}
+
+/* Push back the deadline of an observer which cannot be notified now,
+ * without touching its pmin/pmax state.
+ */
+static void observer_defer(struct observe_node *obs, int64_t deadline)
+{
+	k_spinlock_key_t key = k_spin_lock(&observer_heap_lock);
+
+	if (obs->heap_idx != 0U) {
+		obs->deadline = deadline;
+		observer_heap_sift_down(obs->heap_idx - 1);
+	}
+
+	k_spin_unlock(&observer_heap_lock, key);
+}
+
+static void observer_unschedule(struct observe_node *obs)
+{
+	k_spinlock_key_t key = k_spin_lock(&observer_heap_lock);
+	struct observe_node *last;
+	uint16_t idx;
+
+	if (obs->heap_idx == 0U) {
+		goto out;
+	}
+
+	idx = obs->heap_idx - 1;
+	obs->heap_idx = 0U;
+	observer_heap_len--;
+
+	/* fill the hole with the last entry */
+	if (idx < observer_heap_len) {
+		last = observer_heap[observer_heap_len];
+		observer_heap_set(idx, last);
+		observer_heap_sift_up(idx);
+		observer_heap_sift_down(last->heap_idx - 1);
+	}
+
+out:
+	k_spin_unlock(&observer_heap_lock, key);
+}
+
+/*
+ * Collect observers with a deadline up to @a limit, walking only the part
+ * of the heap which can contain them. Only called from the engine thread.
+ */
+static int observer_collect(int64_t limit, struct observe_node **out,
+			    int max)
+{
+	static uint16_t stack[CONFIG_LWM2M_ENGINE_MAX_OBSERVER];
+	k_spinlock_key_t key = k_spin_lock(&observer_heap_lock);
+	int sp = 0, count = 0;
+	uint16_t idx;
+
+	if (observer_heap_len > 0) {
+		stack[sp++] = 0U;
+	}
+
+	while (sp > 0 && count < max) {
+		idx = stack[--sp];
+		if (observer_heap[idx]->deadline > limit) {
+			continue;
+		}
+
+		out[count++] = observer_heap[idx];
+
+		if (2 * idx + 1 < observer_heap_len) {
+			stack[sp++] = 2 * idx + 1;
+		}
+
+		if (2 * idx + 2 < observer_heap_len) {
+			stack[sp++] = 2 * idx + 2;
+		}
+	}
+
+	k_spin_unlock(&observer_heap_lock, key);
+
+	return count;
+}
+
+static int64_t observer_next_deadline(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&observer_heap_lock);
+	int64_t deadline = INT64_MAX;
+
+	if (observer_heap_len > 0) {
+		deadline = observer_heap[0]->deadline;
+	}
+
+	k_spin_unlock(&observer_heap_lock, key);
+
+	return deadline;
+}
+
 int lwm2m_notify_observer(uint16_t obj_id, uint16_t obj_inst_id, uint16_t res_id)
 {
 	struct observe_node *obs;
@@ -368,6 +582,7 @@ int lwm2m_notify_observer(uint16_t obj_id, uint16_t obj_inst_id, uint16_t res_id
 		     obs->path.res_id == res_id)) {
 			/* update the event time for this observer */
 			obs->event_timestamp = k_uptime_get();
+			observer_schedule(obs);
 
 			LOG_DBG("NOTIFY EVENT %u/%u/%u",
 				obj_id, obj_inst_id, res_id);
@@ -392,6 +607,7 @@ static int engine_add_observer(struct lwm2m_message *msg,
 	struct lwm2m_engine_obj *obj = NULL;
 	struct lwm2m_engine_obj_field *obj_field = NULL;
 	struct lwm2m_engine_obj_inst *obj_inst = NULL;
+	struct lwm2m_engine_res *res = NULL;
 	struct observe_node *obs;
 	struct notification_attrs attrs = {
 		.flags = BIT(LWM2M_ATTR_PMIN) | BIT(LWM2M_ATTR_PMAX),
@@ -464,13 +680,8 @@ static int engine_add_observer(struct lwm2m_message *msg,
 
 	/* check if resource exists */
 	if (msg->path.level >= 3U) {
-		for (i = 0; i < obj_inst->resource_count; i++) {
-			if (obj_inst->resources[i].res_id == msg->path.res_id) {
-				break;
-			}
-		}
-
-		if (i == obj_inst->resource_count) {
+		res = lwm2m_get_engine_res(obj_inst, msg->path.res_id);
+		if (!res) {
 			LOG_ERR("unable to find res_id: %u/%u/%u",
 				msg->path.obj_id, msg->path.obj_inst_id,
 				msg->path.res_id);
@@ -478,8 +689,7 @@ static int engine_add_observer(struct lwm2m_message *msg,
 		}
 
 		/* load object field data */
-		obj_field = lwm2m_get_engine_obj_field(obj,
-				obj_inst->resources[i].res_id);
+		obj_field = lwm2m_get_engine_obj_field(obj, res->res_id);
 		if (!obj_field) {
 			LOG_ERR("unable to find obj_field: %u/%u/%u",
 				msg->path.obj_id, msg->path.obj_inst_id,
@@ -492,7 +702,7 @@ static int engine_add_observer(struct lwm2m_message *msg,
 			return -EPERM;
 		}
 
-		ret = update_attrs(&obj_inst->resources[i], &attrs);
+		ret = update_attrs(res, &attrs);
 		if (ret < 0) {
 			return ret;
 		}
@@ -524,6 +734,7 @@ static int engine_add_observer(struct lwm2m_message *msg,
 	observe_node_data[i].counter = 1U;
 	sys_slist_append(&engine_observer_list,
 			 &observe_node_data[i].node);
+	observer_schedule(&observe_node_data[i]);
 
 	LOG_DBG("OBSERVER ADDED %u/%u/%u(%u) token:'%s' addr:%s",
 		msg->path.obj_id, msg->path.obj_inst_id,
@@ -560,6 +771,7 @@ static int engine_remove_observer(const uint8_t *token, uint8_t tkl)
 	}
 
 	sys_slist_remove(&engine_observer_list, prev_node, &found_obj->node);
+	observer_unschedule(found_obj);
 	(void)memset(found_obj, 0, sizeof(*found_obj));
 
 	LOG_DBG("observer '%s' removed", log_strdup(sprint_token(token, tkl)));
@@ -582,28 +794,46 @@ static void engine_remove_observer_by_id(uint16_t obj_id, int32_t obj_inst_id)
 		}
 
 		sys_slist_remove(&engine_observer_list, prev_node, &obs->node);
+		observer_unschedule(obs);
 		(void)memset(obs, 0, sizeof(*obs));
 	}
 }
 
 /* engine object */
 
+static inline uint32_t obj_hash(uint16_t obj_id)
+{
+	return obj_id & LOOKUP_HASH_MASK;
+}
+
+static inline uint32_t obj_inst_hash(uint16_t obj_id, uint16_t obj_inst_id)
+{
+	/* instances of one object usually have consecutive IDs */
+	return ((obj_id * 37U) + obj_inst_id) & LOOKUP_HASH_MASK;
+}
+
 void lwm2m_register_obj(struct lwm2m_engine_obj *obj)
 {
 	sys_slist_append(&engine_obj_list, &obj->node);
+	sys_slist_append(&engine_obj_hash[obj_hash(obj->obj_id)],
+			 &obj->hash_node);
 }
 
 void lwm2m_unregister_obj(struct lwm2m_engine_obj *obj)
 {
 	engine_remove_observer_by_id(obj->obj_id, -1);
 	sys_slist_find_and_remove(&engine_obj_list, &obj->node);
+	sys_slist_find_and_remove(&engine_obj_hash[obj_hash(obj->obj_id)],
+				  &obj->hash_node);
+	engine_generation++;
 }
 
 static struct lwm2m_engine_obj *get_engine_obj(int obj_id)
 {
 	struct lwm2m_engine_obj *obj;
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&engine_obj_list, obj, node) {
+	SYS_SLIST_FOR_EACH_CONTAINER(&engine_obj_hash[obj_hash(obj_id)],
+				     obj, hash_node) {
 		if (obj->obj_id == obj_id) {
 			return obj;
 		}
@@ -618,6 +848,12 @@ lwm2m_get_engine_obj_field(struct lwm2m_engine_obj *obj, int res_id)
 	int i;
 
 	if (obj && obj->fields && obj->field_count > 0) {
+		/* fields are normally declared in resource ID order */
+		if (res_id < obj->field_count &&
+		    obj->fields[res_id].res_id == res_id) {
+			return &obj->fields[res_id];
+		}
+
 		for (i = 0; i < obj->field_count; i++) {
 			if (obj->fields[i].res_id == res_id) {
 				return &obj->fields[i];
@@ -628,11 +864,58 @@ lwm2m_get_engine_obj_field(struct lwm2m_engine_obj *obj, int res_id)
 	return NULL;
 }
 
+struct lwm2m_engine_res *
+lwm2m_get_engine_res(struct lwm2m_engine_obj_inst *obj_inst, int res_id)
+{
+	int i;
+
+	if (!obj_inst->resources) {
+		return NULL;
+	}
+
+	/* resources are normally initialized in resource ID order */
+	if (res_id < obj_inst->resource_count &&
+	    obj_inst->resources[res_id].res_id == res_id) {
+		return &obj_inst->resources[res_id];
+	}
+
+	for (i = 0; i < obj_inst->resource_count; i++) {
+		if (obj_inst->resources[i].res_id == res_id) {
+			return &obj_inst->resources[i];
+		}
+	}
+
+	return NULL;
+}
+
+struct lwm2m_engine_res_inst *
+lwm2m_get_engine_res_inst(struct lwm2m_engine_res *res, int res_inst_id)
+{
+	int i;
+
+	/* instances are normally created in resource instance ID order */
+	if (res_inst_id < res->res_inst_count &&
+	    res->res_instances[res_inst_id].res_inst_id == res_inst_id) {
+		return &res->res_instances[res_inst_id];
+	}
+
+	for (i = 0; i < res->res_inst_count; i++) {
+		if (res->res_instances[i].res_inst_id == res_inst_id) {
+			return &res->res_instances[i];
+		}
+	}
+
+	return NULL;
+}
+
 /* engine object instance */
 
 static void engine_register_obj_inst(struct lwm2m_engine_obj_inst *obj_inst)
 {
 	sys_slist_append(&engine_obj_inst_list, &obj_inst->node);
+	sys_slist_append(&engine_obj_inst_hash[obj_inst_hash(
+				obj_inst->obj->obj_id, obj_inst->obj_inst_id)],
+			 &obj_inst->hash_node);
 }
 
 static void engine_unregister_obj_inst(struct lwm2m_engine_obj_inst *obj_inst)
@@ -640,6 +923,10 @@ static void engine_unregister_obj_inst(struct lwm2m_engine_obj_inst *obj_inst)
 	engine_remove_observer_by_id(
 			obj_inst->obj->obj_id, obj_inst->obj_inst_id);
 	sys_slist_find_and_remove(&engine_obj_inst_list, &obj_inst->node);
+	sys_slist_find_and_remove(&engine_obj_inst_hash[obj_inst_hash(
+				obj_inst->obj->obj_id, obj_inst->obj_inst_id)],
+				  &obj_inst->hash_node);
+	engine_generation++;
 }
 
 static struct lwm2m_engine_obj_inst *get_engine_obj_inst(int obj_id,
@@ -647,8 +934,9 @@ static struct lwm2m_engine_obj_inst *get_engine_obj_inst(int obj_id,
 {
 	struct lwm2m_engine_obj_inst *obj_inst;
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&engine_obj_inst_list, obj_inst,
-				     node) {
+	SYS_SLIST_FOR_EACH_CONTAINER(
+			&engine_obj_inst_hash[obj_inst_hash(obj_id, obj_inst_id)],
+			obj_inst, hash_node) {
 		if (obj_inst->obj->obj_id == obj_id &&
 		    obj_inst->obj_inst_id == obj_inst_id) {
 			return obj_inst;
@@ -1121,6 +1409,12 @@ static int select_writer(struct lwm2m_output_context *out, uint16_t accept)
 		break;
 #endif
 
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+	case LWM2M_FORMAT_APP_SENML_CBOR:
+		out->writer = &senml_cbor_writer;
+		break;
+#endif
+
 	default:
 		LOG_WRN("Unknown content type %u", accept);
 		return -ENOMSG;
@@ -1152,6 +1446,12 @@ static int select_reader(struct lwm2m_input_context *in, uint16_t format)
 		break;
 #endif
 
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+	case LWM2M_FORMAT_APP_SENML_CBOR:
+		in->reader = &senml_cbor_reader;
+		break;
+#endif
+
 	default:
 		LOG_WRN("Unknown content type %u", format);
 		return -ENOMSG;
@@ -1237,7 +1537,6 @@ static int path_to_objs(const struct lwm2m_obj_path *path,
 	struct lwm2m_engine_obj_field *of;
 	struct lwm2m_engine_res *r = NULL;
 	struct lwm2m_engine_res_inst *ri = NULL;
-	int i;
 
 	if (!path) {
 		return -EINVAL;
@@ -1261,24 +1560,13 @@ static int path_to_objs(const struct lwm2m_obj_path *path,
 		return -ENOENT;
 	}
 
-	for (i = 0; i < oi->resource_count; i++) {
-		if (oi->resources[i].res_id == path->res_id) {
-			r = &oi->resources[i];
-			break;
-		}
-	}
-
+	r = lwm2m_get_engine_res(oi, path->res_id);
 	if (!r) {
 		LOG_ERR("resource %d not found", path->res_id);
 		return -ENOENT;
 	}
 
-	for (i = 0; i < r->res_inst_count; i++) {
-		if (r->res_instances[i].res_inst_id == path->res_inst_id) {
-			ri = &r->res_instances[i];
-			break;
-		}
-	}
+	ri = lwm2m_get_engine_res_inst(r, path->res_inst_id);
 
 	/* specifically don't complain about missing resource instance */
 
@@ -1361,46 +1649,22 @@ int lwm2m_engine_set_res_data(char *pathstr, void *data_ptr, uint16_t data_len,
 	return ret;
 }
 
-static int lwm2m_engine_set(char *pathstr, void *value, uint16_t len)
+static int engine_set_res_inst(struct lwm2m_obj_path *path,
+			       struct lwm2m_engine_obj_inst *obj_inst,
+			       struct lwm2m_engine_obj_field *obj_field,
+			       struct lwm2m_engine_res *res,
+			       struct lwm2m_engine_res_inst *res_inst,
+			       void *value, uint16_t len)
 {
-	struct lwm2m_obj_path path;
-	struct lwm2m_engine_obj_inst *obj_inst;
-	struct lwm2m_engine_obj_field *obj_field;
-	struct lwm2m_engine_res *res = NULL;
-	struct lwm2m_engine_res_inst *res_inst = NULL;
 	void *data_ptr = NULL;
 	size_t max_data_len = 0;
 	int ret = 0;
 	bool changed = false;
 
-	LOG_DBG("path:%s, value:%p, len:%d", log_strdup(pathstr), value, len);
-
-	/* translate path -> path_obj */
-	ret = string_to_path(pathstr, &path, '/');
-	if (ret < 0) {
-		return ret;
-	}
-
-	if (path.level < 3) {
-		LOG_ERR("path must have at least 3 parts");
-		return -EINVAL;
-	}
-
-	/* look up resource obj */
-	ret = path_to_objs(&path, &obj_inst, &obj_field, &res, &res_inst);
-	if (ret < 0) {
-		return ret;
-	}
-
-	if (!res_inst) {
-		LOG_ERR("res instance %d not found", path.res_inst_id);
-		return -ENOENT;
-	}
-
 	if (LWM2M_HAS_RES_FLAG(res_inst, LWM2M_RES_DATA_FLAG_RO)) {
 		LOG_ERR("res instance data pointer is read-only "
-			"[%u/%u/%u/%u:%u]", path.obj_id, path.obj_inst_id,
-			path.res_id, path.res_inst_id, path.level);
+			"[%u/%u/%u/%u:%u]", path->obj_id, path->obj_inst_id,
+			path->res_id, path->res_inst_id, path->level);
 		return -EACCES;
 	}
 
@@ -1417,8 +1681,8 @@ static int lwm2m_engine_set(char *pathstr, void *value, uint16_t len)
 
 	if (!data_ptr) {
 		LOG_ERR("res instance data pointer is NULL [%u/%u/%u/%u:%u]",
-			path.obj_id, path.obj_inst_id, path.res_id,
-			path.res_inst_id, path.level);
+			path->obj_id, path->obj_inst_id, path->res_id,
+			path->res_inst_id, path->level);
 		return -EINVAL;
 	}
 
@@ -1426,7 +1690,7 @@ static int lwm2m_engine_set(char *pathstr, void *value, uint16_t len)
 	if (len > res_inst->max_data_len -
 		(obj_field->data_type == LWM2M_RES_TYPE_STRING ? 1 : 0)) {
 		LOG_ERR("length %u is too long for res instance %d data",
-			len, path.res_id);
+			len, path->res_id);
 		return -ENOMEM;
 	}
 
@@ -1516,12 +1780,139 @@ static int lwm2m_engine_set(char *pathstr, void *value, uint16_t len)
 	}
 
 	if (changed) {
-		NOTIFY_OBSERVER_PATH(&path);
+		NOTIFY_OBSERVER_PATH(path);
 	}
 
 	return ret;
 }
 
+static int lwm2m_engine_set(char *pathstr, void *value, uint16_t len)
+{
+	struct lwm2m_obj_path path;
+	struct lwm2m_engine_obj_inst *obj_inst;
+	struct lwm2m_engine_obj_field *obj_field;
+	struct lwm2m_engine_res *res = NULL;
+	struct lwm2m_engine_res_inst *res_inst = NULL;
+	int ret = 0;
+
+	LOG_DBG("path:%s, value:%p, len:%d", log_strdup(pathstr), value, len);
+
+	/* translate path -> path_obj */
+	ret = string_to_path(pathstr, &path, '/');
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (path.level < 3) {
+		LOG_ERR("path must have at least 3 parts");
+		return -EINVAL;
+	}
+
+	/* look up resource obj */
+	ret = path_to_objs(&path, &obj_inst, &obj_field, &res, &res_inst);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (!res_inst) {
+		LOG_ERR("res instance %d not found", path.res_inst_id);
+		return -ENOENT;
+	}
+
+	return engine_set_res_inst(&path, obj_inst, obj_field, res, res_inst,
+				   value, len);
+}
+
+/* pre-resolved resource handles */
+
+static int handle_resolve(struct lwm2m_engine_res_handle *handle)
+{
+	struct lwm2m_obj_path path = {
+		.obj_id = handle->obj_id,
+		.obj_inst_id = handle->obj_inst_id,
+		.res_id = handle->res_id,
+		.res_inst_id = handle->res_inst_id,
+		.level = handle->level,
+	};
+	struct lwm2m_engine_res_inst *res_inst = NULL;
+	int ret;
+
+	handle->res_inst = NULL;
+
+	ret = path_to_objs(&path, &handle->obj_inst, &handle->obj_field,
+			   &handle->res, &res_inst);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (!res_inst) {
+		LOG_ERR("res instance %d not found", path.res_inst_id);
+		return -ENOENT;
+	}
+
+	handle->res_inst = res_inst;
+	handle->generation = engine_generation;
+
+	return 0;
+}
+
+int lwm2m_engine_resolve_path(char *pathstr,
+			      struct lwm2m_engine_res_handle *handle)
+{
+	struct lwm2m_obj_path path;
+	int ret;
+
+	if (!handle) {
+		return -EINVAL;
+	}
+
+	ret = string_to_path(pathstr, &path, '/');
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (path.level < 3) {
+		LOG_ERR("path must have at least 3 parts");
+		return -EINVAL;
+	}
+
+	(void)memset(handle, 0, sizeof(*handle));
+	handle->obj_id = path.obj_id;
+	handle->obj_inst_id = path.obj_inst_id;
+	handle->res_id = path.res_id;
+	handle->res_inst_id = path.res_inst_id;
+	handle->level = path.level;
+
+	return handle_resolve(handle);
+}
+
+static int lwm2m_engine_handle_set(struct lwm2m_engine_res_handle *handle,
+				   void *value, uint16_t len)
+{
+	struct lwm2m_obj_path path;
+	int ret;
+
+	if (!handle) {
+		return -EINVAL;
+	}
+
+	if (!handle->res_inst || handle->generation != engine_generation) {
+		ret = handle_resolve(handle);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	path.obj_id = handle->obj_id;
+	path.obj_inst_id = handle->obj_inst_id;
+	path.res_id = handle->res_id;
+	path.res_inst_id = handle->res_inst_id;
+	path.level = handle->level;
+
+	return engine_set_res_inst(&path, handle->obj_inst, handle->obj_field,
+				   handle->res, handle->res_inst, value, len);
+}
+
 int lwm2m_engine_set_opaque(char *pathstr, char *data_ptr, uint16_t data_len)
 {
 	return lwm2m_engine_set(pathstr, data_ptr, data_len);
@@ -1594,6 +1985,92 @@ int lwm2m_engine_set_objlnk(char *pathstr, struct lwm2m_objlnk *value)
 	return lwm2m_engine_set(pathstr, value, sizeof(struct lwm2m_objlnk));
 }
 
+int lwm2m_engine_handle_set_opaque(struct lwm2m_engine_res_handle *handle,
+				   char *data_ptr, uint16_t data_len)
+{
+	return lwm2m_engine_handle_set(handle, data_ptr, data_len);
+}
+
+int lwm2m_engine_handle_set_string(struct lwm2m_engine_res_handle *handle,
+				   char *data_ptr)
+{
+	return lwm2m_engine_handle_set(handle, data_ptr, strlen(data_ptr));
+}
+
+int lwm2m_engine_handle_set_u8(struct lwm2m_engine_res_handle *handle,
+			       uint8_t value)
+{
+	return lwm2m_engine_handle_set(handle, &value, 1);
+}
+
+int lwm2m_engine_handle_set_u16(struct lwm2m_engine_res_handle *handle,
+				uint16_t value)
+{
+	return lwm2m_engine_handle_set(handle, &value, 2);
+}
+
+int lwm2m_engine_handle_set_u32(struct lwm2m_engine_res_handle *handle,
+				uint32_t value)
+{
+	return lwm2m_engine_handle_set(handle, &value, 4);
+}
+
+int lwm2m_engine_handle_set_u64(struct lwm2m_engine_res_handle *handle,
+				uint64_t value)
+{
+	return lwm2m_engine_handle_set(handle, &value, 8);
+}
+
+int lwm2m_engine_handle_set_s8(struct lwm2m_engine_res_handle *handle,
+			       int8_t value)
+{
+	return lwm2m_engine_handle_set(handle, &value, 1);
+}
+
+int lwm2m_engine_handle_set_s16(struct lwm2m_engine_res_handle *handle,
+				int16_t value)
+{
+	return lwm2m_engine_handle_set(handle, &value, 2);
+}
+
+int lwm2m_engine_handle_set_s32(struct lwm2m_engine_res_handle *handle,
+				int32_t value)
+{
+	return lwm2m_engine_handle_set(handle, &value, 4);
+}
+
+int lwm2m_engine_handle_set_s64(struct lwm2m_engine_res_handle *handle,
+				int64_t value)
+{
+	return lwm2m_engine_handle_set(handle, &value, 8);
+}
+
+int lwm2m_engine_handle_set_bool(struct lwm2m_engine_res_handle *handle,
+				 bool value)
+{
+	uint8_t temp = (value != 0 ? 1 : 0);
+
+	return lwm2m_engine_handle_set(handle, &temp, 1);
+}
+
+int lwm2m_engine_handle_set_float32(struct lwm2m_engine_res_handle *handle,
+				    float32_value_t *value)
+{
+	return lwm2m_engine_handle_set(handle, value, sizeof(float32_value_t));
+}
+
+int lwm2m_engine_handle_set_float64(struct lwm2m_engine_res_handle *handle,
+				    float64_value_t *value)
+{
+	return lwm2m_engine_handle_set(handle, value, sizeof(float64_value_t));
+}
+
+int lwm2m_engine_handle_set_objlnk(struct lwm2m_engine_res_handle *handle,
+				   struct lwm2m_objlnk *value)
+{
+	return lwm2m_engine_handle_set(handle, value, sizeof(struct lwm2m_objlnk));
+}
+
 /* user data getter functions */
 
 int lwm2m_engine_get_res_data(char *pathstr, void **data_ptr, uint16_t *data_len,
@@ -1951,6 +2428,7 @@ int lwm2m_engine_delete_res_inst(char *pathstr)
 	res_inst->max_data_len = 0U;
 	res_inst->data_len = 0U;
 	res_inst->res_inst_id = RES_INSTANCE_NOT_CREATED;
+	engine_generation++;
 
 	return 0;
 }
@@ -2764,6 +3242,7 @@ static int lwm2m_write_attr_handler(struct lwm2m_engine_obj *obj,
 			nattrs.pmin, MAX(nattrs.pmin, nattrs.pmax));
 		obs->min_period_sec = (uint32_t)nattrs.pmin;
 		obs->max_period_sec = (uint32_t)MAX(nattrs.pmin, nattrs.pmax);
+		observer_schedule(obs);
 		(void)memset(&nattrs, 0, sizeof(nattrs));
 	}
 
@@ -2830,6 +3309,11 @@ static int do_read_op(struct lwm2m_message *msg, uint16_t content_format)
 		return do_read_op_json(msg, content_format);
 #endif
 
+#if defined(CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT)
+	case LWM2M_FORMAT_APP_SENML_CBOR:
+		return do_read_op_senml_cbor(msg, content_format);
+#endif
+
 	default:
 		LOG_ERR("Unsupported content-format: %u", content_format);
 		return -ENOMSG;
@@ -3233,6 +3717,11 @@ static int do_write_op(struct lwm2m_message *msg,
 		return do_write_op_json(msg);
 #endif
 
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+	case LWM2M_FORMAT_APP_SENML_CBOR:
+		return do_write_op_senml_cbor(msg);
+#endif
+
 	default:
 		LOG_ERR("Unsupported format: %u", format);
 		return -ENOMSG;
@@ -3966,34 +4455,55 @@ cleanup:
 	return ret;
 }
 
+/* Called with engine_service_lock held */
+static void service_insert(struct service_node *srv)
+{
+	struct service_node *iter;
+	sys_snode_t *prev = NULL;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&engine_service_list, iter, node) {
+		if (SERVICE_DUE(iter) > SERVICE_DUE(srv)) {
+			break;
+		}
+
+		prev = &iter->node;
+	}
+
+	if (prev) {
+		sys_slist_insert(&engine_service_list, prev, &srv->node);
+	} else {
+		sys_slist_prepend(&engine_service_list, &srv->node);
+	}
+}
+
 int32_t engine_next_service_timeout_ms(uint32_t max_timeout)
 {
 	struct service_node *srv;
-	uint64_t time_left_ms, timestamp = k_uptime_get();
-	uint32_t timeout = max_timeout;
+	int64_t due, timestamp = k_uptime_get();
+	k_spinlock_key_t key;
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&engine_service_list, srv, node) {
-		time_left_ms = srv->last_timestamp + srv->min_call_period;
+	key = k_spin_lock(&engine_service_lock);
+	srv = SYS_SLIST_PEEK_HEAD_CONTAINER(&engine_service_list, srv, node);
+	due = srv ? SERVICE_DUE(srv) : INT64_MAX;
+	k_spin_unlock(&engine_service_lock, key);
 
-		/* service is due */
-		if (time_left_ms < timestamp) {
-			return 0;
-		}
+	due = MIN(due, observer_next_deadline());
 
-		/* service timeout is less than the current timeout */
-		time_left_ms -= timestamp;
-		if (time_left_ms < timeout) {
-			timeout = time_left_ms;
-		}
+	/* something is due */
+	if (due <= timestamp) {
+		return 0;
 	}
 
-	return timeout;
+	return (int32_t)MIN(due - timestamp, (int64_t)max_timeout);
 }
 
 int lwm2m_engine_add_service(k_work_handler_t service, uint32_t period_ms)
 {
+	k_spinlock_key_t key;
 	int i;
 
+	key = k_spin_lock(&engine_service_lock);
+
 	/* find an unused service index node */
 	for (i = 0; i < MAX_PERIODIC_SERVICE; i++) {
 		if (!service_node_data[i].service_work) {
@@ -4002,6 +4512,7 @@ int lwm2m_engine_add_service(k_work_handler_t service, uint32_t period_ms)
 	}
 
 	if (i == MAX_PERIODIC_SERVICE) {
+		k_spin_unlock(&engine_service_lock, key);
 		return -ENOMEM;
 	}
 
@@ -4009,61 +4520,129 @@ int lwm2m_engine_add_service(k_work_handler_t service, uint32_t period_ms)
 	service_node_data[i].min_call_period = period_ms;
 	service_node_data[i].last_timestamp = 0U;
 
-	sys_slist_append(&engine_service_list,
-			 &service_node_data[i].node);
+	service_insert(&service_node_data[i]);
+
+	k_spin_unlock(&engine_service_lock, key);
 
 	return 0;
 }
 
-static int lwm2m_engine_service(void)
+static bool observer_ctx_notified(struct observe_node **list, int count,
+				  struct lwm2m_ctx *ctx)
+{
+	for (int i = 0; i < count; i++) {
+		if (list[i] && list[i]->ctx == ctx) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void engine_notify_due(int64_t timestamp)
 {
+	static struct observe_node *due[CONFIG_LWM2M_ENGINE_MAX_OBSERVER];
 	struct observe_node *obs;
-	struct service_node *srv;
-	int64_t timestamp, service_due_timestamp;
+	int count, ndue = 0;
+	bool manual;
+	int i;
 
 	/*
-	 * 1. scan the observer list
-	 * 2. For each notify event found, scan the observer list
-	 * 3. For each observer match, generate a NOTIFY message,
-	 *    attaching the notify response handler
+	 * Collect observers due now, plus those due within the coalescing
+	 * window so their notification can go out in the same wakeup as
+	 * others for the same server.
 	 */
-	timestamp = k_uptime_get();
-	SYS_SLIST_FOR_EACH_CONTAINER(&engine_observer_list, obs, node) {
+	count = observer_collect(timestamp +
+				 CONFIG_LWM2M_ENGINE_NOTIFY_COALESCE_MS,
+				 due, ARRAY_SIZE(due));
+
+	/* move observers which are due now to the front */
+	for (i = 0; i < count; i++) {
+		if (due[i]->deadline <= timestamp) {
+			obs = due[ndue];
+			due[ndue++] = due[i];
+			due[i] = obs;
+		}
+	}
+
+	/*
+	 * Early observers only qualify if a notification goes to the same
+	 * server anyway and sending now does not violate pmin, i.e. they are
+	 * waiting for pmax rather than for pmin to expire.
+	 */
+	for (i = ndue; i < count; i++) {
+		obs = due[i];
+		if (obs->event_timestamp > obs->last_timestamp ||
+		    timestamp < obs->last_timestamp +
+				MSEC_PER_SEC * obs->min_period_sec ||
+		    !observer_ctx_notified(due, ndue, obs->ctx)) {
+			due[i] = NULL;
+		}
+	}
+
+	for (i = 0; i < count; i++) {
+		obs = due[i];
+		if (!obs) {
+			continue;
+		}
+
+		/* not connected to a server: check again later instead of
+		 * staying due and waking the engine up immediately
+		 */
+		if (!obs->ctx) {
+			observer_defer(obs, timestamp +
+					    ENGINE_UPDATE_INTERVAL_MS);
+			continue;
+		}
+
 		/*
 		 * manual notify requirements:
 		 * - event_timestamp > last_timestamp
-		 * - current timestamp > last_timestamp + min_period_sec
+		 * - current timestamp >= last_timestamp + min_period_sec
+		 * otherwise this is an automatic time-based notify (pmax)
 		 */
-		if (obs->event_timestamp > obs->last_timestamp &&
-		    timestamp > obs->last_timestamp +
-				MSEC_PER_SEC * obs->min_period_sec) {
-			obs->last_timestamp = k_uptime_get();
-			generate_notify_message(obs, true);
+		manual = obs->event_timestamp > obs->last_timestamp;
+		obs->last_timestamp = k_uptime_get();
+		observer_schedule(obs);
+		generate_notify_message(obs, manual);
+	}
+}
 
-		/*
-		 * automatic time-based notify requirements:
-		 * - current timestamp > last_timestamp + max_period_sec
-		 */
-		} else if (timestamp > obs->last_timestamp +
-				MSEC_PER_SEC * obs->max_period_sec) {
-			obs->last_timestamp = k_uptime_get();
-			generate_notify_message(obs, false);
-		}
+static int lwm2m_engine_service(void)
+{
+	struct service_node *srv;
+	sys_slist_t due_list;
+	k_spinlock_key_t key;
+	k_work_handler_t work;
+	int64_t timestamp;
 
-	}
+	/* notify observers whose pmin/pmax deadline has expired */
+	engine_notify_due(k_uptime_get());
 
+	/* services are sorted by due time: take the expired head entries */
+	sys_slist_init(&due_list);
 	timestamp = k_uptime_get();
-	SYS_SLIST_FOR_EACH_CONTAINER(&engine_service_list, srv, node) {
-		service_due_timestamp = srv->last_timestamp +
-					srv->min_call_period;
-		/* service is due */
-		if (timestamp >= service_due_timestamp) {
-			srv->last_timestamp = k_uptime_get();
-			srv->service_work(NULL);
-		}
+	key = k_spin_lock(&engine_service_lock);
+	while ((srv = SYS_SLIST_PEEK_HEAD_CONTAINER(&engine_service_list,
+						    srv, node)) &&
+	       timestamp >= SERVICE_DUE(srv)) {
+		(void)sys_slist_get_not_empty(&engine_service_list);
+		sys_slist_append(&due_list, &srv->node);
+	}
+	k_spin_unlock(&engine_service_lock, key);
+
+	while ((srv = SYS_SLIST_CONTAINER(sys_slist_get(&due_list),
+					  srv, node))) {
+		key = k_spin_lock(&engine_service_lock);
+		srv->last_timestamp = k_uptime_get();
+		work = srv->service_work;
+		service_insert(srv);
+		k_spin_unlock(&engine_service_lock, key);
+
+		work(NULL);
 	}
 
-	/* calculate how long to sleep till the next service */
+	/* calculate how long to sleep till the next deadline */
 	return engine_next_service_timeout_ms(ENGINE_UPDATE_INTERVAL_MS);
 }
 
@@ -4084,6 +4663,7 @@ int lwm2m_engine_context_close(struct lwm2m_ctx *client_ctx)
 		if (obs->ctx == client_ctx) {
 			sys_slist_remove(&engine_observer_list, prev_node,
 					 &obs->node);
+			observer_unschedule(obs);
 			(void)memset(obs, 0, sizeof(*obs));
 		} else {
 			prev_node = &obs->node;
@@ -18,6 +18,7 @@
 #define LWM2M_FORMAT_APP_OCTET_STREAM	42
 #define LWM2M_FORMAT_APP_EXI		47
 #define LWM2M_FORMAT_APP_JSON		50
+#define LWM2M_FORMAT_APP_SENML_CBOR	112
 #define LWM2M_FORMAT_OMA_PLAIN_TEXT	1541
 #define LWM2M_FORMAT_OMA_OLD_TLV	1542
 #define LWM2M_FORMAT_OMA_OLD_JSON	1543
@@ -58,6 +59,10 @@ void lwm2m_register_obj(struct lwm2m_engine_obj *obj);
 void lwm2m_unregister_obj(struct lwm2m_engine_obj *obj);
 struct lwm2m_engine_obj_field *
 lwm2m_get_engine_obj_field(struct lwm2m_engine_obj *obj, int res_id);
+struct lwm2m_engine_res *
+lwm2m_get_engine_res(struct lwm2m_engine_obj_inst *obj_inst, int res_id);
+struct lwm2m_engine_res_inst *
+lwm2m_get_engine_res_inst(struct lwm2m_engine_res *res, int res_inst_id);
 int  lwm2m_create_obj_inst(uint16_t obj_id, uint16_t obj_inst_id,
 			   struct lwm2m_engine_obj_inst **obj_inst);
 int  lwm2m_delete_obj_inst(uint16_t obj_id, uint16_t obj_inst_id);
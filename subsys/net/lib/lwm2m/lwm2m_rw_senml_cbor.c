@@ -0,0 +1,1221 @@
+/*
+ * Copyright (c) 2020 Foundries.io
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * SenML CBOR (RFC 8428, content format 112) reader / writer.
+ *
+ * The writer encodes records directly into the outgoing CoAP packet: the
+ * record array is opened with a 16-bit length placeholder which put_end()
+ * patches, and names are formatted in place, so no payload data is ever
+ * staged or moved.  The first record carries the base name, every record
+ * carries a relative name and one value.
+ *
+ * The reader walks the incoming payload once, accepting both definite
+ * and indefinite length arrays / maps, and hands each record with a value
+ * to lwm2m_write_handler().
+ */
+
+#define LOG_MODULE_NAME net_lwm2m_senml_cbor
+#define LOG_LEVEL CONFIG_LWM2M_LOG_LEVEL
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(LOG_MODULE_NAME);
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <sys/byteorder.h>
+
+#include "lwm2m_object.h"
+#include "lwm2m_rw_senml_cbor.h"
+#include "lwm2m_engine.h"
+#include "lwm2m_util.h"
+
+/* CBOR major types (RFC 7049, section 2.1) */
+#define CBOR_UINT		0x00
+#define CBOR_NINT		0x20
+#define CBOR_BSTR		0x40
+#define CBOR_TSTR		0x60
+#define CBOR_ARRAY		0x80
+#define CBOR_MAP		0xa0
+#define CBOR_TAG		0xc0
+#define CBOR_SIMPLE		0xe0
+
+#define CBOR_MAJOR_MASK		0xe0
+#define CBOR_INFO_MASK		0x1f
+
+#define CBOR_INFO_U8		24
+#define CBOR_INFO_U16		25
+#define CBOR_INFO_U32		26
+#define CBOR_INFO_U64		27
+#define CBOR_INFO_INDEF		31
+
+#define CBOR_FALSE		(CBOR_SIMPLE | 20)
+#define CBOR_TRUE		(CBOR_SIMPLE | 21)
+#define CBOR_FLOAT16		(CBOR_SIMPLE | CBOR_INFO_U16)
+#define CBOR_FLOAT32		(CBOR_SIMPLE | CBOR_INFO_U32)
+#define CBOR_FLOAT64		(CBOR_SIMPLE | CBOR_INFO_U64)
+#define CBOR_BREAK		0xff
+
+/* SenML labels (RFC 8428, table 6) */
+#define SENML_BN		-2
+#define SENML_N			0
+#define SENML_V			2
+#define SENML_VS		3
+#define SENML_VB		4
+#define SENML_VD		8
+/* LwM2M object link value, encoded as a text label */
+#define SENML_VLO		"vlo"
+/* internal markers for text labels */
+#define SENML_VLO_LABEL		(INT32_MIN + 1)
+#define SENML_UNKNOWN		INT32_MIN
+
+/* "65535/65535/65535" or "/65535/65535/" fit in a one byte text head */
+#define SENML_NAME_MAX_LEN	23
+/* nesting allowed when skipping unknown values */
+#define CBOR_SKIP_DEPTH		4
+
+struct cbor_out_formatter_data {
+	/* offset of the record array head */
+	uint16_t mark_pos;
+
+	/* records written so far */
+	uint16_t count;
+
+	/* flags */
+	uint8_t writer_flags;
+
+	/* path storage */
+	uint8_t path_level;
+};
+
+struct cbor_in_formatter_data {
+	/* head of the value item of the current record */
+	uint16_t value_offset;
+};
+
+static const uint8_t label_v[] = { CBOR_UINT | SENML_V };
+static const uint8_t label_vs[] = { CBOR_UINT | SENML_VS };
+static const uint8_t label_vb[] = { CBOR_UINT | SENML_VB };
+static const uint8_t label_vd[] = { CBOR_UINT | SENML_VD };
+static const uint8_t label_vlo[] = {
+	CBOR_TSTR | (sizeof(SENML_VLO) - 1), 'v', 'l', 'o'
+};
+
+static int cbor_put_u8(struct lwm2m_output_context *out, uint8_t value)
+{
+	return buf_append(CPKT_BUF_WRITE(out->out_cpkt), &value, 1);
+}
+
+static int cbor_put_head(struct lwm2m_output_context *out, uint8_t major,
+			 uint64_t value)
+{
+	uint8_t head[9];
+	uint16_t len;
+
+	if (value < CBOR_INFO_U8) {
+		head[0] = major | (uint8_t)value;
+		len = 1U;
+	} else if (value <= UINT8_MAX) {
+		head[0] = major | CBOR_INFO_U8;
+		head[1] = (uint8_t)value;
+		len = 2U;
+	} else if (value <= UINT16_MAX) {
+		head[0] = major | CBOR_INFO_U16;
+		sys_put_be16((uint16_t)value, &head[1]);
+		len = 3U;
+	} else if (value <= UINT32_MAX) {
+		head[0] = major | CBOR_INFO_U32;
+		sys_put_be32((uint32_t)value, &head[1]);
+		len = 5U;
+	} else {
+		head[0] = major | CBOR_INFO_U64;
+		sys_put_be64(value, &head[1]);
+		len = 9U;
+	}
+
+	return buf_append(CPKT_BUF_WRITE(out->out_cpkt), head, len);
+}
+
+static int cbor_put_int(struct lwm2m_output_context *out, int64_t value)
+{
+	if (value < 0) {
+		return cbor_put_head(out, CBOR_NINT, (uint64_t)(-1 - value));
+	}
+
+	return cbor_put_head(out, CBOR_UINT, (uint64_t)value);
+}
+
+static int cbor_put_str(struct lwm2m_output_context *out, uint8_t major,
+			const uint8_t *buf, size_t buflen)
+{
+	int ret;
+
+	if (buflen > UINT16_MAX) {
+		return -ENOMEM;
+	}
+
+	ret = cbor_put_head(out, major, buflen);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return buf_append(CPKT_BUF_WRITE(out->out_cpkt), (uint8_t *)buf,
+			  (uint16_t)buflen);
+}
+
+/*
+ * Format a list of ids separated by sep as a text string, straight into
+ * the packet buffer.  If enclose is set the string also starts and ends
+ * with sep ("/3303/0/").
+ */
+static int cbor_put_ids(struct lwm2m_output_context *out,
+			const uint16_t *ids, int count, char sep, bool enclose)
+{
+	struct coap_packet *cpkt = out->out_cpkt;
+	uint8_t *start, *p;
+	char digits[5];
+	int i, n;
+
+	/* head + count * (5 digits + separator) + leading separator */
+	if (cpkt->offset + 2 + count * 6 > cpkt->max_len) {
+		return -ENOMEM;
+	}
+
+	start = cpkt->data + cpkt->offset;
+	p = start + 1;
+
+	if (enclose) {
+		*p++ = sep;
+	}
+
+	for (i = 0; i < count; i++) {
+		uint16_t v = ids[i];
+
+		if (i > 0) {
+			*p++ = sep;
+		}
+
+		n = 0;
+		do {
+			digits[n++] = '0' + v % 10U;
+			v /= 10U;
+		} while (v);
+
+		/* most significant digit first */
+		while (n > 0) {
+			*p++ = digits[--n];
+		}
+	}
+
+	if (enclose) {
+		*p++ = sep;
+	}
+
+	*start = CBOR_TSTR | (uint8_t)(p - start - 1);
+	cpkt->offset += p - start;
+
+	return 0;
+}
+
+/*
+ * Open a record: map head, base name on the first record, relative name
+ * and the (pre-encoded) value label.  The caller appends the value.
+ */
+static int put_record_prefix(struct lwm2m_output_context *out,
+			     struct cbor_out_formatter_data *fd,
+			     struct lwm2m_obj_path *path,
+			     const uint8_t *label, uint16_t label_len)
+{
+	uint16_t ids[3];
+	int count = 0;
+	int ret;
+
+	ret = cbor_put_u8(out, CBOR_MAP | (fd->count == 0U ? 3 : 2));
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (fd->count == 0U) {
+		ids[count++] = path->obj_id;
+		if (fd->path_level >= 2U) {
+			ids[count++] = path->obj_inst_id;
+		}
+
+		ret = cbor_put_u8(out, CBOR_NINT | (uint8_t)(-1 - SENML_BN));
+		if (ret < 0) {
+			return ret;
+		}
+
+		ret = cbor_put_ids(out, ids, count, '/', true);
+		if (ret < 0) {
+			return ret;
+		}
+
+		count = 0;
+	}
+
+	if (fd->path_level < 2U) {
+		ids[count++] = path->obj_inst_id;
+	}
+
+	ids[count++] = path->res_id;
+	if (fd->writer_flags & WRITER_RESOURCE_INSTANCE) {
+		ids[count++] = path->res_inst_id;
+	}
+
+	ret = cbor_put_u8(out, CBOR_UINT | SENML_N);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = cbor_put_ids(out, ids, count, '/', false);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return buf_append(CPKT_BUF_WRITE(out->out_cpkt), (uint8_t *)label,
+			  label_len);
+}
+
+/* Close a record, or drop it entirely if it did not fit */
+static size_t put_record_end(struct lwm2m_output_context *out,
+			     struct cbor_out_formatter_data *fd,
+			     uint16_t start, int ret)
+{
+	if (ret < 0) {
+		LOG_ERR("Unable to encode record (err:%d)", ret);
+		out->out_cpkt->offset = start;
+		return 0;
+	}
+
+	fd->count++;
+	return out->out_cpkt->offset - start;
+}
+
+static size_t put_begin(struct lwm2m_output_context *out,
+			struct lwm2m_obj_path *path)
+{
+	struct cbor_out_formatter_data *fd;
+	uint8_t head[3] = { CBOR_ARRAY | CBOR_INFO_U16, 0, 0 };
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	/* record count is patched in put_end() */
+	fd->mark_pos = out->out_cpkt->offset;
+	fd->count = 0U;
+
+	if (buf_append(CPKT_BUF_WRITE(out->out_cpkt), head,
+		       sizeof(head)) < 0) {
+		return 0;
+	}
+
+	return sizeof(head);
+}
+
+static size_t put_end(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path)
+{
+	struct cbor_out_formatter_data *fd;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	sys_put_be16(fd->count, out->out_cpkt->data + fd->mark_pos + 1);
+	return 0;
+}
+
+static size_t put_begin_ri(struct lwm2m_output_context *out,
+			   struct lwm2m_obj_path *path)
+{
+	struct cbor_out_formatter_data *fd;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	fd->writer_flags |= WRITER_RESOURCE_INSTANCE;
+	return 0;
+}
+
+static size_t put_end_ri(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path)
+{
+	struct cbor_out_formatter_data *fd;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	fd->writer_flags &= ~WRITER_RESOURCE_INSTANCE;
+	return 0;
+}
+
+static size_t put_s64(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, int64_t value)
+{
+	struct cbor_out_formatter_data *fd;
+	uint16_t start = out->out_cpkt->offset;
+	int ret;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	ret = put_record_prefix(out, fd, path, label_v, sizeof(label_v));
+	if (ret == 0) {
+		ret = cbor_put_int(out, value);
+	}
+
+	return put_record_end(out, fd, start, ret);
+}
+
+static size_t put_s32(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, int32_t value)
+{
+	return put_s64(out, path, (int64_t)value);
+}
+
+static size_t put_s16(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, int16_t value)
+{
+	return put_s64(out, path, (int64_t)value);
+}
+
+static size_t put_s8(struct lwm2m_output_context *out,
+		     struct lwm2m_obj_path *path, int8_t value)
+{
+	return put_s64(out, path, (int64_t)value);
+}
+
+static size_t put_str_value(struct lwm2m_output_context *out,
+			    struct lwm2m_obj_path *path,
+			    const uint8_t *label, uint8_t major,
+			    char *buf, size_t buflen)
+{
+	struct cbor_out_formatter_data *fd;
+	uint16_t start = out->out_cpkt->offset;
+	int ret;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	ret = put_record_prefix(out, fd, path, label, 1U);
+	if (ret == 0) {
+		ret = cbor_put_str(out, major, (uint8_t *)buf, buflen);
+	}
+
+	return put_record_end(out, fd, start, ret);
+}
+
+static size_t put_string(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path,
+			 char *buf, size_t buflen)
+{
+	return put_str_value(out, path, label_vs, CBOR_TSTR, buf, buflen);
+}
+
+static size_t put_opaque(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path,
+			 char *buf, size_t buflen)
+{
+	return put_str_value(out, path, label_vd, CBOR_BSTR, buf, buflen);
+}
+
+/* Reserve the float head and let the binary converter fill it in place */
+static size_t put_float(struct lwm2m_output_context *out,
+			struct lwm2m_obj_path *path,
+			void *value, bool is_f64)
+{
+	struct cbor_out_formatter_data *fd;
+	struct coap_packet *cpkt = out->out_cpkt;
+	uint16_t start = cpkt->offset;
+	uint16_t len = is_f64 ? 8U : 4U;
+	uint8_t *data;
+	int ret;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	ret = put_record_prefix(out, fd, path, label_v, sizeof(label_v));
+	if (ret == 0 && cpkt->offset + 1 + len > cpkt->max_len) {
+		ret = -ENOMEM;
+	}
+
+	if (ret == 0) {
+		data = cpkt->data + cpkt->offset;
+		if (is_f64) {
+			data[0] = CBOR_FLOAT64;
+			ret = lwm2m_f64_to_b64(value, &data[1], len);
+		} else {
+			data[0] = CBOR_FLOAT32;
+			ret = lwm2m_f32_to_b32(value, &data[1], len);
+		}
+
+		cpkt->offset += 1 + len;
+	}
+
+	return put_record_end(out, fd, start, ret);
+}
+
+static size_t put_float32fix(struct lwm2m_output_context *out,
+			     struct lwm2m_obj_path *path,
+			     float32_value_t *value)
+{
+	return put_float(out, path, value, false);
+}
+
+static size_t put_float64fix(struct lwm2m_output_context *out,
+			     struct lwm2m_obj_path *path,
+			     float64_value_t *value)
+{
+	return put_float(out, path, value, true);
+}
+
+static size_t put_bool(struct lwm2m_output_context *out,
+		       struct lwm2m_obj_path *path,
+		       bool value)
+{
+	struct cbor_out_formatter_data *fd;
+	uint16_t start = out->out_cpkt->offset;
+	int ret;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	ret = put_record_prefix(out, fd, path, label_vb, sizeof(label_vb));
+	if (ret == 0) {
+		ret = cbor_put_u8(out, value ? CBOR_TRUE : CBOR_FALSE);
+	}
+
+	return put_record_end(out, fd, start, ret);
+}
+
+static size_t put_objlnk(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path,
+			 struct lwm2m_objlnk *value)
+{
+	struct cbor_out_formatter_data *fd;
+	uint16_t start = out->out_cpkt->offset;
+	uint16_t ids[2] = { value->obj_id, value->obj_inst };
+	int ret;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	ret = put_record_prefix(out, fd, path, label_vlo, sizeof(label_vlo));
+	if (ret == 0) {
+		ret = cbor_put_ids(out, ids, ARRAY_SIZE(ids), ':', false);
+	}
+
+	return put_record_end(out, fd, start, ret);
+}
+
+/*
+ * Decode the head of the data item at *offset.  For major type 7 the
+ * argument holds the raw bits of a float.  Returns 1 for an indefinite
+ * length item, 0 otherwise and a negative error code on failure.
+ */
+static int cbor_get_head(struct lwm2m_input_context *in, uint16_t *offset,
+			 uint8_t *major, uint64_t *value)
+{
+	uint8_t *data = in->in_cpkt->data;
+	uint16_t len = in->in_cpkt->max_len;
+	uint8_t info, size;
+	uint8_t ib;
+
+	if (buf_read_u8(&ib, data, len, offset) < 0) {
+		return -ENODATA;
+	}
+
+	*major = ib & CBOR_MAJOR_MASK;
+	info = ib & CBOR_INFO_MASK;
+
+	if (info < CBOR_INFO_U8) {
+		*value = info;
+		return 0;
+	}
+
+	if (info == CBOR_INFO_INDEF) {
+		*value = 0U;
+		return 1;
+	}
+
+	if (info > CBOR_INFO_U64) {
+		return -EINVAL;
+	}
+
+	size = BIT(info - CBOR_INFO_U8);
+	if (*offset + size > len) {
+		return -ENODATA;
+	}
+
+	switch (size) {
+	case 1:
+		*value = data[*offset];
+		break;
+	case 2:
+		*value = sys_get_be16(&data[*offset]);
+		break;
+	case 4:
+		*value = sys_get_be32(&data[*offset]);
+		break;
+	default:
+		*value = sys_get_be64(&data[*offset]);
+		break;
+	}
+
+	*offset += size;
+	return 0;
+}
+
+static bool cbor_at_break(struct lwm2m_input_context *in, uint16_t *offset)
+{
+	if (*offset < in->in_cpkt->max_len &&
+	    in->in_cpkt->data[*offset] == CBOR_BREAK) {
+		*offset += 1U;
+		return true;
+	}
+
+	return false;
+}
+
+/* Skip over one complete data item, nested at most depth levels deep */
+static int cbor_skip(struct lwm2m_input_context *in, uint16_t *offset,
+		     int depth)
+{
+	uint64_t value, count;
+	uint8_t major;
+	int ret, indef;
+
+	/* a tag only prefixes the item that follows it, so walk over a
+	 * run of tags here rather than recursing once per tag
+	 */
+	do {
+		indef = cbor_get_head(in, offset, &major, &value);
+		if (indef < 0) {
+			return indef;
+		}
+	} while (major == CBOR_TAG);
+
+	switch (major) {
+	case CBOR_BSTR:
+	case CBOR_TSTR:
+		if (indef || value > UINT16_MAX) {
+			/* chunked strings are not used by SenML */
+			return -ENOTSUP;
+		}
+
+		return buf_skip((uint16_t)value, CPKT_BUF_READ(in->in_cpkt),
+				offset);
+
+	case CBOR_ARRAY:
+	case CBOR_MAP:
+		if (depth == 0) {
+			return -E2BIG;
+		}
+
+		count = (major == CBOR_MAP) ? value * 2U : value;
+		while (indef ? !cbor_at_break(in, offset) : count--) {
+			ret = cbor_skip(in, offset, depth - 1);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+
+		return 0;
+
+	default:
+		return 0;
+	}
+}
+
+/* Convert the bits of an IEEE 754 half to binary32 */
+static uint32_t half_to_b32(uint16_t half)
+{
+	uint32_t sign = (uint32_t)(half & 0x8000U) << 16;
+	uint32_t exp = (half >> 10) & 0x1fU;
+	uint32_t mant = half & 0x3ffU;
+
+	if (exp == 0U) {
+		if (mant == 0U) {
+			return sign;
+		}
+
+		/* subnormal: normalize the mantissa */
+		exp = 127U - 15U + 1U;
+		while (!(mant & 0x400U)) {
+			mant <<= 1;
+			exp--;
+		}
+
+		return sign | (exp << 23) | ((mant & 0x3ffU) << 13);
+	}
+
+	if (exp == 0x1fU) {
+		return sign | 0x7f800000U | (mant << 13);
+	}
+
+	return sign | ((exp + 127U - 15U) << 23) | (mant << 13);
+}
+
+static int get_value_head(struct lwm2m_input_context *in, uint16_t *offset,
+			  uint8_t *major, uint64_t *value)
+{
+	struct cbor_in_formatter_data *fd;
+
+	fd = engine_get_in_user_data(in);
+	if (!fd) {
+		return -EINVAL;
+	}
+
+	*offset = fd->value_offset;
+	return cbor_get_head(in, offset, major, value);
+}
+
+/*
+ * Decode the numeric value of the current record.  Returns the number of
+ * bytes used or a negative error code, -ERANGE for integers that do not fit
+ * in an int64_t.
+ */
+static int get_number(struct lwm2m_input_context *in, float64_value_t *value)
+{
+	struct cbor_in_formatter_data *fd = engine_get_in_user_data(in);
+	float32_value_t f32;
+	uint8_t bin[8];
+	uint64_t raw;
+	uint16_t offset;
+	uint8_t major;
+	int ret;
+
+	ret = get_value_head(in, &offset, &major, &raw);
+	if (ret != 0) {
+		return ret < 0 ? ret : -EINVAL;
+	}
+
+	switch (major) {
+	case CBOR_UINT:
+	case CBOR_NINT:
+		/* -1 - raw only fits for raw <= INT64_MAX as well */
+		if (raw > INT64_MAX) {
+			return -ERANGE;
+		}
+
+		value->val1 = (major == CBOR_UINT) ? (int64_t)raw :
+			      -1 - (int64_t)raw;
+		value->val2 = 0;
+		break;
+
+	case CBOR_SIMPLE:
+		/* argument size tells the float width */
+		switch (offset - fd->value_offset - 1) {
+		case 8:
+			sys_put_be64(raw, bin);
+			ret = lwm2m_b64_to_f64(bin, 8, value);
+			break;
+		case 4:
+		case 2:
+			if (offset - fd->value_offset - 1 == 2) {
+				raw = half_to_b32((uint16_t)raw);
+			}
+
+			sys_put_be32((uint32_t)raw, bin);
+			ret = lwm2m_b32_to_f32(bin, 4, &f32);
+			value->val1 = f32.val1;
+			value->val2 = (int64_t)f32.val2 *
+				(LWM2M_FLOAT64_DEC_MAX / LWM2M_FLOAT32_DEC_MAX);
+			break;
+		default:
+			ret = -EINVAL;
+			break;
+		}
+
+		if (ret < 0) {
+			return ret;
+		}
+
+		break;
+
+	default:
+		return -EINVAL;
+	}
+
+	return offset - fd->value_offset;
+}
+
+static size_t get_float64fix(struct lwm2m_input_context *in,
+			     float64_value_t *value)
+{
+	int ret;
+
+	ret = get_number(in, value);
+	if (ret < 0) {
+		LOG_ERR("numeric value decode error: %d", ret);
+		return 0;
+	}
+
+	return ret;
+}
+
+static size_t get_float32fix(struct lwm2m_input_context *in,
+			     float32_value_t *value)
+{
+	float64_value_t f64;
+	size_t len;
+
+	len = get_float64fix(in, &f64);
+	if (len > 0) {
+		value->val1 = (int32_t)f64.val1;
+		value->val2 = (int32_t)(f64.val2 /
+			(LWM2M_FLOAT64_DEC_MAX / LWM2M_FLOAT32_DEC_MAX));
+	}
+
+	return len;
+}
+
+static size_t get_s64(struct lwm2m_input_context *in, int64_t *value)
+{
+	float64_value_t f64;
+	size_t len;
+
+	/* integers, and floats truncated towards zero */
+	len = get_float64fix(in, &f64);
+	if (len > 0) {
+		*value = f64.val1;
+	}
+
+	return len;
+}
+
+static size_t get_s32(struct lwm2m_input_context *in, int32_t *value)
+{
+	int64_t tmp = 0;
+	size_t len;
+
+	len = get_s64(in, &tmp);
+	if (len > 0) {
+		*value = (int32_t)tmp;
+	}
+
+	return len;
+}
+
+static size_t get_string(struct lwm2m_input_context *in,
+			 uint8_t *buf, size_t buflen)
+{
+	uint64_t len;
+	uint16_t offset;
+	uint8_t major;
+
+	if (buflen == 0 ||
+	    get_value_head(in, &offset, &major, &len) != 0 ||
+	    (major != CBOR_TSTR && major != CBOR_BSTR)) {
+		return 0;
+	}
+
+	if (len > buflen - 1) {
+		LOG_WRN("String truncated (%u > %zu)", (uint32_t)len,
+			buflen - 1);
+		len = buflen - 1;
+	}
+
+	if (buf_read(buf, (uint16_t)len, CPKT_BUF_READ(in->in_cpkt),
+		     &offset) < 0) {
+		return 0;
+	}
+
+	buf[len] = '\0';
+	return (size_t)len;
+}
+
+static size_t get_bool(struct lwm2m_input_context *in, bool *value)
+{
+	struct cbor_in_formatter_data *fd = engine_get_in_user_data(in);
+	uint64_t raw;
+	uint16_t offset;
+	uint8_t major;
+
+	if (get_value_head(in, &offset, &major, &raw) != 0) {
+		return 0;
+	}
+
+	if (major == CBOR_SIMPLE && (raw == (CBOR_TRUE & CBOR_INFO_MASK) ||
+				     raw == (CBOR_FALSE & CBOR_INFO_MASK))) {
+		*value = (raw == (CBOR_TRUE & CBOR_INFO_MASK));
+	} else if (major == CBOR_UINT) {
+		*value = (raw != 0U);
+	} else {
+		return 0;
+	}
+
+	return offset - fd->value_offset;
+}
+
+static size_t get_opaque(struct lwm2m_input_context *in,
+			 uint8_t *value, size_t buflen,
+			 struct lwm2m_opaque_context *opaque,
+			 bool *last_block)
+{
+	uint64_t len;
+	uint16_t offset;
+	uint8_t major;
+
+	/* Get the byte string head only on first read. */
+	if (opaque->remaining == 0) {
+		if (get_value_head(in, &offset, &major, &len) != 0 ||
+		    (major != CBOR_BSTR && major != CBOR_TSTR)) {
+			return 0;
+		}
+
+		in->offset = offset;
+		opaque->len = len;
+		opaque->remaining = len;
+	}
+
+	return lwm2m_engine_get_opaque_more(in, value, buflen,
+					    opaque, last_block);
+}
+
+static size_t get_objlnk(struct lwm2m_input_context *in,
+			 struct lwm2m_objlnk *value)
+{
+	char buf[sizeof("65535:65535")];
+	unsigned long id;
+	char *end;
+	size_t len;
+
+	len = get_string(in, (uint8_t *)buf, sizeof(buf));
+	if (len == 0) {
+		return 0;
+	}
+
+	id = strtoul(buf, &end, 10);
+	if (*end != ':' || id > UINT16_MAX) {
+		return 0;
+	}
+
+	value->obj_id = (uint16_t)id;
+
+	id = strtoul(end + 1, &end, 10);
+	if (*end != '\0' || id > UINT16_MAX) {
+		return 0;
+	}
+
+	value->obj_inst = (uint16_t)id;
+
+	return len;
+}
+
+const struct lwm2m_writer senml_cbor_writer = {
+	.put_begin = put_begin,
+	.put_end = put_end,
+	.put_begin_ri = put_begin_ri,
+	.put_end_ri = put_end_ri,
+	.put_s8 = put_s8,
+	.put_s16 = put_s16,
+	.put_s32 = put_s32,
+	.put_s64 = put_s64,
+	.put_string = put_string,
+	.put_float32fix = put_float32fix,
+	.put_float64fix = put_float64fix,
+	.put_bool = put_bool,
+	.put_opaque = put_opaque,
+	.put_objlnk = put_objlnk,
+};
+
+const struct lwm2m_reader senml_cbor_reader = {
+	.get_s32 = get_s32,
+	.get_s64 = get_s64,
+	.get_string = get_string,
+	.get_float32fix = get_float32fix,
+	.get_float64fix = get_float64fix,
+	.get_bool = get_bool,
+	.get_opaque = get_opaque,
+	.get_objlnk = get_objlnk,
+};
+
+int do_read_op_senml_cbor(struct lwm2m_message *msg, int content_format)
+{
+	struct cbor_out_formatter_data fd;
+	int ret;
+
+	(void)memset(&fd, 0, sizeof(fd));
+	engine_set_out_user_data(&msg->out, &fd);
+	/* save the level for output processing */
+	fd.path_level = msg->path.level;
+	ret = lwm2m_perform_read_op(msg, content_format);
+	engine_clear_out_user_data(&msg->out);
+
+	return ret;
+}
+
+static int parse_path(const char *buf, struct lwm2m_obj_path *path)
+{
+	uint16_t *ids[] = {
+		&path->obj_id, &path->obj_inst_id,
+		&path->res_id, &path->res_inst_id
+	};
+	uint32_t val;
+	int level = 0;
+
+	(void)memset(path, 0, sizeof(*path));
+
+	if (*buf == '/') {
+		buf++;
+	}
+
+	while (*buf != '\0') {
+		if (level == ARRAY_SIZE(ids) || !isdigit((unsigned char)*buf)) {
+			return -EINVAL;
+		}
+
+		val = 0U;
+		while (isdigit((unsigned char)*buf)) {
+			val = val * 10U + (*buf++ - '0');
+			if (val > UINT16_MAX) {
+				return -EINVAL;
+			}
+		}
+
+		*ids[level++] = (uint16_t)val;
+
+		if (*buf == '/') {
+			buf++;
+		} else if (*buf != '\0') {
+			return -EINVAL;
+		}
+	}
+
+	return level;
+}
+
+/* Copy a text string item into a NUL terminated buffer */
+static int get_text(struct lwm2m_input_context *in, uint16_t *offset,
+		    char *buf, size_t buflen)
+{
+	uint64_t len;
+	uint8_t major;
+	int ret;
+
+	ret = cbor_get_head(in, offset, &major, &len);
+	if (ret != 0 || major != CBOR_TSTR || len >= buflen) {
+		return -EINVAL;
+	}
+
+	ret = buf_read(buf, (uint16_t)len, CPKT_BUF_READ(in->in_cpkt),
+		       offset);
+	if (ret < 0) {
+		return ret;
+	}
+
+	buf[len] = '\0';
+	return 0;
+}
+
+/* Decode a map key, text labels other than "vlo" are reported unknown */
+static int get_label(struct lwm2m_input_context *in, uint16_t *offset,
+		     int32_t *label)
+{
+	uint64_t value;
+	uint8_t major;
+	int ret;
+
+	ret = cbor_get_head(in, offset, &major, &value);
+	if (ret != 0) {
+		return ret < 0 ? ret : -EINVAL;
+	}
+
+	switch (major) {
+	case CBOR_UINT:
+		*label = value <= INT16_MAX ? (int32_t)value : SENML_UNKNOWN;
+		return 0;
+
+	case CBOR_NINT:
+		*label = value < INT16_MAX ? -1 - (int32_t)value :
+			 SENML_UNKNOWN;
+		return 0;
+
+	case CBOR_TSTR:
+		if (value == sizeof(SENML_VLO) - 1 &&
+		    *offset + value <= in->in_cpkt->max_len &&
+		    !memcmp(in->in_cpkt->data + *offset, SENML_VLO, value)) {
+			*label = SENML_VLO_LABEL;
+		} else {
+			*label = SENML_UNKNOWN;
+		}
+
+		return buf_skip((uint16_t)value, CPKT_BUF_READ(in->in_cpkt),
+				offset);
+
+	default:
+		return -EINVAL;
+	}
+}
+
+static int write_record(struct lwm2m_message *msg, const char *full_name)
+{
+	struct lwm2m_engine_obj_field *obj_field;
+	struct lwm2m_engine_obj_inst *obj_inst = NULL;
+	struct lwm2m_engine_res *res = NULL;
+	struct lwm2m_engine_res_inst *res_inst = NULL;
+	uint8_t created = 0U;
+	int ret;
+
+	ret = parse_path(full_name, &msg->path);
+	if (ret < 3) {
+		return -EINVAL;
+	}
+
+	msg->path.level = ret;
+
+	ret = lwm2m_get_or_create_engine_obj(msg, &obj_inst, &created);
+	if (ret < 0) {
+		return ret;
+	}
+
+	obj_field = lwm2m_get_engine_obj_field(obj_inst->obj,
+					       msg->path.res_id);
+	if (!obj_field) {
+		return -ENOENT;
+	}
+
+	if (!LWM2M_HAS_PERM(obj_field, LWM2M_PERM_W)) {
+		return -EPERM;
+	}
+
+	if (!obj_inst->resources || obj_inst->resource_count == 0U) {
+		return -EINVAL;
+	}
+
+	res = lwm2m_get_engine_res(obj_inst, msg->path.res_id);
+	if (!res) {
+		return -ENOENT;
+	}
+
+	res_inst = lwm2m_get_engine_res_inst(res, msg->path.res_inst_id);
+	if (!res_inst) {
+		return -ENOENT;
+	}
+
+	return lwm2m_write_handler(obj_inst, res, res_inst, obj_field, msg);
+}
+
+int do_write_op_senml_cbor(struct lwm2m_message *msg)
+{
+	struct lwm2m_input_context *in = &msg->in;
+	struct cbor_in_formatter_data fd;
+	struct lwm2m_obj_path orig_path;
+	char base_name[MAX_RESOURCE_LEN] = "";
+	char name[MAX_RESOURCE_LEN];
+	char full_name[MAX_RESOURCE_LEN * 2];
+	uint64_t records, entries;
+	uint16_t offset = in->offset;
+	int32_t label;
+	uint8_t major;
+	bool has_value;
+	int ret, rec_indef, map_indef;
+
+	(void)memset(&fd, 0, sizeof(fd));
+	engine_set_in_user_data(in, &fd);
+
+	/* store a copy of the original path */
+	memcpy(&orig_path, &msg->path, sizeof(msg->path));
+
+	rec_indef = cbor_get_head(in, &offset, &major, &records);
+	if (rec_indef < 0 || major != CBOR_ARRAY) {
+		LOG_ERR("Payload is not a SenML pack");
+		ret = -EINVAL;
+		goto out;
+	}
+
+	ret = 0;
+	while (rec_indef ? !cbor_at_break(in, &offset) : records--) {
+		map_indef = cbor_get_head(in, &offset, &major, &entries);
+		if (map_indef < 0 || major != CBOR_MAP) {
+			ret = -EINVAL;
+			break;
+		}
+
+		name[0] = '\0';
+		has_value = false;
+
+		while (map_indef ? !cbor_at_break(in, &offset) : entries--) {
+			ret = get_label(in, &offset, &label);
+			if (ret < 0) {
+				break;
+			}
+
+			switch (label) {
+			case SENML_BN:
+				ret = get_text(in, &offset, base_name,
+					       sizeof(base_name));
+				break;
+
+			case SENML_N:
+				ret = get_text(in, &offset, name,
+					       sizeof(name));
+				break;
+
+			case SENML_V:
+			case SENML_VS:
+			case SENML_VB:
+			case SENML_VD:
+			case SENML_VLO_LABEL:
+				fd.value_offset = offset;
+				has_value = true;
+				__fallthrough;
+
+			default:
+				ret = cbor_skip(in, &offset, CBOR_SKIP_DEPTH);
+				break;
+			}
+
+			if (ret < 0) {
+				break;
+			}
+		}
+
+		if (ret < 0) {
+			LOG_ERR("Malformed SenML record (err:%d)", ret);
+			break;
+		}
+
+		if (!has_value) {
+			continue;
+		}
+
+		snprintk(full_name, sizeof(full_name), "%s%s",
+			 base_name, name);
+
+		ret = write_record(msg, full_name);
+		if (orig_path.level >= 3U && ret < 0) {
+			/* return errors on a single write */
+			break;
+		}
+	}
+
+out:
+	engine_clear_in_user_data(in);
+
+	return ret;
+}
@@ -25,6 +25,14 @@ static void client_reset(struct mqtt_client *client)
 	client->internal.last_activity = 0U;
 	client->internal.rx_buf_datalen = 0U;
 	client->internal.remaining_payload = 0U;
+
+#if defined(CONFIG_MQTT_VERSION_5_0)
+	/* Limits of the server and topic aliases are per connection */
+	client->internal.server_receive_max = MQTT_DEFAULT_RECEIVE_MAXIMUM;
+	client->internal.server_topic_alias_max = 0U;
+	client->internal.server_max_packet_size = 0U;
+	client->internal.topic_alias_count = 0U;
+#endif
 }
 
 /** @brief Initialize tx buffer. */
@@ -167,6 +175,24 @@ static int client_write_msg(struct mqtt_client *client,
 	return 0;
 }
 
+static int client_flush(struct mqtt_client *client)
+{
+	int err_code;
+
+	if (!MQTT_HAS_STATE(client, MQTT_STATE_CONNECTED)) {
+		return 0;
+	}
+
+	err_code = mqtt_queue_flush(client);
+	if (err_code < 0) {
+		MQTT_TRC("Queue flush failed, err_code = %d, "
+			 "closing connection", err_code);
+		client_disconnect(client, err_code, true);
+	}
+
+	return err_code;
+}
+
 void mqtt_client_init(struct mqtt_client *client)
 {
 	NULL_PARAM_CHECK_VOID(client);
@@ -215,6 +241,12 @@ int mqtt_connect(struct mqtt_client *client)
 		goto error;
 	}
 
+	if (client->protocol_version == MQTT_VERSION_5_0 &&
+	    !IS_ENABLED(CONFIG_MQTT_VERSION_5_0)) {
+		err_code = -ENOTSUP;
+		goto error;
+	}
+
 	err_code = client_connect(client);
 
 error:
@@ -236,6 +268,59 @@ static int verify_tx_state(const struct mqtt_client *client)
 	return 0;
 }
 
+#if defined(CONFIG_MQTT_VERSION_5_0)
+/** @brief Get the topic alias for a topic.
+ *
+ *  @param[out] known True if the server knows the alias already, otherwise
+ *                    the alias is assigned by the message being sent.
+ *
+ *  @return Topic alias, or 0 if the topic has no alias.
+ */
+static uint16_t topic_alias_get(const struct mqtt_client *client,
+				const struct mqtt_utf8 *topic, bool *known)
+{
+	uint16_t max = MIN(client->internal.server_topic_alias_max,
+			   CONFIG_MQTT_TOPIC_ALIAS_MAX);
+	uint8_t i;
+
+	*known = false;
+
+	if (!mqtt_is_version_5_0(client)) {
+		return 0U;
+	}
+
+	for (i = 0U; i < client->internal.topic_alias_count; i++) {
+		if (client->internal.topic_alias[i].len == topic->size &&
+		    !memcmp(client->internal.topic_alias[i].topic, topic->utf8,
+			    topic->size)) {
+			*known = true;
+			return i + 1;
+		}
+	}
+
+	/* The aliases are not reassigned, so the first topics keep them
+	 * for the whole connection.
+	 */
+	if (topic->size == 0U ||
+	    topic->size > CONFIG_MQTT_TOPIC_ALIAS_MAX_LEN ||
+	    client->internal.topic_alias_count >= max) {
+		return 0U;
+	}
+
+	return client->internal.topic_alias_count + 1;
+}
+
+static void topic_alias_add(struct mqtt_client *client,
+			    const struct mqtt_utf8 *topic)
+{
+	uint8_t i = client->internal.topic_alias_count++;
+
+	memcpy(client->internal.topic_alias[i].topic, topic->utf8,
+	       topic->size);
+	client->internal.topic_alias[i].len = topic->size;
+}
+#endif /* CONFIG_MQTT_VERSION_5_0 */
+
 int mqtt_publish(struct mqtt_client *client,
 		 const struct mqtt_publish_param *param)
 {
@@ -243,6 +328,11 @@ int mqtt_publish(struct mqtt_client *client,
 	struct buf_ctx packet;
 	struct iovec io_vector[2];
 	struct msghdr msg;
+	uint16_t topic_alias = 0U;
+#if defined(CONFIG_MQTT_VERSION_5_0)
+	struct mqtt_publish_param alias_param;
+	bool alias_known;
+#endif
 
 	NULL_PARAM_CHECK(client);
 	NULL_PARAM_CHECK(param);
@@ -261,11 +351,29 @@ int mqtt_publish(struct mqtt_client *client,
 		goto error;
 	}
 
-	err_code = publish_encode(param, &packet);
+#if defined(CONFIG_MQTT_VERSION_5_0)
+	topic_alias = topic_alias_get(client, &param->message.topic.topic,
+				      &alias_known);
+	if (alias_known) {
+		/* The topic is replaced by the alias */
+		alias_param = *param;
+		alias_param.message.topic.topic.utf8 = NULL;
+		alias_param.message.topic.topic.size = 0U;
+		param = &alias_param;
+	}
+#endif
+
+	err_code = publish_encode(client, param, topic_alias, &packet);
 	if (err_code < 0) {
 		goto error;
 	}
 
+	if (mqtt_exceeds_max_packet_size(client, packet.end - packet.cur +
+					 param->message.payload.len)) {
+		err_code = -EMSGSIZE;
+		goto error;
+	}
+
 	io_vector[0].iov_base = packet.cur;
 	io_vector[0].iov_len = packet.end - packet.cur;
 	io_vector[1].iov_base = param->message.payload.data;
@@ -278,6 +386,13 @@ int mqtt_publish(struct mqtt_client *client,
 
 	err_code = client_write_msg(client, &msg);
 
+#if defined(CONFIG_MQTT_VERSION_5_0)
+	/* The server knows the alias only once the message is sent */
+	if (err_code == 0 && topic_alias != 0U && !alias_known) {
+		topic_alias_add(client, &param->message.topic.topic);
+	}
+#endif
+
 error:
 	MQTT_TRC("[CID %p]:[State 0x%02x]: << result 0x%08x",
 			 client, client->internal.state, err_code);
@@ -287,6 +402,26 @@ error:
 	return err_code;
 }
 
+#if defined(CONFIG_MQTT_PUBLISH_QUEUE)
+int mqtt_publish_queue_flush(struct mqtt_client *client)
+{
+	int err_code;
+
+	NULL_PARAM_CHECK(client);
+
+	mqtt_mutex_lock(client);
+
+	err_code = verify_tx_state(client);
+	if (err_code == 0) {
+		err_code = client_flush(client);
+	}
+
+	mqtt_mutex_unlock(client);
+
+	return err_code;
+}
+#endif /* CONFIG_MQTT_PUBLISH_QUEUE */
+
 int mqtt_publish_qos1_ack(struct mqtt_client *client,
 			  const struct mqtt_puback_param *param)
 {
@@ -494,7 +629,7 @@ int mqtt_subscribe(struct mqtt_client *client,
 		goto error;
 	}
 
-	err_code = subscribe_encode(param, &packet);
+	err_code = subscribe_encode(client, param, &packet);
 	if (err_code < 0) {
 		goto error;
 	}
@@ -528,7 +663,7 @@ int mqtt_unsubscribe(struct mqtt_client *client,
 		goto error;
 	}
 
-	err_code = unsubscribe_encode(param, &packet);
+	err_code = unsubscribe_encode(client, param, &packet);
 	if (err_code < 0) {
 		goto error;
 	}
@@ -609,6 +744,11 @@ int mqtt_live(struct mqtt_client *client)
 		ping_sent = true;
 	}
 
+	/* Queued messages also count as activity, a failure is reported
+	 * through MQTT_EVT_DISCONNECT.
+	 */
+	(void)client_flush(client);
+
 	mqtt_mutex_unlock(client);
 
 	if (ping_sent) {
@@ -648,6 +788,10 @@ int mqtt_input(struct mqtt_client *client)
 
 	if (MQTT_HAS_STATE(client, MQTT_STATE_TCP_CONNECTED)) {
 		err_code = client_read(client);
+		if (err_code == 0) {
+			/* Acknowledgements may have opened the window */
+			err_code = client_flush(client);
+		}
 	} else {
 		err_code = -EACCES;
 	}
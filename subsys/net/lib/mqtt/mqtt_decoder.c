@@ -13,6 +13,8 @@
 #include <logging/log.h>
 LOG_MODULE_REGISTER(net_mqtt_dec, CONFIG_MQTT_LOG_LEVEL);
 
+#include <sys/byteorder.h>
+
 #include "mqtt_internal.h"
 #include "mqtt_os.h"
 
@@ -69,6 +71,33 @@ static int unpack_uint16(struct buf_ctx *buf, uint16_t *val)
 	return 0;
 }
 
+/**
+ * @brief Unpacks unsigned 32 bit value from the buffer from the offset
+ *        requested.
+ *
+ * @param[inout] buf A pointer to the buf_ctx structure containing current
+ *                   buffer position.
+ * @param[out] val Memory where the value is to be unpacked.
+ *
+ * @retval 0 if the procedure is successful.
+ * @retval -EINVAL if the buffer would be exceeded during the read
+ */
+static int unpack_uint32(struct buf_ctx *buf, uint32_t *val)
+{
+	MQTT_TRC(">> cur:%p, end:%p", buf->cur, buf->end);
+
+	if ((buf->end - buf->cur) < sizeof(uint32_t)) {
+		return -EINVAL;
+	}
+
+	*val = sys_get_be32(buf->cur);
+	buf->cur += sizeof(uint32_t);
+
+	MQTT_TRC("<< val:%08x", *val);
+
+	return 0;
+}
+
 /**
  * @brief Unpacks utf8 string from the buffer from the offset requested.
  *
@@ -188,6 +217,194 @@ static int packet_length_decode(struct buf_ctx *buf, uint32_t *length)
 	return 0;
 }
 
+#if defined(CONFIG_MQTT_VERSION_5_0)
+/**@brief Decode one MQTT 5.0 property.
+ *
+ * @param[inout] buf A pointer to the buf_ctx structure containing the
+ *                   properties.
+ * @param[out] id Property identifier.
+ * @param[out] value Value of an integer property. The string and binary
+ *                   properties are skipped.
+ *
+ * @retval 0 if the procedure is successful.
+ * @retval -EINVAL if the property is unknown or malformed.
+ */
+static int property_decode(struct buf_ctx *buf, uint8_t *id, uint32_t *value)
+{
+	struct mqtt_utf8 str;
+	uint16_t val16;
+	uint8_t val8;
+	int err_code;
+
+	*value = 0U;
+
+	err_code = unpack_uint8(buf, id);
+	if (err_code != 0) {
+		return err_code;
+	}
+
+	switch (*id) {
+	case MQTT_PROP_PAYLOAD_FORMAT_INDICATOR:
+	case MQTT_PROP_REQUEST_PROBLEM_INFORMATION:
+	case MQTT_PROP_REQUEST_RESPONSE_INFORMATION:
+	case MQTT_PROP_MAXIMUM_QOS:
+	case MQTT_PROP_RETAIN_AVAILABLE:
+	case MQTT_PROP_WILDCARD_SUBSCRIPTION_AVAILABLE:
+	case MQTT_PROP_SUBSCRIPTION_IDENTIFIER_AVAILABLE:
+	case MQTT_PROP_SHARED_SUBSCRIPTION_AVAILABLE:
+		err_code = unpack_uint8(buf, &val8);
+		*value = val8;
+		break;
+
+	case MQTT_PROP_SERVER_KEEP_ALIVE:
+	case MQTT_PROP_RECEIVE_MAXIMUM:
+	case MQTT_PROP_TOPIC_ALIAS_MAXIMUM:
+	case MQTT_PROP_TOPIC_ALIAS:
+		err_code = unpack_uint16(buf, &val16);
+		*value = val16;
+		break;
+
+	case MQTT_PROP_MESSAGE_EXPIRY_INTERVAL:
+	case MQTT_PROP_SESSION_EXPIRY_INTERVAL:
+	case MQTT_PROP_WILL_DELAY_INTERVAL:
+	case MQTT_PROP_MAXIMUM_PACKET_SIZE:
+		err_code = unpack_uint32(buf, value);
+		break;
+
+	case MQTT_PROP_SUBSCRIPTION_IDENTIFIER:
+		err_code = packet_length_decode(buf, value);
+		break;
+
+	case MQTT_PROP_USER_PROPERTY:
+		/* A name and value pair */
+		err_code = unpack_utf8_str(buf, &str);
+		if (err_code != 0) {
+			break;
+		}
+
+		/* Fall through */
+	case MQTT_PROP_CONTENT_TYPE:
+	case MQTT_PROP_RESPONSE_TOPIC:
+	case MQTT_PROP_ASSIGNED_CLIENT_IDENTIFIER:
+	case MQTT_PROP_AUTHENTICATION_METHOD:
+	case MQTT_PROP_RESPONSE_INFORMATION:
+	case MQTT_PROP_SERVER_REFERENCE:
+	case MQTT_PROP_REASON_STRING:
+	case MQTT_PROP_CORRELATION_DATA:
+	case MQTT_PROP_AUTHENTICATION_DATA:
+		/* Binary data is encoded the same way as strings */
+		err_code = unpack_utf8_str(buf, &str);
+		break;
+
+	default:
+		MQTT_ERR("Unknown property 0x%02x", *id);
+		return -EINVAL;
+	}
+
+	return err_code != 0 ? -EINVAL : 0;
+}
+
+/**@brief Get the property list of an MQTT 5.0 message.
+ *
+ * @param[inout] buf A pointer to the buf_ctx structure containing current
+ *                   buffer position. Moved past the properties.
+ * @param[out] props Set to the properties, without the length.
+ *
+ * @retval 0 if the procedure is successful.
+ * @retval -EINVAL if the buffer would be exceeded during the read.
+ */
+static int properties_get(struct buf_ctx *buf, struct buf_ctx *props)
+{
+	uint32_t length;
+
+	if (packet_length_decode(buf, &length) != 0 ||
+	    (buf->end - buf->cur) < length) {
+		return -EINVAL;
+	}
+
+	props->cur = buf->cur;
+	props->end = buf->cur + length;
+	buf->cur += length;
+
+	return 0;
+}
+
+static int connect_ack_properties_decode(struct buf_ctx *buf,
+					 struct mqtt_connack_param *param)
+{
+	struct buf_ctx props;
+	uint32_t value;
+	uint8_t id;
+	int err_code;
+
+	param->receive_max = MQTT_DEFAULT_RECEIVE_MAXIMUM;
+	param->topic_alias_max = 0U;
+	param->max_packet_size = 0U;
+
+	err_code = properties_get(buf, &props);
+	if (err_code != 0) {
+		return err_code;
+	}
+
+	while (props.cur < props.end) {
+		err_code = property_decode(&props, &id, &value);
+		if (err_code != 0) {
+			return err_code;
+		}
+
+		switch (id) {
+		case MQTT_PROP_RECEIVE_MAXIMUM:
+			if (value == 0U) {
+				return -EINVAL;
+			}
+
+			param->receive_max = value;
+			break;
+
+		case MQTT_PROP_TOPIC_ALIAS_MAXIMUM:
+			param->topic_alias_max = value;
+			break;
+
+		case MQTT_PROP_MAXIMUM_PACKET_SIZE:
+			if (value == 0U) {
+				return -EINVAL;
+			}
+
+			param->max_packet_size = value;
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	MQTT_TRC("receive_max: %u, topic_alias_max: %u, max_packet_size: %u",
+		 param->receive_max, param->topic_alias_max,
+		 param->max_packet_size);
+
+	return 0;
+}
+
+/* Properties of the other messages are not used by the client */
+static int properties_skip(const struct mqtt_client *client,
+			   struct buf_ctx *buf)
+{
+	struct buf_ctx props;
+
+	if (!mqtt_is_version_5_0(client)) {
+		return 0;
+	}
+
+	return properties_get(buf, &props);
+}
+#else
+static inline int properties_skip(const struct mqtt_client *client,
+				  struct buf_ctx *buf)
+{
+	return 0;
+}
+#endif /* CONFIG_MQTT_VERSION_5_0 */
+
 int fixed_header_decode(struct buf_ctx *buf, uint8_t *type_and_flags,
 			uint32_t *length)
 {
@@ -217,7 +434,7 @@ int connect_ack_decode(const struct mqtt_client *client, struct buf_ctx *buf,
 		return err_code;
 	}
 
-	if (client->protocol_version == MQTT_VERSION_3_1_1) {
+	if (client->protocol_version >= MQTT_VERSION_3_1_1) {
 		param->session_present_flag =
 			flags & MQTT_CONNACK_FLAG_SESSION_PRESENT;
 
@@ -227,12 +444,20 @@ int connect_ack_decode(const struct mqtt_client *client, struct buf_ctx *buf,
 
 	param->return_code = (enum mqtt_conn_return_code)ret_code;
 
+#if defined(CONFIG_MQTT_VERSION_5_0)
+	if (mqtt_is_version_5_0(client)) {
+		return connect_ack_properties_decode(buf, param);
+	}
+#endif
+
 	return 0;
 }
 
-int publish_decode(uint8_t flags, uint32_t var_length, struct buf_ctx *buf,
+int publish_decode(const struct mqtt_client *client, uint8_t flags,
+		   uint32_t var_length, struct buf_ctx *buf,
 		   struct mqtt_publish_param *param)
 {
+	uint8_t *start = buf->cur;
 	int err_code;
 	uint32_t var_header_length;
 
@@ -245,17 +470,20 @@ int publish_decode(uint8_t flags, uint32_t var_length, struct buf_ctx *buf,
 		return err_code;
 	}
 
-	var_header_length = param->message.topic.topic.size + sizeof(uint16_t);
-
 	if (param->message.topic.qos > MQTT_QOS_0_AT_MOST_ONCE) {
 		err_code = unpack_uint16(buf, &param->message_id);
 		if (err_code != 0) {
 			return err_code;
 		}
+	}
 
-		var_header_length += sizeof(uint16_t);
+	err_code = properties_skip(client, buf);
+	if (err_code != 0) {
+		return err_code;
 	}
 
+	var_header_length = buf->cur - start;
+
 	if (var_length < var_header_length) {
 		MQTT_ERR("Corrupted PUBLISH message, header length (%u) larger "
 			 "than total length (%u)", var_header_length,
@@ -269,14 +497,61 @@ int publish_decode(uint8_t flags, uint32_t var_length, struct buf_ctx *buf,
 	return 0;
 }
 
-int publish_ack_decode(struct buf_ctx *buf, struct mqtt_puback_param *param)
+/* With MQTT 5.0 the Reason Code of PUBACK, PUBREC and PUBCOMP follows the
+ * message id. It is omitted on success without properties.
+ */
+static int ack_reason_decode(const struct mqtt_client *client,
+			     uint32_t var_length, struct buf_ctx *buf,
+			     uint8_t *reason_code)
 {
-	return unpack_uint16(buf, &param->message_id);
+	int err_code;
+
+	*reason_code = 0U;
+
+	if (!mqtt_is_version_5_0(client) || var_length <= sizeof(uint16_t)) {
+		return 0;
+	}
+
+	err_code = unpack_uint8(buf, reason_code);
+	if (err_code != 0) {
+		return err_code;
+	}
+
+	MQTT_TRC("reason_code: 0x%02x", *reason_code);
+
+	/* The properties are omitted if there are none. */
+	if (var_length == sizeof(uint16_t) + sizeof(uint8_t)) {
+		return 0;
+	}
+
+	return properties_skip(client, buf);
 }
 
-int publish_receive_decode(struct buf_ctx *buf, struct mqtt_pubrec_param *param)
+int publish_ack_decode(const struct mqtt_client *client, uint32_t var_length,
+		       struct buf_ctx *buf, struct mqtt_puback_param *param)
 {
-	return unpack_uint16(buf, &param->message_id);
+	int err_code;
+
+	err_code = unpack_uint16(buf, &param->message_id);
+	if (err_code != 0) {
+		return err_code;
+	}
+
+	return ack_reason_decode(client, var_length, buf, &param->reason_code);
+}
+
+int publish_receive_decode(const struct mqtt_client *client,
+			   uint32_t var_length, struct buf_ctx *buf,
+			   struct mqtt_pubrec_param *param)
+{
+	int err_code;
+
+	err_code = unpack_uint16(buf, &param->message_id);
+	if (err_code != 0) {
+		return err_code;
+	}
+
+	return ack_reason_decode(client, var_length, buf, &param->reason_code);
 }
 
 int publish_release_decode(struct buf_ctx *buf, struct mqtt_pubrel_param *param)
@@ -284,13 +559,22 @@ int publish_release_decode(struct buf_ctx *buf, struct mqtt_pubrel_param *param)
 	return unpack_uint16(buf, &param->message_id);
 }
 
-int publish_complete_decode(struct buf_ctx *buf,
+int publish_complete_decode(const struct mqtt_client *client,
+			    uint32_t var_length, struct buf_ctx *buf,
 			    struct mqtt_pubcomp_param *param)
 {
-	return unpack_uint16(buf, &param->message_id);
+	int err_code;
+
+	err_code = unpack_uint16(buf, &param->message_id);
+	if (err_code != 0) {
+		return err_code;
+	}
+
+	return ack_reason_decode(client, var_length, buf, &param->reason_code);
 }
 
-int subscribe_ack_decode(struct buf_ctx *buf, struct mqtt_suback_param *param)
+int subscribe_ack_decode(const struct mqtt_client *client,
+			 struct buf_ctx *buf, struct mqtt_suback_param *param)
 {
 	int err_code;
 
@@ -299,6 +583,11 @@ int subscribe_ack_decode(struct buf_ctx *buf, struct mqtt_suback_param *param)
 		return err_code;
 	}
 
+	err_code = properties_skip(client, buf);
+	if (err_code != 0) {
+		return err_code;
+	}
+
 	return unpack_data(buf->end - buf->cur, buf, &param->return_codes);
 }
 
@@ -18,6 +18,7 @@ LOG_MODULE_REGISTER(net_mqtt_enc, CONFIG_MQTT_LOG_LEVEL);
 static const struct mqtt_utf8 mqtt_3_1_0_proto_desc =
 	MQTT_UTF8_LITERAL("MQIsdp");
 
+/** Protocol name of MQTT 3.1.1 and MQTT 5.0. */
 static const struct mqtt_utf8 mqtt_3_1_1_proto_desc =
 	MQTT_UTF8_LITERAL("MQTT");
 
@@ -232,6 +233,28 @@ static int zero_len_str_encode(struct buf_ctx *buf)
 	return pack_uint16(0x0000, buf);
 }
 
+/**
+ * @brief Encodes an empty property list of an MQTT 5.0 message. Nothing is
+ *        encoded for the earlier protocol versions.
+ *
+ * @param[in] client Identifies the client for which the procedure is
+ *                   requested.
+ * @param[inout] buf A pointer to the buf_ctx structure containing current
+ *                   buffer position.
+ *
+ * @retval 0 if the procedure is successful.
+ * @retval -ENOMEM if there is no place in the buffer to store the length.
+ */
+static int empty_properties_encode(const struct mqtt_client *client,
+				   struct buf_ctx *buf)
+{
+	if (!mqtt_is_version_5_0(client)) {
+		return 0;
+	}
+
+	return pack_uint8(0, buf);
+}
+
 /**
  * @brief Encodes and sends messages that contain only message id in
  *        the variable header.
@@ -277,10 +300,10 @@ int connect_request_encode(const struct mqtt_client *client,
 	int err_code;
 	uint8_t *start;
 
-	if (client->protocol_version == MQTT_VERSION_3_1_1) {
-		mqtt_proto_desc = &mqtt_3_1_1_proto_desc;
-	} else {
+	if (client->protocol_version == MQTT_VERSION_3_1_0) {
 		mqtt_proto_desc = &mqtt_3_1_0_proto_desc;
+	} else {
+		mqtt_proto_desc = &mqtt_3_1_1_proto_desc;
 	}
 
 	/* Reserve space for fixed header. */
@@ -317,6 +340,14 @@ int connect_request_encode(const struct mqtt_client *client,
 		return err_code;
 	}
 
+	/* Default values of all the connect properties are fine, the
+	 * client does not accept topic aliases from the server.
+	 */
+	err_code = empty_properties_encode(client, buf);
+	if (err_code != 0) {
+		return err_code;
+	}
+
 	MQTT_TRC("Encoding Client Id. Str:%s Size:%08x.",
 		 client->client_id.utf8, client->client_id.size);
 	err_code = pack_utf8_str(&client->client_id, buf);
@@ -331,6 +362,11 @@ int connect_request_encode(const struct mqtt_client *client,
 		connect_flags |= ((client->will_topic->qos & 0x03) << 3);
 		connect_flags |= client->will_retain << 5;
 
+		err_code = empty_properties_encode(client, buf);
+		if (err_code != 0) {
+			return err_code;
+		}
+
 		MQTT_TRC("Encoding Will Topic. Str:%s Size:%08x.",
 			 client->will_topic->topic.utf8,
 			 client->will_topic->topic.size);
@@ -386,7 +422,9 @@ int connect_request_encode(const struct mqtt_client *client,
 	return mqtt_encode_fixed_header(message_type, start, buf);
 }
 
-int publish_encode(const struct mqtt_publish_param *param, struct buf_ctx *buf)
+int publish_encode(const struct mqtt_client *client,
+		   const struct mqtt_publish_param *param,
+		   uint16_t topic_alias, struct buf_ctx *buf)
 {
 	const uint8_t message_type = MQTT_MESSAGES_OPTIONS(
 			MQTT_PKT_TYPE_PUBLISH, param->dup_flag,
@@ -415,6 +453,26 @@ int publish_encode(const struct mqtt_publish_param *param, struct buf_ctx *buf)
 		}
 	}
 
+	if (mqtt_is_version_5_0(client) && topic_alias != 0U) {
+		err_code = pack_uint8(sizeof(uint8_t) + sizeof(uint16_t), buf);
+		if (err_code != 0) {
+			return err_code;
+		}
+
+		err_code = pack_uint8(MQTT_PROP_TOPIC_ALIAS, buf);
+		if (err_code != 0) {
+			return err_code;
+		}
+
+		err_code = pack_uint16(topic_alias, buf);
+	} else {
+		err_code = empty_properties_encode(client, buf);
+	}
+
+	if (err_code != 0) {
+		return err_code;
+	}
+
 	/* Do not copy payload. We move the buffer pointer to ensure that
 	 * message length in fixed header is encoded correctly.
 	 */
@@ -478,7 +536,8 @@ int disconnect_encode(struct buf_ctx *buf)
 	return 0;
 }
 
-int subscribe_encode(const struct mqtt_subscription_list *param,
+int subscribe_encode(const struct mqtt_client *client,
+		     const struct mqtt_subscription_list *param,
 		     struct buf_ctx *buf)
 {
 	const uint8_t message_type = MQTT_MESSAGES_OPTIONS(
@@ -500,6 +559,11 @@ int subscribe_encode(const struct mqtt_subscription_list *param,
 		return err_code;
 	}
 
+	err_code = empty_properties_encode(client, buf);
+	if (err_code != 0) {
+		return err_code;
+	}
+
 	for (i = 0; i < param->list_count; i++) {
 		err_code = pack_utf8_str(&param->list[i].topic, buf);
 		if (err_code != 0) {
@@ -515,7 +579,8 @@ int subscribe_encode(const struct mqtt_subscription_list *param,
 	return mqtt_encode_fixed_header(message_type, start, buf);
 }
 
-int unsubscribe_encode(const struct mqtt_subscription_list *param,
+int unsubscribe_encode(const struct mqtt_client *client,
+		       const struct mqtt_subscription_list *param,
 		       struct buf_ctx *buf)
 {
 	const uint8_t message_type = MQTT_MESSAGES_OPTIONS(
@@ -532,6 +597,11 @@ int unsubscribe_encode(const struct mqtt_subscription_list *param,
 		return err_code;
 	}
 
+	err_code = empty_properties_encode(client, buf);
+	if (err_code != 0) {
+		return err_code;
+	}
+
 	for (i = 0; i < param->list_count; i++) {
 		err_code = pack_utf8_str(&param->list[i].topic, buf);
 		if (err_code != 0) {
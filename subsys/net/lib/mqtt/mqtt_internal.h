@@ -69,6 +69,41 @@ extern "C" {
 
 #define MQTT_CONNACK_FLAG_SESSION_PRESENT 0x01
 
+/**@brief MQTT 5.0 property identifiers. */
+#define MQTT_PROP_PAYLOAD_FORMAT_INDICATOR          0x01
+#define MQTT_PROP_MESSAGE_EXPIRY_INTERVAL           0x02
+#define MQTT_PROP_CONTENT_TYPE                      0x03
+#define MQTT_PROP_RESPONSE_TOPIC                    0x08
+#define MQTT_PROP_CORRELATION_DATA                  0x09
+#define MQTT_PROP_SUBSCRIPTION_IDENTIFIER           0x0B
+#define MQTT_PROP_SESSION_EXPIRY_INTERVAL           0x11
+#define MQTT_PROP_ASSIGNED_CLIENT_IDENTIFIER        0x12
+#define MQTT_PROP_SERVER_KEEP_ALIVE                 0x13
+#define MQTT_PROP_AUTHENTICATION_METHOD             0x15
+#define MQTT_PROP_AUTHENTICATION_DATA               0x16
+#define MQTT_PROP_REQUEST_PROBLEM_INFORMATION       0x17
+#define MQTT_PROP_WILL_DELAY_INTERVAL               0x18
+#define MQTT_PROP_REQUEST_RESPONSE_INFORMATION      0x19
+#define MQTT_PROP_RESPONSE_INFORMATION              0x1A
+#define MQTT_PROP_SERVER_REFERENCE                  0x1C
+#define MQTT_PROP_REASON_STRING                     0x1F
+#define MQTT_PROP_RECEIVE_MAXIMUM                   0x21
+#define MQTT_PROP_TOPIC_ALIAS_MAXIMUM               0x22
+#define MQTT_PROP_TOPIC_ALIAS                       0x23
+#define MQTT_PROP_MAXIMUM_QOS                       0x24
+#define MQTT_PROP_RETAIN_AVAILABLE                  0x25
+#define MQTT_PROP_USER_PROPERTY                     0x26
+#define MQTT_PROP_MAXIMUM_PACKET_SIZE               0x27
+#define MQTT_PROP_WILDCARD_SUBSCRIPTION_AVAILABLE   0x28
+#define MQTT_PROP_SUBSCRIPTION_IDENTIFIER_AVAILABLE 0x29
+#define MQTT_PROP_SHARED_SUBSCRIPTION_AVAILABLE     0x2A
+
+/**@brief Receive Maximum when the property is absent (MQTT 5.0). */
+#define MQTT_DEFAULT_RECEIVE_MAXIMUM 0xFFFF
+
+/**@brief Lowest MQTT 5.0 Reason Code indicating a failure. */
+#define MQTT_REASON_CODE_FAILURE 0x80
+
 /**@brief Maximum payload size of MQTT packet. */
 #define MQTT_MAX_PAYLOAD_SIZE 0x0FFFFFFF
 
@@ -181,7 +216,11 @@ int connect_request_encode(const struct mqtt_client *client,
 
 /**@brief Constructs/encodes Publish packet.
  *
- * @param[in] param Publish message parameters.
+ * @param[in] client Identifies the client for which the procedure is requested.
+ * @param[in] param Publish message parameters. An empty topic is allowed
+ *                  with a topic alias.
+ * @param[in] topic_alias Topic alias to be sent with an MQTT 5.0 message,
+ *                        0 if none.
  * @param[inout] buf_ctx Pointer to the buffer context structure,
  *                       containing buffer for the encoded message.
  *                       As output points to the beginning and end of
@@ -189,7 +228,9 @@ int connect_request_encode(const struct mqtt_client *client,
  *
  * @return 0 if the procedure is successful, an error code otherwise.
  */
-int publish_encode(const struct mqtt_publish_param *param, struct buf_ctx *buf);
+int publish_encode(const struct mqtt_client *client,
+		   const struct mqtt_publish_param *param,
+		   uint16_t topic_alias, struct buf_ctx *buf);
 
 /**@brief Constructs/encodes Publish Ack packet.
  *
@@ -256,6 +297,7 @@ int disconnect_encode(struct buf_ctx *buf);
 
 /**@brief Constructs/encodes Subscribe packet.
  *
+ * @param[in] client Identifies the client for which the procedure is requested.
  * @param[in] param Subscribe message parameters.
  * @param[inout] buf_ctx Pointer to the buffer context structure,
  *                       containing buffer for the encoded message.
@@ -264,11 +306,13 @@ int disconnect_encode(struct buf_ctx *buf);
  *
  * @return 0 if the procedure is successful, an error code otherwise.
  */
-int subscribe_encode(const struct mqtt_subscription_list *param,
+int subscribe_encode(const struct mqtt_client *client,
+		     const struct mqtt_subscription_list *param,
 		     struct buf_ctx *buf);
 
 /**@brief Constructs/encodes Unsubscribe packet.
  *
+ * @param[in] client Identifies the client for which the procedure is requested.
  * @param[in] param Unsubscribe message parameters.
  * @param[inout] buf_ctx Pointer to the buffer context structure,
  *                       containing buffer for the encoded message.
@@ -277,7 +321,8 @@ int subscribe_encode(const struct mqtt_subscription_list *param,
  *
  * @return 0 if the procedure is successful, an error code otherwise.
  */
-int unsubscribe_encode(const struct mqtt_subscription_list *param,
+int unsubscribe_encode(const struct mqtt_client *client,
+		       const struct mqtt_subscription_list *param,
 		       struct buf_ctx *buf);
 
 /**@brief Constructs/encodes Ping Request packet.
@@ -317,6 +362,7 @@ int connect_ack_decode(const struct mqtt_client *client, struct buf_ctx *buf,
 
 /**@brief Decode MQTT Publish packet.
  *
+ * @param[in] client Identifies the client for which the procedure is requested.
  * @param[in] flags Byte containing message type and flags.
  * @param[in] var_length Length of the variable part of the message.
  * @param[inout] buf A pointer to the buf_ctx structure containing current
@@ -325,28 +371,35 @@ int connect_ack_decode(const struct mqtt_client *client, struct buf_ctx *buf,
  *
  * @return 0 if the procedure is successful, an error code otherwise.
  */
-int publish_decode(uint8_t flags, uint32_t var_length, struct buf_ctx *buf,
+int publish_decode(const struct mqtt_client *client, uint8_t flags,
+		   uint32_t var_length, struct buf_ctx *buf,
 		   struct mqtt_publish_param *param);
 
 /**@brief Decode MQTT Publish Ack packet.
  *
+ * @param[in] client Identifies the client for which the procedure is requested.
+ * @param[in] var_length Length of the variable header.
  * @param[inout] buf A pointer to the buf_ctx structure containing current
  *                   buffer position.
  * @param[out] param Pointer to buffer for decoded Publish Ack parameters.
  *
  * @return 0 if the procedure is successful, an error code otherwise.
  */
-int publish_ack_decode(struct buf_ctx *buf, struct mqtt_puback_param *param);
+int publish_ack_decode(const struct mqtt_client *client, uint32_t var_length,
+		       struct buf_ctx *buf, struct mqtt_puback_param *param);
 
 /**@brief Decode MQTT Publish Receive packet.
  *
+ * @param[in] client Identifies the client for which the procedure is requested.
+ * @param[in] var_length Length of the variable header.
  * @param[inout] buf A pointer to the buf_ctx structure containing current
  *                   buffer position.
  * @param[out] param Pointer to buffer for decoded Publish Receive parameters.
  *
  * @return 0 if the procedure is successful, an error code otherwise.
  */
-int publish_receive_decode(struct buf_ctx *buf,
+int publish_receive_decode(const struct mqtt_client *client,
+			   uint32_t var_length, struct buf_ctx *buf,
 			   struct mqtt_pubrec_param *param);
 
 /**@brief Decode MQTT Publish Release packet.
@@ -362,24 +415,29 @@ int publish_release_decode(struct buf_ctx *buf,
 
 /**@brief Decode MQTT Publish Complete packet.
  *
+ * @param[in] client Identifies the client for which the procedure is requested.
+ * @param[in] var_length Length of the variable header.
  * @param[inout] buf A pointer to the buf_ctx structure containing current
  *                   buffer position.
  * @param[out] param Pointer to buffer for decoded Publish Complete parameters.
  *
  * @return 0 if the procedure is successful, an error code otherwise.
  */
-int publish_complete_decode(struct buf_ctx *buf,
+int publish_complete_decode(const struct mqtt_client *client,
+			    uint32_t var_length, struct buf_ctx *buf,
 			    struct mqtt_pubcomp_param *param);
 
 /**@brief Decode MQTT Subscribe packet.
  *
+ * @param[in] client Identifies the client for which the procedure is requested.
  * @param[inout] buf A pointer to the buf_ctx structure containing current
  *                   buffer position.
  * @param[out] param Pointer to buffer for decoded Subscribe parameters.
  *
  * @return 0 if the procedure is successful, an error code otherwise.
  */
-int subscribe_ack_decode(struct buf_ctx *buf,
+int subscribe_ack_decode(const struct mqtt_client *client,
+			 struct buf_ctx *buf,
 			 struct mqtt_suback_param *param);
 
 /**@brief Decode MQTT Unsubscribe packet.
@@ -393,6 +451,95 @@ int subscribe_ack_decode(struct buf_ctx *buf,
 int unsubscribe_ack_decode(struct buf_ctx *buf,
 			   struct mqtt_unsuback_param *param);
 
+/**@brief Check if the client uses MQTT 5.0. */
+static inline bool mqtt_is_version_5_0(const struct mqtt_client *client)
+{
+#if defined(CONFIG_MQTT_VERSION_5_0)
+	return client->protocol_version == MQTT_VERSION_5_0;
+#else
+	return false;
+#endif
+}
+
+/**@brief Maximum number of unacknowledged QoS 1 and QoS 2 messages the
+ *        server accepts on the connection.
+ */
+static inline uint16_t mqtt_server_receive_max(const struct mqtt_client *client)
+{
+#if defined(CONFIG_MQTT_VERSION_5_0)
+	if (mqtt_is_version_5_0(client)) {
+		return client->internal.server_receive_max;
+	}
+#endif
+
+	return MQTT_DEFAULT_RECEIVE_MAXIMUM;
+}
+
+/**@brief Check if a packet is larger than the server accepts. */
+static inline bool mqtt_exceeds_max_packet_size(const struct mqtt_client *client,
+						size_t size)
+{
+#if defined(CONFIG_MQTT_VERSION_5_0)
+	if (mqtt_is_version_5_0(client) &&
+	    client->internal.server_max_packet_size > 0) {
+		return size > client->internal.server_max_packet_size;
+	}
+#endif
+
+	return false;
+}
+
+#if defined(CONFIG_MQTT_PUBLISH_QUEUE)
+/**@brief Write queued PUBLISH messages that fit in the in-flight window.
+ *
+ * @param[in] client Identifies the client. Connection shall be established.
+ *
+ * @return 0 if the procedure is successful, a transport error otherwise.
+ */
+int mqtt_queue_flush(struct mqtt_client *client);
+
+/**@brief Retransmit the in-flight messages after a new connection has been
+ *        accepted, then write the queued messages.
+ *
+ * @param[in] client Identifies the client.
+ * @param[in] session_present Session Present flag of the CONNACK.
+ *
+ * @return 0 if the procedure is successful, a transport error otherwise.
+ */
+int mqtt_queue_resend(struct mqtt_client *client, bool session_present);
+
+/**@brief Update the in-flight message acknowledged by PUBACK, PUBREC or
+ *        PUBCOMP. PUBREL is sent for a QoS 2 message on a successful
+ *        PUBREC. A failure Reason Code completes the message.
+ *
+ * @param[in] client Identifies the client.
+ * @param[in] type Type of the acknowledgement, MQTT_PKT_TYPE_*.
+ * @param[in] message_id Acknowledged message id.
+ * @param[in] reason_code MQTT 5.0 Reason Code of the acknowledgement.
+ *
+ * @return 0 if the procedure is successful, a transport error otherwise.
+ */
+int mqtt_queue_ack(struct mqtt_client *client, uint8_t type,
+		   uint16_t message_id, uint8_t reason_code);
+#else
+static inline int mqtt_queue_flush(struct mqtt_client *client)
+{
+	return 0;
+}
+
+static inline int mqtt_queue_resend(struct mqtt_client *client,
+				    bool session_present)
+{
+	return 0;
+}
+
+static inline int mqtt_queue_ack(struct mqtt_client *client, uint8_t type,
+				 uint16_t message_id, uint8_t reason_code)
+{
+	return 0;
+}
+#endif /* CONFIG_MQTT_PUBLISH_QUEUE */
+
 #ifdef __cplusplus
 }
 #endif
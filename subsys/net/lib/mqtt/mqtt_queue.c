@@ -0,0 +1,404 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file mqtt_queue.c
+ *
+ * @brief MQTT asynchronous publish queue.
+ *
+ * Messages are encoded by the producer into a buffer and appended to the
+ * client queue under a spinlock, so producers never wait for the client
+ * mutex, which is held during transport I/O. The thread servicing the
+ * connection moves queued messages to the transport. QoS 1 and QoS 2
+ * messages are then kept in the in-flight list until the broker completes
+ * them.
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_mqtt_queue, CONFIG_MQTT_LOG_LEVEL);
+
+#include <net/mqtt.h>
+#include <net/buf.h>
+
+#include "mqtt_transport.h"
+#include "mqtt_internal.h"
+#include "mqtt_os.h"
+
+/** Per message state, stored as the buffer user data. */
+struct queue_meta {
+	/** Message id, unused for QoS 0. */
+	uint16_t message_id;
+
+	/** QoS of the message. */
+	uint8_t qos;
+
+	/** PUBREC received for a QoS 2 message, the buffer holds PUBREL. */
+	uint8_t released;
+};
+
+NET_BUF_POOL_DEFINE(mqtt_queue_pool, CONFIG_MQTT_PUBLISH_QUEUE_SIZE,
+		    CONFIG_MQTT_PUBLISH_QUEUE_BUF_SIZE,
+		    sizeof(struct queue_meta), NULL);
+
+static inline struct queue_meta *queue_meta(struct net_buf *buf)
+{
+	return net_buf_user_data(buf);
+}
+
+static struct net_buf *queue_peek(sys_slist_t *list)
+{
+	sys_snode_t *node = sys_slist_peek_head(list);
+
+	return node ? CONTAINER_OF(node, struct net_buf, node) : NULL;
+}
+
+static void inflight_remove(struct mqtt_client *client, struct net_buf *buf)
+{
+	sys_slist_find_and_remove(&client->internal.inflight, &buf->node);
+	client->internal.inflight_count--;
+
+	net_buf_unref(buf);
+}
+
+static struct net_buf *inflight_find(struct mqtt_client *client,
+				     uint16_t message_id)
+{
+	struct net_buf *buf;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&client->internal.inflight, buf, node) {
+		if (queue_meta(buf)->message_id == message_id) {
+			return buf;
+		}
+	}
+
+	return NULL;
+}
+
+static uint16_t queue_window(const struct mqtt_client *client)
+{
+	return MIN(CONFIG_MQTT_PUBLISH_QUEUE_INFLIGHT,
+		   mqtt_server_receive_max(client));
+}
+
+static int queue_write(struct mqtt_client *client, struct iovec *io_vector,
+		       size_t count)
+{
+	struct msghdr msg;
+	int err_code;
+
+	memset(&msg, 0, sizeof(msg));
+
+	msg.msg_iov = io_vector;
+	msg.msg_iovlen = count;
+
+	MQTT_TRC("[%p]: Writing %zu queued messages.", client, count);
+
+	err_code = mqtt_transport_write_msg(client, &msg);
+	if (err_code < 0) {
+		return err_code;
+	}
+
+	client->internal.last_activity = mqtt_sys_tick_in_ms_get();
+
+	return 0;
+}
+
+int mqtt_publish_enqueue(struct mqtt_client *client,
+			 const struct mqtt_publish_param *param,
+			 k_timeout_t timeout)
+{
+	struct buf_ctx packet;
+	struct queue_meta *meta;
+	struct net_buf *buf;
+	k_spinlock_key_t key;
+	int err_code;
+
+	NULL_PARAM_CHECK(client);
+	NULL_PARAM_CHECK(param);
+
+	buf = net_buf_alloc(&mqtt_queue_pool, timeout);
+	if (!buf) {
+		return -ENOMEM;
+	}
+
+	packet.cur = buf->data;
+	packet.end = buf->data + net_buf_tailroom(buf);
+
+	/* The encoder leaves room for the payload without copying it,
+	 * the payload is appended after the encoded header. The connection
+	 * the message is sent on is not known, so no topic alias is used.
+	 */
+	err_code = publish_encode(client, param, 0U, &packet);
+	if (err_code < 0) {
+		goto error;
+	}
+
+	net_buf_add(buf, packet.end - buf->data);
+	net_buf_pull(buf, packet.cur - buf->data);
+
+	if (net_buf_tailroom(buf) < param->message.payload.len) {
+		err_code = -EMSGSIZE;
+		goto error;
+	}
+
+	net_buf_add_mem(buf, param->message.payload.data,
+			param->message.payload.len);
+
+	meta = queue_meta(buf);
+	meta->message_id = param->message_id;
+	meta->qos = param->message.topic.qos;
+	meta->released = 0U;
+
+	key = k_spin_lock(&client->internal.queue_lock);
+	sys_slist_append(&client->internal.queue, &buf->node);
+	k_spin_unlock(&client->internal.queue_lock, key);
+
+	MQTT_TRC("[CID %p]: Queued message id 0x%04x, %u bytes", client,
+		 meta->message_id, buf->len);
+
+	return 0;
+
+error:
+	net_buf_unref(buf);
+
+	return err_code;
+}
+
+void mqtt_publish_queue_clear(struct mqtt_client *client)
+{
+	struct net_buf *buf;
+	k_spinlock_key_t key;
+
+	NULL_PARAM_CHECK_VOID(client);
+
+	mqtt_mutex_lock(client);
+
+	while ((buf = queue_peek(&client->internal.inflight)) != NULL) {
+		inflight_remove(client, buf);
+	}
+
+	key = k_spin_lock(&client->internal.queue_lock);
+
+	while ((buf = queue_peek(&client->internal.queue)) != NULL) {
+		sys_slist_get(&client->internal.queue);
+		net_buf_unref(buf);
+	}
+
+	k_spin_unlock(&client->internal.queue_lock, key);
+
+	mqtt_mutex_unlock(client);
+}
+
+int mqtt_queue_flush(struct mqtt_client *client)
+{
+	struct iovec io_vector[CONFIG_MQTT_PUBLISH_QUEUE_BATCH];
+	struct net_buf *sent[CONFIG_MQTT_PUBLISH_QUEUE_BATCH];
+	struct queue_meta *meta;
+	struct net_buf *buf;
+	sys_slist_t dropped;
+	k_spinlock_key_t key;
+	size_t count, i;
+	int err_code;
+
+	do {
+		count = 0;
+		sys_slist_init(&dropped);
+
+		key = k_spin_lock(&client->internal.queue_lock);
+
+		/* Messages leave the queue in order, so a QoS 1 or QoS 2
+		 * message that does not fit in the window holds back the
+		 * ones after it.
+		 */
+		while (count < ARRAY_SIZE(sent)) {
+			buf = queue_peek(&client->internal.queue);
+			if (!buf) {
+				break;
+			}
+
+			meta = queue_meta(buf);
+			if (meta->qos && client->internal.inflight_count >=
+					 queue_window(client)) {
+				break;
+			}
+
+			sys_slist_get(&client->internal.queue);
+
+			/* Released after the lock, so is the log message */
+			if (mqtt_exceeds_max_packet_size(client, buf->len)) {
+				sys_slist_append(&dropped, &buf->node);
+				continue;
+			}
+
+			if (meta->qos) {
+				sys_slist_append(&client->internal.inflight,
+						 &buf->node);
+				client->internal.inflight_count++;
+			}
+
+			io_vector[count].iov_base = buf->data;
+			io_vector[count].iov_len = buf->len;
+			sent[count++] = buf;
+		}
+
+		k_spin_unlock(&client->internal.queue_lock, key);
+
+		while ((buf = queue_peek(&dropped)) != NULL) {
+			sys_slist_get(&dropped);
+
+			MQTT_ERR("[CID %p]: Message id 0x%04x too large for the "
+				 "server, dropped", client,
+				 queue_meta(buf)->message_id);
+			net_buf_unref(buf);
+		}
+
+		if (count == 0) {
+			return 0;
+		}
+
+		err_code = queue_write(client, io_vector, count);
+
+		for (i = 0; i < count; i++) {
+			if (queue_meta(sent[i])->qos == 0U) {
+				/* QoS 0 messages are sent at most once */
+				net_buf_unref(sent[i]);
+			} else {
+				/* Any later transmission is a retransmission */
+				sent[i]->data[0] |= MQTT_HEADER_DUP_MASK;
+			}
+		}
+
+		if (err_code < 0) {
+			return err_code;
+		}
+	} while (count == ARRAY_SIZE(sent));
+
+	return 0;
+}
+
+int mqtt_queue_resend(struct mqtt_client *client, bool session_present)
+{
+	struct iovec io_vector[CONFIG_MQTT_PUBLISH_QUEUE_BATCH];
+	struct net_buf *buf, *next;
+	struct queue_meta *meta;
+	size_t count = 0;
+	int err_code;
+
+	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&client->internal.inflight, buf,
+					  next, node) {
+		meta = queue_meta(buf);
+
+		/* Without a session the broker has no message to release,
+		 * it has been delivered already.
+		 */
+		if (meta->released && !session_present) {
+			inflight_remove(client, buf);
+			continue;
+		}
+
+		io_vector[count].iov_base = buf->data;
+		io_vector[count].iov_len = buf->len;
+
+		MQTT_TRC("[CID %p]: Resending message id 0x%04x", client,
+			 meta->message_id);
+
+		if (++count == ARRAY_SIZE(io_vector)) {
+			err_code = queue_write(client, io_vector, count);
+			if (err_code < 0) {
+				return err_code;
+			}
+
+			count = 0;
+		}
+	}
+
+	if (count > 0) {
+		err_code = queue_write(client, io_vector, count);
+		if (err_code < 0) {
+			return err_code;
+		}
+	}
+
+	return mqtt_queue_flush(client);
+}
+
+int mqtt_queue_ack(struct mqtt_client *client, uint8_t type,
+		   uint16_t message_id, uint8_t reason_code)
+{
+	struct queue_meta *meta;
+	struct net_buf *buf;
+	int err_code;
+
+	buf = inflight_find(client, message_id);
+	if (!buf) {
+		/* Not a queued message, left to the application */
+		return 0;
+	}
+
+	meta = queue_meta(buf);
+
+	/* The flow ends on a failure, PUBREL is not sent after PUBREC. The
+	 * application is notified of the Reason Code through the event.
+	 */
+	if (reason_code >= MQTT_REASON_CODE_FAILURE) {
+		MQTT_ERR("[CID %p]: Message id 0x%04x failed, reason 0x%02x",
+			 client, message_id, reason_code);
+
+		if (type != MQTT_PKT_TYPE_PUBACK ||
+		    meta->qos == MQTT_QOS_1_AT_LEAST_ONCE) {
+			inflight_remove(client, buf);
+		}
+
+		return 0;
+	}
+
+	switch (type) {
+	case MQTT_PKT_TYPE_PUBACK:
+		if (meta->qos == MQTT_QOS_1_AT_LEAST_ONCE) {
+			inflight_remove(client, buf);
+		}
+
+		break;
+
+	case MQTT_PKT_TYPE_PUBREC:
+		if (meta->qos != MQTT_QOS_2_EXACTLY_ONCE) {
+			break;
+		}
+
+		/* The PUBLISH message is not needed anymore, the buffer is
+		 * reused for PUBREL which is retransmitted in its place.
+		 * PUBREL is sent again if PUBREC is received twice.
+		 */
+		if (!meta->released) {
+			meta->released = 1U;
+
+			net_buf_reset(buf);
+			net_buf_add_u8(buf, MQTT_MESSAGES_OPTIONS(
+					       MQTT_PKT_TYPE_PUBREL, 0, 1, 0));
+			net_buf_add_u8(buf, sizeof(uint16_t));
+			net_buf_add_be16(buf, message_id);
+		}
+
+		err_code = mqtt_transport_write(client, buf->data, buf->len);
+		if (err_code < 0) {
+			return err_code;
+		}
+
+		client->internal.last_activity = mqtt_sys_tick_in_ms_get();
+		break;
+
+	case MQTT_PKT_TYPE_PUBCOMP:
+		if (meta->released) {
+			inflight_remove(client, buf);
+		}
+
+		break;
+
+	default:
+		break;
+	}
+
+	return 0;
+}
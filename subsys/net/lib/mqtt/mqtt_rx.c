@@ -42,6 +42,18 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 						MQTT_CONNECTION_ACCEPTED) {
 				/* Set state. */
 				MQTT_SET_STATE(client, MQTT_STATE_CONNECTED);
+
+#if defined(CONFIG_MQTT_VERSION_5_0)
+				client->internal.server_receive_max =
+					evt.param.connack.receive_max;
+				client->internal.server_topic_alias_max =
+					evt.param.connack.topic_alias_max;
+				client->internal.server_max_packet_size =
+					evt.param.connack.max_packet_size;
+#endif
+
+				err_code = mqtt_queue_resend(client,
+					evt.param.connack.session_present_flag);
 			} else {
 				err_code = -ECONNREFUSED;
 			}
@@ -57,8 +69,8 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 		MQTT_TRC("[CID %p]: Received MQTT_PKT_TYPE_PUBLISH", client);
 
 		evt.type = MQTT_EVT_PUBLISH;
-		err_code = publish_decode(type_and_flags, var_length, buf,
-					  &evt.param.publish);
+		err_code = publish_decode(client, type_and_flags, var_length,
+					  buf, &evt.param.publish);
 		evt.result = err_code;
 
 		client->internal.remaining_payload =
@@ -75,16 +87,30 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 		MQTT_TRC("[CID %p]: Received MQTT_PKT_TYPE_PUBACK!", client);
 
 		evt.type = MQTT_EVT_PUBACK;
-		err_code = publish_ack_decode(buf, &evt.param.puback);
+		err_code = publish_ack_decode(client, var_length, buf,
+					      &evt.param.puback);
 		evt.result = err_code;
+
+		if (err_code == 0) {
+			err_code = mqtt_queue_ack(client, MQTT_PKT_TYPE_PUBACK,
+						  evt.param.puback.message_id,
+						  evt.param.puback.reason_code);
+		}
 		break;
 
 	case MQTT_PKT_TYPE_PUBREC:
 		MQTT_TRC("[CID %p]: Received MQTT_PKT_TYPE_PUBREC!", client);
 
 		evt.type = MQTT_EVT_PUBREC;
-		err_code = publish_receive_decode(buf, &evt.param.pubrec);
+		err_code = publish_receive_decode(client, var_length, buf,
+						  &evt.param.pubrec);
 		evt.result = err_code;
+
+		if (err_code == 0) {
+			err_code = mqtt_queue_ack(client, MQTT_PKT_TYPE_PUBREC,
+						  evt.param.pubrec.message_id,
+						  evt.param.pubrec.reason_code);
+		}
 		break;
 
 	case MQTT_PKT_TYPE_PUBREL:
@@ -99,15 +125,23 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 		MQTT_TRC("[CID %p]: Received MQTT_PKT_TYPE_PUBCOMP!", client);
 
 		evt.type = MQTT_EVT_PUBCOMP;
-		err_code = publish_complete_decode(buf, &evt.param.pubcomp);
+		err_code = publish_complete_decode(client, var_length, buf,
+						   &evt.param.pubcomp);
 		evt.result = err_code;
+
+		if (err_code == 0) {
+			err_code = mqtt_queue_ack(client, MQTT_PKT_TYPE_PUBCOMP,
+						  evt.param.pubcomp.message_id,
+						  evt.param.pubcomp.reason_code);
+		}
 		break;
 
 	case MQTT_PKT_TYPE_SUBACK:
 		MQTT_TRC("[CID %p]: Received MQTT_PKT_TYPE_SUBACK!", client);
 
 		evt.type = MQTT_EVT_SUBACK;
-		err_code = subscribe_ack_decode(buf, &evt.param.suback);
+		err_code = subscribe_ack_decode(client, buf,
+						&evt.param.suback);
 		evt.result = err_code;
 		break;
 
@@ -119,6 +153,15 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 		evt.result = err_code;
 		break;
 
+	case MQTT_PKT_TYPE_DISCONNECT:
+		/* Sent by an MQTT 5.0 server before closing the connection */
+		MQTT_TRC("[CID %p]: Received MQTT_PKT_TYPE_DISCONNECT!",
+			 client);
+
+		err_code = -ECONNRESET;
+		notify_event = false;
+		break;
+
 	case MQTT_PKT_TYPE_PINGRSP:
 		MQTT_TRC("[CID %p]: Received MQTT_PKT_TYPE_PINGRSP!", client);
 
@@ -191,6 +234,36 @@ static int mqtt_read_message_chunk(struct mqtt_client *client,
 	return 0;
 }
 
+/* Read the MQTT 5.0 properties that follow the first offset bytes of
+ * the variable header.
+ */
+static int mqtt_read_properties(struct mqtt_client *client,
+				struct buf_ctx *buf, uint32_t offset)
+{
+	uint32_t length = 0U;
+	uint8_t shift = 0U;
+	uint8_t byte;
+	int err_code;
+
+	/* Property length is a variable byte integer, read byte by byte. */
+	do {
+		if (shift >= MQTT_MAX_LENGTH_BYTES * MQTT_LENGTH_SHIFT) {
+			return -EINVAL;
+		}
+
+		err_code = mqtt_read_message_chunk(client, buf, ++offset);
+		if (err_code < 0) {
+			return err_code;
+		}
+
+		byte = buf->cur[offset - 1];
+		length += (uint32_t)(byte & MQTT_LENGTH_VALUE_MASK) << shift;
+		shift += MQTT_LENGTH_SHIFT;
+	} while (byte & MQTT_LENGTH_CONTINUATION_BIT);
+
+	return mqtt_read_message_chunk(client, buf, offset + length);
+}
+
 static int mqtt_read_publish_var_header(struct mqtt_client *client,
 					uint8_t type_and_flags,
 					struct buf_ctx *buf)
@@ -223,7 +296,12 @@ static int mqtt_read_publish_var_header(struct mqtt_client *client,
 		return err_code;
 	}
 
-	return 0;
+	if (mqtt_is_version_5_0(client)) {
+		err_code = mqtt_read_properties(client, buf,
+						variable_header_length);
+	}
+
+	return err_code;
 }
 
 static int mqtt_read_and_parse_fixed_header(struct mqtt_client *client,
@@ -42,6 +42,9 @@ LOG_MODULE_REGISTER(net_websocket, CONFIG_NET_WEBSOCKET_LOG_LEVEL);
 #define HEXDUMP_SENT_PACKETS 0
 #define HEXDUMP_RECV_PACKETS 0
 
+/* Masked payloads up to this length are masked in a stack buffer */
+#define MASK_BUF_LEN 128
+
 static struct websocket_context contexts[CONFIG_WEBSOCKET_MAX_CONTEXTS];
 
 static struct k_sem contexts_lock;
@@ -440,6 +443,43 @@ static int websocket_ioctl_vmeth(void *obj, unsigned int request, va_list args)
 	return sock_fd_op_vtable.fd_vtable.ioctl(obj, request, args);
 }
 
+/* Mask or unmask len bytes from src to dst, which may be the same buffer.
+ * The offset is the position of the data in the payload, as it selects
+ * the byte of the masking key to start with.
+ */
+static void websocket_mask(uint8_t *dst, const uint8_t *src, size_t len,
+			   uint32_t masking_value, uint64_t offset)
+{
+	uint8_t key[sizeof(uint32_t)], word_key[sizeof(uint32_t)];
+	uint32_t word;
+	size_t i = 0;
+	int j;
+
+	sys_put_be32(masking_value, key);
+
+	for (; i < len && POINTER_TO_UINT(&dst[i]) % sizeof(uint32_t); i++) {
+		dst[i] = src[i] ^ key[(offset + i) % sizeof(key)];
+	}
+
+	if (len - i >= sizeof(uint32_t)) {
+		/* The key in the order it is applied from here on */
+		for (j = 0; j < sizeof(word_key); j++) {
+			word_key[j] = key[(offset + i + j) % sizeof(key)];
+		}
+
+		word = UNALIGNED_GET((uint32_t *)word_key);
+
+		for (; len - i >= sizeof(uint32_t); i += sizeof(uint32_t)) {
+			*(uint32_t *)&dst[i] =
+				UNALIGNED_GET((const uint32_t *)&src[i]) ^ word;
+		}
+	}
+
+	for (; i < len; i++) {
+		dst[i] = src[i] ^ key[(offset + i) % sizeof(key)];
+	}
+}
+
 static int websocket_prepare_and_send(struct websocket_context *ctx,
 				      uint8_t *header, size_t header_len,
 				      uint8_t *payload, size_t payload_len,
@@ -480,12 +520,49 @@ static int websocket_prepare_and_send(struct websocket_context *ctx,
 #endif /* CONFIG_NET_TEST */
 }
 
+/* Mask and send the payload in pieces when there is no memory for all
+ * of it. The header is sent with the first piece.
+ */
+static int websocket_send_masked(struct websocket_context *ctx,
+				 uint8_t *header, size_t header_len,
+				 const uint8_t *payload, size_t payload_len,
+				 int32_t timeout)
+{
+	uint8_t mask_buf[MASK_BUF_LEN];
+	size_t sent = 0, len, hdr_len = header_len;
+	int ret;
+
+	while (sent < payload_len) {
+		len = MIN(payload_len - sent, sizeof(mask_buf));
+
+		websocket_mask(mask_buf, payload + sent, len,
+			       ctx->masking_value, sent);
+
+		ret = websocket_prepare_and_send(ctx, header, hdr_len,
+						 mask_buf, len, timeout);
+		if (ret < 0) {
+			return ret;
+		}
+
+		/* The rest of the frame cannot be sent after a short write */
+		if (ret != hdr_len + len) {
+			return -EIO;
+		}
+
+		hdr_len = 0;
+		sent += len;
+	}
+
+	return header_len + sent;
+}
+
 int websocket_send_msg(int ws_sock, const uint8_t *payload, size_t payload_len,
 		       enum websocket_opcode opcode, bool mask, bool final,
 		       int32_t timeout)
 {
 	struct websocket_context *ctx;
 	uint8_t header[MAX_HEADER_LEN], hdr_len = 2;
+	uint8_t mask_buf[MASK_BUF_LEN];
 	uint8_t *data_to_send = (uint8_t *)payload;
 	int ret;
 
@@ -550,8 +627,6 @@ int websocket_send_msg(int ws_sock, const uint8_t *payload, size_t payload_len,
 
 	/* Add masking value if needed */
 	if (mask) {
-		int i;
-
 		ctx->masking_value = sys_rand32_get();
 
 		header[hdr_len++] |= ctx->masking_value >> 24;
@@ -559,17 +634,27 @@ int websocket_send_msg(int ws_sock, const uint8_t *payload, size_t payload_len,
 		header[hdr_len++] |= ctx->masking_value >> 8;
 		header[hdr_len++] |= ctx->masking_value;
 
-		data_to_send = k_malloc(payload_len);
-		if (!data_to_send) {
-			return -ENOMEM;
+		if (payload_len <= sizeof(mask_buf)) {
+			data_to_send = mask_buf;
+		} else {
+			data_to_send = k_malloc(payload_len);
 		}
 
-		memcpy(data_to_send, payload, payload_len);
+		if (!data_to_send) {
+			ret = websocket_send_masked(ctx, header, hdr_len,
+						    payload, payload_len,
+						    timeout);
+			if (ret < 0) {
+				NET_DBG("Cannot send ws msg (%d)", ret);
+				return ret;
+			}
 
-		for (i = 0; i < payload_len; i++) {
-			data_to_send[i] ^=
-				ctx->masking_value >> (8 * (3 - i % 4));
+			return ret - hdr_len;
 		}
+
+		/* The payload is masked while it is copied */
+		websocket_mask(data_to_send, payload, payload_len,
+			       ctx->masking_value, 0);
 	}
 
 	ret = websocket_prepare_and_send(ctx, header, hdr_len,
@@ -580,7 +665,7 @@ int websocket_send_msg(int ws_sock, const uint8_t *payload, size_t payload_len,
 	}
 
 quit:
-	if (data_to_send != payload) {
+	if (data_to_send != payload && data_to_send != mask_buf) {
 		k_free(data_to_send);
 	}
 
@@ -765,7 +850,7 @@ int websocket_recv_msg(int ws_sock, uint8_t *buf, size_t buf_len,
 			ctx->tmp_buf_len - header_len);
 		ctx->tmp_buf_pos -= header_len;
 
-		if (ctx->tmp_buf_pos == 0) {
+		if (ctx->tmp_buf_pos == 0 && ctx->message_len > 0) {
 			/* No data after the header, let the caller call
 			 * this function again to get the payload.
 			 */
@@ -777,17 +862,29 @@ int websocket_recv_msg(int ws_sock, uint8_t *buf, size_t buf_len,
 
 	/* Now read the whole payload or parts of it */
 
+	if (ctx->message_len == ctx->total_read) {
+		/* A zero length frame has no payload to read, so finish it
+		 * here. Reading it would return 0 and the frame would never
+		 * complete.
+		 */
+		recv_len = 0;
+		goto received;
+	}
+
 	if (ctx->tmp_buf_pos == 0) {
-		/* Read more data into temp buffer */
-#if defined(CONFIG_NET_TEST)
-		size_t input_len = MIN(ctx->tmp_buf_len, test_data->input_len);
+		/* Nothing is buffered, so the payload is read directly to
+		 * the caller buffer. Only this message is read, the next
+		 * header stays in the socket.
+		 */
+		can_copy = MIN(ctx->message_len - ctx->total_read, buf_len);
 
-		memcpy(ctx->tmp_buf, test_data->input_buf, input_len);
-		test_data->input_buf += input_len;
+#if defined(CONFIG_NET_TEST)
+		ret = MIN(can_copy, test_data->input_len);
 
-		ret = input_len;
+		memcpy(buf, test_data->input_buf, ret);
+		test_data->input_buf += ret;
 #else
-		ret = recv(ctx->real_sock, ctx->tmp_buf, ctx->tmp_buf_len,
+		ret = recv(ctx->real_sock, buf, can_copy,
 			   K_TIMEOUT_EQ(tout, K_NO_WAIT) ? MSG_DONTWAIT : 0);
 #endif /* CONFIG_NET_TEST */
 
@@ -799,7 +896,8 @@ int websocket_recv_msg(int ws_sock, uint8_t *buf, size_t buf_len,
 			return 0;
 		}
 
-		ctx->tmp_buf_pos = ret;
+		recv_len = ret;
+		goto received;
 	}
 
 	if (ctx->tmp_buf_pos <= buf_len) {
@@ -827,23 +925,18 @@ int websocket_recv_msg(int ws_sock, uint8_t *buf, size_t buf_len,
 	}
 
 	ctx->tmp_buf_pos = left;
-	ctx->total_read += recv_len;
 
-	/* Unmask the data */
+received:
+	/* Unmask the data, the position in the payload tells which byte of
+	 * the masking value to start with.
+	 */
 	if (ctx->masked) {
-		/* As we might have less than 4 received bytes, we must select
-		 * which byte from masking value to take. The mask_shift will
-		 * tell that.
-		 */
-		int mask_shift = (ctx->total_read - recv_len) % sizeof(uint32_t);
-		int i;
-
-		for (i = 0; i < recv_len; i++) {
-			buf[i] ^= ctx->masking_value >>
-				(8 * (3 - (i + mask_shift) % 4));
-		}
+		websocket_mask(buf, buf, recv_len, ctx->masking_value,
+			       ctx->total_read);
 	}
 
+	ctx->total_read += recv_len;
+
 #if HEXDUMP_RECV_PACKETS
 	LOG_HEXDUMP_DBG(buf, recv_len, "Payload");
 #endif
@@ -13,12 +13,43 @@
  *  1. From __start to main()
  *  2. From __start to task
  *  3. From __start to idle
+ *  4. The init function of each device
  */
 
 #include <zephyr.h>
+#include <device.h>
 #include <tc_util.h>
 #include <kernel_internal.h>
 
+static uint32_t cycles_to_us(uint32_t cycles)
+{
+	return (uint32_t)ceiling_fraction(USEC_PER_SEC * (uint64_t)cycles,
+					  sys_clock_hw_cycles_per_sec());
+}
+
+static void device_init_report(void)
+{
+	const struct device *devices;
+	uint32_t cycles, total = 0U;
+	size_t count, i;
+
+	count = z_device_get_all_static(&devices);
+
+	for (i = 0; i < count; i++) {
+		cycles = z_device_init_cycles(&devices[i]);
+		total += cycles;
+
+		TC_PRINT("init %-20s: %u cycles, %u us\n", devices[i].name,
+			 cycles, cycles_to_us(cycles));
+	}
+
+	/* With CONFIG_DEVICE_INIT_PARALLEL, devices initialized at the same
+	 * time add up to more than the elapsed time.
+	 */
+	TC_PRINT("init %-20s: %u cycles, %u us (%zu devices)\n", "total",
+		 total, cycles_to_us(total), count);
+}
+
 void main(void)
 {
 	uint32_t task_time_stamp;	/* timestamp at beginning of first task */
@@ -52,6 +83,7 @@ void main(void)
 						       task_us);
 	TC_PRINT("_start->idle  : %u cycles, %u us\n", z_timestamp_idle,
 						       idle_us);
+	device_init_report();
 	TC_PRINT("Boot Time Measurement finished\n");
 
 	TC_END_RESULT(TC_PASS);
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Copy of the network message cache of subsys/bluetooth/mesh/net.c and of
+ * the replay protection list of subsys/bluetooth/mesh/rpl.c as they were
+ * before they were hashed. IV index handling is left out, the benchmark
+ * runs within a single IV index.
+ */
+
+#include <string.h>
+#include <sys/util.h>
+#include <zephyr/types.h>
+
+#include "baseline.h"
+
+static struct {
+	uint16_t src;
+	uint32_t seq:17;
+} msg_cache[CONFIG_BT_MESH_MSG_CACHE_SIZE];
+static uint16_t msg_cache_next;
+
+static struct {
+	uint16_t src;
+	uint32_t seq:24;
+} replay_list[CONFIG_BT_MESH_CRPL];
+
+bool baseline_msg_cache_check(uint16_t src, uint32_t seq)
+{
+	uint16_t i;
+
+	for (i = 0U; i < ARRAY_SIZE(msg_cache); i++) {
+		if (msg_cache[i].src == src &&
+		    msg_cache[i].seq == (seq & BIT_MASK(17))) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void baseline_msg_cache_add(uint16_t src, uint32_t seq)
+{
+	msg_cache[msg_cache_next].src = src;
+	msg_cache[msg_cache_next].seq = seq;
+	msg_cache_next++;
+	msg_cache_next %= ARRAY_SIZE(msg_cache);
+}
+
+bool baseline_rpl_check(uint16_t src, uint32_t seq)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(replay_list); i++) {
+		/* Empty slot */
+		if (!replay_list[i].src) {
+			replay_list[i].src = src;
+			replay_list[i].seq = seq;
+			return false;
+		}
+
+		/* Existing slot for given address */
+		if (replay_list[i].src == src) {
+			if (replay_list[i].seq < seq) {
+				replay_list[i].seq = seq;
+				return false;
+			}
+
+			return true;
+		}
+	}
+
+	return true;
+}
+
+void baseline_clear(void)
+{
+	(void)memset(msg_cache, 0, sizeof(msg_cache));
+	(void)memset(replay_list, 0, sizeof(replay_list));
+	msg_cache_next = 0U;
+}
@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef BENCHMARK_BT_MESH_RELAY_BASELINE_H_
+#define BENCHMARK_BT_MESH_RELAY_BASELINE_H_
+
+#include <stdbool.h>
+#include <zephyr/types.h>
+
+/* The network message cache and RPL of the mesh stack before they were
+ * hashed, kept as the baseline of the benchmark: both lists are scanned
+ * linearly for every received PDU.
+ */
+bool baseline_msg_cache_check(uint16_t src, uint32_t seq);
+void baseline_msg_cache_add(uint16_t src, uint32_t seq);
+
+/* Returns true if seq from src is a replay, otherwise accepts it */
+bool baseline_rpl_check(uint16_t src, uint32_t seq);
+
+void baseline_clear(void);
+
+#endif /* BENCHMARK_BT_MESH_RELAY_BASELINE_H_ */
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <errno.h>
+#include <sys/printk.h>
+#include <bluetooth/mesh.h>
+
+#include "mesh.h"
+#include "net.h"
+#include "rpl.h"
+
+#include "baseline.h"
+#include "bench_timer.h"
+
+/* Number of messages received from each source */
+#define ROUNDS 16
+/* Sources are unicast addresses, which fill the whole RPL */
+#define SRC_COUNT MIN(CONFIG_BT_MESH_CRPL, 0x7fff)
+/* Each message is received twice */
+#define PDU_COUNT (2U * ROUNDS * SRC_COUNT)
+
+static int linear_recv(uint16_t src, uint32_t seq)
+{
+	if (baseline_msg_cache_check(src, seq)) {
+		return -EINVAL;
+	}
+
+	baseline_msg_cache_add(src, seq);
+
+	if (baseline_rpl_check(src, seq)) {
+		return -EINVAL;
+	}
+
+	/* A relayed copy of the same message must be filtered out */
+	if (!baseline_msg_cache_check(src, seq)) {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int hashed_recv(uint16_t src, uint32_t seq)
+{
+	struct bt_mesh_net_rx rx = {
+		.ctx.addr = src,
+		.seq = seq,
+		.net_if = BT_MESH_NET_IF_ADV,
+		.local_match = 1U,
+	};
+
+	if (bt_mesh_msg_cache_check(src, seq)) {
+		return -EINVAL;
+	}
+
+	rx.msg_cache_idx = bt_mesh_msg_cache_add(src, seq);
+
+	/* Settings are disabled, the entry is updated without storing it */
+	if (bt_mesh_rpl_check(&rx, NULL)) {
+		return -EINVAL;
+	}
+
+	if (!bt_mesh_msg_cache_check(src, seq)) {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static void bench_filter(const char *name, int (*recv)(uint16_t, uint32_t))
+{
+	uint32_t cycles, ns;
+	uint64_t start;
+	uint16_t src;
+	int round;
+
+	start = bench_time_get();
+
+	for (round = 1; round <= ROUNDS; round++) {
+		for (src = 1U; src <= SRC_COUNT; src++) {
+			if (recv(src, round)) {
+				printk("%s filter failed for 0x%04x\n", name,
+				       src);
+				return;
+			}
+		}
+	}
+
+	bench_result(start, PDU_COUNT, &cycles, &ns);
+
+	printk("  %-8s %8u %8u\n", name, cycles, ns);
+}
+
+void main(void)
+{
+	printk("bt mesh relay benchmark: %u sources, %u cache entries, "
+	       "%u rounds\n", SRC_COUNT, CONFIG_BT_MESH_MSG_CACHE_SIZE,
+	       ROUNDS);
+	printk("  filter      cycles       ns\n");
+
+	baseline_clear();
+	bench_filter("linear", linear_recv);
+
+	bt_mesh_rpl_clear();
+	bt_mesh_msg_cache_clear();
+	bench_filter("hashed", hashed_recv);
+
+	printk("bt mesh relay benchmark done\n");
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file
+ * @brief Time measurement shared by the benchmarks
+ *
+ * The average time of a run is measured with the cycle counter. On
+ * native_posix the simulated time does not advance while code runs, so the
+ * host clock is used instead. It counts no cycles, and the cycle count is
+ * reported as 0.
+ *
+ * Add ${ZEPHYR_BASE}/tests/benchmarks/common to the include directories of
+ * the application to use it.
+ */
+
+#ifndef ZEPHYR_TESTS_BENCHMARKS_COMMON_BENCH_TIMER_H_
+#define ZEPHYR_TESTS_BENCHMARKS_COMMON_BENCH_TIMER_H_
+
+#include <zephyr.h>
+
+#if defined(CONFIG_ARCH_POSIX)
+extern uint64_t get_host_us_time(void);
+#endif
+
+/** @brief Get the start time of a measurement. */
+static inline uint64_t bench_time_get(void)
+{
+#if defined(CONFIG_ARCH_POSIX)
+	return get_host_us_time();
+#else
+	return k_cycle_get_32();
+#endif
+}
+
+/**
+ * @brief Get the average time of a run.
+ *
+ * @param start Time returned by bench_time_get() before the runs.
+ * @param count Number of runs.
+ * @param cycles Average number of cycles of a run, 0 on native_posix.
+ * @param ns Average number of nanoseconds of a run.
+ */
+static inline void bench_result(uint64_t start, uint32_t count,
+				uint32_t *cycles, uint32_t *ns)
+{
+#if defined(CONFIG_ARCH_POSIX)
+	*cycles = 0U;
+	*ns = (uint32_t)((get_host_us_time() - start) * NSEC_PER_USEC / count);
+#else
+	uint32_t elapsed = k_cycle_get_32() - (uint32_t)start;
+
+	*cycles = elapsed / count;
+	*ns = (uint32_t)(k_cyc_to_ns_floor64(elapsed) / count);
+#endif
+}
+
+#endif /* ZEPHYR_TESTS_BENCHMARKS_COMMON_BENCH_TIMER_H_ */
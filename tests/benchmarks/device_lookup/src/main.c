@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <device.h>
+#include <string.h>
+#include <sys/printk.h>
+
+/* Lookups of each name, the average time is reported */
+#define LOOKUP_ROUNDS 1000
+
+#define BENCH_NAME_PREFIX "BENCH_"
+
+static int bench_init(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	return 0;
+}
+
+#define BENCH_DEVICE(i, _)						\
+	DEVICE_AND_API_INIT(bench_dev_##i, BENCH_NAME_PREFIX #i,	\
+			    bench_init, NULL, NULL, APPLICATION,	\
+			    CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, NULL);
+
+UTIL_LISTIFY(CONFIG_APP_DEVICE_COUNT, BENCH_DEVICE, _)
+
+static bool bench_lookup(const char *label, const char *kind,
+			 const char *name, const struct device *expected)
+{
+	const struct device *dev;
+	uint32_t start, cycles;
+	int i;
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < LOOKUP_ROUNDS; i++) {
+		dev = device_get_binding(name);
+		if (dev != expected) {
+			printk("%s: unexpected device %p\n", label, dev);
+			return false;
+		}
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	printk("  %-8s %-8s %8u cycles/lookup %8u ns/lookup\n", label, kind,
+	       cycles / LOOKUP_ROUNDS,
+	       (uint32_t)(k_cyc_to_ns_floor64(cycles) / LOOKUP_ROUNDS));
+
+	return true;
+}
+
+/* Look the device up with the string it was defined with, which is
+ * matched by address, and with a copy of it.
+ */
+static bool bench_device(const char *label, const struct device *dev)
+{
+	char name[Z_DEVICE_MAX_NAME_LEN];
+
+	strncpy(name, dev->name, sizeof(name) - 1);
+	name[sizeof(name) - 1] = '\0';
+
+	return bench_lookup(label, "literal", dev->name, dev) &&
+	       bench_lookup(label, "copy", name, dev);
+}
+
+void main(void)
+{
+	const struct device *bench[CONFIG_APP_DEVICE_COUNT];
+	const struct device *devs;
+	size_t count, i, n = 0;
+	char missing[] = BENCH_NAME_PREFIX "MISSING";
+
+	/* The benchmark devices in the order of the device list, which is
+	 * the order a linear search goes through.
+	 */
+	count = z_device_get_all_static(&devs);
+
+	for (i = 0; i < count && n < ARRAY_SIZE(bench); i++) {
+		if (strncmp(devs[i].name, BENCH_NAME_PREFIX,
+			    strlen(BENCH_NAME_PREFIX)) == 0) {
+			bench[n++] = &devs[i];
+		}
+	}
+
+	if (n != ARRAY_SIZE(bench)) {
+		printk("found %zu of %d devices\n", n, CONFIG_APP_DEVICE_COUNT);
+		return;
+	}
+
+	printk("device lookup: %zu devices, %zu defined by the benchmark, "
+	       "%d rounds\n", count, n, LOOKUP_ROUNDS);
+
+	if (!bench_device("first", bench[0]) ||
+	    !bench_device("middle", bench[n / 2]) ||
+	    !bench_device("last", bench[n - 1]) ||
+	    !bench_lookup("missing", "copy", missing, NULL)) {
+		return;
+	}
+
+	printk("device lookup benchmark done\n");
+}
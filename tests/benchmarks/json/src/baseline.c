@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Copy of the callback based encoder of lib/os/json.c as it was before it
+ * encoded in a single pass. Floating point fields are not used by the
+ * benchmark documents and are left out.
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/printk.h>
+#include <sys/util.h>
+#include <zephyr/types.h>
+
+#include "baseline.h"
+
+static ptrdiff_t get_elem_size(const struct json_obj_descr *descr)
+{
+	switch (descr->type) {
+	case JSON_TOK_NUMBER:
+		return sizeof(int32_t);
+	case JSON_TOK_INT64:
+		return sizeof(int64_t);
+	case JSON_TOK_STRING:
+		return sizeof(char *);
+	case JSON_TOK_TRUE:
+	case JSON_TOK_FALSE:
+		return sizeof(bool);
+	case JSON_TOK_LIST_START:
+		return descr->array.n_elements * get_elem_size(descr->array.element_descr);
+	case JSON_TOK_OBJECT_START: {
+		ptrdiff_t total = 0;
+		size_t i;
+
+		for (i = 0; i < descr->object.sub_descr_len; i++) {
+			ptrdiff_t s = get_elem_size(&descr->object.sub_descr[i]);
+
+			total += ROUND_UP(s, 1 << descr->align_shift);
+		}
+
+		return total;
+	}
+	default:
+		return -EINVAL;
+	}
+}
+
+static char escape_as(char chr)
+{
+	switch (chr) {
+	case '"':
+		return '"';
+	case '\\':
+		return '\\';
+	case '\b':
+		return 'b';
+	case '\f':
+		return 'f';
+	case '\n':
+		return 'n';
+	case '\r':
+		return 'r';
+	case '\t':
+		return 't';
+	}
+
+	return 0;
+}
+
+static int json_escape_internal(const char *str,
+				json_append_bytes_t append_bytes,
+				void *data)
+{
+	const char *cur;
+	int ret = 0;
+
+	for (cur = str; ret == 0 && *cur; cur++) {
+		char escaped = escape_as(*cur);
+
+		if (escaped) {
+			char bytes[2] = { '\\', escaped };
+
+			ret = append_bytes(bytes, 2, data);
+		} else {
+			ret = append_bytes(cur, 1, data);
+		}
+	}
+
+	return ret;
+}
+
+static int encode(const struct json_obj_descr *descr, const void *val,
+		  json_append_bytes_t append_bytes, void *data);
+
+static int arr_encode(const struct json_obj_descr *elem_descr,
+		      const void *field, const void *val,
+		      json_append_bytes_t append_bytes, void *data)
+{
+	ptrdiff_t elem_size = get_elem_size(elem_descr);
+	size_t n_elem = *(size_t *)((char *)val + elem_descr->offset);
+	size_t i;
+	int ret;
+
+	ret = append_bytes("[", 1, data);
+	if (ret < 0) {
+		return ret;
+	}
+
+	for (i = 0; i < n_elem; i++) {
+		ret = encode(elem_descr, (char *)field - elem_descr->offset,
+			     append_bytes, data);
+		if (ret < 0) {
+			return ret;
+		}
+
+		if (i < n_elem - 1) {
+			ret = append_bytes(",", 1, data);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+
+		field = (char *)field + elem_size;
+	}
+
+	return append_bytes("]", 1, data);
+}
+
+static int str_encode(const char **str, json_append_bytes_t append_bytes,
+		      void *data)
+{
+	int ret;
+
+	ret = append_bytes("\"", 1, data);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = json_escape_internal(*str, append_bytes, data);
+	if (!ret) {
+		return append_bytes("\"", 1, data);
+	}
+
+	return ret;
+}
+
+static int num_encode(const int32_t *num, json_append_bytes_t append_bytes,
+		      void *data)
+{
+	char buf[3 * sizeof(int32_t)];
+	int ret;
+
+	ret = snprintk(buf, sizeof(buf), "%d", *num);
+	if (ret < 0) {
+		return ret;
+	}
+	if (ret >= (int)sizeof(buf)) {
+		return -ENOMEM;
+	}
+
+	return append_bytes(buf, (size_t)ret, data);
+}
+
+static int int64_encode(const int64_t *num, json_append_bytes_t append_bytes,
+			void *data)
+{
+	char buf[sizeof("-9223372036854775808") - 1];
+	char *pos = buf + sizeof(buf);
+	uint64_t val = *num < 0 ? 0U - (uint64_t)*num : (uint64_t)*num;
+
+	do {
+		*--pos = '0' + val % 10U;
+		val /= 10U;
+	} while (val != 0U);
+
+	if (*num < 0) {
+		*--pos = '-';
+	}
+
+	return append_bytes(pos, (size_t)(buf + sizeof(buf) - pos), data);
+}
+
+static int bool_encode(const bool *value, json_append_bytes_t append_bytes,
+		       void *data)
+{
+	if (*value) {
+		return append_bytes("true", 4, data);
+	}
+
+	return append_bytes("false", 5, data);
+}
+
+static int encode(const struct json_obj_descr *descr, const void *val,
+		  json_append_bytes_t append_bytes, void *data)
+{
+	void *ptr = (char *)val + descr->offset;
+
+	switch (descr->type) {
+	case JSON_TOK_FALSE:
+	case JSON_TOK_TRUE:
+		return bool_encode(ptr, append_bytes, data);
+	case JSON_TOK_STRING:
+		return str_encode(ptr, append_bytes, data);
+	case JSON_TOK_LIST_START:
+		return arr_encode(descr->array.element_descr, ptr,
+				  val, append_bytes, data);
+	case JSON_TOK_OBJECT_START:
+		return baseline_obj_encode(descr->object.sub_descr,
+					   descr->object.sub_descr_len,
+					   ptr, append_bytes, data);
+	case JSON_TOK_NUMBER:
+		return num_encode(ptr, append_bytes, data);
+	case JSON_TOK_INT64:
+		return int64_encode(ptr, append_bytes, data);
+	default:
+		return -EINVAL;
+	}
+}
+
+int baseline_obj_encode(const struct json_obj_descr *descr, size_t descr_len,
+			const void *val, json_append_bytes_t append_bytes,
+			void *data)
+{
+	size_t i;
+	int ret;
+
+	ret = append_bytes("{", 1, data);
+	if (ret < 0) {
+		return ret;
+	}
+
+	for (i = 0; i < descr_len; i++) {
+		ret = str_encode((const char **)&descr[i].field_name,
+				 append_bytes, data);
+		if (ret < 0) {
+			return ret;
+		}
+
+		ret = append_bytes(":", 1, data);
+		if (ret < 0) {
+			return ret;
+		}
+
+		ret = encode(&descr[i], val, append_bytes, data);
+		if (ret < 0) {
+			return ret;
+		}
+
+		if (i < descr_len - 1) {
+			ret = append_bytes(",", 1, data);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+	}
+
+	return append_bytes("}", 1, data);
+}
+
+struct appender {
+	char *buffer;
+	size_t used;
+	size_t size;
+};
+
+static int append_bytes_to_buf(const char *bytes, size_t len, void *data)
+{
+	struct appender *appender = data;
+
+	if (len >= appender->size - appender->used) {
+		return -ENOMEM;
+	}
+
+	memcpy(appender->buffer + appender->used, bytes, len);
+	appender->used += len;
+	appender->buffer[appender->used] = '\0';
+
+	return 0;
+}
+
+int baseline_obj_encode_buf(const struct json_obj_descr *descr,
+			    size_t descr_len, const void *val, char *buffer,
+			    size_t buf_size)
+{
+	struct appender appender = { .buffer = buffer, .size = buf_size };
+
+	return baseline_obj_encode(descr, descr_len, val, append_bytes_to_buf,
+				   &appender);
+}
+
+static int measure_bytes(const char *bytes, size_t len, void *data)
+{
+	ssize_t *total = data;
+
+	*total += (ssize_t)len;
+
+	ARG_UNUSED(bytes);
+
+	return 0;
+}
+
+ssize_t baseline_calc_encoded_len(const struct json_obj_descr *descr,
+				  size_t descr_len, const void *val)
+{
+	ssize_t total = 0;
+	int ret;
+
+	ret = baseline_obj_encode(descr, descr_len, val, measure_bytes,
+				  &total);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return total;
+}
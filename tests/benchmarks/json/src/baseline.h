@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef BENCHMARK_JSON_BASELINE_H_
+#define BENCHMARK_JSON_BASELINE_H_
+
+#include <data/json.h>
+
+/* The encoder of the JSON library before the single pass one, kept as the
+ * baseline of the benchmark: one append_bytes call per token, and a
+ * separate measuring pass to size the buffer.
+ */
+int baseline_obj_encode(const struct json_obj_descr *descr, size_t descr_len,
+			const void *val, json_append_bytes_t append_bytes,
+			void *data);
+
+int baseline_obj_encode_buf(const struct json_obj_descr *descr,
+			    size_t descr_len, const void *val, char *buffer,
+			    size_t buf_size);
+
+ssize_t baseline_calc_encoded_len(const struct json_obj_descr *descr,
+				  size_t descr_len, const void *val);
+
+#endif /* BENCHMARK_JSON_BASELINE_H_ */
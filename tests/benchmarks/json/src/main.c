@@ -0,0 +1,326 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <sys/printk.h>
+#include <data/json.h>
+
+#include "baseline.h"
+#include "bench_timer.h"
+
+#define ROUNDS 1000
+
+#define BUF_SIZE 2048
+
+/* LwM2M device object, in the JSON content format */
+struct lwm2m_res {
+	const char *n;
+	const char *sv;
+};
+
+struct lwm2m_obj {
+	const char *bn;
+	int64_t bt;
+	struct lwm2m_res e[12];
+	size_t e_len;
+};
+
+static const struct json_obj_descr lwm2m_res_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct lwm2m_res, n, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct lwm2m_res, sv, JSON_TOK_STRING),
+};
+
+static const struct json_obj_descr lwm2m_obj_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct lwm2m_obj, bn, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct lwm2m_obj, bt, JSON_TOK_INT64),
+	JSON_OBJ_DESCR_OBJ_ARRAY(struct lwm2m_obj, e, 12, e_len,
+				 lwm2m_res_descr,
+				 ARRAY_SIZE(lwm2m_res_descr)),
+};
+
+static const struct lwm2m_obj lwm2m = {
+	.bn = "/3/0/",
+	.bt = 1599123456,
+	.e = {
+		{ "0", "Zephyr" },
+		{ "1", "OMA-LWM2M Sample Client" },
+		{ "2", "345000123" },
+		{ "3", "1.0" },
+		{ "6/0", "1" },
+		{ "6/1", "5" },
+		{ "7/0", "3800" },
+		{ "7/1", "5000" },
+		{ "9", "100" },
+		{ "11/0", "0" },
+		{ "16", "U" },
+		{ "17", "Zephyr \"qemu_x86\" board" },
+	},
+	.e_len = 12,
+};
+
+/* hawkBit deployment base */
+struct hawkbit_href {
+	const char *href;
+};
+
+struct hawkbit_hashes {
+	const char *sha1;
+	const char *md5;
+	const char *sha256;
+};
+
+struct hawkbit_links {
+	struct hawkbit_href download_http;
+	struct hawkbit_href md5sum_http;
+};
+
+struct hawkbit_artifact {
+	const char *filename;
+	struct hawkbit_hashes hashes;
+	struct hawkbit_links _links;
+	int size;
+};
+
+struct hawkbit_chunk {
+	const char *part;
+	const char *name;
+	const char *version;
+	struct hawkbit_artifact artifacts[2];
+	size_t num_artifacts;
+};
+
+struct hawkbit_deploy {
+	const char *download;
+	const char *update;
+	struct hawkbit_chunk chunks[1];
+	size_t num_chunks;
+};
+
+struct hawkbit_dep {
+	const char *id;
+	struct hawkbit_deploy deployment;
+};
+
+static const struct json_obj_descr hawkbit_href_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct hawkbit_href, href, JSON_TOK_STRING),
+};
+
+static const struct json_obj_descr hawkbit_hashes_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct hawkbit_hashes, sha1, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct hawkbit_hashes, md5, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct hawkbit_hashes, sha256, JSON_TOK_STRING),
+};
+
+static const struct json_obj_descr hawkbit_links_descr[] = {
+	JSON_OBJ_DESCR_OBJECT_NAMED(struct hawkbit_links, "download-http",
+				    download_http, hawkbit_href_descr),
+	JSON_OBJ_DESCR_OBJECT_NAMED(struct hawkbit_links, "md5sum-http",
+				    md5sum_http, hawkbit_href_descr),
+};
+
+static const struct json_obj_descr hawkbit_artifact_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct hawkbit_artifact, filename,
+			    JSON_TOK_STRING),
+	JSON_OBJ_DESCR_OBJECT(struct hawkbit_artifact, hashes,
+			      hawkbit_hashes_descr),
+	JSON_OBJ_DESCR_OBJECT(struct hawkbit_artifact, _links,
+			      hawkbit_links_descr),
+	JSON_OBJ_DESCR_PRIM(struct hawkbit_artifact, size, JSON_TOK_NUMBER),
+};
+
+static const struct json_obj_descr hawkbit_chunk_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct hawkbit_chunk, part, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct hawkbit_chunk, name, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct hawkbit_chunk, version, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_OBJ_ARRAY(struct hawkbit_chunk, artifacts, 2,
+				 num_artifacts, hawkbit_artifact_descr,
+				 ARRAY_SIZE(hawkbit_artifact_descr)),
+};
+
+static const struct json_obj_descr hawkbit_deploy_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct hawkbit_deploy, download, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct hawkbit_deploy, update, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_OBJ_ARRAY(struct hawkbit_deploy, chunks, 1,
+				 num_chunks, hawkbit_chunk_descr,
+				 ARRAY_SIZE(hawkbit_chunk_descr)),
+};
+
+static const struct json_obj_descr hawkbit_dep_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct hawkbit_dep, id, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_OBJECT(struct hawkbit_dep, deployment,
+			      hawkbit_deploy_descr),
+};
+
+#define HAWKBIT_URL "https://hawkbit.example.com/DEFAULT/controller/v1/" \
+	"qemu_x86-0123456789abcdef/softwaremodules/23/artifacts/zephyr.signed.bin"
+
+static const struct hawkbit_artifact hawkbit_artifact = {
+	.filename = "zephyr.signed.bin",
+	.hashes = {
+		.sha1 = "0f9d2a5e0d4c1b8f7a6e5d4c3b2a19080706f5e4",
+		.md5 = "5d4c3b2a190807060504030201f0e0d0",
+		.sha256 = "3a7bd3e2360a3d29eea436fcfb7e44c735d117c4"
+			  "2d1c1835420b6b9942dd4f1b",
+	},
+	._links = {
+		.download_http = { HAWKBIT_URL },
+		.md5sum_http = { HAWKBIT_URL ".MD5SUM" },
+	},
+	.size = 186412,
+};
+
+static const struct hawkbit_dep hawkbit = {
+	.id = "42",
+	.deployment = {
+		.download = "forced",
+		.update = "attempt",
+		.chunks = {
+			{
+				.part = "os",
+				.name = "zephyr",
+				.version = "2.3.99",
+				.artifacts = {
+					hawkbit_artifact, hawkbit_artifact,
+				},
+				.num_artifacts = 2,
+			},
+		},
+		.num_chunks = 1,
+	},
+};
+
+struct bench_doc {
+	const char *name;
+	const struct json_obj_descr *descr;
+	size_t descr_len;
+	const void *val;
+};
+
+static const struct bench_doc docs[] = {
+	{ "lwm2m", lwm2m_obj_descr, ARRAY_SIZE(lwm2m_obj_descr), &lwm2m },
+	{ "hawkbit", hawkbit_dep_descr, ARRAY_SIZE(hawkbit_dep_descr),
+	  &hawkbit },
+};
+
+enum bench_encoder {
+	ENC_OLD_CALC_BUF,
+	ENC_OLD_BUF,
+	ENC_CALC_BUF,
+	ENC_CALLBACK,
+	ENC_BUF_LEN,
+};
+
+static const char *const encoder_names[] = {
+	[ENC_OLD_CALC_BUF] = "old calc+buf",
+	[ENC_OLD_BUF] = "old buf",
+	[ENC_CALC_BUF] = "calc+buf",
+	[ENC_CALLBACK] = "callback",
+	[ENC_BUF_LEN] = "buf_len",
+};
+
+static char buf[BUF_SIZE];
+
+struct buf_appender {
+	char *buf;
+	size_t used;
+};
+
+static int append_to_buf(const char *bytes, size_t len, void *data)
+{
+	struct buf_appender *appender = data;
+
+	if (len >= sizeof(buf) - appender->used) {
+		return -ENOMEM;
+	}
+
+	memcpy(appender->buf + appender->used, bytes, len);
+	appender->used += len;
+
+	return 0;
+}
+
+static int encode_doc(enum bench_encoder enc, const struct bench_doc *doc)
+{
+	struct buf_appender appender = { .buf = buf };
+	ssize_t len;
+
+	switch (enc) {
+	case ENC_OLD_CALC_BUF:
+		len = baseline_calc_encoded_len(doc->descr, doc->descr_len,
+						doc->val);
+		if (len < 0 || len >= sizeof(buf)) {
+			return -ENOMEM;
+		}
+
+		return baseline_obj_encode_buf(doc->descr, doc->descr_len,
+					       doc->val, buf, len + 1);
+	case ENC_OLD_BUF:
+		return baseline_obj_encode_buf(doc->descr, doc->descr_len,
+					       doc->val, buf, sizeof(buf));
+	case ENC_CALC_BUF:
+		len = json_calc_encoded_len(doc->descr, doc->descr_len,
+					    doc->val);
+		if (len < 0 || len >= sizeof(buf)) {
+			return -ENOMEM;
+		}
+
+		return json_obj_encode_buf(doc->descr, doc->descr_len,
+					   doc->val, buf, len + 1);
+	case ENC_CALLBACK:
+		return json_obj_encode(doc->descr, doc->descr_len, doc->val,
+				       append_to_buf, &appender);
+	case ENC_BUF_LEN:
+		len = json_obj_encode_buf_len(doc->descr, doc->descr_len,
+					      doc->val, buf, sizeof(buf));
+		return len < sizeof(buf) ? 0 : -ENOMEM;
+	}
+
+	return -EINVAL;
+}
+
+static void bench_encode(enum bench_encoder enc, const struct bench_doc *doc)
+{
+	ssize_t len = json_calc_encoded_len(doc->descr, doc->descr_len,
+					    doc->val);
+	uint32_t cycles, ns;
+	uint64_t start;
+	int i, ret = 0;
+
+	start = bench_time_get();
+
+	for (i = 0; i < ROUNDS && !ret; i++) {
+		ret = encode_doc(enc, doc);
+	}
+
+	bench_result(start, ROUNDS, &cycles, &ns);
+
+	if (ret < 0) {
+		printk("  %-8s %6zd  %-12s failed: %d\n", doc->name, len,
+		       encoder_names[enc], ret);
+		return;
+	}
+
+	printk("  %-8s %6zd  %-12s %8u %8u\n", doc->name, len,
+	       encoder_names[enc], cycles, ns);
+}
+
+void main(void)
+{
+	enum bench_encoder enc;
+	int d;
+
+	printk("json benchmark: %d rounds\n", ROUNDS);
+	printk("  document  bytes  encoder        cycles       ns\n");
+
+	for (d = 0; d < ARRAY_SIZE(docs); d++) {
+		for (enc = ENC_OLD_CALC_BUF; enc <= ENC_BUF_LEN; enc++) {
+			bench_encode(enc, &docs[d]);
+		}
+	}
+
+	printk("json benchmark done\n");
+}
@@ -23,6 +23,7 @@ extern void int_to_thread(void);
 extern void int_to_thread_evt(void);
 extern void sema_test_signal(void);
 extern void mutex_lock_unlock(void);
+extern void sys_mutex_lock_unlock(void);
 extern int coop_ctx_switch(void);
 extern int sema_test(void);
 extern int sema_context_switch(void);
@@ -57,6 +58,8 @@ void test_thread(void *arg1, void *arg2, void *arg3)
 
 	mutex_lock_unlock();
 
+	sys_mutex_lock_unlock();
+
 	TC_END_REPORT(error_count);
 }
 
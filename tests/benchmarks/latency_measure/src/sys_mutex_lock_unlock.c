@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/mutex.h>
+#include <app_memory/app_memdomain.h>
+#include <timing/timing.h>
+#include "utils.h"
+
+/* the number of sys_mutex lock/unlock cycles */
+#define N_TEST_SYS_MUTEX 1000
+
+#define STACK_SIZE (1024 + CONFIG_TEST_EXTRA_STACKSIZE)
+
+#ifdef CONFIG_USERSPACE
+K_APPMEM_PARTITION_DEFINE(sys_mutex_partition);
+#define SYS_MUTEX_BMEM K_APP_BMEM(sys_mutex_partition)
+#else
+#define SYS_MUTEX_BMEM
+#endif
+
+SYS_MUTEX_BMEM SYS_MUTEX_DEFINE(test_sys_mutex);
+
+static struct k_thread lock_thread;
+static K_THREAD_STACK_DEFINE(lock_stack, STACK_SIZE);
+
+static void lock_unlock(void *p1, void *p2, void *p3)
+{
+	int i;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	for (i = 0; i < N_TEST_SYS_MUTEX; i++) {
+		sys_mutex_lock(&test_sys_mutex, K_FOREVER);
+		sys_mutex_unlock(&test_sys_mutex);
+	}
+}
+
+#ifdef CONFIG_USERSPACE
+static void nothing(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+}
+
+/* The timing counter may not be readable in user mode, the thread is
+ * timed from its creation to its end instead. It has a higher priority
+ * than the calling thread, so it runs to completion before the calling
+ * thread resumes.
+ */
+static uint32_t thread_run(k_thread_entry_t entry, uint32_t options)
+{
+	timing_t timestamp_start;
+	timing_t timestamp_end;
+
+	timestamp_start = timing_counter_get();
+
+	k_thread_create(&lock_thread, lock_stack, STACK_SIZE, entry,
+			NULL, NULL, NULL,
+			k_thread_priority_get(k_current_get()) - 1,
+			options, K_NO_WAIT);
+	k_thread_join(&lock_thread, K_FOREVER);
+
+	timestamp_end = timing_counter_get();
+
+	return timing_cycles_get(&timestamp_start, &timestamp_end);
+}
+#endif /* CONFIG_USERSPACE */
+
+/**
+ *
+ * @brief Test for the sys_mutex lock/unlock time
+ *
+ * The routine locks and unlocks an uncontended sys_mutex multiple times,
+ * from a supervisor thread and, with userspace, from a user thread, where
+ * the mutex is locked and unlocked without system calls.
+ *
+ * @return 0 on success
+ */
+int sys_mutex_lock_unlock(void)
+{
+	uint32_t diff;
+	timing_t timestamp_start;
+	timing_t timestamp_end;
+
+	timing_start();
+
+	timestamp_start = timing_counter_get();
+
+	lock_unlock(NULL, NULL, NULL);
+
+	timestamp_end = timing_counter_get();
+
+	diff = timing_cycles_get(&timestamp_start, &timestamp_end);
+	PRINT_STATS_AVG("Average time to lock and unlock a sys_mutex", diff,
+			N_TEST_SYS_MUTEX);
+
+#ifdef CONFIG_USERSPACE
+	uint32_t overhead;
+
+	k_mem_domain_add_partition(&k_mem_domain_default,
+				   &sys_mutex_partition);
+
+	/* Creating, running and joining the thread is not measured */
+	overhead = thread_run(nothing, K_USER);
+	diff = thread_run(lock_unlock, K_USER);
+	diff = diff > overhead ? diff - overhead : 0;
+
+	PRINT_STATS_AVG("Average time to lock and unlock a sys_mutex "
+			"in user mode", diff, N_TEST_SYS_MUTEX);
+#endif
+
+	timing_stop();
+	return 0;
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <sys/printk.h>
+
+#include "bench_timer.h"
+
+/* Each measurement goes through about this many bytes */
+#define BENCH_BYTES (64 * 1024)
+
+/* The host clock used on native_posix counts microseconds, so each
+ * measurement is repeated this many times there to span enough of them.
+ */
+#if defined(CONFIG_ARCH_POSIX)
+#define BENCH_REPEAT 100
+#else
+#define BENCH_REPEAT 1
+#endif
+
+#define MAX_SIZE 4096
+#define MAX_OFFSET 8
+
+static const size_t sizes[] = { 8, 64, 512, MAX_SIZE };
+
+/* Offsets of the source and of the destination from a word boundary */
+static const struct {
+	uint8_t src;
+	uint8_t dst;
+} offsets[] = {
+	{ 0, 0 },
+	{ 1, 1 },
+	{ 0, 1 },
+	{ 3, 0 },
+};
+
+static uint8_t src_buf[MAX_SIZE + 2 * MAX_OFFSET] __aligned(8);
+static uint8_t dst_buf[MAX_SIZE + 2 * MAX_OFFSET] __aligned(8);
+
+enum bench_op {
+	OP_MEMCPY,
+	OP_MEMMOVE,
+	OP_MEMSET,
+	OP_MEMCHR,
+	OP_STRLEN,
+	OP_STRCMP,
+};
+
+static const char *const op_names[] = {
+	[OP_MEMCPY] = "memcpy",
+	[OP_MEMMOVE] = "memmove",
+	[OP_MEMSET] = "memset",
+	[OP_MEMCHR] = "memchr",
+	[OP_STRLEN] = "strlen",
+	[OP_STRCMP] = "strcmp",
+};
+
+/* Buffers that only hold the terminator at <size> - 1, which is also the
+ * byte memchr() looks for.
+ */
+static void bench_setup(uint8_t *src, uint8_t *dst, size_t size)
+{
+	(void)memset(src_buf, 'a', sizeof(src_buf));
+	(void)memset(dst_buf, 'a', sizeof(dst_buf));
+
+	src[size - 1] = '\0';
+	dst[size - 1] = '\0';
+}
+
+static void bench_op(enum bench_op op, size_t size, int src_off,
+		     int dst_off)
+{
+	uint8_t *src = src_buf + src_off;
+	uint8_t *dst = dst_buf + dst_off;
+	uint32_t rounds = MAX(BENCH_BYTES / size, 1) * BENCH_REPEAT;
+	uint32_t cycles, ns, i;
+	uint64_t start;
+	volatile size_t sink = 0;
+
+	bench_setup(src, dst, size);
+
+	start = bench_time_get();
+
+	for (i = 0; i < rounds; i++) {
+		switch (op) {
+		case OP_MEMCPY:
+			(void)memcpy(dst, src, size);
+			break;
+		case OP_MEMMOVE:
+			/* Overlapping move up within the source buffer */
+			(void)memmove(src + MAX_OFFSET - src_off + dst_off,
+				      src, size);
+			break;
+		case OP_MEMSET:
+			(void)memset(dst, 'a', size);
+			break;
+		case OP_MEMCHR:
+			sink += (size_t)memchr(src, '\0', size);
+			break;
+		case OP_STRLEN:
+			sink += strlen((const char *)src);
+			break;
+		case OP_STRCMP:
+			sink += strcmp((const char *)src, (const char *)dst);
+			break;
+		}
+	}
+
+	bench_result(start, rounds, &cycles, &ns);
+
+	printk("  %-8s %5zu %3d %3d %8u %8u\n", op_names[op], size,
+	       src_off, dst_off, cycles, ns);
+}
+
+void main(void)
+{
+	enum bench_op op;
+	int s, o;
+
+	printk("string benchmark: %d bytes per measurement\n", BENCH_BYTES);
+	printk("  function  size src dst   cycles       ns\n");
+
+	for (op = OP_MEMCPY; op <= OP_STRCMP; op++) {
+		for (s = 0; s < ARRAY_SIZE(sizes); s++) {
+			for (o = 0; o < ARRAY_SIZE(offsets); o++) {
+				bench_op(op, sizes[s], offsets[o].src,
+					 offsets[o].dst);
+			}
+		}
+	}
+
+	printk("string benchmark done\n");
+}
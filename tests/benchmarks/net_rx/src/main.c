@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <net/socket.h>
+
+/*
+ * UDP echo server used to measure the receive path of an Ethernet driver.
+ * Every datagram sent to BENCH_PORT is echoed back to its sender, and the
+ * number of datagrams received is reported once per second. The load and
+ * the round-trip latency are generated and measured on the host by
+ * udp_load.py. See README.rst.
+ */
+
+#define BENCH_PORT 4242
+#define REPORT_MS 1000
+
+static uint8_t buf[1500];
+
+void main(void)
+{
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(BENCH_PORT),
+	};
+	struct sockaddr peer;
+	socklen_t peer_len;
+	struct pollfd fds;
+	uint32_t pkts = 0U, bytes = 0U;
+	int64_t next = k_uptime_get() + REPORT_MS;
+	int sock, len;
+
+	sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (sock < 0) {
+		printk("socket() failed (%d)\n", errno);
+		return;
+	}
+
+	if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		printk("bind() failed (%d)\n", errno);
+		return;
+	}
+
+	fds.fd = sock;
+	fds.events = POLLIN;
+
+	printk("UDP echo on port %d\n", BENCH_PORT);
+
+	while (1) {
+		if (poll(&fds, 1, MAX(next - k_uptime_get(), 0)) > 0) {
+			peer_len = sizeof(peer);
+			len = recvfrom(sock, buf, sizeof(buf), 0, &peer,
+				       &peer_len);
+			if (len > 0) {
+				(void)sendto(sock, buf, len, 0, &peer,
+					     peer_len);
+				pkts++;
+				bytes += len;
+			}
+		}
+
+		if (k_uptime_get() >= next) {
+			if (pkts) {
+				printk("rx %u pkts/s %u bytes/s\n", pkts,
+				       bytes);
+			}
+
+			pkts = 0U;
+			bytes = 0U;
+			next += REPORT_MS;
+		}
+	}
+}
@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2020 Intel Corporation
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""Host side of the net_rx benchmark.
+
+Measures the UDP round-trip latency to the Zephyr echo server with one
+datagram in flight, then the echoed packet rate with a window of datagrams
+in flight.
+"""
+
+import argparse
+import select
+import socket
+import time
+
+
+def latency(sock, addr, count, size):
+    payload = bytes(size)
+    rtts = []
+
+    for _ in range(count):
+        start = time.perf_counter()
+        sock.sendto(payload, addr)
+        if not select.select([sock], [], [], 1.0)[0]:
+            continue
+        sock.recv(2048)
+        rtts.append((time.perf_counter() - start) * 1e6)
+
+    if not rtts:
+        print("latency: no replies")
+        return
+
+    rtts.sort()
+    print("latency: %d/%d replies, min %.0f us, median %.0f us, "
+          "p99 %.0f us" % (len(rtts), count, rtts[0],
+                           rtts[len(rtts) // 2],
+                           rtts[min(len(rtts) - 1, len(rtts) * 99 // 100)]))
+
+
+def rate(sock, addr, duration, size, window):
+    payload = bytes(size)
+    sent = received = 0
+    end = time.perf_counter() + duration
+
+    while time.perf_counter() < end:
+        while sent - received < window:
+            sock.sendto(payload, addr)
+            sent += 1
+
+        if select.select([sock], [], [], 0.1)[0]:
+            sock.recv(2048)
+            received += 1
+        else:
+            # Assume the outstanding datagrams were dropped
+            sent = received
+
+    print("rate: %d echoed in %d s, %.0f pkts/s" %
+          (received, duration, received / duration))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--addr", default="192.0.2.1")
+    parser.add_argument("--port", type=int, default=4242)
+    parser.add_argument("--size", type=int, default=64)
+    parser.add_argument("--count", type=int, default=1000,
+                        help="datagrams sent for the latency test")
+    parser.add_argument("--duration", type=int, default=10,
+                        help="seconds of the rate test")
+    parser.add_argument("--window", type=int, default=32,
+                        help="datagrams in flight during the rate test")
+    args = parser.parse_args()
+
+    addr = (args.addr, args.port)
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+
+    latency(sock, addr, args.count, args.size)
+    rate(sock, addr, args.duration, args.size, args.window)
+
+
+if __name__ == "__main__":
+    main()
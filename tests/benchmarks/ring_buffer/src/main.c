@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <sys/ring_buffer.h>
+#include <sys/ring_buffer_lockfree.h>
+
+/*
+ * Ring buffer throughput benchmark: producer threads push TOTAL_BYTES in
+ * CHUNK sized pieces through each ring buffer flavour while the main thread
+ * consumes, and the elapsed cycle count is reported. See README.rst.
+ */
+
+#define BUF_POW 10
+#define CHUNK 32
+#define TOTAL_BYTES (1024 * 1024)
+#define NUM_PRODUCERS 2
+#define STACK_SIZE (512 + CONFIG_TEST_EXTRA_STACKSIZE)
+
+K_THREAD_STACK_ARRAY_DEFINE(prod_stacks, NUM_PRODUCERS, STACK_SIZE);
+static struct k_thread prod_threads[NUM_PRODUCERS];
+
+RING_BUF_DECLARE(locked_rb, BIT(BUF_POW));
+static struct k_spinlock locked_lock;
+RING_BUF_SPSC_DECLARE_POW2(spsc_rb, BUF_POW);
+RING_BUF_MPSC_DECLARE_POW2(mpsc_rb, BUF_POW);
+RING_BUF_MPMC_DECLARE_POW2(mpmc_rb, BUF_POW);
+
+static uint8_t pattern[CHUNK];
+
+typedef uint32_t (*claim_fn_t)(uint8_t **data, uint32_t size);
+typedef void (*finish_fn_t)(uint32_t size);
+
+struct bench_ops {
+	const char *name;
+	claim_fn_t put_claim;
+	finish_fn_t put_finish;
+	claim_fn_t get_claim;
+	finish_fn_t get_finish;
+	int producers;
+};
+
+static uint32_t locked_put_claim(uint8_t **data, uint32_t size)
+{
+	k_spinlock_key_t key = k_spin_lock(&locked_lock);
+	uint32_t ret = ring_buf_put_claim(&locked_rb, data, size);
+
+	k_spin_unlock(&locked_lock, key);
+	return ret;
+}
+
+static void locked_put_finish(uint32_t size)
+{
+	k_spinlock_key_t key = k_spin_lock(&locked_lock);
+
+	(void)ring_buf_put_finish(&locked_rb, size);
+	k_spin_unlock(&locked_lock, key);
+}
+
+static uint32_t locked_get_claim(uint8_t **data, uint32_t size)
+{
+	k_spinlock_key_t key = k_spin_lock(&locked_lock);
+	uint32_t ret = ring_buf_get_claim(&locked_rb, data, size);
+
+	k_spin_unlock(&locked_lock, key);
+	return ret;
+}
+
+static void locked_get_finish(uint32_t size)
+{
+	k_spinlock_key_t key = k_spin_lock(&locked_lock);
+
+	(void)ring_buf_get_finish(&locked_rb, size);
+	k_spin_unlock(&locked_lock, key);
+}
+
+static uint32_t spsc_put_claim(uint8_t **data, uint32_t size)
+{
+	return ring_buf_spsc_put_claim(&spsc_rb, data, size);
+}
+
+static void spsc_put_finish(uint32_t size)
+{
+	(void)ring_buf_spsc_put_finish(&spsc_rb, size);
+}
+
+static uint32_t spsc_get_claim(uint8_t **data, uint32_t size)
+{
+	return ring_buf_spsc_get_claim(&spsc_rb, data, size);
+}
+
+static void spsc_get_finish(uint32_t size)
+{
+	(void)ring_buf_spsc_get_finish(&spsc_rb, size);
+}
+
+static uint32_t mpsc_put_claim(uint8_t **data, uint32_t size)
+{
+	return ring_buf_mpsc_put_claim(&mpsc_rb, data, size);
+}
+
+static void mpsc_put_finish(uint32_t size)
+{
+	(void)ring_buf_mpsc_put_finish(&mpsc_rb, size);
+}
+
+static uint32_t mpsc_get_claim(uint8_t **data, uint32_t size)
+{
+	return ring_buf_mpsc_get_claim(&mpsc_rb, data, size);
+}
+
+static void mpsc_get_finish(uint32_t size)
+{
+	(void)ring_buf_mpsc_get_finish(&mpsc_rb, size);
+}
+
+static uint32_t mpmc_put_claim(uint8_t **data, uint32_t size)
+{
+	return ring_buf_mpmc_put_claim(&mpmc_rb, data, size);
+}
+
+static void mpmc_put_finish(uint32_t size)
+{
+	(void)ring_buf_mpmc_put_finish(&mpmc_rb, size);
+}
+
+static uint32_t mpmc_get_claim(uint8_t **data, uint32_t size)
+{
+	return ring_buf_mpmc_get_claim(&mpmc_rb, data, size);
+}
+
+static void mpmc_get_finish(uint32_t size)
+{
+	(void)ring_buf_mpmc_get_finish(&mpmc_rb, size);
+}
+
+static const struct bench_ops benches[] = {
+	{ "locked", locked_put_claim, locked_put_finish,
+	  locked_get_claim, locked_get_finish, 1 },
+	{ "spsc", spsc_put_claim, spsc_put_finish,
+	  spsc_get_claim, spsc_get_finish, 1 },
+	{ "mpsc", mpsc_put_claim, mpsc_put_finish,
+	  mpsc_get_claim, mpsc_get_finish, NUM_PRODUCERS },
+	{ "mpmc", mpmc_put_claim, mpmc_put_finish,
+	  mpmc_get_claim, mpmc_get_finish, NUM_PRODUCERS },
+};
+
+static void producer(void *p1, void *p2, void *p3)
+{
+	const struct bench_ops *ops = p1;
+	uint32_t remaining = POINTER_TO_UINT(p2);
+	uint8_t *data;
+	uint32_t len;
+
+	ARG_UNUSED(p3);
+
+	while (remaining) {
+		len = ops->put_claim(&data, MIN(remaining, CHUNK));
+		if (len == 0U) {
+			k_yield();
+			continue;
+		}
+
+		memcpy(data, pattern, len);
+		ops->put_finish(len);
+		remaining -= len;
+	}
+}
+
+static void run(const struct bench_ops *ops)
+{
+	uint32_t per_producer = TOTAL_BYTES / ops->producers;
+	uint32_t received = 0U;
+	uint32_t start, cycles, len;
+	uint8_t *data;
+	int prio = k_thread_priority_get(k_current_get());
+
+	start = k_cycle_get_32();
+
+	for (int i = 0; i < ops->producers; i++) {
+		k_thread_create(&prod_threads[i], prod_stacks[i], STACK_SIZE,
+				producer, (void *)ops,
+				UINT_TO_POINTER(per_producer), NULL,
+				prio, 0, K_FOREVER);
+#ifdef CONFIG_SCHED_CPU_MASK
+		(void)k_thread_cpu_mask_clear(&prod_threads[i]);
+		(void)k_thread_cpu_mask_enable(&prod_threads[i],
+				(i + 1) % CONFIG_MP_NUM_CPUS);
+#endif
+		k_thread_start(&prod_threads[i]);
+	}
+
+	while (received < per_producer * ops->producers) {
+		len = ops->get_claim(&data, CHUNK);
+		if (len == 0U) {
+			k_yield();
+			continue;
+		}
+
+		ops->get_finish(len);
+		received += len;
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	for (int i = 0; i < ops->producers; i++) {
+		k_thread_join(&prod_threads[i], K_FOREVER);
+	}
+
+	printk("%-8s %8u bytes %10u cycles\n", ops->name, received, cycles);
+}
+
+void main(void)
+{
+	for (int i = 0; i < CHUNK; i++) {
+		pattern[i] = i;
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(benches); i++) {
+		run(&benches[i]);
+	}
+
+	printk("fin\n");
+}
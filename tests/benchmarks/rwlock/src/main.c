@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/atomic.h>
+#include <sys/printk.h>
+#ifdef CONFIG_PTHREAD_IPC
+#include <posix/pthread.h>
+#endif
+
+#define STACK_SIZE (1024 + CONFIG_TEST_EXTRA_STACKSIZE)
+
+/* The workers are preempted by the main thread when the run is over */
+#define WORKER_PRIO K_PRIO_PREEMPT(5)
+
+/* Uncontended lock and unlock, the average time is reported */
+#define UNCONTENDED_ROUNDS 10000
+
+/* Number of words of the protected data */
+#define TABLE_SIZE 16
+
+struct bench_lock {
+	const char *name;
+	void (*read_lock)(void);
+	void (*read_unlock)(void);
+	void (*write_lock)(void);
+	void (*write_unlock)(void);
+};
+
+static K_MUTEX_DEFINE(mutex);
+static K_RWLOCK_DEFINE(rwlock);
+
+static void mutex_lock(void)
+{
+	(void)k_mutex_lock(&mutex, K_FOREVER);
+}
+
+static void mutex_unlock(void)
+{
+	(void)k_mutex_unlock(&mutex);
+}
+
+static void rwlock_read_lock(void)
+{
+	(void)k_rwlock_read_lock(&rwlock, K_FOREVER);
+}
+
+static void rwlock_write_lock(void)
+{
+	(void)k_rwlock_write_lock(&rwlock, K_FOREVER);
+}
+
+static void rwlock_unlock(void)
+{
+	(void)k_rwlock_unlock(&rwlock);
+}
+
+#ifdef CONFIG_PTHREAD_IPC
+static pthread_rwlock_t prwlock;
+
+static void prwlock_read_lock(void)
+{
+	(void)pthread_rwlock_rdlock(&prwlock);
+}
+
+static void prwlock_write_lock(void)
+{
+	(void)pthread_rwlock_wrlock(&prwlock);
+}
+
+static void prwlock_unlock(void)
+{
+	(void)pthread_rwlock_unlock(&prwlock);
+}
+#endif
+
+static const struct bench_lock locks[] = {
+	{ "k_mutex", mutex_lock, mutex_unlock, mutex_lock, mutex_unlock },
+	{ "k_rwlock", rwlock_read_lock, rwlock_unlock, rwlock_write_lock,
+	  rwlock_unlock },
+#ifdef CONFIG_PTHREAD_IPC
+	{ "pthread", prwlock_read_lock, prwlock_unlock, prwlock_write_lock,
+	  prwlock_unlock },
+#endif
+};
+
+static K_THREAD_STACK_ARRAY_DEFINE(stacks, CONFIG_APP_THREADS, STACK_SIZE);
+static struct k_thread threads[CONFIG_APP_THREADS];
+static uint32_t thread_ops[CONFIG_APP_THREADS];
+
+/* Data protected by the lock, a reader checks all the words are equal */
+static volatile uint32_t table[TABLE_SIZE];
+
+static const struct bench_lock *bench;
+static volatile bool running;
+static atomic_t inconsistent;
+
+static void worker(void *p1, void *p2, void *p3)
+{
+	uint32_t *ops = p1;
+	uint32_t n, i, first;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	for (n = 0U; running; n++) {
+		if (n % 100U < CONFIG_APP_WRITE_PERCENT) {
+			bench->write_lock();
+			for (i = 0U; i < TABLE_SIZE; i++) {
+				table[i] = n;
+			}
+			bench->write_unlock();
+			continue;
+		}
+
+		bench->read_lock();
+		first = table[0];
+		for (i = 1U; i < TABLE_SIZE; i++) {
+			if (table[i] != first) {
+				atomic_inc(&inconsistent);
+				break;
+			}
+		}
+		bench->read_unlock();
+	}
+
+	*ops = n;
+}
+
+static void bench_uncontended(const struct bench_lock *lock)
+{
+	uint32_t start, rd_cycles, wr_cycles;
+	int i;
+
+	start = k_cycle_get_32();
+	for (i = 0; i < UNCONTENDED_ROUNDS; i++) {
+		lock->read_lock();
+		lock->read_unlock();
+	}
+	rd_cycles = k_cycle_get_32() - start;
+
+	start = k_cycle_get_32();
+	for (i = 0; i < UNCONTENDED_ROUNDS; i++) {
+		lock->write_lock();
+		lock->write_unlock();
+	}
+	wr_cycles = k_cycle_get_32() - start;
+
+	printk("  %-8s read %6u cycles %6u ns, write %6u cycles %6u ns\n",
+	       lock->name, rd_cycles / UNCONTENDED_ROUNDS,
+	       (uint32_t)(k_cyc_to_ns_floor64(rd_cycles) / UNCONTENDED_ROUNDS),
+	       wr_cycles / UNCONTENDED_ROUNDS,
+	       (uint32_t)(k_cyc_to_ns_floor64(wr_cycles) / UNCONTENDED_ROUNDS));
+}
+
+static void bench_contended(const struct bench_lock *lock)
+{
+	uint32_t ops = 0U;
+	int i;
+
+	bench = lock;
+	running = true;
+	atomic_clear(&inconsistent);
+
+	for (i = 0; i < CONFIG_APP_THREADS; i++) {
+		k_thread_create(&threads[i], stacks[i], STACK_SIZE, worker,
+				&thread_ops[i], NULL, NULL, WORKER_PRIO, 0,
+				K_NO_WAIT);
+	}
+
+	k_msleep(CONFIG_APP_DURATION_MS);
+	running = false;
+
+	for (i = 0; i < CONFIG_APP_THREADS; i++) {
+		(void)k_thread_join(&threads[i], K_FOREVER);
+		ops += thread_ops[i];
+	}
+
+	printk("  %-8s %8u accesses/s%s\n", lock->name,
+	       (uint32_t)((uint64_t)ops * MSEC_PER_SEC /
+			  CONFIG_APP_DURATION_MS),
+	       atomic_get(&inconsistent) ? ", INCONSISTENT READS" : "");
+}
+
+void main(void)
+{
+	int i;
+
+#ifdef CONFIG_PTHREAD_IPC
+	(void)pthread_rwlock_init(&prwlock, NULL);
+#endif
+
+	printk("rwlock: %d threads, %d%% writes, %d CPUs\n",
+	       CONFIG_APP_THREADS, CONFIG_APP_WRITE_PERCENT,
+	       CONFIG_MP_NUM_CPUS);
+
+	printk("uncontended lock and unlock, %d rounds\n",
+	       UNCONTENDED_ROUNDS);
+	for (i = 0; i < ARRAY_SIZE(locks); i++) {
+		bench_uncontended(&locks[i]);
+	}
+
+	printk("contended for %d ms\n", CONFIG_APP_DURATION_MS);
+	for (i = 0; i < ARRAY_SIZE(locks); i++) {
+		bench_contended(&locks[i]);
+	}
+
+	printk("rwlock benchmark done\n");
+}
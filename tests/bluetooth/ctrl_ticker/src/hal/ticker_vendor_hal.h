@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Ticker HAL of the simulated counter in ticker_sim.c. It behaves as the
+ * 24-bit, 32768 Hz RTC of the nRF5 HAL, so the ticker sees the same tick
+ * arithmetic as on hardware.
+ */
+
+#define HAL_TICKER_CNTR_CLK_FREQ_HZ 32768U
+
+#define HAL_TICKER_CNTR_CMP_OFFSET_MIN 3
+
+#define HAL_TICKER_CNTR_SET_LATENCY 0
+
+#define HAL_TICKER_US_TO_TICKS(x) \
+	( \
+		((uint32_t)(((uint64_t) (x) * 1000000000UL) / 30517578125UL)) \
+		& HAL_TICKER_CNTR_MASK \
+	)
+
+#define HAL_TICKER_REMAINDER(x) \
+	( \
+		( \
+			((uint64_t) (x) * 1000000000UL) \
+			- ((uint64_t)HAL_TICKER_US_TO_TICKS(x) * 30517578125UL) \
+		) \
+		/ 1000UL \
+	)
+
+#define HAL_TICKER_TICKS_TO_US(x) \
+	((uint32_t)(((uint64_t)(x) * 30517578125UL) / 1000000000UL))
+
+#define HAL_TICKER_CNTR_MSBIT 23
+
+#define HAL_TICKER_CNTR_MASK 0x00FFFFFF
+
+#define HAL_TICKER_REMAINDER_RANGE \
+	HAL_TICKER_TICKS_TO_US(1000000)
+
+#define HAL_TICKER_RESCHEDULE_MARGIN \
+	HAL_TICKER_US_TO_TICKS(150)
@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <zephyr/types.h>
+#include <ztest.h>
+
+#include "hal/ticker.h"
+
+#include "util/mem.h"
+#include "util/memq.h"
+#include "util/mayfly.h"
+
+#include "ticker/ticker.h"
+
+#include "ticker_sim.h"
+
+#define TICKER_NODES 64
+
+#define TICKER_USER_LLL_OPS      2
+#define TICKER_USER_ULL_HIGH_OPS 2
+#define TICKER_USER_ULL_LOW_OPS  2
+/* All the tickers can be started or stopped at once */
+#define TICKER_USER_THREAD_OPS   (TICKER_NODES + 1)
+#define TICKER_USER_OPS          (TICKER_USER_LLL_OPS + \
+				  TICKER_USER_ULL_HIGH_OPS + \
+				  TICKER_USER_ULL_LOW_OPS + \
+				  TICKER_USER_THREAD_OPS)
+
+/* Periodic interval of the benchmark tickers, 40 ms */
+#define BENCH_PERIOD_TICKS 1311U
+/* Reserved slot of each benchmark ticker, 1 ms */
+#define BENCH_SLOT_TICKS   33U
+/* Simulated duration of each benchmark run, 1 s */
+#define BENCH_TICKS        32768U
+
+static uint8_t MALIGN(4) ticker_nodes[TICKER_NODES][TICKER_NODE_T_SIZE];
+static uint8_t MALIGN(4) ticker_users[MAYFLY_CALLER_COUNT][TICKER_USER_T_SIZE];
+static uint8_t MALIGN(4) ticker_user_ops[TICKER_USER_OPS]
+					[TICKER_USER_OP_T_SIZE];
+
+struct expiry {
+	uint32_t count;
+	uint32_t ticks_at_expire;
+	uint32_t ticks_interval;
+	uint16_t lazy;
+};
+
+static struct expiry expiries[TICKER_NODES];
+
+static void ticker_setup(void)
+{
+	uint32_t err;
+
+	(void)memset(ticker_nodes, 0, sizeof(ticker_nodes));
+	(void)memset(ticker_users, 0, sizeof(ticker_users));
+	(void)memset(expiries, 0, sizeof(expiries));
+
+	sim_init();
+
+	ticker_users[SIM_USER_ID_LLL][0] = TICKER_USER_LLL_OPS;
+	ticker_users[SIM_USER_ID_ULL_HIGH][0] = TICKER_USER_ULL_HIGH_OPS;
+	ticker_users[SIM_USER_ID_ULL_LOW][0] = TICKER_USER_ULL_LOW_OPS;
+	ticker_users[SIM_USER_ID_THREAD][0] = TICKER_USER_THREAD_OPS;
+
+	err = ticker_init(0, TICKER_NODES, &ticker_nodes[0][0],
+			  MAYFLY_CALLER_COUNT, &ticker_users[0][0],
+			  TICKER_USER_OPS, &ticker_user_ops[0][0],
+			  hal_ticker_instance0_caller_id_get,
+			  hal_ticker_instance0_sched,
+			  hal_ticker_instance0_trigger_set);
+	zassert_equal(err, TICKER_STATUS_SUCCESS, "ticker_init failed");
+}
+
+static void ticker_timeout(uint32_t ticks_at_expire, uint32_t remainder,
+			   uint16_t lazy, void *context)
+{
+	struct expiry *e = context;
+
+	if (e->count) {
+		e->ticks_interval = ticker_ticks_diff_get(ticks_at_expire,
+							  e->ticks_at_expire);
+	}
+
+	e->ticks_at_expire = ticks_at_expire;
+	e->lazy = lazy;
+	e->count++;
+}
+
+static void ticker_op(uint32_t status, void *op_context)
+{
+	*(uint32_t *)op_context = status;
+}
+
+static void start(uint8_t ticker_id, uint32_t ticks_anchor,
+		  uint32_t ticks_first, uint32_t ticks_periodic,
+		  uint32_t ticks_slot)
+{
+	static uint32_t status;
+	uint32_t ret;
+
+	status = TICKER_STATUS_BUSY;
+
+	ret = ticker_start(0, SIM_USER_ID_THREAD, ticker_id, ticks_anchor,
+			   ticks_first, ticks_periodic, TICKER_NULL_REMAINDER,
+			   TICKER_NULL_LAZY, ticks_slot, ticker_timeout,
+			   &expiries[ticker_id], ticker_op, &status);
+	zassert_equal(ret, TICKER_STATUS_BUSY, "ticker_start failed");
+
+	sim_run();
+
+	zassert_equal(status, TICKER_STATUS_SUCCESS, "ticker %u not started",
+		      ticker_id);
+}
+
+static void stop(uint8_t ticker_id)
+{
+	static uint32_t status;
+	uint32_t ret;
+
+	status = TICKER_STATUS_BUSY;
+
+	ret = ticker_stop(0, SIM_USER_ID_THREAD, ticker_id, ticker_op,
+			  &status);
+	zassert_equal(ret, TICKER_STATUS_BUSY, "ticker_stop failed");
+
+	sim_run();
+
+	zassert_equal(status, TICKER_STATUS_SUCCESS, "ticker %u not stopped",
+		      ticker_id);
+}
+
+void test_ticker_single_shot(void)
+{
+	ticker_setup();
+
+	start(0, ticker_ticks_now_get(), 100U, TICKER_NULL_PERIOD,
+	      TICKER_NULL_SLOT);
+
+	sim_advance(99U);
+	zassert_equal(expiries[0].count, 0U, "expired early");
+
+	sim_advance(1U);
+	zassert_equal(expiries[0].count, 1U, "not expired");
+	zassert_equal(expiries[0].ticks_at_expire, 100U, "wrong expiry");
+
+	sim_advance(1000U);
+	zassert_equal(expiries[0].count, 1U, "expired again");
+}
+
+void test_ticker_periodic(void)
+{
+	ticker_setup();
+
+	start(0, ticker_ticks_now_get(), 32U, 32U, TICKER_NULL_SLOT);
+
+	sim_advance(32U * 100U);
+	zassert_equal(expiries[0].count, 100U, "%u expiries",
+		      expiries[0].count);
+	zassert_equal(expiries[0].ticks_interval, 32U, "wrong interval");
+	zassert_equal(expiries[0].lazy, 0U, "expiry skipped");
+
+	stop(0);
+
+	sim_advance(32U * 100U);
+	zassert_equal(expiries[0].count, 100U, "expired after stop");
+}
+
+void test_ticker_counter_wrap(void)
+{
+	uint32_t anchor;
+
+	ticker_setup();
+
+	/* Move close to the end of the counter range. The ticker only
+	 * tracks the counter while a ticker is running.
+	 */
+	start(1, ticker_ticks_now_get(), HAL_TICKER_CNTR_MASK >> 2,
+	      HAL_TICKER_CNTR_MASK >> 2, TICKER_NULL_SLOT);
+	sim_advance(HAL_TICKER_CNTR_MASK - 100U);
+	anchor = ticker_ticks_now_get();
+
+	start(0, anchor, 32U, 32U, TICKER_NULL_SLOT);
+
+	sim_advance(32U * 10U);
+	zassert_equal(expiries[0].count, 10U, "%u expiries",
+		      expiries[0].count);
+	zassert_equal(expiries[0].ticks_at_expire,
+		      (anchor + 32U * 10U) & HAL_TICKER_CNTR_MASK,
+		      "wrong expiry");
+}
+
+void test_ticker_collision(void)
+{
+	uint32_t anchor;
+
+	ticker_setup();
+
+	anchor = ticker_ticks_now_get();
+
+	/* The second ticker expires within the slot reserved by the first
+	 * one, every time.
+	 */
+	start(0, anchor, 100U, 1000U, 200U);
+	start(1, anchor, 150U, 1000U, 200U);
+
+	sim_advance(1000U * 100U);
+
+	/* Only one of the overlapping tickers expires in each interval, and
+	 * none of them is starved.
+	 */
+	zassert_true(expiries[0].count + expiries[1].count <= 100U,
+		     "overlapping expiries %u + %u", expiries[0].count,
+		     expiries[1].count);
+	zassert_true(expiries[0].count > 0U && expiries[1].count > 0U,
+		     "ticker starved %u/%u", expiries[0].count,
+		     expiries[1].count);
+}
+
+/* Start the tickers in a single ticker_job and then run them for the
+ * simulated benchmark duration. With overlap, all the tickers reserve a
+ * slot at about the same time in each interval and ticker_job resolves
+ * the collisions. Otherwise the tickers are spread over the interval and
+ * reserve no slot.
+ */
+static void bench_run(uint8_t count, bool overlap)
+{
+	struct sim_job_stats start_stats, run_stats;
+	static uint32_t status[TICKER_NODES];
+	uint32_t anchor, expired = 0U;
+	uint32_t ret;
+	uint8_t i;
+
+	ticker_setup();
+
+	anchor = ticker_ticks_now_get();
+
+	for (i = 0U; i < count; i++) {
+		uint32_t ticks_first, ticks_slot;
+
+		if (overlap) {
+			ticks_first = BENCH_SLOT_TICKS + i;
+			ticks_slot = BENCH_SLOT_TICKS;
+		} else {
+			ticks_first = BENCH_SLOT_TICKS +
+				      i * (BENCH_PERIOD_TICKS / count);
+			ticks_slot = TICKER_NULL_SLOT;
+		}
+
+		status[i] = TICKER_STATUS_BUSY;
+
+		ret = ticker_start(0, SIM_USER_ID_THREAD, i, anchor,
+				   ticks_first, BENCH_PERIOD_TICKS,
+				   TICKER_NULL_REMAINDER, TICKER_NULL_LAZY,
+				   ticks_slot, ticker_timeout, &expiries[i],
+				   ticker_op, &status[i]);
+		zassert_equal(ret, TICKER_STATUS_BUSY, "ticker_start failed");
+	}
+
+	sim_run();
+	sim_job_stats_get(&start_stats);
+
+	for (i = 0U; i < count; i++) {
+		zassert_equal(status[i], TICKER_STATUS_SUCCESS,
+			      "ticker %u not started", i);
+	}
+
+	sim_job_stats_reset();
+	sim_advance(BENCH_TICKS);
+	sim_job_stats_get(&run_stats);
+
+	for (i = 0U; i < count; i++) {
+		expired += expiries[i].count;
+	}
+
+	zassert_true(run_stats.count > 0U, "ticker_job not run");
+
+	TC_PRINT("%2u tickers %-7s start %5u us, %5u jobs %6u ns/job, "
+		 "%5u expiries\n", count, overlap ? "overlap" : "spread",
+		 (uint32_t)start_stats.us, run_stats.count,
+		 (uint32_t)(run_stats.us * 1000U / run_stats.count), expired);
+}
+
+void test_ticker_job_bench(void)
+{
+	uint8_t count;
+
+	for (count = 1U; count <= TICKER_NODES; count <<= 1) {
+		bench_run(count, false);
+		bench_run(count, true);
+	}
+}
+
+void test_main(void)
+{
+	ztest_test_suite(test_ctrl_ticker,
+			 ztest_unit_test(test_ticker_single_shot),
+			 ztest_unit_test(test_ticker_periodic),
+			 ztest_unit_test(test_ticker_counter_wrap),
+			 ztest_unit_test(test_ticker_collision),
+			 ztest_unit_test(test_ticker_job_bench));
+	ztest_run_test_suite(test_ctrl_ticker);
+}
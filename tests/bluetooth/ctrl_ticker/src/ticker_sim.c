@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+
+#include "hal/cntr.h"
+#include "hal/ticker.h"
+
+#include "util/memq.h"
+#include "util/mayfly.h"
+
+#include "ticker/ticker.h"
+
+#include "ticker_sim.h"
+
+/* Host time provided by the native_posix board */
+extern uint64_t get_host_us_time(void);
+
+#define TICKER_CALL_ID_COUNT (TICKER_CALL_ID_PROGRAM + 1)
+
+/* Mayfly caller and callee ids of the ticker execution contexts, as used
+ * by the nRF5 HAL.
+ */
+static uint8_t const mayfly_id_lut[TICKER_CALL_ID_COUNT] = {
+	[TICKER_CALL_ID_ISR] = SIM_USER_ID_LLL,
+	[TICKER_CALL_ID_TRIGGER] = SIM_USER_ID_ULL_HIGH,
+	[TICKER_CALL_ID_WORKER] = SIM_USER_ID_ULL_HIGH,
+	[TICKER_CALL_ID_JOB] = SIM_USER_ID_ULL_LOW,
+	[TICKER_CALL_ID_PROGRAM] = SIM_USER_ID_THREAD,
+};
+
+static uint8_t const caller_id_lut[] = {
+	TICKER_CALL_ID_ISR,
+	TICKER_CALL_ID_WORKER,
+	TICKER_CALL_ID_JOB,
+	TICKER_CALL_ID_PROGRAM
+};
+
+static memq_link_t links[TICKER_CALL_ID_COUNT][TICKER_CALL_ID_COUNT];
+static struct mayfly mfy[TICKER_CALL_ID_COUNT][TICKER_CALL_ID_COUNT];
+
+/* Callees pended for execution */
+static uint8_t pending;
+
+static uint32_t cnt;
+static uint32_t cmp;
+static uint8_t refcount;
+
+static struct sim_job_stats job_stats;
+
+void cntr_init(void)
+{
+	cnt = 0U;
+	cmp = 0U;
+	refcount = 0U;
+}
+
+uint32_t cntr_start(void)
+{
+	if (refcount++) {
+		return 1;
+	}
+
+	return 0;
+}
+
+uint32_t cntr_stop(void)
+{
+	__ASSERT_NO_MSG(refcount);
+
+	if (--refcount) {
+		return 1;
+	}
+
+	return 0;
+}
+
+uint32_t cntr_cnt_get(void)
+{
+	return cnt;
+}
+
+void cntr_cmp_set(uint8_t cmp_id, uint32_t value)
+{
+	ARG_UNUSED(cmp_id);
+
+	cmp = value & HAL_TICKER_CNTR_MASK;
+}
+
+void mayfly_enable_cb(uint8_t caller_id, uint8_t callee_id, uint8_t enable)
+{
+	ARG_UNUSED(caller_id);
+	ARG_UNUSED(callee_id);
+	ARG_UNUSED(enable);
+}
+
+uint32_t mayfly_is_enabled(uint8_t caller_id, uint8_t callee_id)
+{
+	ARG_UNUSED(caller_id);
+	ARG_UNUSED(callee_id);
+
+	return 1U;
+}
+
+uint32_t mayfly_prio_is_equal(uint8_t caller_id, uint8_t callee_id)
+{
+	return caller_id == callee_id;
+}
+
+void mayfly_pend(uint8_t caller_id, uint8_t callee_id)
+{
+	ARG_UNUSED(caller_id);
+
+	pending |= BIT(callee_id);
+}
+
+static void sim_job(void *param)
+{
+	uint64_t start = get_host_us_time();
+
+	ticker_job(param);
+
+	job_stats.us += get_host_us_time() - start;
+	job_stats.count++;
+}
+
+uint8_t hal_ticker_instance0_caller_id_get(uint8_t user_id)
+{
+	__ASSERT_NO_MSG(user_id < ARRAY_SIZE(caller_id_lut));
+
+	return caller_id_lut[user_id];
+}
+
+void hal_ticker_instance0_sched(uint8_t caller_id, uint8_t callee_id,
+				uint8_t chain, void *instance)
+{
+	struct mayfly *m;
+
+	__ASSERT_NO_MSG(caller_id < TICKER_CALL_ID_COUNT &&
+			callee_id < TICKER_CALL_ID_COUNT);
+
+	m = &mfy[caller_id][callee_id];
+
+	switch (callee_id) {
+	case TICKER_CALL_ID_WORKER:
+		m->fp = ticker_worker;
+		break;
+
+	case TICKER_CALL_ID_JOB:
+		m->fp = sim_job;
+		break;
+
+	default:
+		__ASSERT_NO_MSG(0);
+		return;
+	}
+
+	m->param = instance;
+
+	mayfly_enqueue(mayfly_id_lut[caller_id], mayfly_id_lut[callee_id],
+		       chain, m);
+}
+
+void hal_ticker_instance0_trigger_set(uint32_t value)
+{
+	cntr_cmp_set(0, value);
+}
+
+void sim_init(void)
+{
+	uint8_t caller_id, callee_id;
+
+	for (caller_id = 0U; caller_id < TICKER_CALL_ID_COUNT; caller_id++) {
+		for (callee_id = 0U; callee_id < TICKER_CALL_ID_COUNT;
+		     callee_id++) {
+			mfy[caller_id][callee_id] = (struct mayfly){
+				._link = &links[caller_id][callee_id],
+			};
+		}
+	}
+
+	pending = 0U;
+
+	mayfly_init();
+
+	cntr_init();
+	(void)cntr_start();
+
+	sim_job_stats_reset();
+}
+
+void sim_run(void)
+{
+	uint8_t callee_id = 0U;
+
+	/* The highest priority callee pended runs first, also when it is
+	 * pended by a lower priority one.
+	 */
+	while (callee_id < MAYFLY_CALLEE_COUNT) {
+		if (!(pending & BIT(callee_id))) {
+			callee_id++;
+			continue;
+		}
+
+		pending &= ~BIT(callee_id);
+		mayfly_run(callee_id);
+
+		callee_id = 0U;
+	}
+}
+
+void sim_advance(uint32_t ticks)
+{
+	uint32_t delta;
+
+	sim_run();
+
+	while (ticks) {
+		/* The compare event is generated when the counter changes to
+		 * the compare value.
+		 */
+		delta = (cmp - cnt) & HAL_TICKER_CNTR_MASK;
+		if (!delta) {
+			delta = HAL_TICKER_CNTR_MASK + 1;
+		}
+
+		if (delta > ticks) {
+			cnt = (cnt + ticks) & HAL_TICKER_CNTR_MASK;
+			break;
+		}
+
+		cnt = cmp;
+		ticks -= delta;
+
+		/* RTC interrupt */
+		ticker_trigger(0);
+
+		sim_run();
+	}
+}
+
+void sim_job_stats_get(struct sim_job_stats *stats)
+{
+	*stats = job_stats;
+}
+
+void sim_job_stats_reset(void)
+{
+	job_stats = (struct sim_job_stats){ 0 };
+}
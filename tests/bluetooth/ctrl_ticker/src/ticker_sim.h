@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Simulated RTC counter, mayfly execution contexts and ticker instance 0
+ * glue, used to run the ticker on native_posix.
+ *
+ * The counter only advances through sim_advance(). Mayflies are run to
+ * completion in priority order: LLL, ULL_HIGH, ULL_LOW and then thread.
+ * A compare match triggers the ticker from the LLL context, as the RTC
+ * interrupt does on hardware.
+ */
+
+/* Ticker user ids, matching the mayfly caller and callee ids */
+#define SIM_USER_ID_LLL      MAYFLY_CALL_ID_0
+#define SIM_USER_ID_ULL_HIGH MAYFLY_CALL_ID_1
+#define SIM_USER_ID_ULL_LOW  MAYFLY_CALL_ID_2
+#define SIM_USER_ID_THREAD   MAYFLY_CALL_ID_PROGRAM
+
+/* Statistics of the ticker_job invocations */
+struct sim_job_stats {
+	uint32_t count;
+	uint64_t us;
+};
+
+void sim_init(void);
+void sim_run(void);
+void sim_advance(uint32_t ticks);
+void sim_job_stats_get(struct sim_job_stats *stats);
+void sim_job_stats_reset(void);
@@ -89,6 +89,16 @@ static struct bt_gatt_attr test1_attrs[] = {
 
 static struct bt_gatt_service test1_svc = BT_GATT_SERVICE(test1_attrs);
 
+static struct bt_uuid_128 test2_uuid = BT_UUID_INIT_128(
+	0xf6, 0xde, 0xbc, 0x9a, 0x78, 0x56, 0x34, 0x12,
+	0x78, 0x56, 0x34, 0x12, 0x78, 0x56, 0x34, 0x12);
+
+BT_GATT_SERVICE_DEFINE(test2_svc,
+	BT_GATT_PRIMARY_SERVICE(&test2_uuid),
+	BT_GATT_CHARACTERISTIC(&test_chrc_uuid.uuid, BT_GATT_CHRC_READ,
+			       BT_GATT_PERM_READ, read_test, NULL, test_value),
+);
+
 void test_gatt_register(void)
 {
 	/* Attempt to register services */
@@ -224,6 +234,48 @@ void test_gatt_foreach(void)
 	}
 }
 
+static uint8_t check_handle(const struct bt_gatt_attr *attr, uint16_t handle,
+			    void *user_data)
+{
+	uint16_t *prev = user_data;
+
+	zassert_true(handle > *prev, "Handles not in ascending order");
+	zassert_equal(bt_gatt_attr_get_handle(attr), handle,
+		      "Handle of attribute don't match");
+
+	*prev = handle;
+
+	return BT_GATT_ITER_CONTINUE;
+}
+
+void test_gatt_handles(void)
+{
+	const struct bt_gatt_attr *attr;
+	uint16_t handle = 0;
+
+	/* Static and dynamic attributes map to their handles */
+	bt_gatt_foreach_attr(0x0001, 0xffff, check_handle, &handle);
+	zassert_equal(handle, test1_attrs[ARRAY_SIZE(test1_attrs) - 1].handle,
+		      "Not all attributes iterated");
+
+	handle = bt_gatt_attr_get_handle(&attr_test2_svc[0]);
+	zassert_not_equal(handle, 0, "Static attribute has no handle");
+
+	/* Look up a static attribute by handle */
+	attr = NULL;
+	bt_gatt_foreach_attr(handle + 1, handle + 1, find_attr, &attr);
+	zassert_equal(attr, &attr_test2_svc[1], "Attribute don't match");
+	zassert_equal(bt_gatt_attr_next(&attr_test2_svc[0]), &attr_test2_svc[1],
+		      "Next attribute don't match");
+
+	/* Look up a range starting in the middle of a dynamic service */
+	handle = 0;
+	bt_gatt_foreach_attr(test1_attrs[1].handle, 0xffff, count_attr,
+			     &handle);
+	zassert_equal(handle, ARRAY_SIZE(test1_attrs) - 1,
+		      "Number of attributes don't match");
+}
+
 void test_gatt_read(void)
 {
 	const struct bt_gatt_attr *attr;
@@ -272,6 +324,7 @@ void test_main(void)
 			 ztest_unit_test(test_gatt_register),
 			 ztest_unit_test(test_gatt_unregister),
 			 ztest_unit_test(test_gatt_foreach),
+			 ztest_unit_test(test_gatt_handles),
 			 ztest_unit_test(test_gatt_read),
 			 ztest_unit_test(test_gatt_write));
 	ztest_run_test_suite(test_gatt);
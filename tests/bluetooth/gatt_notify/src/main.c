@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <ztest.h>
+#include <sys/byteorder.h>
+
+#include <bluetooth/bluetooth.h>
+#include <bluetooth/conn.h>
+#include <bluetooth/gatt.h>
+
+#include "hci_core.h"
+#include "conn_internal.h"
+#include "l2cap_internal.h"
+#include "att_internal.h"
+
+#define CONN_COUNT CONFIG_BT_MAX_CONN
+
+/* L2CAP header, opcode and handle in front of the value */
+#define PDU_HDR_LEN (sizeof(struct bt_l2cap_hdr) + 1 + sizeof(uint16_t))
+
+static struct bt_uuid_128 test_uuid = BT_UUID_INIT_128(
+	0xf0, 0xde, 0xbc, 0x9a, 0x78, 0x56, 0x34, 0x12,
+	0x78, 0x56, 0x34, 0x12, 0x78, 0x56, 0x34, 0x12);
+static struct bt_uuid_128 test_chrc_uuid = BT_UUID_INIT_128(
+	0xf2, 0xde, 0xbc, 0x9a, 0x78, 0x56, 0x34, 0x12,
+	0x78, 0x56, 0x34, 0x12, 0x78, 0x56, 0x34, 0x12);
+
+BT_GATT_SERVICE_DEFINE(test_svc,
+	BT_GATT_PRIMARY_SERVICE(&test_uuid),
+	BT_GATT_CHARACTERISTIC(&test_chrc_uuid.uuid, BT_GATT_CHRC_NOTIFY,
+			       BT_GATT_PERM_NONE, NULL, NULL, NULL),
+	BT_GATT_CCC(NULL, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+);
+
+static const uint8_t test_value[] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
+	0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13,
+};
+
+static struct bt_conn *conns[CONN_COUNT];
+
+/* Connections are created without a controller. Nothing sends their TX
+ * queues, so the PDUs queued to them can be checked.
+ */
+static void test_connect(void)
+{
+	uint16_t value = sys_cpu_to_le16(BT_GATT_CCC_NOTIFY);
+	const struct bt_gatt_attr *ccc = &test_svc.attrs[3];
+	bt_addr_le_t peer = {
+		.type = BT_ADDR_LE_RANDOM,
+		.a.val = { 0x01, 0x00, 0x00, 0x00, 0x00, 0xc0 },
+	};
+	ssize_t ret;
+	int i;
+
+	atomic_set_bit(bt_dev.flags, BT_DEV_READY);
+
+	for (i = 0; i < CONN_COUNT; i++) {
+		peer.a.val[0] = i + 1;
+
+		conns[i] = bt_conn_add_le(BT_ID_DEFAULT, &peer);
+		zassert_not_null(conns[i], "Cannot add connection %d", i);
+
+		bt_conn_set_state(conns[i], BT_CONN_CONNECTED);
+
+		ret = ccc->write(conns[i], ccc, &value, sizeof(value), 0, 0);
+		zassert_equal(ret, sizeof(value), "Cannot subscribe %d", i);
+	}
+}
+
+static void set_mtu(struct bt_conn *conn, uint16_t mtu)
+{
+	struct bt_l2cap_chan *chan;
+
+	chan = bt_l2cap_le_lookup_tx_cid(conn, BT_L2CAP_CID_ATT);
+	zassert_not_null(chan, "No ATT channel");
+
+	BT_L2CAP_LE_CHAN(chan)->tx.mtu = mtu;
+}
+
+static int notify(struct bt_conn *conn)
+{
+	return bt_gatt_notify(conn, &test_svc.attrs[1], test_value,
+			      sizeof(test_value));
+}
+
+/* Take the PDU queued to the connection and check its content */
+static struct net_buf *take_pdu(struct bt_conn *conn)
+{
+	uint8_t pdu[PDU_HDR_LEN + sizeof(test_value)];
+	uint16_t handle = bt_gatt_attr_get_handle(&test_svc.attrs[2]);
+	struct net_buf *buf;
+	size_t len;
+
+	buf = net_buf_get(&conn->tx_queue, K_NO_WAIT);
+	zassert_not_null(buf, "No PDU queued");
+
+	len = net_buf_linearize(pdu, sizeof(pdu), buf, 0, sizeof(pdu));
+	zassert_equal(len, sizeof(pdu), "Invalid PDU length");
+	zassert_equal(net_buf_frags_len(buf), sizeof(pdu), "Extra data");
+
+	zassert_equal(sys_get_le16(&pdu[0]), sizeof(pdu) - 4,
+		      "Invalid L2CAP length");
+	zassert_equal(sys_get_le16(&pdu[2]), BT_L2CAP_CID_ATT,
+		      "Invalid L2CAP CID");
+	zassert_equal(pdu[4], BT_ATT_OP_NOTIFY, "Invalid opcode");
+	zassert_equal(sys_get_le16(&pdu[5]), handle, "Invalid handle");
+	zassert_mem_equal(&pdu[PDU_HDR_LEN], test_value, sizeof(test_value),
+			  "Invalid value");
+
+	return buf;
+}
+
+static void test_notify_conn(void)
+{
+	struct net_buf *buf;
+
+	zassert_equal(notify(conns[0]), 0, "Notification failed");
+
+	buf = take_pdu(conns[0]);
+	zassert_is_null(buf->frags, "Value not in the PDU");
+	net_buf_unref(buf);
+
+	zassert_is_null(net_buf_get(&conns[1]->tx_queue, K_NO_WAIT),
+			"PDU queued to another connection");
+}
+
+static void test_notify_all(void)
+{
+	struct net_buf *bufs[CONN_COUNT];
+	int i;
+
+	zassert_equal(notify(NULL), 0, "Notification failed");
+
+	for (i = 0; i < CONN_COUNT; i++) {
+		bufs[i] = take_pdu(conns[i]);
+	}
+
+	/* Each connection has its own copy of the value */
+	for (i = 0; i < CONN_COUNT; i++) {
+		zassert_is_null(bufs[i]->frags, "Value not in the PDU");
+	}
+
+	for (i = 0; i < CONN_COUNT; i++) {
+		net_buf_unref(bufs[i]);
+	}
+}
+
+static void test_notify_partial(void)
+{
+	struct net_buf *buf;
+	int i;
+
+	/* The value does not fit the MTU of the second connection, which
+	 * stops the notification there. It still succeeds since the first
+	 * connection has been notified.
+	 */
+	set_mtu(conns[1], 10);
+
+	zassert_equal(notify(NULL), 0, "Notification failed");
+
+	buf = take_pdu(conns[0]);
+	net_buf_unref(buf);
+
+	for (i = 1; i < CONN_COUNT; i++) {
+		zassert_is_null(net_buf_get(&conns[i]->tx_queue, K_NO_WAIT),
+				"PDU queued to connection %d", i);
+	}
+
+	set_mtu(conns[1], BT_ATT_DEFAULT_LE_MTU);
+}
+
+static void test_notify_none(void)
+{
+	int i;
+
+	/* Nobody has been notified, so an error is returned */
+	set_mtu(conns[0], 10);
+
+	zassert_true(notify(NULL) < 0, "Notification succeeded");
+
+	for (i = 0; i < CONN_COUNT; i++) {
+		zassert_is_null(net_buf_get(&conns[i]->tx_queue, K_NO_WAIT),
+				"PDU queued to connection %d", i);
+	}
+
+	set_mtu(conns[0], BT_ATT_DEFAULT_LE_MTU);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(test_gatt_notify,
+			 ztest_unit_test(test_connect),
+			 ztest_unit_test(test_notify_conn),
+			 ztest_unit_test(test_notify_all),
+			 ztest_unit_test(test_notify_partial),
+			 ztest_unit_test(test_notify_none));
+	ztest_run_test_suite(test_gatt_notify);
+}
@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <settings/settings.h>
+#include <bluetooth/mesh.h>
+
+#include "mesh.h"
+#include "net.h"
+#include "rpl.h"
+#include "settings.h"
+
+#define RAM_STORE_ENTRIES	8
+#define RAM_STORE_NAME_LEN	24
+#define RAM_STORE_VAL_LEN	128
+
+/* Wait for a store that is started right away */
+#define STORE_NOW		K_MSEC(100)
+/* Wait for the RPL store timeout to expire */
+#define STORE_TIMEOUT		K_MSEC(CONFIG_BT_MESH_RPL_STORE_TIMEOUT * \
+				       MSEC_PER_SEC + 500)
+
+#define WINDOW			CONFIG_BT_MESH_RPL_STORE_SEQ_WINDOW
+
+/* Same layout as the storage entries in subsys/bluetooth/mesh/settings.c */
+struct rpl_val {
+	uint32_t seq:24,
+		 old_iv:1;
+};
+
+struct rpl_block_val {
+	uint16_t src;
+	struct rpl_val rpl;
+} __packed;
+
+/* RAM settings backend, so that the stored values can be inspected */
+struct ram_entry {
+	char name[RAM_STORE_NAME_LEN];
+	uint8_t val[RAM_STORE_VAL_LEN];
+	size_t len;
+};
+
+static struct ram_entry ram_entries[RAM_STORE_ENTRIES];
+static int ram_writes;
+static int ram_deletes;
+
+static struct ram_entry *ram_find(const char *name)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(ram_entries); i++) {
+		if (!strcmp(ram_entries[i].name, name)) {
+			return &ram_entries[i];
+		}
+	}
+
+	return NULL;
+}
+
+static void ram_put(const char *name, const void *val, size_t len)
+{
+	struct ram_entry *entry = ram_find(name);
+
+	if (!entry) {
+		entry = ram_find("");
+	}
+
+	zassert_not_null(entry, "RAM store full");
+	zassert_true(len <= sizeof(entry->val), "value too long");
+
+	strncpy(entry->name, name, sizeof(entry->name) - 1);
+	memcpy(entry->val, val, len);
+	entry->len = len;
+}
+
+static ssize_t ram_read(void *cb_arg, void *data, size_t len)
+{
+	struct ram_entry *entry = cb_arg;
+
+	len = MIN(len, entry->len);
+	memcpy(data, entry->val, len);
+
+	return len;
+}
+
+static int ram_load(struct settings_store *cs,
+		    const struct settings_load_arg *arg)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(ram_entries); i++) {
+		if (ram_entries[i].name[0] == '\0') {
+			continue;
+		}
+
+		settings_call_set_handler(ram_entries[i].name,
+					  ram_entries[i].len, ram_read,
+					  &ram_entries[i], arg);
+	}
+
+	return 0;
+}
+
+static int ram_save(struct settings_store *cs, const char *name,
+		    const char *value, size_t val_len)
+{
+	struct ram_entry *entry;
+
+	if (!value || !val_len) {
+		entry = ram_find(name);
+		if (entry) {
+			(void)memset(entry, 0, sizeof(*entry));
+		}
+
+		ram_deletes++;
+		return 0;
+	}
+
+	ram_put(name, value, val_len);
+	ram_writes++;
+
+	return 0;
+}
+
+static const struct settings_store_itf ram_itf = {
+	.csi_load = ram_load,
+	.csi_save = ram_save,
+};
+
+static struct settings_store ram_store = {
+	.cs_itf = &ram_itf,
+};
+
+int settings_backend_init(void)
+{
+	settings_dst_register(&ram_store);
+	settings_src_register(&ram_store);
+
+	return 0;
+}
+
+/* Look up src in a stored RPL block */
+static const struct rpl_block_val *block_find(const char *name, uint16_t src)
+{
+	const struct ram_entry *entry = ram_find(name);
+	const struct rpl_block_val *val;
+	size_t i;
+
+	if (!entry) {
+		return NULL;
+	}
+
+	val = (const struct rpl_block_val *)entry->val;
+
+	for (i = 0; i < entry->len / sizeof(*val); i++) {
+		if (val[i].src == src) {
+			return &val[i];
+		}
+	}
+
+	return NULL;
+}
+
+static void clear_entry(struct bt_mesh_rpl *rpl, void *user_data)
+{
+	(void)memset(rpl, 0, sizeof(*rpl));
+}
+
+/* Forget the RPL in RAM and load it back, as after a reboot */
+static void reboot(void)
+{
+	bt_mesh_rpl_foreach(clear_entry, NULL);
+
+	zassert_equal(settings_load_subtree("bt/mesh"), 0, "load failed");
+}
+
+/* Accept seq from src, as the network layer does */
+static struct bt_mesh_rpl *accept(uint16_t src, uint32_t seq)
+{
+	struct bt_mesh_rpl *rpl;
+
+	rpl = bt_mesh_rpl_find(src);
+	if (!rpl) {
+		rpl = bt_mesh_rpl_alloc(src);
+	}
+
+	zassert_not_null(rpl, "RPL full");
+	zassert_true(seq > rpl->seq || !rpl->seq, "replayed seq");
+
+	rpl->seq = seq;
+	bt_mesh_store_rpl(rpl);
+
+	return rpl;
+}
+
+static void test_setup(void)
+{
+	/* let a store left over from the previous test finish */
+	k_sleep(STORE_TIMEOUT);
+
+	(void)memset(ram_entries, 0, sizeof(ram_entries));
+	bt_mesh_rpl_foreach(clear_entry, NULL);
+	atomic_set_bit(bt_mesh.flags, BT_MESH_VALID);
+	ram_writes = 0;
+	ram_deletes = 0;
+}
+
+static void test_window_not_stored(void)
+{
+	struct rpl_block_val block[] = {
+		{ .src = 0x0001, .rpl = { .seq = 100 } },
+	};
+	const struct rpl_block_val *val;
+
+	ram_put("bt/mesh/RPLB/0", block, sizeof(block));
+	reboot();
+
+	zassert_equal(bt_mesh_rpl_find(0x0001)->seq, 100 + WINDOW,
+		      "window not skipped on load");
+
+	/* a new source is stored with the next batch */
+	accept(0x0002, 5);
+	k_sleep(STORE_NOW);
+	zassert_equal(ram_writes, 0, "new source not batched");
+
+	k_sleep(STORE_TIMEOUT);
+	zassert_true(ram_writes > 0, "RPL not stored");
+
+	val = block_find("bt/mesh/RPLB/0", 0x0001);
+	zassert_not_null(val, "loaded source not stored");
+	zassert_equal(val->rpl.seq, 100, "window stored");
+
+	val = block_find("bt/mesh/RPLB/0", 0x0002);
+	zassert_not_null(val, "new source not stored");
+	zassert_equal(val->rpl.seq, 5, "wrong seq stored");
+
+	/* the window does not grow from one reboot to the next */
+	reboot();
+	zassert_equal(bt_mesh_rpl_find(0x0001)->seq, 100 + WINDOW,
+		      "window grew across reboots");
+	zassert_equal(bt_mesh_rpl_find(0x0002)->seq, 5 + WINDOW,
+		      "wrong seq loaded");
+}
+
+static void test_window_exceeded(void)
+{
+	struct rpl_block_val block[] = {
+		{ .src = 0x0001, .rpl = { .seq = 100 } },
+	};
+	const struct rpl_block_val *val;
+
+	ram_put("bt/mesh/RPLB/0", block, sizeof(block));
+	reboot();
+
+	/* anything accepted beyond the window must be stored right away,
+	 * or it could be replayed after the next reset
+	 */
+	accept(0x0001, 100 + WINDOW + 1);
+	k_sleep(STORE_NOW);
+
+	val = block_find("bt/mesh/RPLB/0", 0x0001);
+	zassert_not_null(val, "source not stored");
+	zassert_equal(val->rpl.seq, 100 + WINDOW + 1, "seq not stored");
+
+	/* small steps after that wait for the batch */
+	ram_writes = 0;
+	accept(0x0001, 100 + WINDOW + 2);
+	k_sleep(STORE_NOW);
+	zassert_equal(ram_writes, 0, "small step not batched");
+}
+
+static void test_watermark(void)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_BT_MESH_RPL_STORE_WATERMARK - 1; i++) {
+		accept(0x0010 + i, 1);
+	}
+
+	k_sleep(STORE_NOW);
+	zassert_equal(ram_writes, 0, "stored below the watermark");
+
+	accept(0x0010 + i, 1);
+	k_sleep(STORE_NOW);
+	zassert_true(ram_writes > 0, "not stored at the watermark");
+
+	for (i = 0; i < CONFIG_BT_MESH_RPL_STORE_WATERMARK; i++) {
+		zassert_not_null(block_find("bt/mesh/RPLB/0", 0x0010 + i),
+				 "source 0x%04x not stored", 0x0010 + i);
+	}
+}
+
+static void test_legacy_entries(void)
+{
+	struct rpl_val single = { .seq = 10 };
+
+	ram_put("bt/mesh/RPL/7", &single, sizeof(single));
+	reboot();
+
+	zassert_equal(bt_mesh_rpl_find(0x0007)->seq, 10 + WINDOW,
+		      "single entry not loaded");
+
+	/* the first store moves the single entries into blocks */
+	accept(0x0008, 1);
+	k_sleep(STORE_TIMEOUT);
+
+	zassert_is_null(ram_find("bt/mesh/RPL/7"), "single entry kept");
+	zassert_equal(block_find("bt/mesh/RPLB/0", 0x0007)->rpl.seq, 10,
+		      "single entry not moved");
+}
+
+static void test_clear_legacy_entries(void)
+{
+	struct rpl_val single = { .seq = 10 };
+	struct rpl_block_val block[] = {
+		{ .src = 0x0001, .rpl = { .seq = 100 } },
+	};
+
+	ram_put("bt/mesh/RPL/7", &single, sizeof(single));
+	ram_put("bt/mesh/RPLB/0", block, sizeof(block));
+	reboot();
+
+	/* clearing before the first store removes the single entries too */
+	atomic_clear_bit(bt_mesh.flags, BT_MESH_VALID);
+	bt_mesh_clear_rpl();
+	k_sleep(STORE_TIMEOUT);
+
+	zassert_is_null(ram_find("bt/mesh/RPL/7"), "single entry kept");
+	zassert_is_null(ram_find("bt/mesh/RPLB/0"), "block kept");
+	zassert_is_null(bt_mesh_rpl_find(0x0001), "RAM entry kept");
+	zassert_is_null(bt_mesh_rpl_find(0x0007), "RAM entry kept");
+}
+
+void test_main(void)
+{
+	bt_mesh_settings_init();
+
+	ztest_test_suite(bt_mesh_rpl_store,
+		ztest_unit_test_setup_teardown(test_window_not_stored,
+					       test_setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_window_exceeded,
+					       test_setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_watermark,
+					       test_setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_legacy_entries,
+					       test_setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_clear_legacy_entries,
+					       test_setup, unit_test_noop));
+
+	ztest_run_test_suite(bt_mesh_rpl_store);
+}
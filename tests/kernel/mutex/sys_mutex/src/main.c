@@ -64,10 +64,35 @@ ZTEST_BMEM SYS_MUTEX_DEFINE(mutex_4);
 
 #ifdef CONFIG_USERSPACE
 static SYS_MUTEX_DEFINE(no_access_mutex);
+
+/* User threads inside and outside of the memory domain of the tests,
+ * which never run, and mutexes whose owner word names them.
+ */
+static struct k_mem_domain no_access_domain;
+static K_THREAD_STACK_DEFINE(no_access_stack_area, STACKSIZE);
+static struct k_thread no_access_thread_data;
+static K_THREAD_STACK_DEFINE(access_stack_area, STACKSIZE);
+static struct k_thread access_thread_data;
+
+static ZTEST_BMEM SYS_MUTEX_DEFINE(forged_mutex);
+static ZTEST_BMEM SYS_MUTEX_DEFINE(adopted_mutex);
 #endif
 static ZTEST_BMEM SYS_MUTEX_DEFINE(not_my_mutex);
 static ZTEST_BMEM SYS_MUTEX_DEFINE(bad_count_mutex);
 
+static ZTEST_BMEM volatile bool expect_fault;
+
+void k_sys_fatal_error_handler(unsigned int reason, const z_arch_esf_t *esf)
+{
+	if (!expect_fault) {
+		printk("Unexpected fault during test\n");
+		k_fatal_halt(reason);
+	}
+
+	/* The faulting test thread is aborted, which passes the test */
+	expect_fault = false;
+}
+
 /**
  *
  * thread_05 -
@@ -385,13 +410,47 @@ void test_supervisor_access(void)
 
 void test_user_access(void)
 {
+#ifdef CONFIG_USERSPACE
+	/* An uncontended mutex is locked in user mode, accessing a mutex
+	 * outside of the memory domain of the thread faults.
+	 */
+	expect_fault = true;
+	compiler_barrier();
+
+	(void)sys_mutex_lock(&no_access_mutex, K_NO_WAIT);
+	zassert_unreachable("accessed mutex not in memory domain");
+#else
+	ztest_test_skip();
+#endif /* CONFIG_USERSPACE */
+}
+
+void test_forged_owner(void)
+{
 #ifdef CONFIG_USERSPACE
 	int rv;
 
-	rv = sys_mutex_lock(&no_access_mutex, K_NO_WAIT);
-	zassert_true(rv == -EACCES, "accessed mutex not in memory domain");
-	rv = sys_mutex_unlock(&no_access_mutex);
-	zassert_true(rv == -EACCES, "accessed mutex not in memory domain");
+	/* The kernel takes over the owner named in the owner word when a
+	 * thread waits for the mutex, and boosts it. A thread that could
+	 * not have locked the mutex is not taken.
+	 */
+	atomic_ptr_set(&forged_mutex.owner,
+		       (void *)((uintptr_t)&no_access_thread_data |
+				Z_SYS_MUTEX_USER));
+	rv = sys_mutex_lock(&forged_mutex, K_MSEC(10));
+	zassert_equal(rv, -EINVAL, "took over a thread without access");
+
+	atomic_ptr_set(&forged_mutex.owner, (void *)Z_SYS_MUTEX_USER);
+	rv = sys_mutex_lock(&forged_mutex, K_NO_WAIT);
+	zassert_equal(rv, 0, "Failed to lock restored mutex");
+	rv = sys_mutex_unlock(&forged_mutex);
+	zassert_equal(rv, 0, "Failed to unlock restored mutex");
+
+	/* A thread of the same memory domain is a valid owner */
+	atomic_ptr_set(&adopted_mutex.owner,
+		       (void *)((uintptr_t)&access_thread_data |
+				Z_SYS_MUTEX_USER));
+	rv = sys_mutex_lock(&adopted_mutex, K_MSEC(10));
+	zassert_equal(rv, -EAGAIN, "did not wait for the recorded owner");
 #else
 	ztest_test_skip();
 #endif /* CONFIG_USERSPACE */
@@ -430,6 +489,17 @@ void test_main(void)
 	k_mem_domain_add_thread(&k_mem_domain_default, THREAD_08);
 	k_mem_domain_add_thread(&k_mem_domain_default, THREAD_09);
 	k_mem_domain_add_thread(&k_mem_domain_default, THREAD_11);
+
+	k_thread_create(&no_access_thread_data, no_access_stack_area,
+			STACKSIZE, (k_thread_entry_t)thread_12, NULL, NULL,
+			NULL, K_PRIO_PREEMPT(12), K_USER, K_FOREVER);
+	k_mem_domain_init(&no_access_domain, 0, NULL);
+	k_mem_domain_add_thread(&no_access_domain, &no_access_thread_data);
+
+	k_thread_create(&access_thread_data, access_stack_area, STACKSIZE,
+			(k_thread_entry_t)thread_12, NULL, NULL, NULL,
+			K_PRIO_PREEMPT(12), K_USER, K_FOREVER);
+	k_mem_domain_add_thread(&k_mem_domain_default, &access_thread_data);
 #endif
 	rv = sys_mutex_lock(&not_my_mutex, K_NO_WAIT);
 	if (rv != 0) {
@@ -446,6 +516,7 @@ void test_main(void)
 	ztest_test_suite(mutex_complex,
 			 ztest_1cpu_user_unit_test(test_mutex),
 			 ztest_user_unit_test(test_user_access),
+			 ztest_user_unit_test(test_forged_owner),
 			 ztest_unit_test(test_supervisor_access));
 
 	ztest_run_test_suite(mutex_complex);
@@ -453,6 +524,7 @@ void test_main(void)
 	ztest_test_suite(mutex_complex,
 			 ztest_1cpu_unit_test(test_mutex),
 			 ztest_unit_test(test_user_access),
+			 ztest_unit_test(test_forged_owner),
 			 ztest_unit_test(test_supervisor_access));
 
 	ztest_run_test_suite(mutex_complex);
@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+
+#define TIMEOUT_MS 100
+#define STACK_SIZE (512 + CONFIG_TEST_EXTRA_STACKSIZE)
+
+/* The test thread is cooperative, the spawned threads run when it waits */
+#define PRIO_HIGH K_PRIO_PREEMPT(0)
+#define PRIO_MID K_PRIO_PREEMPT(1)
+#define PRIO_LOW K_PRIO_PREEMPT(2)
+
+/* Value of a thread result before the thread has set it */
+#define NOT_SET 1
+
+/**TESTPOINT: init via K_RWLOCK_DEFINE*/
+K_RWLOCK_DEFINE(krwlock);
+static struct k_rwlock rwlock;
+
+static K_THREAD_STACK_DEFINE(tstack, STACK_SIZE);
+static K_THREAD_STACK_DEFINE(tstack2, STACK_SIZE);
+static struct k_thread tdata;
+static struct k_thread tdata2;
+
+static ZTEST_BMEM int thread_ret;
+static ZTEST_BMEM int thread2_ret;
+
+/* Order in which the spawned threads got the lock */
+static ZTEST_BMEM int lock_seq;
+static ZTEST_BMEM int thread_seq;
+static ZTEST_BMEM int thread2_seq;
+
+static void spawn(struct k_thread *thread, k_thread_stack_t *stack,
+		  k_thread_entry_t entry, int *ret, int *seq, int prio)
+{
+	*ret = NOT_SET;
+
+	k_thread_create(thread, stack, STACK_SIZE, entry, ret, seq, NULL,
+			prio, K_USER | K_INHERIT_PERMS, K_NO_WAIT);
+}
+
+static void join(struct k_thread *thread)
+{
+	zassert_equal(k_thread_join(thread, K_FOREVER), 0, NULL);
+}
+
+static void read_try(void *p1, void *p2, void *p3)
+{
+	int *ret = p1;
+
+	*ret = k_rwlock_read_lock(&rwlock, K_NO_WAIT);
+	if (*ret == 0) {
+		zassert_equal(k_rwlock_unlock(&rwlock), 0, NULL);
+	}
+}
+
+static void write_try(void *p1, void *p2, void *p3)
+{
+	int *ret = p1;
+
+	*ret = k_rwlock_write_lock(&rwlock, K_NO_WAIT);
+	if (*ret == 0) {
+		zassert_equal(k_rwlock_unlock(&rwlock), 0, NULL);
+	}
+}
+
+static void unlock_try(void *p1, void *p2, void *p3)
+{
+	int *ret = p1;
+
+	*ret = k_rwlock_unlock(&rwlock);
+}
+
+static void read_wait(void *p1, void *p2, void *p3)
+{
+	int *ret = p1, *seq = p2;
+
+	*ret = k_rwlock_read_lock(&rwlock, K_FOREVER);
+	if (*ret == 0) {
+		*seq = ++lock_seq;
+		k_msleep(10);
+		zassert_equal(k_rwlock_unlock(&rwlock), 0, NULL);
+	}
+}
+
+static void write_wait(void *p1, void *p2, void *p3)
+{
+	int *ret = p1, *seq = p2;
+
+	*ret = k_rwlock_write_lock(&rwlock, K_FOREVER);
+	if (*ret == 0) {
+		*seq = ++lock_seq;
+		k_msleep(10);
+		zassert_equal(k_rwlock_unlock(&rwlock), 0, NULL);
+	}
+}
+
+static void write_timeout(void *p1, void *p2, void *p3)
+{
+	int *ret = p1;
+
+	*ret = k_rwlock_write_lock(&rwlock, K_MSEC(TIMEOUT_MS));
+	if (*ret == 0) {
+		zassert_equal(k_rwlock_unlock(&rwlock), 0, NULL);
+	}
+}
+
+/**
+ * @brief Test that a statically defined reader-writer lock is usable
+ */
+void test_rwlock_define(void)
+{
+	zassert_equal(k_rwlock_read_lock(&krwlock, K_NO_WAIT), 0, NULL);
+	zassert_equal(k_rwlock_write_lock(&krwlock, K_NO_WAIT), -EBUSY, NULL);
+	zassert_equal(k_rwlock_unlock(&krwlock), 0, NULL);
+
+	zassert_equal(k_rwlock_write_lock(&krwlock, K_NO_WAIT), 0, NULL);
+	zassert_equal(k_rwlock_unlock(&krwlock), 0, NULL);
+	zassert_equal(k_rwlock_unlock(&krwlock), -EINVAL, NULL);
+}
+
+/**
+ * @brief Test that read locks are shared and exclude a writer
+ */
+void test_rwlock_read_shared(void)
+{
+	zassert_equal(k_rwlock_init(&rwlock), 0, NULL);
+
+	zassert_equal(k_rwlock_read_lock(&rwlock, K_NO_WAIT), 0, NULL);
+	zassert_equal(k_rwlock_read_lock(&rwlock, K_FOREVER), 0, NULL);
+
+	spawn(&tdata, tstack, read_try, &thread_ret, NULL, PRIO_HIGH);
+	join(&tdata);
+	zassert_equal(thread_ret, 0, "reader excluded by readers");
+
+	spawn(&tdata, tstack, write_try, &thread_ret, NULL, PRIO_HIGH);
+	join(&tdata);
+	zassert_equal(thread_ret, -EBUSY, "writer not excluded by readers");
+
+	zassert_equal(k_rwlock_write_lock(&rwlock, K_MSEC(TIMEOUT_MS)),
+		      -EAGAIN, NULL);
+
+	zassert_equal(k_rwlock_unlock(&rwlock), 0, NULL);
+	zassert_equal(k_rwlock_unlock(&rwlock), 0, NULL);
+	zassert_equal(k_rwlock_unlock(&rwlock), -EINVAL, NULL);
+}
+
+/**
+ * @brief Test that the write lock excludes readers and other writers
+ */
+void test_rwlock_write_exclusive(void)
+{
+	zassert_equal(k_rwlock_init(&rwlock), 0, NULL);
+
+	zassert_equal(k_rwlock_write_lock(&rwlock, K_NO_WAIT), 0, NULL);
+	zassert_equal(k_rwlock_write_lock(&rwlock, K_FOREVER), -EDEADLK, NULL);
+	zassert_equal(k_rwlock_read_lock(&rwlock, K_MSEC(TIMEOUT_MS)),
+		      -EAGAIN, NULL);
+
+	spawn(&tdata, tstack, read_try, &thread_ret, NULL, PRIO_HIGH);
+	join(&tdata);
+	zassert_equal(thread_ret, -EBUSY, "reader not excluded by writer");
+
+	spawn(&tdata, tstack, write_try, &thread_ret, NULL, PRIO_HIGH);
+	join(&tdata);
+	zassert_equal(thread_ret, -EBUSY, "writer not excluded by writer");
+
+	spawn(&tdata, tstack, unlock_try, &thread_ret, NULL, PRIO_HIGH);
+	join(&tdata);
+	zassert_equal(thread_ret, -EPERM, "write lock released by non-owner");
+
+	zassert_equal(k_rwlock_unlock(&rwlock), 0, NULL);
+	zassert_equal(k_rwlock_unlock(&rwlock), -EINVAL, NULL);
+}
+
+/**
+ * @brief Test that readers wait for a waiting writer of the same priority,
+ * but not for one of a lower priority
+ */
+void test_rwlock_writer_preference(void)
+{
+	zassert_equal(k_rwlock_init(&rwlock), 0, NULL);
+	lock_seq = 0;
+
+	zassert_equal(k_rwlock_read_lock(&rwlock, K_NO_WAIT), 0, NULL);
+
+	spawn(&tdata2, tstack2, write_wait, &thread2_ret, &thread2_seq,
+	      PRIO_MID);
+	k_msleep(TIMEOUT_MS);
+	zassert_equal(thread2_ret, NOT_SET, "writer not waiting for reader");
+
+	spawn(&tdata, tstack, read_try, &thread_ret, NULL, PRIO_MID);
+	join(&tdata);
+	zassert_equal(thread_ret, -EBUSY, "reader passed a waiting writer");
+
+	spawn(&tdata, tstack, read_try, &thread_ret, NULL, PRIO_HIGH);
+	join(&tdata);
+	zassert_equal(thread_ret, 0, "higher priority reader waits");
+
+	/* The writer gets the lock once the last reader has released it */
+	zassert_equal(k_rwlock_unlock(&rwlock), 0, NULL);
+	join(&tdata2);
+	zassert_equal(thread2_ret, 0, NULL);
+	zassert_equal(thread2_seq, 1, NULL);
+}
+
+/**
+ * @brief Test that a released write lock goes to the waiting writer before
+ * waiting readers of the same priority
+ */
+void test_rwlock_writer_handoff(void)
+{
+	zassert_equal(k_rwlock_init(&rwlock), 0, NULL);
+	lock_seq = 0;
+
+	zassert_equal(k_rwlock_write_lock(&rwlock, K_NO_WAIT), 0, NULL);
+
+	spawn(&tdata, tstack, read_wait, &thread_ret, &thread_seq, PRIO_MID);
+	spawn(&tdata2, tstack2, write_wait, &thread2_ret, &thread2_seq,
+	      PRIO_MID);
+	k_msleep(TIMEOUT_MS);
+	zassert_equal(thread_ret, NOT_SET, "reader not waiting for writer");
+	zassert_equal(thread2_ret, NOT_SET, "writer not waiting for writer");
+
+	zassert_equal(k_rwlock_unlock(&rwlock), 0, NULL);
+	join(&tdata);
+	join(&tdata2);
+
+	zassert_equal(thread_ret, 0, NULL);
+	zassert_equal(thread2_ret, 0, NULL);
+	zassert_equal(thread2_seq, 1, "reader got the lock before writer");
+	zassert_equal(thread_seq, 2, NULL);
+}
+
+/**
+ * @brief Test that the readers held back by a writer get the lock when the
+ * writer times out
+ */
+void test_rwlock_writer_timeout(void)
+{
+	zassert_equal(k_rwlock_init(&rwlock), 0, NULL);
+	lock_seq = 0;
+
+	zassert_equal(k_rwlock_read_lock(&rwlock, K_NO_WAIT), 0, NULL);
+
+	spawn(&tdata2, tstack2, write_timeout, &thread2_ret, NULL, PRIO_MID);
+	spawn(&tdata, tstack, read_wait, &thread_ret, &thread_seq, PRIO_LOW);
+	k_msleep(TIMEOUT_MS / 2);
+	zassert_equal(thread_ret, NOT_SET, "reader passed a waiting writer");
+
+	join(&tdata2);
+	zassert_equal(thread2_ret, -EAGAIN, NULL);
+
+	join(&tdata);
+	zassert_equal(thread_ret, 0, "reader not woken by writer timeout");
+
+	zassert_equal(k_rwlock_unlock(&rwlock), 0, NULL);
+}
+
+void test_main(void)
+{
+	k_thread_access_grant(k_current_get(), &tdata, &tstack, &tdata2,
+			      &tstack2, &krwlock, &rwlock);
+
+	ztest_test_suite(rwlock_api,
+		 ztest_user_unit_test(test_rwlock_define),
+		 ztest_1cpu_user_unit_test(test_rwlock_read_shared),
+		 ztest_1cpu_user_unit_test(test_rwlock_write_exclusive),
+		 ztest_1cpu_user_unit_test(test_rwlock_writer_preference),
+		 ztest_1cpu_user_unit_test(test_rwlock_writer_handoff),
+		 ztest_1cpu_user_unit_test(test_rwlock_writer_timeout)
+		 );
+	ztest_run_test_suite(rwlock_api);
+}
@@ -474,6 +474,146 @@ void test_memstr(void)
 		     "memmove failed");
 }
 
+/* Offsets and lengths covering the word-sized paths of the string
+ * functions, whatever the alignments of the buffers.
+ */
+#define ALIGN_MAX_OFFSET 8
+#define ALIGN_MAX_LEN 40
+#define ALIGN_BUFSIZE (ALIGN_MAX_OFFSET + ALIGN_MAX_LEN + ALIGN_MAX_OFFSET)
+
+static unsigned char align_src[ALIGN_BUFSIZE];
+static unsigned char align_dst[ALIGN_BUFSIZE];
+static unsigned char align_ref[ALIGN_BUFSIZE];
+
+static void align_fill(void)
+{
+	int i;
+
+	for (i = 0; i < ALIGN_BUFSIZE; i++) {
+		align_src[i] = i + 1;
+		align_dst[i] = 0xaa;
+		align_ref[i] = 0xaa;
+	}
+}
+
+/**
+ *
+ * @brief Test copies between buffers of any alignment
+ *
+ * @see memcpy(), memmove(), memset().
+ *
+ */
+void test_mem_alignment(void)
+{
+	int so, dof, len, i;
+
+	for (so = 0; so < ALIGN_MAX_OFFSET; so++) {
+		for (dof = 0; dof < ALIGN_MAX_OFFSET; dof++) {
+			for (len = 0; len <= ALIGN_MAX_LEN; len++) {
+				align_fill();
+				for (i = 0; i < len; i++) {
+					align_ref[dof + i] = align_src[so + i];
+				}
+
+				zassert_equal(memcpy(align_dst + dof,
+						     align_src + so, len),
+					      align_dst + dof, "memcpy error");
+				zassert_equal(memcmp(align_dst, align_ref,
+						     ALIGN_BUFSIZE), 0,
+					      "memcpy %d to %d, %d bytes",
+					      so, dof, len);
+
+				align_fill();
+				(void)memset(align_dst + dof, so, len);
+				for (i = 0; i < len; i++) {
+					align_ref[dof + i] = so;
+				}
+				zassert_equal(memcmp(align_dst, align_ref,
+						     ALIGN_BUFSIZE), 0,
+					      "memset at %d, %d bytes",
+					      dof, len);
+			}
+		}
+	}
+
+	/* Overlapping moves in both directions */
+	for (so = 0; so < 2 * ALIGN_MAX_OFFSET; so++) {
+		for (dof = 0; dof < 2 * ALIGN_MAX_OFFSET; dof++) {
+			for (len = 0; len <= ALIGN_MAX_LEN; len++) {
+				align_fill();
+				(void)memcpy(align_dst, align_src,
+					     ALIGN_BUFSIZE);
+				(void)memcpy(align_ref, align_src,
+					     ALIGN_BUFSIZE);
+				for (i = 0; i < len; i++) {
+					align_ref[dof + i] = align_src[so + i];
+				}
+
+				zassert_equal(memmove(align_dst + dof,
+						      align_dst + so, len),
+					      align_dst + dof, "memmove error");
+				zassert_equal(memcmp(align_dst, align_ref,
+						     ALIGN_BUFSIZE), 0,
+					      "memmove %d to %d, %d bytes",
+					      so, dof, len);
+			}
+		}
+	}
+}
+
+/**
+ *
+ * @brief Test string and byte scans at any alignment
+ *
+ * @see strlen(), strcmp(), memchr().
+ *
+ */
+void test_str_alignment(void)
+{
+	char *s1 = (char *)align_src, *s2 = (char *)align_dst;
+	int o1, o2, len;
+
+	for (o1 = 0; o1 < ALIGN_MAX_OFFSET; o1++) {
+		for (len = 0; len <= ALIGN_MAX_LEN; len++) {
+			(void)memset(s1, 'a', ALIGN_BUFSIZE);
+			s1[o1 + len] = '\0';
+
+			zassert_equal(strlen(s1 + o1), len,
+				      "strlen at %d, %d bytes", o1, len);
+
+			s1[o1 + len] = 'b';
+			zassert_equal(memchr(s1 + o1, 'b', ALIGN_MAX_LEN + 1),
+				      s1 + o1 + len, "memchr at %d, %d bytes",
+				      o1, len);
+			zassert_is_null(memchr(s1 + o1, 'b', len),
+					"memchr at %d, %d bytes", o1, len);
+			s1[o1 + len] = '\0';
+
+			for (o2 = 0; o2 < ALIGN_MAX_OFFSET; o2++) {
+				(void)memset(s2, 'a', ALIGN_BUFSIZE);
+				s2[o2 + len] = '\0';
+				zassert_equal(strcmp(s1 + o1, s2 + o2), 0,
+					      "strcmp %d and %d, %d bytes",
+					      o1, o2, len);
+
+				if (len == 0) {
+					continue;
+				}
+
+				s2[o2 + len - 1] = 'b';
+				zassert_true(strcmp(s1 + o1, s2 + o2) < 0,
+					     "strcmp %d and %d, %d bytes",
+					     o1, o2, len);
+
+				s2[o2 + len - 1] = '\0';
+				zassert_true(strcmp(s1 + o1, s2 + o2) > 0,
+					     "strcmp %d and %d, %d bytes",
+					     o1, o2, len);
+			}
+		}
+	}
+}
+
 /**
  *
  * @brief test str operate functions
@@ -619,6 +759,8 @@ void test_main(void)
 			 ztest_unit_test(test_atoi),
 			 ztest_unit_test(test_checktype),
 			 ztest_unit_test(test_memstr),
+			 ztest_unit_test(test_mem_alignment),
+			 ztest_unit_test(test_str_alignment),
 			 ztest_unit_test(test_str_operate),
 			 ztest_unit_test(test_tolower_toupper),
 			 ztest_unit_test(test_strtok_r)
@@ -1599,6 +1599,12 @@ static void test_dep_ord(void)
 		test_requires[] = { DT_REQUIRES_DEP_ORDS(DT_PATH(test)) },
 		root_supports[] = { DT_SUPPORTS_DEP_ORDS(DT_ROOT) },
 		test_supports[] = { DT_SUPPORTS_DEP_ORDS(DT_PATH(test)) },
+		i2c_dev_devices[] = {
+			DT_REQUIRES_DEVICE_DEP_ORDS(TEST_I2C_DEV)
+		},
+		labeled_ords[] = {
+			DT_FOREACH_LABELED_STATUS_OKAY(DEP_ORD_AND_COMMA)
+		},
 		children_ords[] = {
 			DT_FOREACH_CHILD(TEST_CHILDREN, DEP_ORD_AND_COMMA)
 		},
@@ -1633,6 +1639,27 @@ static void test_dep_ord(void)
 	zassert_false(ORD_IN_ARRAY(root_ord, test_supports),
 		      "the /test node doesn't support the root");
 
+	/* DT_REQUIRES_DEVICE_DEP_ORDS */
+	zassert_true(ORD_IN_ARRAY(DT_DEP_ORD(TEST_I2C_BUS), i2c_dev_devices),
+		     "i2c devices depend on their controller");
+	zassert_false(ORD_IN_ARRAY(test_ord, i2c_dev_devices),
+		      "/test has no label, it is not a device node");
+	zassert_false(ORD_IN_ARRAY(root_ord, i2c_dev_devices),
+		      "the root node is not a device node");
+
+	/* DT_FOREACH_LABELED_STATUS_OKAY */
+	zassert_true(ORD_IN_ARRAY(DT_DEP_ORD(TEST_I2C_DEV), labeled_ords),
+		     "enabled nodes with a label are visited");
+	zassert_false(ORD_IN_ARRAY(DT_DEP_ORD(DT_NODELABEL(disabled_gpio)),
+				   labeled_ords),
+		      "disabled nodes are not visited");
+	zassert_false(ORD_IN_ARRAY(test_ord, labeled_ords),
+		      "nodes without a label are not visited");
+	for (i = 1; i < ARRAY_SIZE(labeled_ords); i++) {
+		zassert_true(labeled_ords[i] > labeled_ords[i - 1],
+			     "labeled nodes are in dependency order");
+	}
+
 	unsigned int children_combined_ords_expected[] = {
 		/*
 		 * Combined ordinals for /test/test-children are from
@@ -3,6 +3,7 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
+#include <float.h>
 #include <string.h>
 #include <zephyr/types.h>
 #include <stdbool.h>
@@ -95,6 +96,26 @@ static const struct json_obj_descr array_array_descr[] = {
 				   ARRAY_SIZE(array_descr)),
 };
 
+struct test_fp {
+	float some_float;
+	double some_double;
+	int64_t some_int64;
+	double double_array[4];
+	size_t double_array_len;
+	int64_t int64_array[4];
+	size_t int64_array_len;
+};
+
+static const struct json_obj_descr fp_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct test_fp, some_float, JSON_TOK_FLOAT),
+	JSON_OBJ_DESCR_PRIM(struct test_fp, some_double, JSON_TOK_DOUBLE),
+	JSON_OBJ_DESCR_PRIM(struct test_fp, some_int64, JSON_TOK_INT64),
+	JSON_OBJ_DESCR_ARRAY(struct test_fp, double_array, 4,
+			     double_array_len, JSON_TOK_DOUBLE),
+	JSON_OBJ_DESCR_ARRAY(struct test_fp, int64_array, 4,
+			     int64_array_len, JSON_TOK_INT64),
+};
+
 static void test_json_encoding(void)
 {
 	struct test_struct ts = {
@@ -539,6 +560,306 @@ static void test_json_encode_bounds_check(void)
 	zassert_equal(ret, -ENOMEM, "Bounds check rejected");
 }
 
+static void test_json_encode_buf_len(void)
+{
+	struct elt elt = { .name = "tab\tand \"quotes\"", .height = -170 };
+	const char encoded[] = "{\"name\":\"tab\\tand \\\"quotes\\\"\","
+		"\"height\":-170}";
+	char buffer[sizeof(encoded)];
+	ssize_t len;
+
+	len = json_obj_encode_buf_len(elt_descr, ARRAY_SIZE(elt_descr), &elt,
+				      buffer, sizeof(buffer));
+	zassert_equal(len, sizeof(encoded) - 1, "Encoded length is exact");
+	zassert_true(!strcmp(buffer, encoded), "Encoded contents consistent");
+
+	/* Too small: truncated, but the length is still exact */
+	len = json_obj_encode_buf_len(elt_descr, ARRAY_SIZE(elt_descr), &elt,
+				      buffer, 12);
+	zassert_equal(len, sizeof(encoded) - 1, "Truncated length is exact");
+	zassert_true(!strncmp(buffer, encoded, 11) && buffer[11] == '\0',
+		     "Truncated contents consistent");
+
+	len = json_obj_encode_buf_len(elt_descr, ARRAY_SIZE(elt_descr), &elt,
+				      NULL, 0);
+	zassert_equal(len, sizeof(encoded) - 1, "Measured length is exact");
+}
+
+static int append_bytes_count(const char *bytes, size_t len, void *data)
+{
+	size_t *total = data;
+
+	*total += len;
+
+	return len > 64 ? -EINVAL : 0;
+}
+
+static void test_json_encode_append_bytes(void)
+{
+	struct elt elt = {
+		.name = "a name much longer than the encoder chunks are, "
+			"which goes to append_bytes in one piece",
+		.height = 42,
+	};
+	size_t total = 0;
+	ssize_t len;
+	int ret;
+
+	ret = json_obj_encode(elt_descr, ARRAY_SIZE(elt_descr), &elt,
+			      append_bytes_count, &total);
+	zassert_equal(ret, -EINVAL, "append_bytes error is returned");
+
+	elt.name = "short";
+	len = json_calc_encoded_len(elt_descr, ARRAY_SIZE(elt_descr), &elt);
+	total = 0;
+
+	ret = json_obj_encode(elt_descr, ARRAY_SIZE(elt_descr), &elt,
+			      append_bytes_count, &total);
+	zassert_equal(ret, 0, "Encoding function returned no errors");
+	zassert_equal(total, len, "All bytes appended");
+}
+
+static void test_json_fp_encoding(void)
+{
+	struct test_fp fp = {
+		.some_float = -0.125f,
+		.some_double = 6.02214076e23,
+		.some_int64 = INT64_MIN,
+		.double_array = { 0.1, 1234.5, 1e-7, 0 },
+		.double_array_len = 4,
+		.int64_array = { 1599123456789, -1 },
+		.int64_array_len = 2,
+	};
+	char encoded[] = "{\"some_float\":-0.125,"
+		"\"some_double\":6.02214076e23,"
+		"\"some_int64\":-9223372036854775808,"
+		"\"double_array\":[0.1,1234.5,1e-7,0],"
+		"\"int64_array\":[1599123456789,-1]"
+		"}";
+	char buffer[sizeof(encoded)];
+	ssize_t len;
+	int ret;
+
+	len = json_calc_encoded_len(fp_descr, ARRAY_SIZE(fp_descr), &fp);
+	zassert_equal(len, strlen(encoded), "encoded size mismatch");
+
+	ret = json_obj_encode_buf(fp_descr, ARRAY_SIZE(fp_descr), &fp,
+				  buffer, sizeof(buffer));
+	zassert_equal(ret, 0, "Encoding function returned no errors");
+	zassert_true(!strcmp(buffer, encoded), "Encoded contents consistent");
+}
+
+static void test_json_fp_decoding(void)
+{
+	struct test_fp fp;
+	char encoded[] = "{\"some_float\":3.5,"
+		"\"some_double\":-1.5E-3,"
+		"\"some_int64\":9223372036854775807,"
+		"\"double_array\":[1e+2, 0.25, -7],"
+		"\"int64_array\":[-4294967296]"
+		"}";
+	int ret;
+
+	ret = json_obj_parse(encoded, sizeof(encoded) - 1, fp_descr,
+			     ARRAY_SIZE(fp_descr), &fp);
+	zassert_equal(ret, (1 << ARRAY_SIZE(fp_descr)) - 1,
+		      "All fields decoded correctly");
+
+	zassert_equal(fp.some_float, 3.5f, "Float decoded correctly");
+	zassert_within(fp.some_double, -1.5e-3, 1e-18,
+		       "Double decoded correctly");
+	zassert_equal(fp.some_int64, INT64_MAX, "Int64 decoded correctly");
+	zassert_equal(fp.double_array_len, 3,
+		      "Array has correct number of items");
+	zassert_equal(fp.double_array[0], 100.0, "Exponent decoded correctly");
+	zassert_equal(fp.double_array[1], 0.25, "Fraction decoded correctly");
+	zassert_equal(fp.double_array[2], -7.0, "Integer decoded correctly");
+	zassert_equal(fp.int64_array_len, 1,
+		      "Array has correct number of items");
+	zassert_equal(fp.int64_array[0], -4294967296LL,
+		      "Int64 array decoded correctly");
+}
+
+static void test_json_fp_round_trip(void)
+{
+	static const struct {
+		float f;
+		double d;
+	} values[] = {
+		{ 1234567.0f, 0.1 + 0.2 },
+		{ FLT_MAX, DBL_MAX },
+		{ -FLT_MAX, -DBL_MAX },
+		{ FLT_MIN, DBL_MIN },
+		{ 1.0f / 3.0f, 1.0 / 3.0 },
+		{ 16777217.0f, 9007199254740993.0 },
+		{ 1e-45f, 4.9406564584124654e-324 },
+		{ 3.14159274f, 2.718281828459045 },
+	};
+	struct test_fp fp = { 0 }, decoded;
+	char buffer[256];
+	int ret;
+
+	for (int i = 0; i < ARRAY_SIZE(values); i++) {
+		fp.some_float = values[i].f;
+		fp.some_double = values[i].d;
+
+		ret = json_obj_encode_buf(fp_descr, ARRAY_SIZE(fp_descr), &fp,
+					  buffer, sizeof(buffer));
+		zassert_equal(ret, 0, "Encoding function returned no errors");
+
+		ret = json_obj_parse(buffer, strlen(buffer), fp_descr,
+				     ARRAY_SIZE(fp_descr), &decoded);
+		zassert_equal(ret, (1 << ARRAY_SIZE(fp_descr)) - 1,
+			      "Encoded numbers decoded");
+		zassert_equal(decoded.some_float, values[i].f,
+			      "Float %d decoded as encoded", i);
+		zassert_equal(decoded.some_double, values[i].d,
+			      "Double %d decoded as encoded", i);
+	}
+
+	fp.some_float = 1234567.0f;
+	fp.some_double = DBL_MAX;
+	ret = json_obj_encode_buf(fp_descr, 2, &fp, buffer, sizeof(buffer));
+	zassert_equal(ret, 0, "Encoding function returned no errors");
+	zassert_true(!strcmp(buffer, "{\"some_float\":1234567,"
+			     "\"some_double\":1.7976931348623157e308}"),
+		     "Shortest digits encoded");
+
+	strcpy(buffer, "{\"some_float\":3.4028235e38}");
+	ret = json_obj_parse(buffer, strlen(buffer), fp_descr,
+			     ARRAY_SIZE(fp_descr), &decoded);
+	zassert_equal(ret, 1, "Number rounding to FLT_MAX decoded");
+	zassert_equal(decoded.some_float, FLT_MAX, "Float rounded to FLT_MAX");
+}
+
+static void test_json_fp_invalid(void)
+{
+	struct encoding_test encoded[] = {
+		{ "{\"some_double\":.5}", -EINVAL },
+		{ "{\"some_double\":1.}", -EINVAL },
+		{ "{\"some_double\":1e}", -EINVAL },
+		{ "{\"some_double\":1e999}", -ERANGE },
+		{ "{\"some_float\":1e39}", -ERANGE },
+		{ "{\"some_float\":3.4028236e38}", -ERANGE },
+		{ "{\"some_int64\":1.5}", -EINVAL },
+		{ "{\"some_int64\":9223372036854775808}", -ERANGE },
+		{ "{\"some_int64\":-9223372036854775809}", -ERANGE },
+	};
+	struct test_fp fp;
+	int ret;
+
+	for (int i = 0; i < ARRAY_SIZE(encoded); i++) {
+		ret = json_obj_parse(encoded[i].str, strlen(encoded[i].str),
+				     fp_descr, ARRAY_SIZE(fp_descr), &fp);
+		zassert_equal(ret, encoded[i].result,
+			      "Decoding '%s' result %d, expected %d",
+			      encoded[i].str, ret, encoded[i].result);
+	}
+}
+
+static const char stream_encoded[] = "{\"some_string\":\"zephyr \\\"123\\u00e9\","
+	"\"unknown\":{\"list\":[1, {\"a\":null}, \"]}\"]},"
+	"\"some_int\":\t42\n,"
+	"\"some_bool\":true,"
+	"\"some_nested_struct\":{\"nested_int\":-1234,"
+	"\"nested_bool\":false,\"nested_string\":\"nested\"},"
+	"\"some_array\":[11,22, 33,\t45,\n299],"
+	"\"another_b!@l\":true,"
+	"\"if\":false,"
+	"\"another-array\":[],"
+	"\"4nother_ne$+\":{\"nested_int\":1234,\"nested_bool\":true,"
+	"\"nested_string\":\"no escape necessary\"}"
+	"}\n";
+
+static void stream_check(size_t fragment)
+{
+	const int expected_array[] = { 11, 22, 33, 45, 299 };
+	struct json_stream stream;
+	struct test_struct ts;
+	char strings[64];
+	size_t pos, len;
+	int ret;
+
+	json_stream_init(&stream, test_descr, ARRAY_SIZE(test_descr), &ts,
+			 strings, sizeof(strings));
+
+	for (pos = 0; pos < sizeof(stream_encoded) - 1; pos += len) {
+		len = MIN(fragment, sizeof(stream_encoded) - 1 - pos);
+
+		ret = json_stream_feed(&stream, &stream_encoded[pos], len);
+		zassert_equal(ret, 0, "Fragment at %zu decoded", pos);
+	}
+
+	ret = json_stream_finish(&stream);
+	zassert_equal(ret, (1 << ARRAY_SIZE(test_descr)) - 1,
+		      "All fields decoded correctly");
+
+	zassert_true(!strcmp(ts.some_string, "zephyr \\\"123\\u00e9"),
+		     "String decoded correctly");
+	zassert_equal(ts.some_int, 42, "Positive integer decoded correctly");
+	zassert_true(ts.some_bool, "Boolean decoded correctly");
+	zassert_equal(ts.some_nested_struct.nested_int, -1234,
+		      "Nested negative integer decoded correctly");
+	zassert_false(ts.some_nested_struct.nested_bool,
+		      "Nested boolean value decoded correctly");
+	zassert_true(!strcmp(ts.some_nested_struct.nested_string, "nested"),
+		     "Nested string decoded correctly");
+	zassert_equal(ts.some_array_len, 5, "Array has correct number of items");
+	zassert_true(!memcmp(ts.some_array, expected_array,
+			     sizeof(expected_array)),
+		     "Array decoded with expected values");
+	zassert_true(ts.another_bxxl,
+		     "Named boolean (special chars) decoded correctly");
+	zassert_false(ts.if_,
+		      "Named boolean (reserved word) decoded correctly");
+	zassert_equal(ts.another_array_len, 0, "Empty array decoded");
+	zassert_true(!strcmp(ts.xnother_nexx.nested_string,
+			     "no escape necessary"),
+		     "Named nested string decoded correctly");
+}
+
+static void test_json_stream(void)
+{
+	stream_check(sizeof(stream_encoded));
+	stream_check(1);
+	stream_check(7);
+}
+
+static void test_json_stream_invalid(void)
+{
+	struct encoding_test encoded[] = {
+		{ "[]", -EINVAL },
+		{ "{\"some_int\" 1}", -EINVAL },
+		{ "{\"some_int\":1,}", -EINVAL },
+		{ "{\"some_int\":1 \"some_bool\":true}", -EINVAL },
+		{ "{\"some_int\":1.5}", -EINVAL },
+		{ "{\"some_string\":\"\\X\"}", -EINVAL },
+		{ "{\"some_bool\":truffle}", -EINVAL },
+		{ "{\"some_string\":null}", -EINVAL },
+		{ "{\"some_string\":\"0123456789abcdef\"}", -ENOMEM },
+		{ "{\"some_array\":[1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17]}",
+		  -ENOSPC },
+		{ "{\"some_int\":1", -EINVAL },
+		{ "{} {}", -EINVAL },
+	};
+	struct json_stream stream;
+	struct test_struct ts;
+	char strings[16];
+	int ret;
+
+	for (int i = 0; i < ARRAY_SIZE(encoded); i++) {
+		json_stream_init(&stream, test_descr, ARRAY_SIZE(test_descr),
+				 &ts, strings, sizeof(strings));
+
+		(void)json_stream_feed(&stream, encoded[i].str,
+				       strlen(encoded[i].str));
+		ret = json_stream_finish(&stream);
+		zassert_equal(ret, encoded[i].result,
+			      "Decoding '%s' result %d, expected %d",
+			      encoded[i].str, ret, encoded[i].result);
+	}
+}
+
 void test_main(void)
 {
 	ztest_test_suite(lib_json_test,
@@ -560,7 +881,15 @@ void test_main(void)
 			 ztest_unit_test(test_json_escape_empty),
 			 ztest_unit_test(test_json_escape_no_op),
 			 ztest_unit_test(test_json_escape_bounds_check),
-			 ztest_unit_test(test_json_encode_bounds_check)
+			 ztest_unit_test(test_json_encode_bounds_check),
+			 ztest_unit_test(test_json_encode_buf_len),
+			 ztest_unit_test(test_json_encode_append_bytes),
+			 ztest_unit_test(test_json_fp_encoding),
+			 ztest_unit_test(test_json_fp_decoding),
+			 ztest_unit_test(test_json_fp_round_trip),
+			 ztest_unit_test(test_json_fp_invalid),
+			 ztest_unit_test(test_json_stream),
+			 ztest_unit_test(test_json_stream_invalid)
 			 );
 
 	ztest_run_test_suite(lib_json_test);
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <irq_offload.h>
+#include <sys/ring_buffer_lockfree.h>
+
+#define LF_POW 4
+#define LF_SIZE BIT(LF_POW)
+
+RING_BUF_SPSC_DECLARE_POW2(spsc_rb, LF_POW);
+RING_BUF_MPSC_DECLARE_POW2(mpsc_rb, LF_POW);
+RING_BUF_MPMC_DECLARE_POW2(mpmc_rb, LF_POW);
+
+static const uint8_t lf_indata[LF_SIZE] = {
+	0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15
+};
+
+/**
+ * @brief Test SPSC claim/finish and full buffer usage
+ *
+ * @ingroup lib_ringbuffer_tests
+ *
+ * @see ring_buf_spsc_put_claim(), ring_buf_spsc_get_claim()
+ */
+void test_ringbuffer_spsc_claim(void)
+{
+	uint8_t outdata[LF_SIZE];
+	uint8_t *data;
+	uint32_t granted;
+
+	zassert_true(ring_buf_spsc_is_empty(&spsc_rb), NULL);
+	zassert_equal(ring_buf_spsc_capacity_get(&spsc_rb), LF_SIZE, NULL);
+
+	/* Whole buffer is usable. */
+	zassert_equal(ring_buf_spsc_put(&spsc_rb, lf_indata, LF_SIZE),
+		      LF_SIZE, NULL);
+	zassert_equal(ring_buf_spsc_space_get(&spsc_rb), 0, NULL);
+	zassert_equal(ring_buf_spsc_put(&spsc_rb, lf_indata, 1), 0, NULL);
+
+	/* Free part of the buffer so the next claim wraps. */
+	zassert_equal(ring_buf_spsc_get(&spsc_rb, outdata, 10), 10, NULL);
+	zassert_true(memcmp(outdata, lf_indata, 10) == 0, NULL);
+
+	granted = ring_buf_spsc_put_claim(&spsc_rb, &data, 10);
+	zassert_equal(granted, 10, NULL);
+	memcpy(data, lf_indata, granted);
+
+	/* Finishing more than claimed is rejected. */
+	zassert_equal(ring_buf_spsc_put_finish(&spsc_rb, 11), -EINVAL, NULL);
+	zassert_equal(ring_buf_spsc_put_finish(&spsc_rb, 10), 0, NULL);
+
+	zassert_equal(ring_buf_spsc_get(&spsc_rb, outdata, LF_SIZE),
+		      LF_SIZE, NULL);
+	zassert_true(memcmp(outdata, &lf_indata[10], 6) == 0, NULL);
+	zassert_true(memcmp(&outdata[6], lf_indata, 10) == 0, NULL);
+	zassert_true(ring_buf_spsc_is_empty(&spsc_rb), NULL);
+
+	/* Partial finish returns the rest of the claim. */
+	granted = ring_buf_spsc_put_claim(&spsc_rb, &data, 4);
+	zassert_equal(granted, 4, NULL);
+	zassert_equal(ring_buf_spsc_put_finish(&spsc_rb, 2), 0, NULL);
+	zassert_equal(ring_buf_spsc_space_get(&spsc_rb), LF_SIZE - 2, NULL);
+
+	granted = ring_buf_spsc_get_claim(&spsc_rb, &data, LF_SIZE);
+	zassert_equal(granted, 2, NULL);
+	zassert_equal(ring_buf_spsc_get_finish(&spsc_rb, 3), -EINVAL, NULL);
+	zassert_equal(ring_buf_spsc_get_finish(&spsc_rb, 2), 0, NULL);
+}
+
+static void spsc_isr_put(const void *arg)
+{
+	ARG_UNUSED(arg);
+
+	zassert_equal(ring_buf_spsc_put(&spsc_rb, lf_indata, 5), 5, NULL);
+}
+
+/**
+ * @brief Test SPSC with producer in ISR and consumer in thread context
+ *
+ * @ingroup lib_ringbuffer_tests
+ */
+void test_ringbuffer_spsc_isr(void)
+{
+	uint8_t outdata[5];
+
+	for (int i = 0; i < 10; i++) {
+		irq_offload(spsc_isr_put, NULL);
+		zassert_equal(ring_buf_spsc_get(&spsc_rb, outdata, 5), 5,
+			      NULL);
+		zassert_true(memcmp(outdata, lf_indata, 5) == 0, NULL);
+	}
+	zassert_true(ring_buf_spsc_is_empty(&spsc_rb), NULL);
+}
+
+static uint32_t mpsc_isr_granted;
+
+static void mpsc_isr_put(const void *arg)
+{
+	ARG_UNUSED(arg);
+
+	mpsc_isr_granted = ring_buf_mpsc_put(&mpsc_rb, &lf_indata[8], 4);
+}
+
+/**
+ * @brief Test MPSC claim/finish with interleaved producers
+ *
+ * @details A claim is opened in thread context, then another producer
+ * (ISR) writes a record. Nothing is visible to the consumer until the
+ * first claim is finished, after which both records are visible in
+ * reservation order.
+ *
+ * @ingroup lib_ringbuffer_tests
+ *
+ * @see ring_buf_mpsc_put_claim(), ring_buf_mpsc_put_finish()
+ */
+void test_ringbuffer_mpsc_claim(void)
+{
+	uint8_t outdata[LF_SIZE];
+	uint8_t *data;
+	uint32_t granted;
+
+	zassert_true(ring_buf_mpsc_is_empty(&mpsc_rb), NULL);
+	zassert_equal(ring_buf_mpsc_put_finish(&mpsc_rb, 1), -EINVAL, NULL);
+
+	granted = ring_buf_mpsc_put_claim(&mpsc_rb, &data, 4);
+	zassert_equal(granted, 4, NULL);
+
+	irq_offload(mpsc_isr_put, NULL);
+	zassert_equal(mpsc_isr_granted, 4, NULL);
+
+	/* First claim still outstanding: nothing published. */
+	zassert_true(ring_buf_mpsc_is_empty(&mpsc_rb), NULL);
+
+	memcpy(data, lf_indata, granted);
+	zassert_equal(ring_buf_mpsc_put_finish(&mpsc_rb, granted), 0, NULL);
+
+	zassert_equal(ring_buf_mpsc_get(&mpsc_rb, outdata, LF_SIZE), 8, NULL);
+	zassert_true(memcmp(outdata, lf_indata, 4) == 0, NULL);
+	zassert_true(memcmp(&outdata[4], &lf_indata[8], 4) == 0, NULL);
+
+	/* Records are all or nothing and do not wrap. */
+	zassert_equal(ring_buf_mpsc_put(&mpsc_rb, lf_indata, 12), 0, NULL);
+	zassert_equal(ring_buf_mpsc_put(&mpsc_rb, lf_indata, 8), 8, NULL);
+	zassert_equal(ring_buf_mpsc_put(&mpsc_rb, lf_indata, 8), 8, NULL);
+	zassert_equal(ring_buf_mpsc_put(&mpsc_rb, lf_indata, 1), 0, NULL);
+	zassert_equal(ring_buf_mpsc_get(&mpsc_rb, outdata, LF_SIZE),
+		      LF_SIZE, NULL);
+	zassert_true(ring_buf_mpsc_is_empty(&mpsc_rb), NULL);
+}
+
+static uint32_t mpmc_isr_granted;
+
+static void mpmc_isr_get(const void *arg)
+{
+	uint8_t *outdata = (uint8_t *)arg;
+
+	mpmc_isr_granted = ring_buf_mpmc_get(&mpmc_rb, outdata, 4);
+}
+
+/**
+ * @brief Test MPMC claim/finish with interleaved consumers
+ *
+ * @details A read claim is opened in thread context, then another consumer
+ * (ISR) reads the next record. The space is not returned to the producers
+ * until the first claim is finished.
+ *
+ * @ingroup lib_ringbuffer_tests
+ *
+ * @see ring_buf_mpmc_get_claim(), ring_buf_mpmc_get_finish()
+ */
+void test_ringbuffer_mpmc_claim(void)
+{
+	uint8_t outdata[LF_SIZE];
+	uint8_t *data;
+	uint32_t granted;
+
+	zassert_true(ring_buf_mpmc_is_empty(&mpmc_rb), NULL);
+	zassert_equal(ring_buf_mpmc_get_finish(&mpmc_rb, 1), -EINVAL, NULL);
+	zassert_equal(ring_buf_mpmc_get_claim(&mpmc_rb, &data, 1), 0, NULL);
+
+	zassert_equal(ring_buf_mpmc_put(&mpmc_rb, lf_indata, 8), 8, NULL);
+	zassert_equal(ring_buf_mpmc_put(&mpmc_rb, &lf_indata[8], 8), 8, NULL);
+	zassert_equal(ring_buf_mpmc_put(&mpmc_rb, lf_indata, 1), 0, NULL);
+
+	granted = ring_buf_mpmc_get_claim(&mpmc_rb, &data, 4);
+	zassert_equal(granted, 4, NULL);
+	zassert_true(memcmp(data, lf_indata, 4) == 0, NULL);
+
+	irq_offload(mpmc_isr_get, outdata);
+	zassert_equal(mpmc_isr_granted, 4, NULL);
+	zassert_true(memcmp(outdata, &lf_indata[4], 4) == 0, NULL);
+
+	/* First claim still outstanding: no space returned. */
+	zassert_equal(ring_buf_mpmc_put(&mpmc_rb, lf_indata, 1), 0, NULL);
+
+	zassert_equal(ring_buf_mpmc_get_finish(&mpmc_rb, granted), 0, NULL);
+	zassert_equal(ring_buf_mpmc_put(&mpmc_rb, lf_indata, 8), 8, NULL);
+
+	/* Reads do not wrap, the rest comes with the next read. */
+	zassert_equal(ring_buf_mpmc_get(&mpmc_rb, outdata, LF_SIZE), 8, NULL);
+	zassert_true(memcmp(outdata, &lf_indata[8], 8) == 0, NULL);
+	zassert_equal(ring_buf_mpmc_get(&mpmc_rb, outdata, LF_SIZE), 8, NULL);
+	zassert_true(memcmp(outdata, lf_indata, 8) == 0, NULL);
+	zassert_true(ring_buf_mpmc_is_empty(&mpmc_rb), NULL);
+}
@@ -740,6 +740,11 @@ void test_ringbuffer_array_perf(void)
 }
 
 
+extern void test_ringbuffer_spsc_claim(void);
+extern void test_ringbuffer_spsc_isr(void);
+extern void test_ringbuffer_mpsc_claim(void);
+extern void test_ringbuffer_mpmc_claim(void);
+
 /*test case main entry*/
 void test_main(void)
 {
@@ -759,7 +764,11 @@ void test_main(void)
 			 ztest_unit_test(test_byte_put_free),
 			 ztest_unit_test(test_byte_put_free),
 			 ztest_unit_test(test_capacity),
-			 ztest_unit_test(test_reset)
+			 ztest_unit_test(test_reset),
+			 ztest_unit_test(test_ringbuffer_spsc_claim),
+			 ztest_unit_test(test_ringbuffer_spsc_isr),
+			 ztest_unit_test(test_ringbuffer_mpsc_claim),
+			 ztest_unit_test(test_ringbuffer_mpmc_claim)
 			 );
 	ztest_run_test_suite(test_ringbuffer_api);
 }
@@ -0,0 +1,379 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_IPV4_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/printk.h>
+#include <linker/sections.h>
+
+#include <ztest.h>
+
+#include <net/dummy.h>
+#include <net/buf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+
+#define NET_LOG_ENABLED 1
+#include "net_private.h"
+
+#include "ipv4.h"
+#include "udp_internal.h"
+#include "net_stats.h"
+
+/* The fragments sent by the interface are looped back to it with
+ * the source and destination addresses swapped, so the same test
+ * exercises both fragmentation and reassembly.
+ */
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+
+#define MY_PORT 4243
+#define PEER_PORT 4242
+
+#define TEST_MTU 576
+#define PAYLOAD_LEN 1400
+#define MAX_FRAGS 4
+
+#define WAIT_TIME K_SECONDS(1)
+#define ALLOC_TIMEOUT K_MSEC(500)
+
+enum recv_mode {
+	RECV_IN_ORDER,
+	RECV_REVERSE,
+	RECV_DUPLICATE,
+	RECV_OVERLAP,
+};
+
+static enum recv_mode recv_mode;
+static struct net_pkt *held[MAX_FRAGS];
+static int held_count;
+static int frag_count;
+
+static struct net_if *iface1;
+static bool test_failed;
+static struct k_sem wait_data;
+
+static int net_iface_dev_init(const struct device *dev)
+{
+	return 0;
+}
+
+static void net_iface_init(struct net_if *iface)
+{
+	static uint8_t mac[] = { 0x00, 0x00, 0x5E, 0x00, 0x53, 0x01 };
+
+	net_if_set_link_addr(iface, mac, sizeof(mac), NET_LINK_ETHERNET);
+}
+
+static uint16_t frag_flags(struct net_pkt *pkt)
+{
+	struct net_ipv4_hdr *hdr = (struct net_ipv4_hdr *)pkt->buffer->data;
+
+	return (hdr->offset[0] << 8) | hdr->offset[1];
+}
+
+static void deliver(struct net_pkt *pkt)
+{
+	if (net_recv_data(iface1, pkt) < 0) {
+		net_pkt_unref(pkt);
+		test_failed = true;
+	}
+}
+
+static void swap_addresses(struct net_pkt *pkt)
+{
+	struct net_ipv4_hdr *hdr = (struct net_ipv4_hdr *)pkt->buffer->data;
+	struct in_addr tmp;
+
+	/* Neither the IPv4 nor the UDP checksum changes when the
+	 * addresses are swapped.
+	 */
+	net_ipaddr_copy(&tmp, &hdr->src);
+	net_ipaddr_copy(&hdr->src, &hdr->dst);
+	net_ipaddr_copy(&hdr->dst, &tmp);
+}
+
+static void make_overlap(struct net_pkt *pkt)
+{
+	struct net_ipv4_hdr *hdr = (struct net_ipv4_hdr *)pkt->buffer->data;
+	uint16_t flags = frag_flags(pkt);
+
+	/* Move the fragment one 8 byte unit backwards */
+	flags -= 1U;
+	hdr->offset[0] = flags >> 8;
+	hdr->offset[1] = flags;
+
+	net_pkt_set_ip_hdr_len(pkt, sizeof(struct net_ipv4_hdr));
+	net_pkt_set_ipv4_opts_len(pkt, 0);
+	hdr->chksum = 0U;
+	hdr->chksum = net_calc_chksum_ipv4(pkt);
+}
+
+static int sender_iface(const struct device *dev, struct net_pkt *pkt)
+{
+	struct net_pkt *rx;
+	bool last;
+	int i;
+
+	if (!pkt->buffer) {
+		NET_DBG("No data to send!");
+		return -ENODATA;
+	}
+
+	if (net_pkt_get_len(pkt) > TEST_MTU) {
+		NET_DBG("Fragment %zd bytes exceeds MTU",
+			net_pkt_get_len(pkt));
+		test_failed = true;
+	}
+
+	frag_count++;
+
+	last = !(frag_flags(pkt) & NET_IPV4_MORE_FRAG_MASK);
+
+	rx = net_pkt_clone(pkt, K_NO_WAIT);
+	net_pkt_unref(pkt);
+
+	if (!rx) {
+		test_failed = true;
+		return 0;
+	}
+
+	swap_addresses(rx);
+
+	switch (recv_mode) {
+	case RECV_IN_ORDER:
+		deliver(rx);
+		break;
+
+	case RECV_DUPLICATE:
+		if (frag_count == 1) {
+			struct net_pkt *dup = net_pkt_clone(rx, K_NO_WAIT);
+
+			if (dup) {
+				deliver(dup);
+			}
+		}
+
+		deliver(rx);
+		break;
+
+	case RECV_OVERLAP:
+		if (frag_count == 2) {
+			make_overlap(rx);
+		}
+
+		deliver(rx);
+		break;
+
+	case RECV_REVERSE:
+		held[held_count++] = rx;
+
+		if (!last && held_count < MAX_FRAGS) {
+			break;
+		}
+
+		for (i = held_count - 1; i >= 0; i--) {
+			deliver(held[i]);
+			held[i] = NULL;
+		}
+
+		held_count = 0;
+		break;
+	}
+
+	return 0;
+}
+
+static struct dummy_api net_iface_api = {
+	.iface_api.init = net_iface_init,
+	.send = sender_iface,
+};
+
+#define _ETH_L2_LAYER DUMMY_L2
+#define _ETH_L2_CTX_TYPE NET_L2_GET_CTX_TYPE(DUMMY_L2)
+
+NET_DEVICE_INIT_INSTANCE(net_iface1_test,
+			 "iface1",
+			 iface1,
+			 net_iface_dev_init,
+			 device_pm_control_nop,
+			 NULL,
+			 NULL,
+			 CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+			 &net_iface_api,
+			 _ETH_L2_LAYER,
+			 _ETH_L2_CTX_TYPE,
+			 TEST_MTU);
+
+static enum net_verdict udp_data_received(struct net_conn *conn,
+					  struct net_pkt *pkt,
+					  union net_ip_header *ip_hdr,
+					  union net_proto_header *proto_hdr,
+					  void *user_data)
+{
+	uint8_t data;
+	int i;
+
+	NET_DBG("Data %p received", pkt);
+
+	net_pkt_cursor_init(pkt);
+
+	if (net_pkt_get_len(pkt) != NET_IPV4UDPH_LEN + PAYLOAD_LEN ||
+	    net_pkt_skip(pkt, NET_IPV4UDPH_LEN)) {
+		test_failed = true;
+		goto out;
+	}
+
+	for (i = 0; i < PAYLOAD_LEN; i++) {
+		if (net_pkt_read_u8(pkt, &data) || data != (uint8_t)i) {
+			NET_DBG("Invalid data at %d", i);
+			test_failed = true;
+			goto out;
+		}
+	}
+
+	k_sem_give(&wait_data);
+out:
+	net_pkt_unref(pkt);
+
+	return NET_OK;
+}
+
+static void test_setup(void)
+{
+	static struct net_conn_handle *handle;
+	struct sockaddr remote_addr = { 0 };
+	struct sockaddr local_addr = { 0 };
+	struct net_if_addr *ifaddr;
+	int ret;
+
+	k_sem_init(&wait_data, 0, UINT_MAX);
+
+	iface1 = net_if_get_by_index(1);
+	zassert_not_null(iface1, "Interface 1");
+
+	ifaddr = net_if_ipv4_addr_add(iface1, &my_addr, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv4 address");
+
+	net_if_up(iface1);
+
+	net_ipaddr_copy(&net_sin(&local_addr)->sin_addr, &my_addr);
+	local_addr.sa_family = AF_INET;
+
+	net_ipaddr_copy(&net_sin(&remote_addr)->sin_addr, &peer_addr);
+	remote_addr.sa_family = AF_INET;
+
+	ret = net_udp_register(AF_INET, &remote_addr, &local_addr,
+			       PEER_PORT, MY_PORT, udp_data_received,
+			       NULL, &handle);
+	zassert_equal(ret, 0, "Cannot register UDP handler");
+}
+
+static void send_large_udp(enum recv_mode mode)
+{
+	struct net_pkt *pkt;
+	int i, ret;
+
+	recv_mode = mode;
+	frag_count = 0;
+	test_failed = false;
+
+	pkt = net_pkt_alloc_with_buffer(iface1, PAYLOAD_LEN, AF_INET,
+					IPPROTO_UDP, ALLOC_TIMEOUT);
+	zassert_not_null(pkt, "packet");
+
+	ret = net_ipv4_create(pkt, &my_addr, &peer_addr);
+	zassert_equal(ret, 0, "Cannot create IPv4 header");
+
+	ret = net_udp_create(pkt, htons(PEER_PORT), htons(MY_PORT));
+	zassert_equal(ret, 0, "Cannot create UDP header");
+
+	for (i = 0; i < PAYLOAD_LEN; i++) {
+		ret = net_pkt_write_u8(pkt, i);
+		zassert_equal(ret, 0, "Cannot append data");
+	}
+
+	net_pkt_cursor_init(pkt);
+	net_ipv4_finalize(pkt, IPPROTO_UDP);
+
+	ret = net_send_data(pkt);
+	zassert_equal(ret, 0, "Cannot send");
+}
+
+static void test_ipv4_fragment_in_order(void)
+{
+	net_stats_t reassembled = GET_STAT(iface1, ipv4_frag.reassembled);
+
+	send_large_udp(RECV_IN_ORDER);
+
+	zassert_equal(k_sem_take(&wait_data, WAIT_TIME), 0, "Timeout");
+	zassert_false(test_failed, "Fragment check failed");
+
+	/* 1428 bytes over a 576 byte MTU: 552 + 552 + 304 byte payloads */
+	zassert_equal(frag_count, 3, "Invalid fragment count %d", frag_count);
+	zassert_equal(GET_STAT(iface1, ipv4_frag.reassembled),
+		      reassembled + 1, "Reassembly not counted");
+}
+
+static void test_ipv4_fragment_reverse(void)
+{
+	send_large_udp(RECV_REVERSE);
+
+	zassert_equal(k_sem_take(&wait_data, WAIT_TIME), 0, "Timeout");
+	zassert_false(test_failed, "Fragment check failed");
+}
+
+static void test_ipv4_fragment_duplicate(void)
+{
+	send_large_udp(RECV_DUPLICATE);
+
+	zassert_equal(k_sem_take(&wait_data, WAIT_TIME), 0, "Timeout");
+	zassert_false(test_failed, "Fragment check failed");
+
+	/* The duplicate must not be delivered as a second packet */
+	zassert_not_equal(k_sem_take(&wait_data, K_MSEC(100)), 0,
+			  "Packet received twice");
+}
+
+static void test_ipv4_fragment_overlap(void)
+{
+	net_stats_t reassembled = GET_STAT(iface1, ipv4_frag.reassembled);
+	net_stats_t timeout = GET_STAT(iface1, ipv4_frag.timeout);
+
+	send_large_udp(RECV_OVERLAP);
+
+	zassert_not_equal(k_sem_take(&wait_data, WAIT_TIME), 0,
+			  "Overlapping fragments accepted");
+	zassert_equal(GET_STAT(iface1, ipv4_frag.reassembled), reassembled,
+		      "Overlapping fragments reassembled");
+
+	/* The last fragment starts a new reassembly that must expire */
+	k_sleep(K_MSEC(CONFIG_NET_IPV4_FRAGMENT_TIMEOUT * MSEC_PER_SEC +
+		       100));
+	zassert_equal(GET_STAT(iface1, ipv4_frag.timeout), timeout + 1,
+		      "Reassembly did not time out");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_ipv4_fragment_test,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_ipv4_fragment_in_order),
+			 ztest_unit_test(test_ipv4_fragment_reverse),
+			 ztest_unit_test(test_ipv4_fragment_duplicate),
+			 ztest_unit_test(test_ipv4_fragment_overlap)
+			 );
+
+	ztest_run_test_suite(net_ipv4_fragment_test);
+}
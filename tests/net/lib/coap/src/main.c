@@ -588,6 +588,207 @@ out:
 
 }
 
+static int test_option_index(void)
+{
+	struct coap_packet cpkt;
+	struct coap_packet parsed;
+	struct coap_option options[16] = {};
+	uint8_t *data;
+	int result = TC_FAIL;
+	int i, r;
+
+	data = (uint8_t *)k_malloc(COAP_BUF_SIZE);
+	if (!data) {
+		goto done;
+	}
+
+	r = coap_packet_init(&cpkt, data, COAP_BUF_SIZE,
+			     1, COAP_TYPE_CON, 0, NULL,
+			     COAP_METHOD_GET, 0x1234);
+	if (r < 0) {
+		TC_PRINT("Could not initialize packet\n");
+		goto done;
+	}
+
+	r = coap_packet_append_option(&cpkt, COAP_OPTION_URI_PATH, "a", 1);
+	r |= coap_packet_append_option(&cpkt, COAP_OPTION_URI_PATH, "bc", 2);
+	r |= coap_append_option_int(&cpkt, COAP_OPTION_CONTENT_FORMAT, 60);
+	/* not a registered option number */
+	r |= coap_packet_append_option(&cpkt, 13, "x", 1);
+	if (r < 0) {
+		TC_PRINT("Could not append options\n");
+		goto done;
+	}
+
+	r = coap_packet_parse(&parsed, data, cpkt.offset, NULL, 0);
+	if (r) {
+		TC_PRINT("Could not parse packet\n");
+		goto done;
+	}
+
+	r = coap_find_options(&parsed, COAP_OPTION_URI_PATH, options,
+			      ARRAY_SIZE(options));
+	if (r != 2 || options[1].len != 2U ||
+	    memcmp(options[1].value, "bc", 2)) {
+		TC_PRINT("Uri-Path options don't match the reference\n");
+		goto done;
+	}
+
+	r = coap_find_options(&parsed, COAP_OPTION_URI_PATH, options, 1);
+	if (r != 1 || options[0].len != 1U || options[0].value[0] != 'a') {
+		TC_PRINT("Option vector length not honoured\n");
+		goto done;
+	}
+
+	r = coap_find_options(&parsed, COAP_OPTION_OBSERVE, options,
+			      ARRAY_SIZE(options));
+	if (r != 0) {
+		TC_PRINT("Found an option not in the packet\n");
+		goto done;
+	}
+
+	r = coap_find_options(&parsed, 13, options, ARRAY_SIZE(options));
+	if (r != 1 || options[0].len != 1U || options[0].value[0] != 'x') {
+		TC_PRINT("Unregistered option doesn't match the reference\n");
+		goto done;
+	}
+
+	/* More options than the index holds: parsing falls back */
+	for (i = 0; i < 12; i++) {
+		r = coap_packet_append_option(&cpkt, COAP_OPTION_URI_QUERY,
+					      "q", 1);
+		if (r < 0) {
+			TC_PRINT("Could not append option\n");
+			goto done;
+		}
+	}
+
+	r = coap_packet_parse(&parsed, data, cpkt.offset, NULL, 0);
+	if (r) {
+		TC_PRINT("Could not parse packet\n");
+		goto done;
+	}
+
+	r = coap_find_options(&parsed, COAP_OPTION_URI_QUERY, options,
+			      ARRAY_SIZE(options));
+	if (r != 12) {
+		TC_PRINT("Options beyond the index not found\n");
+		goto done;
+	}
+
+	r = coap_find_options(&parsed, COAP_OPTION_CONTENT_FORMAT, options,
+			      ARRAY_SIZE(options));
+	if (r != 1 || coap_option_value_to_int(&options[0]) != 60) {
+		TC_PRINT("Content-Format doesn't match the reference\n");
+		goto done;
+	}
+
+	result = TC_PASS;
+
+done:
+	k_free(data);
+
+	TC_END_RESULT(result);
+
+	return result;
+}
+
+static int set_uri_path(struct coap_option *options, const char *uri)
+{
+	int count = 0;
+	const char *end;
+
+	while (*uri) {
+		end = strchr(uri, '/');
+		if (!end) {
+			end = uri + strlen(uri);
+		}
+
+		options[count].delta = COAP_OPTION_URI_PATH;
+		options[count].len = end - uri;
+		memcpy(options[count].value, uri, end - uri);
+		count++;
+
+		uri = *end ? end + 1 : end;
+	}
+
+	return count;
+}
+
+static const char * const table_path_ab[] = { "a", "b", NULL };
+static const char * const table_path_ac[] = { "a", "c", NULL };
+static const char * const table_path_a[] = { "a", NULL };
+static const char * const table_path_aplus[] = { "a", "+", NULL };
+static const char * const table_path_xhash[] = { "x", "#", NULL };
+static const char * const table_path_long[] = { "1", "2", "3", "4", NULL };
+
+static struct coap_resource table_resources[] = {
+	{ .path = table_path_ab },
+	{ .path = table_path_ac },
+	{ .path = table_path_a },
+	{ .path = table_path_aplus },
+	{ .path = table_path_xhash },
+	{ .path = table_path_long },
+	{ },
+};
+
+static int test_resource_table(void)
+{
+	static const struct {
+		const char *uri;
+		int index; /* into table_resources, -1 if not found */
+	} lookups[] = {
+		{ "a", 2 },
+		{ "a/b", 0 },
+		{ "a/c", 1 },
+		{ "a/d", IS_ENABLED(CONFIG_COAP_URI_WILDCARD) ? 3 : -1 },
+		{ "a/b/c", -1 },
+		{ "x", -1 },
+		{ "x/y/z", IS_ENABLED(CONFIG_COAP_URI_WILDCARD) ? 4 : -1 },
+		{ "1/2/3/4", 5 },
+		{ "1/2/3", -1 },
+		{ "b", -1 },
+		{ "", -1 },
+	};
+	struct coap_resource_node nodes[16];
+	struct coap_resource_table table;
+	struct coap_option options[8];
+	struct coap_resource *resource;
+	int result = TC_FAIL;
+	int i, r, count;
+
+	r = coap_resource_table_init(&table, table_resources, nodes, 4);
+	if (r != -ENOMEM) {
+		TC_PRINT("Table init with too few nodes didn't fail\n");
+		goto done;
+	}
+
+	r = coap_resource_table_init(&table, table_resources, nodes,
+				     ARRAY_SIZE(nodes));
+	if (r) {
+		TC_PRINT("Could not initialize resource table\n");
+		goto done;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(lookups); i++) {
+		count = set_uri_path(options, lookups[i].uri);
+		resource = coap_resource_table_find(&table, options, count);
+
+		if (resource != (lookups[i].index < 0 ? NULL :
+				 &table_resources[lookups[i].index])) {
+			TC_PRINT("Lookup of \"%s\" failed\n", lookups[i].uri);
+			goto done;
+		}
+	}
+
+	result = TC_PASS;
+
+done:
+	TC_END_RESULT(result);
+
+	return result;
+}
+
 #define BLOCK_WISE_TRANSFER_SIZE_GET 128
 
 static int prepare_block1_request(struct coap_packet *req,
@@ -1471,6 +1672,8 @@ static const struct {
 	{ "Parse malformed empty payload with marker",
 		test_parse_malformed_marker, },
 	{ "Test match path uri", test_match_path_uri, },
+	{ "Test option index", test_option_index, },
+	{ "Test resource table", test_resource_table, },
 	{ "Test block sized 1 transfer", test_block1_size, },
 	{ "Test block sized 2 transfer", test_block2_size, },
 	{ "Test retransmission", test_retransmit_second_round, },
@@ -0,0 +1,373 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/printk.h>
+
+#include <net/socket.h>
+#include <net/http_client.h>
+
+#define SERVER_ADDR	CONFIG_NET_CONFIG_MY_IPV4_ADDR
+#define SERVER_COUNT	2
+#define STACK_SIZE	2048
+#define THREAD_PRIO	K_PRIO_PREEMPT(8)
+
+/* Time for a closed connection to be noticed by the other end */
+#define CLOSE_WAIT	K_MSEC(100)
+#define TIMEOUT		1000
+
+#define RESPONSE_BODY	"OK"
+
+/* HTTP server answering each request with a short body. It serves one
+ * connection at a time.
+ */
+struct test_server {
+	const char *port;
+	int sock;
+
+	/** Connections accepted */
+	atomic_t accepted;
+
+	/** Responses sent */
+	atomic_t responses;
+
+	/** Close the connection after a response */
+	bool close;
+
+	/** Announce the close with "Connection: close" */
+	bool announce_close;
+
+	/** Wait for the semaphore before a response */
+	bool hold;
+	struct k_sem hold_sem;
+
+	struct k_thread thread;
+};
+
+static struct test_server servers[SERVER_COUNT] = {
+	{ .port = "8080" },
+	{ .port = "8081" },
+};
+
+K_THREAD_STACK_ARRAY_DEFINE(server_stacks, SERVER_COUNT, STACK_SIZE);
+K_THREAD_STACK_DEFINE(client_stack, STACK_SIZE);
+static struct k_thread client_thread;
+
+static uint8_t recv_buf[512];
+static atomic_t completed;
+
+static int server_respond(struct test_server *srv, int sock)
+{
+	char rsp[128];
+	int len;
+
+	if (srv->hold) {
+		k_sem_take(&srv->hold_sem, K_FOREVER);
+	}
+
+	len = snprintk(rsp, sizeof(rsp),
+		       "HTTP/1.1 200 OK\r\n"
+		       "Content-Length: %u\r\n"
+		       "%s\r\n" RESPONSE_BODY,
+		       (unsigned int)strlen(RESPONSE_BODY),
+		       srv->announce_close ? "Connection: close\r\n" : "");
+
+	if (send(sock, rsp, len, 0) != len) {
+		return -EIO;
+	}
+
+	atomic_inc(&srv->responses);
+
+	return srv->close ? -ECONNRESET : 0;
+}
+
+/* Answer the requests received on the connection until it is closed */
+static void server_serve(struct test_server *srv, int sock)
+{
+	char buf[512];
+	size_t len = 0;
+	char *end;
+	int ret;
+
+	while (true) {
+		ret = recv(sock, buf + len, sizeof(buf) - len - 1, 0);
+		if (ret <= 0) {
+			return;
+		}
+
+		len += ret;
+		buf[len] = '\0';
+
+		/* Requests have no body, so each one ends with an empty
+		 * line. Pipelined requests may arrive together.
+		 */
+		while ((end = strstr(buf, "\r\n\r\n")) != NULL) {
+			end += 4;
+			len -= end - buf;
+			memmove(buf, end, len + 1);
+
+			if (server_respond(srv, sock) < 0) {
+				return;
+			}
+		}
+
+		if (len == sizeof(buf) - 1) {
+			return;
+		}
+	}
+}
+
+static void server_thread(void *p1, void *p2, void *p3)
+{
+	struct test_server *srv = p1;
+	int sock;
+
+	while (true) {
+		sock = accept(srv->sock, NULL, NULL);
+		if (sock < 0) {
+			k_sleep(K_MSEC(10));
+			continue;
+		}
+
+		atomic_inc(&srv->accepted);
+
+		server_serve(srv, sock);
+
+		(void)close(sock);
+	}
+}
+
+static void server_start(struct test_server *srv, k_thread_stack_t *stack)
+{
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(atoi(srv->port)),
+	};
+
+	zassert_equal(inet_pton(AF_INET, SERVER_ADDR, &addr.sin_addr), 1,
+		      "inet_pton failed");
+
+	srv->sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	zassert_true(srv->sock >= 0, "socket open failed");
+
+	zassert_equal(bind(srv->sock, (struct sockaddr *)&addr, sizeof(addr)),
+		      0, "bind failed");
+	zassert_equal(listen(srv->sock, 2), 0, "listen failed");
+
+	k_sem_init(&srv->hold_sem, 0, UINT_MAX);
+
+	k_thread_create(&srv->thread, stack, STACK_SIZE, server_thread,
+			srv, NULL, NULL, THREAD_PRIO, 0, K_NO_WAIT);
+}
+
+static void response_cb(struct http_response *rsp,
+			enum http_final_call final_data, void *user_data)
+{
+	if (final_data == HTTP_DATA_FINAL &&
+	    strcmp(rsp->http_status, "OK") == 0) {
+		atomic_inc(&completed);
+	}
+}
+
+static void req_init(struct http_request *req, struct test_server *srv)
+{
+	(void)memset(req, 0, sizeof(*req));
+
+	req->method = HTTP_GET;
+	req->url = "/";
+	req->host = SERVER_ADDR;
+	req->port = srv->port;
+	req->protocol = "HTTP/1.1";
+	req->response = response_cb;
+	req->recv_buf = recv_buf;
+	req->recv_buf_len = sizeof(recv_buf);
+}
+
+/* Send count pipelined requests to the server */
+static int request(struct test_server *srv, size_t count, int32_t timeout)
+{
+	static struct http_request reqs[3];
+	struct http_request *req_list[ARRAY_SIZE(reqs)];
+	size_t i;
+
+	zassert_true(count <= ARRAY_SIZE(reqs), "too many requests");
+
+	for (i = 0; i < count; i++) {
+		req_init(&reqs[i], srv);
+		req_list[i] = &reqs[i];
+	}
+
+	return http_client_pool_req(req_list, count, NULL, 0, timeout, NULL);
+}
+
+static void test_setup(void)
+{
+	int i;
+
+	http_client_pool_close();
+	k_sleep(CLOSE_WAIT);
+
+	for (i = 0; i < ARRAY_SIZE(servers); i++) {
+		servers[i].close = false;
+		servers[i].announce_close = false;
+		servers[i].hold = false;
+		k_sem_reset(&servers[i].hold_sem);
+		atomic_clear(&servers[i].accepted);
+		atomic_clear(&servers[i].responses);
+	}
+
+	atomic_clear(&completed);
+}
+
+static void test_start(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(servers); i++) {
+		server_start(&servers[i], server_stacks[i]);
+	}
+}
+
+static void test_reuse(void)
+{
+	struct test_server *srv = &servers[0];
+
+	zassert_equal(request(srv, 1, TIMEOUT), 1, "request failed");
+	zassert_equal(request(srv, 1, TIMEOUT), 1, "request failed");
+
+	/* Pipelined requests share the connection too */
+	zassert_equal(request(srv, 3, TIMEOUT), 3, "requests failed");
+
+	zassert_equal(atomic_get(&completed), 5, "responses missing");
+	zassert_equal(atomic_get(&srv->accepted), 1, "connection not reused");
+}
+
+static void test_evict(void)
+{
+	/* The pool is full, so the idle connection to the first server is
+	 * closed for the second one.
+	 */
+	zassert_equal(request(&servers[0], 1, TIMEOUT), 1, "request failed");
+	zassert_equal(request(&servers[1], 1, TIMEOUT), 1, "request failed");
+	zassert_equal(request(&servers[0], 1, TIMEOUT), 1, "request failed");
+
+	zassert_equal(atomic_get(&servers[0].accepted), 2,
+		      "idle connection not evicted");
+	zassert_equal(atomic_get(&servers[1].accepted), 1,
+		      "wrong connection count");
+}
+
+static struct http_request client_req;
+static int client_ret;
+
+/* Request from another thread, which keeps the connection busy */
+static void client_entry(void *p1, void *p2, void *p3)
+{
+	struct http_request *req = &client_req;
+
+	req_init(req, p1);
+
+	client_ret = http_client_pool_req(&req, 1, NULL, 0, TIMEOUT, NULL);
+}
+
+static void test_exhaustion(void)
+{
+	struct test_server *srv = &servers[0];
+
+	/* The only connection is busy with a request */
+	srv->hold = true;
+
+	k_thread_create(&client_thread, client_stack, STACK_SIZE,
+			client_entry, srv, NULL, NULL, THREAD_PRIO, 0,
+			K_NO_WAIT);
+	k_sleep(CLOSE_WAIT);
+
+	zassert_equal(request(&servers[1], 1, TIMEOUT), -EAGAIN,
+		      "request without a free connection");
+
+	k_sem_give(&srv->hold_sem);
+	k_thread_join(&client_thread, K_FOREVER);
+
+	zassert_equal(client_ret, 1, "held request failed");
+
+	/* The connection is free again */
+	srv->hold = false;
+	zassert_equal(request(&servers[1], 1, TIMEOUT), 1, "request failed");
+}
+
+static void test_peer_close(void)
+{
+	struct test_server *srv = &servers[0];
+
+	/* The server announces the close, the connection is not kept */
+	srv->close = true;
+	srv->announce_close = true;
+
+	zassert_equal(request(srv, 1, TIMEOUT), 1, "request failed");
+	zassert_equal(request(srv, 1, TIMEOUT), 1, "request failed");
+	zassert_equal(atomic_get(&srv->accepted), 2, "closed connection kept");
+
+	/* Requests after the close are not answered */
+	zassert_equal(request(srv, 2, TIMEOUT), 1,
+		      "request after the close answered");
+
+	/* The server closes the idle connection without a notice, which is
+	 * found before the connection is reused.
+	 */
+	srv->announce_close = false;
+
+	zassert_equal(request(srv, 1, TIMEOUT), 1, "request failed");
+	k_sleep(CLOSE_WAIT);
+
+	srv->close = false;
+
+	zassert_equal(request(srv, 1, TIMEOUT), 1,
+		      "request on a closed connection");
+	zassert_equal(atomic_get(&srv->accepted), 5, "wrong connection count");
+}
+
+static void test_timeout(void)
+{
+	struct test_server *srv = &servers[0];
+
+	srv->hold = true;
+
+	zassert_equal(request(srv, 1, 200), -ETIMEDOUT, "request not timed out");
+
+	srv->hold = false;
+	k_sem_give(&srv->hold_sem);
+	k_sleep(CLOSE_WAIT);
+
+	/* The timed out connection is not reused */
+	zassert_equal(request(srv, 1, TIMEOUT), 1, "request failed");
+	zassert_equal(atomic_get(&srv->accepted), 2,
+		      "timed out connection reused");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(http_client_pool,
+			 ztest_unit_test(test_start),
+			 ztest_unit_test_setup_teardown(test_reuse,
+							test_setup,
+							unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_evict,
+							test_setup,
+							unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_exhaustion,
+							test_setup,
+							unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_peer_close,
+							test_setup,
+							unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_timeout,
+							test_setup,
+							unit_test_noop));
+
+	ztest_run_test_suite(http_client_pool);
+}
@@ -0,0 +1,20 @@
+/*
+ * Copyright (c) 2020 Foundries.io
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __ENGINE_TEST_H__
+#define __ENGINE_TEST_H__
+
+#define TEST_OBJ_ID		32770
+#define TEST_MAX_INST		3
+
+/* single instance S32 resources, then one S32 resource with two instances */
+#define TEST_RES_VALUE_COUNT	3
+#define TEST_RES_MULTI		3
+#define TEST_RES_MULTI_COUNT	2
+
+void test_notify_order(void);
+
+#endif /* __ENGINE_TEST_H__ */
@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2020 Foundries.io
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <net/lwm2m.h>
+
+#include "lwm2m_object.h"
+#include "lwm2m_engine.h"
+
+#include "engine_test.h"
+
+#define TEST_RES_COUNT		(TEST_RES_VALUE_COUNT + 1)
+#define TEST_RES_INST_COUNT	(TEST_RES_VALUE_COUNT + TEST_RES_MULTI_COUNT)
+
+/* shares a lookup hash bucket with instance 0 */
+#define TEST_INST_COLLIDE	BIT(CONFIG_LWM2M_ENGINE_LOOKUP_HASH_BITS)
+
+static struct lwm2m_engine_obj test_obj;
+static struct lwm2m_engine_obj_field test_fields[] = {
+	OBJ_FIELD_DATA(0, RW, S32),
+	OBJ_FIELD_DATA(1, RW, S32),
+	OBJ_FIELD_DATA(2, RW, S32),
+	OBJ_FIELD_DATA(TEST_RES_MULTI, RW, S32),
+};
+
+static struct lwm2m_engine_obj_inst test_inst[TEST_MAX_INST];
+static struct lwm2m_engine_res test_res[TEST_MAX_INST][TEST_RES_COUNT];
+static struct lwm2m_engine_res_inst
+	test_res_inst[TEST_MAX_INST][TEST_RES_INST_COUNT];
+static int32_t test_value[TEST_MAX_INST][TEST_RES_VALUE_COUNT];
+static int32_t test_multi[TEST_MAX_INST][TEST_RES_MULTI_COUNT];
+
+static int test_inst_index(uint16_t obj_inst_id)
+{
+	int i;
+
+	for (i = 0; i < TEST_MAX_INST; i++) {
+		if (test_inst[i].obj &&
+		    test_inst[i].obj_inst_id == obj_inst_id) {
+			return i;
+		}
+	}
+
+	return -ENOENT;
+}
+
+static struct lwm2m_engine_obj_inst *test_obj_create(uint16_t obj_inst_id)
+{
+	int index, i = 0, j = 0, k;
+
+	if (test_inst_index(obj_inst_id) >= 0) {
+		return NULL;
+	}
+
+	for (index = 0; index < TEST_MAX_INST; index++) {
+		if (!test_inst[index].obj) {
+			break;
+		}
+	}
+
+	if (index >= TEST_MAX_INST) {
+		return NULL;
+	}
+
+	(void)memset(test_value[index], 0, sizeof(test_value[index]));
+	(void)memset(test_multi[index], 0, sizeof(test_multi[index]));
+	(void)memset(test_res[index], 0, sizeof(test_res[index]));
+	init_res_instance(test_res_inst[index],
+			  ARRAY_SIZE(test_res_inst[index]));
+
+	for (k = 0; k < TEST_RES_VALUE_COUNT; k++) {
+		INIT_OBJ_RES_DATA(k, test_res[index], i,
+				  test_res_inst[index], j,
+				  &test_value[index][k],
+				  sizeof(test_value[index][k]));
+	}
+
+	INIT_OBJ_RES_MULTI_OPTDATA(TEST_RES_MULTI, test_res[index], i,
+				   test_res_inst[index], j,
+				   TEST_RES_MULTI_COUNT, true);
+
+	test_inst[index].resources = test_res[index];
+	test_inst[index].resource_count = i;
+
+	return &test_inst[index];
+}
+
+static char *test_path(uint16_t obj_inst_id, uint16_t res_id)
+{
+	static char path[MAX_RESOURCE_LEN];
+
+	snprintk(path, sizeof(path), "%u/%u/%u", TEST_OBJ_ID, obj_inst_id,
+		 res_id);
+
+	return path;
+}
+
+static void test_create(uint16_t obj_inst_id)
+{
+	char path[MAX_RESOURCE_LEN];
+
+	snprintk(path, sizeof(path), "%u/%u", TEST_OBJ_ID, obj_inst_id);
+	zassert_equal(lwm2m_engine_create_obj_inst(path), 0,
+		      "create %s failed", path);
+}
+
+static void test_teardown(void)
+{
+	int i;
+
+	for (i = 0; i < TEST_MAX_INST; i++) {
+		if (test_inst[i].obj) {
+			(void)lwm2m_delete_obj_inst(TEST_OBJ_ID,
+						    test_inst[i].obj_inst_id);
+		}
+	}
+}
+
+static void test_lookup_create_delete(void)
+{
+	static const uint16_t ids[] = { 0, 1, TEST_INST_COLLIDE };
+	int32_t value;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(ids); i++) {
+		test_create(ids[i]);
+		zassert_equal(lwm2m_engine_set_s32(test_path(ids[i], 0),
+						   100 + ids[i]), 0,
+			      "set %u failed", ids[i]);
+	}
+
+	for (i = 0; i < ARRAY_SIZE(ids); i++) {
+		zassert_equal(lwm2m_engine_get_s32(test_path(ids[i], 0),
+						   &value), 0,
+			      "get %u failed", ids[i]);
+		zassert_equal(value, 100 + ids[i], "wrong instance found");
+	}
+
+	/* delete the instance at the head of a shared bucket */
+	zassert_equal(lwm2m_delete_obj_inst(TEST_OBJ_ID, 0), 0,
+		      "delete failed");
+	zassert_equal(lwm2m_engine_get_s32(test_path(0, 0), &value),
+		      -ENOENT, "deleted instance still found");
+	zassert_equal(lwm2m_delete_obj_inst(TEST_OBJ_ID, 0), -ENOENT,
+		      "deleted instance deleted twice");
+
+	zassert_equal(lwm2m_engine_get_s32(test_path(TEST_INST_COLLIDE, 0),
+					   &value), 0,
+		      "colliding instance lost");
+	zassert_equal(value, 100 + TEST_INST_COLLIDE, "wrong instance found");
+	zassert_equal(lwm2m_engine_get_s32(test_path(1, 0), &value), 0,
+		      "instance 1 lost");
+	zassert_equal(value, 101, "wrong instance found");
+
+	/* a new instance with the same ID is found, with its own data */
+	test_create(0);
+	zassert_equal(lwm2m_engine_get_s32(test_path(0, 0), &value), 0,
+		      "re-created instance not found");
+	zassert_equal(value, 0, "old instance data found");
+
+	/* unknown IDs in a populated bucket */
+	zassert_equal(lwm2m_engine_get_s32(test_path(2 * TEST_INST_COLLIDE, 0),
+					   &value), -ENOENT,
+		      "unknown instance found");
+}
+
+static void test_handle_stale(void)
+{
+	struct lwm2m_engine_res_handle handle, other;
+	int32_t value;
+
+	test_create(0);
+	test_create(1);
+
+	zassert_equal(lwm2m_engine_resolve_path(test_path(0, 0), &handle), 0,
+		      "resolve failed");
+	zassert_equal(lwm2m_engine_resolve_path(test_path(1, 0), &other), 0,
+		      "resolve failed");
+
+	zassert_equal(lwm2m_engine_handle_set_s32(&handle, 5), 0,
+		      "handle set failed");
+	zassert_equal(lwm2m_engine_get_s32(test_path(0, 0), &value), 0,
+		      "get failed");
+	zassert_equal(value, 5, "handle set wrong resource");
+
+	/* the handle must not write into the deleted instance */
+	zassert_equal(lwm2m_delete_obj_inst(TEST_OBJ_ID, 0), 0,
+		      "delete failed");
+	zassert_equal(lwm2m_engine_handle_set_s32(&handle, 6), -ENOENT,
+		      "stale handle used");
+
+	/* handles to other instances are still usable */
+	zassert_equal(lwm2m_engine_handle_set_s32(&other, 7), 0,
+		      "handle set failed");
+	zassert_equal(lwm2m_engine_get_s32(test_path(1, 0), &value), 0,
+		      "get failed");
+	zassert_equal(value, 7, "handle set wrong resource");
+
+	/* the handle resolves again once the path exists again */
+	test_create(0);
+	zassert_equal(lwm2m_engine_handle_set_s32(&handle, 8), 0,
+		      "handle set failed");
+	zassert_equal(lwm2m_engine_get_s32(test_path(0, 0), &value), 0,
+		      "get failed");
+	zassert_equal(value, 8, "handle set wrong resource");
+}
+
+static void test_handle_stale_res_inst(void)
+{
+	struct lwm2m_engine_res_handle handle;
+	char path[MAX_RESOURCE_LEN];
+	int32_t value;
+	int index;
+
+	test_create(0);
+	index = test_inst_index(0);
+
+	snprintk(path, sizeof(path), "%u/0/%u/1", TEST_OBJ_ID, TEST_RES_MULTI);
+	zassert_equal(lwm2m_engine_set_res_data(path, &test_multi[index][1],
+						sizeof(test_multi[index][1]),
+						0), 0,
+		      "set res data failed");
+	zassert_equal(lwm2m_engine_resolve_path(path, &handle), 0,
+		      "resolve failed");
+	zassert_equal(lwm2m_engine_handle_set_s32(&handle, 9), 0,
+		      "handle set failed");
+	zassert_equal(test_multi[index][1], 9, "handle set wrong instance");
+
+	zassert_equal(lwm2m_engine_delete_res_inst(path), 0,
+		      "delete res inst failed");
+	zassert_equal(lwm2m_engine_handle_set_s32(&handle, 10), -ENOENT,
+		      "stale handle used");
+	zassert_equal(test_multi[index][1], 9, "deleted instance written");
+
+	zassert_equal(lwm2m_engine_create_res_inst(path), 0,
+		      "create res inst failed");
+	zassert_equal(lwm2m_engine_set_res_data(path, &test_multi[index][1],
+						sizeof(test_multi[index][1]),
+						0), 0,
+		      "set res data failed");
+	zassert_equal(lwm2m_engine_handle_set_s32(&handle, 11), 0,
+		      "handle set failed");
+	zassert_equal(lwm2m_engine_get_s32(path, &value), 0, "get failed");
+	zassert_equal(value, 11, "handle set wrong instance");
+}
+
+void test_main(void)
+{
+	test_obj.obj_id = TEST_OBJ_ID;
+	test_obj.fields = test_fields;
+	test_obj.field_count = ARRAY_SIZE(test_fields);
+	test_obj.max_instance_count = TEST_MAX_INST;
+	test_obj.create_cb = test_obj_create;
+	lwm2m_register_obj(&test_obj);
+
+	ztest_test_suite(lwm2m_engine,
+		ztest_unit_test_setup_teardown(test_lookup_create_delete,
+					       unit_test_noop, test_teardown),
+		ztest_unit_test_setup_teardown(test_handle_stale,
+					       unit_test_noop, test_teardown),
+		ztest_unit_test_setup_teardown(test_handle_stale_res_inst,
+					       unit_test_noop, test_teardown),
+		ztest_unit_test_setup_teardown(test_notify_order,
+					       unit_test_noop, test_teardown));
+
+	ztest_run_test_suite(lwm2m_engine);
+}
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2020 Foundries.io
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <net/socket.h>
+#include <net/coap.h>
+#include <net/lwm2m.h>
+
+#include "lwm2m_object.h"
+#include "lwm2m_engine.h"
+
+#include "engine_test.h"
+
+#define SERVER_PORT		5683
+#define TIMEOUT_MS		2000
+
+/* notifications are expected within a second of their deadline */
+#define NOTIFY_TIMEOUT_MS	5000
+
+static struct lwm2m_ctx test_ctx;
+static struct sockaddr_in6 client_addr;
+static int server_sock = -1;
+static uint16_t server_mid;
+
+static uint8_t tx_buf[128];
+static uint8_t rx_buf[NET_IPV6_MTU];
+
+static int server_start(void)
+{
+	struct sockaddr_in6 *addr = net_sin6(&test_ctx.remote_addr);
+	socklen_t addr_len = sizeof(client_addr);
+	int ret;
+
+	(void)memset(&test_ctx, 0, sizeof(test_ctx));
+	addr->sin6_family = AF_INET6;
+	addr->sin6_port = htons(SERVER_PORT);
+	ret = inet_pton(AF_INET6, CONFIG_NET_CONFIG_MY_IPV6_ADDR,
+			&addr->sin6_addr);
+	if (ret != 1) {
+		return -EINVAL;
+	}
+
+	server_sock = socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+	if (server_sock < 0) {
+		return -errno;
+	}
+
+	if (bind(server_sock, &test_ctx.remote_addr, sizeof(*addr)) < 0) {
+		return -errno;
+	}
+
+	/* the client socket is connected to the server address */
+	test_ctx.sec_obj_inst = -1;
+	test_ctx.srv_obj_inst = -1;
+	lwm2m_engine_context_init(&test_ctx);
+	ret = lwm2m_socket_start(&test_ctx);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* reply to the client port on the same local address */
+	if (getsockname(test_ctx.sock_fd, (struct sockaddr *)&client_addr,
+			&addr_len) < 0) {
+		return -errno;
+	}
+
+	client_addr.sin6_addr = addr->sin6_addr;
+
+	return 0;
+}
+
+static void server_stop(void)
+{
+	(void)lwm2m_engine_context_close(&test_ctx);
+
+	if (server_sock >= 0) {
+		(void)close(server_sock);
+		server_sock = -1;
+	}
+}
+
+static int server_send(struct coap_packet *cpkt)
+{
+	if (sendto(server_sock, cpkt->data, cpkt->offset, 0,
+		   (struct sockaddr *)&client_addr,
+		   sizeof(client_addr)) != cpkt->offset) {
+		return -errno;
+	}
+
+	return 0;
+}
+
+static int server_recv(struct coap_packet *cpkt, int timeout_ms)
+{
+	struct pollfd fds = {
+		.fd = server_sock,
+		.events = POLLIN,
+	};
+	ssize_t len;
+
+	if (poll(&fds, 1, timeout_ms) <= 0) {
+		return -ETIMEDOUT;
+	}
+
+	len = recv(server_sock, rx_buf, sizeof(rx_buf), 0);
+	if (len < 0) {
+		return -errno;
+	}
+
+	return coap_packet_parse(cpkt, rx_buf, len, NULL, 0);
+}
+
+/* Send a confirmable request for a test object resource and return the
+ * response code.
+ */
+static int server_request(uint8_t method, uint16_t res_id, const char *query,
+			  uint8_t token)
+{
+	struct coap_packet cpkt;
+	char res[6];
+	int ret;
+
+	ret = coap_packet_init(&cpkt, tx_buf, sizeof(tx_buf), 1,
+			       COAP_TYPE_CON, sizeof(token), &token, method,
+			       ++server_mid);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* a GET with a token registers an observer */
+	if (method == COAP_METHOD_GET) {
+		ret = coap_append_option_int(&cpkt, COAP_OPTION_OBSERVE, 0);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	snprintk(res, sizeof(res), "%u", TEST_OBJ_ID);
+	ret = coap_packet_append_option(&cpkt, COAP_OPTION_URI_PATH, res,
+					strlen(res));
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = coap_packet_append_option(&cpkt, COAP_OPTION_URI_PATH, "0", 1);
+	if (ret < 0) {
+		return ret;
+	}
+
+	snprintk(res, sizeof(res), "%u", res_id);
+	ret = coap_packet_append_option(&cpkt, COAP_OPTION_URI_PATH, res,
+					strlen(res));
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (query) {
+		ret = coap_packet_append_option(&cpkt, COAP_OPTION_URI_QUERY,
+						query, strlen(query));
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	if (method == COAP_METHOD_GET) {
+		ret = coap_append_option_int(&cpkt, COAP_OPTION_ACCEPT,
+					     LWM2M_FORMAT_PLAIN_TEXT);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	ret = server_send(&cpkt);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* the response is piggybacked on the ACK */
+	do {
+		ret = server_recv(&cpkt, TIMEOUT_MS);
+		if (ret < 0) {
+			return ret;
+		}
+	} while (coap_header_get_type(&cpkt) != COAP_TYPE_ACK ||
+		 coap_header_get_id(&cpkt) != server_mid);
+
+	return coap_header_get_code(&cpkt);
+}
+
+static int server_ack(struct coap_packet *request)
+{
+	struct coap_packet cpkt;
+	int ret;
+
+	ret = coap_packet_init(&cpkt, tx_buf, sizeof(tx_buf), 1,
+			       COAP_TYPE_ACK, 0, NULL, COAP_CODE_EMPTY,
+			       coap_header_get_id(request));
+	if (ret < 0) {
+		return ret;
+	}
+
+	return server_send(&cpkt);
+}
+
+void test_notify_order(void)
+{
+	static const struct {
+		uint16_t res_id;
+		const char *query;
+	} observe[] = {
+		/* periodic, slow */
+		{ 0, "pmax=3" },
+		/* periodic, fast */
+		{ 1, "pmax=1" },
+		/* value change, held back by pmin */
+		{ 2, "pmin=2" },
+	};
+	/* tokens in order of the first notification */
+	static const uint8_t expected[] = { 2, 3, 1 };
+	uint8_t order[ARRAY_SIZE(expected)];
+	struct coap_packet cpkt;
+	uint8_t token[8];
+	int64_t end;
+	int i, ret, count = 0;
+
+	(void)memset(token, 0, sizeof(token));
+
+	zassert_equal(lwm2m_engine_create_obj_inst("32770/0"), 0,
+		      "create failed");
+	zassert_equal(server_start(), 0, "server start failed");
+
+	for (i = 0; i < ARRAY_SIZE(observe); i++) {
+		ret = server_request(COAP_METHOD_PUT, observe[i].res_id,
+				     observe[i].query, 0);
+		zassert_equal(ret, COAP_RESPONSE_CODE_CHANGED,
+			      "write attributes failed (%d)", ret);
+	}
+
+	/* tokens start at 1 and follow the observe[] order */
+	for (i = 0; i < ARRAY_SIZE(observe); i++) {
+		ret = server_request(COAP_METHOD_GET, observe[i].res_id, NULL,
+				     i + 1);
+		zassert_equal(ret, COAP_RESPONSE_CODE_CONTENT,
+			      "observe failed (%d)", ret);
+	}
+
+	/* a value change only notifies once pmin expired */
+	k_msleep(100);
+	zassert_equal(lwm2m_engine_set_s32("32770/0/2", 1), 0, "set failed");
+
+	end = k_uptime_get() + NOTIFY_TIMEOUT_MS;
+	while (count < ARRAY_SIZE(order) && k_uptime_get() < end) {
+		ret = server_recv(&cpkt, (int)(end - k_uptime_get()));
+		zassert_equal(ret, 0, "notification timed out");
+
+		if (coap_header_get_type(&cpkt) != COAP_TYPE_CON) {
+			continue;
+		}
+
+		zassert_equal(server_ack(&cpkt), 0, "ack failed");
+		zassert_equal(coap_header_get_token(&cpkt, token), 1,
+			      "wrong token length");
+
+		/* only the first notification of each observer counts */
+		if (memchr(order, token[0], count) == NULL) {
+			order[count++] = token[0];
+		}
+	}
+
+	server_stop();
+
+	zassert_equal(count, ARRAY_SIZE(order), "notifications missing");
+	zassert_mem_equal(order, expected, sizeof(expected),
+			  "notifications out of deadline order");
+}
@@ -0,0 +1,482 @@
+/*
+ * Copyright (c) 2020 Foundries.io
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <sys/byteorder.h>
+#include <net/lwm2m.h>
+
+#include "lwm2m_object.h"
+#include "lwm2m_engine.h"
+#include "lwm2m_rw_json.h"
+#include "lwm2m_rw_oma_tlv.h"
+#include "lwm2m_rw_senml_cbor.h"
+
+#include "bench_timer.h"
+
+#define TEST_OBJ_ID		32769
+#define TEST_RES_COUNT		8
+
+#define TEST_RES_S32		0
+#define TEST_RES_S64		1
+#define TEST_RES_STRING		2
+#define TEST_RES_FLOAT32	3
+#define TEST_RES_FLOAT64	4
+#define TEST_RES_BOOL		5
+#define TEST_RES_OPAQUE		6
+#define TEST_RES_OBJLNK		7
+
+#define TEST_STRING_LEN		16
+#define TEST_OPAQUE_LEN		8
+
+#define ROUNDS			100
+
+/* test object with one resource of each data type */
+static int32_t test_s32;
+static int64_t test_s64;
+static char test_string[TEST_STRING_LEN];
+static float32_value_t test_float32;
+static float64_value_t test_float64;
+static bool test_bool;
+static uint8_t test_opaque[TEST_OPAQUE_LEN];
+static struct lwm2m_objlnk test_objlnk;
+
+static struct lwm2m_engine_obj test_obj;
+static struct lwm2m_engine_obj_field test_fields[] = {
+	OBJ_FIELD_DATA(TEST_RES_S32, RW, S32),
+	OBJ_FIELD_DATA(TEST_RES_S64, RW, S64),
+	OBJ_FIELD_DATA(TEST_RES_STRING, RW, STRING),
+	OBJ_FIELD_DATA(TEST_RES_FLOAT32, RW, FLOAT32),
+	OBJ_FIELD_DATA(TEST_RES_FLOAT64, RW, FLOAT64),
+	OBJ_FIELD_DATA(TEST_RES_BOOL, RW, BOOL),
+	OBJ_FIELD_DATA(TEST_RES_OPAQUE, RW, OPAQUE),
+	OBJ_FIELD_DATA(TEST_RES_OBJLNK, RW, OBJLNK),
+};
+
+static struct lwm2m_engine_obj_inst test_inst;
+static struct lwm2m_engine_res test_res[TEST_RES_COUNT];
+static struct lwm2m_engine_res_inst test_res_inst[TEST_RES_COUNT];
+
+static struct lwm2m_engine_obj_inst *test_obj_create(uint16_t obj_inst_id)
+{
+	int i = 0, j = 0;
+
+	if (test_inst.obj) {
+		return NULL;
+	}
+
+	(void)memset(test_res, 0, sizeof(test_res));
+	init_res_instance(test_res_inst, ARRAY_SIZE(test_res_inst));
+
+	INIT_OBJ_RES_DATA(TEST_RES_S32, test_res, i, test_res_inst, j,
+			  &test_s32, sizeof(test_s32));
+	INIT_OBJ_RES_DATA(TEST_RES_S64, test_res, i, test_res_inst, j,
+			  &test_s64, sizeof(test_s64));
+	INIT_OBJ_RES_DATA(TEST_RES_STRING, test_res, i, test_res_inst, j,
+			  test_string, sizeof(test_string));
+	INIT_OBJ_RES_DATA(TEST_RES_FLOAT32, test_res, i, test_res_inst, j,
+			  &test_float32, sizeof(test_float32));
+	INIT_OBJ_RES_DATA(TEST_RES_FLOAT64, test_res, i, test_res_inst, j,
+			  &test_float64, sizeof(test_float64));
+	INIT_OBJ_RES_DATA(TEST_RES_BOOL, test_res, i, test_res_inst, j,
+			  &test_bool, sizeof(test_bool));
+	INIT_OBJ_RES_DATA(TEST_RES_OPAQUE, test_res, i, test_res_inst, j,
+			  test_opaque, sizeof(test_opaque));
+	INIT_OBJ_RES_DATA(TEST_RES_OBJLNK, test_res, i, test_res_inst, j,
+			  &test_objlnk, sizeof(test_objlnk));
+
+	test_inst.resources = test_res;
+	test_inst.resource_count = i;
+
+	return &test_inst;
+}
+
+static struct lwm2m_ctx test_ctx;
+static struct lwm2m_message msg;
+static struct coap_packet in_cpkt;
+
+/* Run a read of path and return the payload produced by the writer */
+static uint8_t *read_op(const struct lwm2m_writer *writer, uint16_t format,
+			struct lwm2m_obj_path *path, uint16_t *len)
+{
+	uint16_t start;
+	int ret;
+
+	(void)memset(&msg, 0, sizeof(msg));
+	msg.ctx = &test_ctx;
+	msg.path = *path;
+
+	ret = coap_packet_init(&msg.cpkt, msg.msg_data, sizeof(msg.msg_data),
+			       1, COAP_TYPE_ACK, 0, NULL,
+			       COAP_RESPONSE_CODE_CONTENT, 0);
+	zassert_equal(ret, 0, "coap_packet_init failed");
+
+	msg.out.out_cpkt = &msg.cpkt;
+	msg.out.writer = writer;
+
+	switch (format) {
+	case LWM2M_FORMAT_OMA_TLV:
+		ret = do_read_op_tlv(&msg, format);
+		break;
+	case LWM2M_FORMAT_OMA_JSON:
+		ret = do_read_op_json(&msg, format);
+		break;
+	default:
+		ret = do_read_op_senml_cbor(&msg, format);
+		break;
+	}
+
+	zassert_equal(ret, 0, "read failed: %d", ret);
+
+	/* payload follows the options and the payload marker */
+	start = msg.cpkt.hdr_len + msg.cpkt.opt_len + 1U;
+	*len = msg.cpkt.offset - start;
+
+	return msg.cpkt.data + start;
+}
+
+static int write_op(struct lwm2m_obj_path *path, const uint8_t *payload,
+		    uint16_t len)
+{
+	static uint8_t data[256];
+
+	zassert_true(len <= sizeof(data), "payload too large");
+	memcpy(data, payload, len);
+
+	(void)memset(&msg, 0, sizeof(msg));
+	msg.ctx = &test_ctx;
+	msg.path = *path;
+
+	(void)memset(&in_cpkt, 0, sizeof(in_cpkt));
+	in_cpkt.data = data;
+	in_cpkt.offset = len;
+	in_cpkt.max_len = len;
+
+	msg.in.in_cpkt = &in_cpkt;
+	msg.in.reader = &senml_cbor_reader;
+	msg.in.offset = 0U;
+
+	return do_write_op_senml_cbor(&msg);
+}
+
+static bool has_record(const uint8_t *payload, uint16_t len,
+		       const uint8_t *record, size_t record_len)
+{
+	uint16_t i;
+
+	for (i = 0U; i + record_len <= len; i++) {
+		if (!memcmp(payload + i, record, record_len)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void test_setup(void)
+{
+	test_s32 = 0;
+	test_s64 = 0;
+	(void)memset(test_string, 0, sizeof(test_string));
+	(void)memset(&test_float32, 0, sizeof(test_float32));
+	(void)memset(&test_float64, 0, sizeof(test_float64));
+	test_bool = false;
+	(void)memset(test_opaque, 0, sizeof(test_opaque));
+	(void)memset(&test_objlnk, 0, sizeof(test_objlnk));
+}
+
+static void test_put_single(void)
+{
+	struct lwm2m_obj_path path = {
+		.obj_id = TEST_OBJ_ID, .obj_inst_id = 0U,
+		.res_id = TEST_RES_S32, .level = 3U,
+	};
+	static const uint8_t expected[] = {
+		/* array of 1 record, 16-bit length */
+		0x99, 0x00, 0x01,
+		/* { -2: "/32769/0/", 0: "0", 2: 42 } */
+		0xa3,
+		0x21, 0x69, '/', '3', '2', '7', '6', '9', '/', '0', '/',
+		0x00, 0x61, '0',
+		0x02, 0x18, 0x2a,
+	};
+	uint8_t *payload;
+	uint16_t len;
+
+	test_s32 = 42;
+	payload = read_op(&senml_cbor_writer, LWM2M_FORMAT_APP_SENML_CBOR,
+			  &path, &len);
+
+	zassert_equal(len, sizeof(expected), "wrong length %u", len);
+	zassert_mem_equal(payload, expected, sizeof(expected),
+			  "wrong payload");
+}
+
+static void test_put_types(void)
+{
+	struct lwm2m_obj_path path = {
+		.obj_id = TEST_OBJ_ID, .obj_inst_id = 0U, .level = 2U,
+	};
+	static const uint8_t s64_record[] = {
+		0xa2, 0x00, 0x61, '1', 0x02, 0x3b,
+		0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	};
+	static const uint8_t float32_record[] = {
+		0xa2, 0x00, 0x61, '3', 0x02, 0xfa, 0x3f, 0xc0, 0x00, 0x00,
+	};
+	static const uint8_t float64_record[] = {
+		0xa2, 0x00, 0x61, '4', 0x02, 0xfb,
+		0xc0, 0x02, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00,
+	};
+	static const uint8_t bool_record[] = {
+		0xa2, 0x00, 0x61, '5', 0x04, 0xf5,
+	};
+	static const uint8_t objlnk_record[] = {
+		0xa2, 0x00, 0x61, '7', 0x63, 'v', 'l', 'o',
+		0x63, '3', ':', '1',
+	};
+	uint8_t *payload;
+	uint16_t len;
+
+	test_s64 = INT64_MIN;
+	test_float32.val1 = 1;
+	test_float32.val2 = 500000;
+	test_float64.val1 = -2;
+	test_float64.val2 = 250000000LL;
+	test_bool = true;
+	test_objlnk.obj_id = 3U;
+	test_objlnk.obj_inst = 1U;
+
+	payload = read_op(&senml_cbor_writer, LWM2M_FORMAT_APP_SENML_CBOR,
+			  &path, &len);
+
+	/* one 16-bit length array of all the resources */
+	zassert_equal(payload[0], 0x99, "no record array");
+	zassert_equal(sys_get_be16(&payload[1]), TEST_RES_COUNT,
+		      "wrong record count");
+
+	zassert_true(has_record(payload, len, s64_record,
+				 sizeof(s64_record)), "bad s64 record");
+	zassert_true(has_record(payload, len, float32_record,
+				 sizeof(float32_record)), "bad float32 record");
+	zassert_true(has_record(payload, len, float64_record,
+				 sizeof(float64_record)), "bad float64 record");
+	zassert_true(has_record(payload, len, bool_record,
+				 sizeof(bool_record)), "bad bool record");
+	zassert_true(has_record(payload, len, objlnk_record,
+				 sizeof(objlnk_record)), "bad objlnk record");
+}
+
+static void test_get_types(void)
+{
+	struct lwm2m_obj_path path = {
+		.obj_id = TEST_OBJ_ID, .obj_inst_id = 0U, .level = 2U,
+	};
+	static const uint8_t payload[] = {
+		/* indefinite length pack */
+		0x9f,
+		/* { -2: "/32769/0/", 0: "0", 2: -7 } */
+		0xa3,
+		0x21, 0x69, '/', '3', '2', '7', '6', '9', '/', '0', '/',
+		0x00, 0x61, '0',
+		0x02, 0x26,
+		/* { 0: "1", 2: INT64_MAX } */
+		0xa2, 0x00, 0x61, '1', 0x02, 0x1b,
+		0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		/* { 0: "2", 3: "hello" } */
+		0xa2, 0x00, 0x61, '2', 0x03, 0x65, 'h', 'e', 'l', 'l', 'o',
+		/* { 0: "3", 2: 1.5 as binary16 } */
+		0xa2, 0x00, 0x61, '3', 0x02, 0xf9, 0x3e, 0x00,
+		/* { 0: "4", 2: -2.25 as binary64 } */
+		0xa2, 0x00, 0x61, '4', 0x02, 0xfb,
+		0xc0, 0x02, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00,
+		/* indefinite map { 0: "5", 4: true } */
+		0xbf, 0x00, 0x61, '5', 0x04, 0xf5, 0xff,
+		/* { 0: "6", 8: h'0102' } */
+		0xa2, 0x00, 0x61, '6', 0x08, 0x42, 0x01, 0x02,
+		/* { 0: "7", "vlo": "3:1" } */
+		0xa2, 0x00, 0x61, '7', 0x63, 'v', 'l', 'o',
+		0x63, '3', ':', '1',
+		0xff,
+	};
+	static const uint8_t opaque[] = { 0x01, 0x02 };
+	int ret;
+
+	ret = write_op(&path, payload, sizeof(payload));
+	zassert_equal(ret, 0, "write failed: %d", ret);
+
+	zassert_equal(test_s32, -7, "wrong s32");
+	zassert_equal(test_s64, INT64_MAX, "wrong s64");
+	zassert_true(!strcmp(test_string, "hello"), "wrong string");
+	zassert_equal(test_float32.val1, 1, "wrong float32");
+	zassert_equal(test_float32.val2, 500000, "wrong float32 fraction");
+	zassert_equal(test_float64.val1, -2, "wrong float64");
+	zassert_equal(test_float64.val2, 250000000LL,
+		      "wrong float64 fraction");
+	zassert_true(test_bool, "wrong bool");
+	zassert_mem_equal(test_opaque, opaque, sizeof(opaque),
+			  "wrong opaque");
+	zassert_equal(test_objlnk.obj_id, 3U, "wrong objlnk object");
+	zassert_equal(test_objlnk.obj_inst, 1U, "wrong objlnk instance");
+}
+
+static void test_get_int_range(void)
+{
+	struct lwm2m_obj_path path = {
+		.obj_id = TEST_OBJ_ID, .obj_inst_id = 0U,
+		.res_id = TEST_RES_S64, .level = 3U,
+	};
+	static const uint8_t nint_payload[] = {
+		0x81, 0xa3,
+		0x21, 0x69, '/', '3', '2', '7', '6', '9', '/', '0', '/',
+		0x00, 0x61, '1',
+		/* -1 - 0x8000000000000000 does not fit in an int64_t */
+		0x02, 0x3b, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	};
+	static const uint8_t uint_payload[] = {
+		0x81, 0xa3,
+		0x21, 0x69, '/', '3', '2', '7', '6', '9', '/', '0', '/',
+		0x00, 0x61, '1',
+		0x02, 0x1b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	};
+	static const uint8_t min_payload[] = {
+		0x81, 0xa3,
+		0x21, 0x69, '/', '3', '2', '7', '6', '9', '/', '0', '/',
+		0x00, 0x61, '1',
+		0x02, 0x3b, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	};
+
+	/* out of range values are rejected and leave the resource alone */
+	test_s64 = 1234;
+	(void)write_op(&path, nint_payload, sizeof(nint_payload));
+	zassert_equal(test_s64, 1234, "out of range NINT accepted");
+
+	(void)write_op(&path, uint_payload, sizeof(uint_payload));
+	zassert_equal(test_s64, 1234, "out of range UINT accepted");
+
+	(void)write_op(&path, min_payload, sizeof(min_payload));
+	zassert_equal(test_s64, INT64_MIN, "INT64_MIN rejected");
+}
+
+static void test_skip_unknown(void)
+{
+	struct lwm2m_obj_path path = {
+		.obj_id = TEST_OBJ_ID, .obj_inst_id = 0U,
+		.res_id = TEST_RES_S32, .level = 3U,
+	};
+	static const uint8_t head[] = {
+		0x81, 0xa4,
+		0x21, 0x69, '/', '3', '2', '7', '6', '9', '/', '0', '/',
+		0x00, 0x61, '0',
+		0x02, 0x05,
+		/* unknown label 6 followed by a tagged value */
+		0x06,
+	};
+	static const uint8_t nested[] = {
+		0x81, 0xa4,
+		0x21, 0x69, '/', '3', '2', '7', '6', '9', '/', '0', '/',
+		0x00, 0x61, '0',
+		0x02, 0x07,
+		/* unknown label 6, arrays nested deeper than allowed */
+		0x06, 0x81, 0x81, 0x81, 0x81, 0x81, 0x00,
+	};
+	uint8_t payload[sizeof(head) + 201];
+	int ret;
+
+	/* a long run of tags is skipped without recursing per tag */
+	memcpy(payload, head, sizeof(head));
+	(void)memset(payload + sizeof(head), 0xc6, 200);
+	payload[sizeof(payload) - 1] = 0x00;
+
+	ret = write_op(&path, payload, sizeof(payload));
+	zassert_equal(ret, 0, "tagged value not skipped: %d", ret);
+	zassert_equal(test_s32, 5, "wrong s32");
+
+	ret = write_op(&path, nested, sizeof(nested));
+	zassert_equal(ret, -E2BIG, "deep nesting accepted: %d", ret);
+	zassert_equal(test_s32, 5, "malformed record written");
+}
+
+/*
+ * Encode the same IPSO temperature sensor instance read in all formats
+ * and report payload size and encode time.
+ */
+static void test_format_comparison(void)
+{
+	static const struct {
+		const char *name;
+		const struct lwm2m_writer *writer;
+		uint16_t format;
+	} formats[] = {
+		{ "OMA JSON", &json_writer, LWM2M_FORMAT_OMA_JSON },
+		{ "SenML CBOR", &senml_cbor_writer,
+		  LWM2M_FORMAT_APP_SENML_CBOR },
+		{ "OMA TLV", &oma_tlv_writer, LWM2M_FORMAT_OMA_TLV },
+	};
+	struct lwm2m_obj_path path = {
+		.obj_id = IPSO_OBJECT_TEMP_SENSOR_ID, .obj_inst_id = 0U,
+		.level = 2U,
+	};
+	float32_value_t value = { 23, 500000 };
+	uint16_t len[ARRAY_SIZE(formats)];
+	uint32_t cycles, ns;
+	uint64_t start;
+	int i, r;
+
+	zassert_equal(lwm2m_engine_set_float32("3303/0/5700", &value), 0,
+		      "unable to set the sensor value");
+	zassert_equal(lwm2m_engine_set_string("3303/0/5701", "Cel"), 0,
+		      "unable to set the units");
+
+	TC_PRINT("  format      bytes  ns/read\n");
+
+	for (i = 0; i < ARRAY_SIZE(formats); i++) {
+		start = bench_time_get();
+
+		for (r = 0; r < ROUNDS; r++) {
+			(void)read_op(formats[i].writer, formats[i].format,
+				      &path, &len[i]);
+		}
+
+		bench_result(start, ROUNDS, &cycles, &ns);
+		TC_PRINT("  %-10s %6u %8u\n", formats[i].name, len[i], ns);
+	}
+
+	zassert_true(len[1] < len[0], "SenML CBOR not smaller than JSON");
+}
+
+void test_main(void)
+{
+	int ret;
+
+	test_obj.obj_id = TEST_OBJ_ID;
+	test_obj.fields = test_fields;
+	test_obj.field_count = ARRAY_SIZE(test_fields);
+	test_obj.max_instance_count = 1U;
+	test_obj.create_cb = test_obj_create;
+	lwm2m_register_obj(&test_obj);
+
+	ret = lwm2m_engine_create_obj_inst("32769/0");
+	zassert_equal(ret, 0, "unable to create the test object");
+
+	ret = lwm2m_engine_create_obj_inst("3303/0");
+	zassert_equal(ret, 0, "unable to create the temperature object");
+
+	ztest_test_suite(lwm2m_senml_cbor,
+		ztest_unit_test_setup_teardown(test_put_single,
+					       test_setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_put_types,
+					       test_setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_get_types,
+					       test_setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_get_int_range,
+					       test_setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_skip_unknown,
+					       test_setup, unit_test_noop),
+		ztest_unit_test(test_format_comparison));
+
+	ztest_run_test_suite(lwm2m_senml_cbor);
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <net/socket.h>
+
+#include "broker.h"
+
+#define BROKER_BUF_SIZE 256
+
+static int broker_sock[2] = { -1, -1 };
+static uint8_t broker_buf[BROKER_BUF_SIZE];
+
+static void evt_handler(struct mqtt_client *const client,
+			const struct mqtt_evt *evt)
+{
+	/* Acknowledgements of the queued messages are handled by the
+	 * library, nothing to do here.
+	 */
+}
+
+void broker_connect(struct mqtt_client *client, uint8_t *rx_buf,
+		    uint8_t *tx_buf, size_t buf_size)
+{
+	int ret;
+
+	ret = zsock_socketpair(AF_UNIX, SOCK_STREAM, 0, broker_sock);
+	zassert_equal(ret, 0, "socketpair failed: %d", errno);
+
+	mqtt_client_init(client);
+	client->evt_cb = evt_handler;
+	client->rx_buf = rx_buf;
+	client->rx_buf_size = buf_size;
+	client->tx_buf = tx_buf;
+	client->tx_buf_size = buf_size;
+	client->transport.type = MQTT_TRANSPORT_NON_SECURE;
+	client->transport.tcp.sock = broker_sock[0];
+
+	MQTT_SET_STATE(client, MQTT_STATE_TCP_CONNECTED);
+	MQTT_SET_STATE(client, MQTT_STATE_CONNECTED);
+}
+
+void broker_disconnect(struct mqtt_client *client)
+{
+	MQTT_STATE_INIT(client);
+
+	(void)zsock_close(broker_sock[0]);
+	(void)zsock_close(broker_sock[1]);
+}
+
+void broker_send(struct mqtt_client *client, const uint8_t *data,
+		 size_t len)
+{
+	ssize_t ret;
+
+	ret = zsock_send(broker_sock[1], data, len, 0);
+	zassert_equal(ret, len, "broker send failed: %d", errno);
+
+	zassert_equal(mqtt_input(client), 0, "mqtt_input failed");
+}
+
+void broker_ack(struct mqtt_client *client, uint8_t type,
+		uint16_t message_id)
+{
+	uint8_t ack[] = {
+		type, sizeof(uint16_t), message_id >> 8, message_id & 0xff
+	};
+
+	broker_send(client, ack, sizeof(ack));
+}
+
+static int broker_read(uint8_t *data, size_t len)
+{
+	ssize_t ret;
+
+	ret = zsock_recv(broker_sock[1], data, len, ZSOCK_MSG_DONTWAIT);
+	if (ret < 0 && errno == EAGAIN) {
+		return -EAGAIN;
+	}
+
+	zassert_equal(ret, len, "broker recv failed: %d", errno);
+
+	return 0;
+}
+
+int broker_recv(uint8_t *type_and_flags, struct buf_ctx *buf)
+{
+	struct buf_ctx hdr;
+	uint32_t length;
+	size_t hdr_len = 0;
+
+	/* Type and the first length byte */
+	if (broker_read(broker_buf, 2) < 0) {
+		return -EAGAIN;
+	}
+
+	hdr_len = 2;
+
+	while (broker_buf[hdr_len - 1] & MQTT_LENGTH_CONTINUATION_BIT) {
+		zassert_true(hdr_len < MQTT_FIXED_HEADER_MAX_SIZE,
+			     "invalid length");
+		zassert_equal(broker_read(&broker_buf[hdr_len], 1), 0,
+			      "length missing");
+		hdr_len++;
+	}
+
+	hdr.cur = broker_buf;
+	hdr.end = broker_buf + hdr_len;
+	zassert_equal(fixed_header_decode(&hdr, type_and_flags, &length), 0,
+		      "fixed_header_decode failed");
+	zassert_true(hdr_len + length <= sizeof(broker_buf),
+		     "message too long");
+
+	if (length > 0) {
+		zassert_equal(broker_read(&broker_buf[hdr_len], length), 0,
+			      "message truncated");
+	}
+
+	buf->cur = &broker_buf[hdr_len];
+	buf->end = &broker_buf[hdr_len + length];
+
+	return 0;
+}
+
+uint8_t broker_recv_publish(struct mqtt_client *client, uint16_t message_id,
+			    struct mqtt_publish_param *param)
+{
+	uint8_t type_and_flags;
+	struct buf_ctx buf;
+	uint32_t length;
+	int rc;
+
+	zassert_equal(broker_recv(&type_and_flags, &buf), 0,
+		      "no message 0x%04x", message_id);
+	zassert_equal(type_and_flags & 0xF0, MQTT_PKT_TYPE_PUBLISH,
+		      "not a PUBLISH message");
+
+	/* The message id is not decoded for QoS 0 */
+	(void)memset(param, 0, sizeof(*param));
+
+	length = buf.end - buf.cur;
+	rc = publish_decode(client, type_and_flags, length, &buf, param);
+	zassert_equal(rc, 0, "publish_decode failed");
+	zassert_equal(param->message_id, message_id, "wrong message id");
+
+	return type_and_flags;
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __MQTT_TEST_BROKER_H__
+#define __MQTT_TEST_BROKER_H__
+
+#include <mqtt_internal.h>
+
+/* Connect the client to a fake broker through a socket pair. The client
+ * is in the connected state, no CONNECT message is exchanged.
+ */
+void broker_connect(struct mqtt_client *client, uint8_t *rx_buf,
+		    uint8_t *tx_buf, size_t buf_size);
+
+void broker_disconnect(struct mqtt_client *client);
+
+/* Send a message from the broker and let the client process it */
+void broker_send(struct mqtt_client *client, const uint8_t *data,
+		 size_t len);
+
+/* Send PUBACK, PUBREC or PUBCOMP from the broker */
+void broker_ack(struct mqtt_client *client, uint8_t type,
+		uint16_t message_id);
+
+/* Receive the next message written by the client. buf is set to the
+ * variable header and the payload.
+ *
+ * @return 0 or -EAGAIN if the client has written nothing.
+ */
+int broker_recv(uint8_t *type_and_flags, struct buf_ctx *buf);
+
+/* Receive a PUBLISH message and check its message id
+ *
+ * @return Type and flags of the message.
+ */
+uint8_t broker_recv_publish(struct mqtt_client *client, uint16_t message_id,
+			    struct mqtt_publish_param *param);
+
+#endif /* __MQTT_TEST_BROKER_H__ */
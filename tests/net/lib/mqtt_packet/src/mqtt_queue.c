@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <string.h>
+
+#include "broker.h"
+
+#define QUEUE_BUF_SIZE	128
+#define INFLIGHT	CONFIG_MQTT_PUBLISH_QUEUE_INFLIGHT
+
+static uint8_t rx_buffer[QUEUE_BUF_SIZE];
+static uint8_t tx_buffer[QUEUE_BUF_SIZE];
+static struct mqtt_client client;
+
+static uint8_t payload[] = "queued";
+
+static int enqueue(uint8_t qos, uint16_t message_id)
+{
+	struct mqtt_publish_param param = {
+		.message.topic.qos = qos,
+		.message.topic.topic = MQTT_UTF8_LITERAL("sensors"),
+		.message.payload.data = payload,
+		.message.payload.len = sizeof(payload),
+		.message_id = message_id,
+	};
+
+	return mqtt_publish_enqueue(&client, &param, K_NO_WAIT);
+}
+
+static void expect_publish(uint16_t message_id, uint8_t qos, bool dup)
+{
+	struct mqtt_publish_param param;
+	uint8_t type_and_flags;
+
+	type_and_flags = broker_recv_publish(&client, message_id, &param);
+
+	zassert_equal(param.message.topic.qos, qos, "wrong qos");
+	zassert_equal(!!(type_and_flags & MQTT_HEADER_DUP_MASK), dup,
+		      "wrong dup flag");
+	zassert_equal(param.message.payload.len, sizeof(payload),
+		      "wrong payload length");
+}
+
+static void expect_none(void)
+{
+	uint8_t type_and_flags;
+	struct buf_ctx buf;
+
+	zassert_equal(broker_recv(&type_and_flags, &buf), -EAGAIN,
+		      "unexpected message 0x%02x", type_and_flags);
+}
+
+static void queue_setup(void)
+{
+	broker_connect(&client, rx_buffer, tx_buffer, QUEUE_BUF_SIZE);
+}
+
+static void queue_teardown(void)
+{
+	mqtt_publish_queue_clear(&client);
+	broker_disconnect(&client);
+}
+
+static void test_queue_qos0(void)
+{
+	int i;
+
+	for (i = 0; i < 3; i++) {
+		zassert_equal(enqueue(MQTT_QOS_0_AT_MOST_ONCE, 0), 0,
+			      "enqueue failed");
+	}
+
+	/* Nothing is written until the connection is serviced */
+	expect_none();
+
+	zassert_equal(mqtt_publish_queue_flush(&client), 0, "flush failed");
+
+	for (i = 0; i < 3; i++) {
+		expect_publish(0, MQTT_QOS_0_AT_MOST_ONCE, false);
+	}
+
+	expect_none();
+	zassert_equal(client.internal.inflight_count, 0,
+		      "QoS 0 message in flight");
+}
+
+static void test_queue_window(void)
+{
+	int i;
+
+	for (i = 1; i <= INFLIGHT + 1; i++) {
+		zassert_equal(enqueue(MQTT_QOS_1_AT_LEAST_ONCE, i), 0,
+			      "enqueue failed");
+	}
+
+	zassert_equal(mqtt_publish_queue_flush(&client), 0, "flush failed");
+
+	for (i = 1; i <= INFLIGHT; i++) {
+		expect_publish(i, MQTT_QOS_1_AT_LEAST_ONCE, false);
+	}
+
+	/* The last message waits for an acknowledgement */
+	expect_none();
+	zassert_equal(client.internal.inflight_count, INFLIGHT,
+		      "wrong in-flight count");
+
+	broker_ack(&client, MQTT_PKT_TYPE_PUBACK, 1);
+	expect_publish(INFLIGHT + 1, MQTT_QOS_1_AT_LEAST_ONCE, false);
+
+	for (i = 2; i <= INFLIGHT + 1; i++) {
+		broker_ack(&client, MQTT_PKT_TYPE_PUBACK, i);
+	}
+
+	expect_none();
+	zassert_equal(client.internal.inflight_count, 0,
+		      "acknowledged message in flight");
+}
+
+static void test_queue_qos2(void)
+{
+	struct mqtt_pubrel_param pubrel;
+	uint8_t type_and_flags;
+	struct buf_ctx buf;
+
+	zassert_equal(enqueue(MQTT_QOS_2_EXACTLY_ONCE, 7), 0,
+		      "enqueue failed");
+	zassert_equal(mqtt_publish_queue_flush(&client), 0, "flush failed");
+	expect_publish(7, MQTT_QOS_2_EXACTLY_ONCE, false);
+
+	/* PUBACK does not complete a QoS 2 message */
+	broker_ack(&client, MQTT_PKT_TYPE_PUBACK, 7);
+	zassert_equal(client.internal.inflight_count, 1,
+		      "QoS 2 message completed by PUBACK");
+
+	broker_ack(&client, MQTT_PKT_TYPE_PUBREC, 7);
+
+	zassert_equal(broker_recv(&type_and_flags, &buf), 0, "no PUBREL");
+	zassert_equal(type_and_flags,
+		      MQTT_MESSAGES_OPTIONS(MQTT_PKT_TYPE_PUBREL, 0, 1, 0),
+		      "not a PUBREL message");
+	zassert_equal(publish_release_decode(&buf, &pubrel), 0,
+		      "publish_release_decode failed");
+	zassert_equal(pubrel.message_id, 7, "wrong message id");
+
+	broker_ack(&client, MQTT_PKT_TYPE_PUBCOMP, 7);
+
+	expect_none();
+	zassert_equal(client.internal.inflight_count, 0,
+		      "completed message in flight");
+}
+
+static void test_queue_resend(void)
+{
+	zassert_equal(enqueue(MQTT_QOS_1_AT_LEAST_ONCE, 1), 0,
+		      "enqueue failed");
+	zassert_equal(mqtt_publish_queue_flush(&client), 0, "flush failed");
+	expect_publish(1, MQTT_QOS_1_AT_LEAST_ONCE, false);
+
+	/* The message is sent again with the DUP flag after a reconnect */
+	zassert_equal(mqtt_queue_resend(&client, true), 0, "resend failed");
+	expect_publish(1, MQTT_QOS_1_AT_LEAST_ONCE, true);
+	expect_none();
+
+	broker_ack(&client, MQTT_PKT_TYPE_PUBACK, 1);
+	zassert_equal(client.internal.inflight_count, 0,
+		      "acknowledged message in flight");
+}
+
+static void test_queue_full(void)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_MQTT_PUBLISH_QUEUE_SIZE; i++) {
+		zassert_equal(enqueue(MQTT_QOS_1_AT_LEAST_ONCE, i + 1), 0,
+			      "enqueue failed");
+	}
+
+	zassert_equal(enqueue(MQTT_QOS_1_AT_LEAST_ONCE, i + 1), -ENOMEM,
+		      "enqueue to a full queue succeeded");
+
+	/* Clearing releases the buffers */
+	mqtt_publish_queue_clear(&client);
+
+	zassert_equal(enqueue(MQTT_QOS_1_AT_LEAST_ONCE, 1), 0,
+		      "enqueue after clear failed");
+	zassert_equal(mqtt_publish_queue_flush(&client), 0, "flush failed");
+	expect_publish(1, MQTT_QOS_1_AT_LEAST_ONCE, false);
+	expect_none();
+}
+
+static void test_queue_too_long(void)
+{
+	static uint8_t long_payload[CONFIG_MQTT_PUBLISH_QUEUE_BUF_SIZE];
+	struct mqtt_publish_param param = {
+		.message.topic.qos = MQTT_QOS_0_AT_MOST_ONCE,
+		.message.topic.topic = MQTT_UTF8_LITERAL("sensors"),
+		.message.payload.data = long_payload,
+		.message.payload.len = sizeof(long_payload),
+	};
+
+	zassert_equal(mqtt_publish_enqueue(&client, &param, K_NO_WAIT),
+		      -EMSGSIZE, "message larger than a buffer queued");
+
+	zassert_equal(mqtt_publish_queue_flush(&client), 0, "flush failed");
+	expect_none();
+}
+
+void test_mqtt_queue(void)
+{
+	ztest_test_suite(test_mqtt_queue_fn,
+		ztest_unit_test_setup_teardown(test_queue_qos0,
+					       queue_setup, queue_teardown),
+		ztest_unit_test_setup_teardown(test_queue_window,
+					       queue_setup, queue_teardown),
+		ztest_unit_test_setup_teardown(test_queue_qos2,
+					       queue_setup, queue_teardown),
+		ztest_unit_test_setup_teardown(test_queue_resend,
+					       queue_setup, queue_teardown),
+		ztest_unit_test_setup_teardown(test_queue_full,
+					       queue_setup, queue_teardown),
+		ztest_unit_test_setup_teardown(test_queue_too_long,
+					       queue_setup, queue_teardown));
+	ztest_run_test_suite(test_mqtt_queue_fn);
+}
@@ -0,0 +1,484 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <sys/byteorder.h>
+
+#include "broker.h"
+
+#define V5_BUF_SIZE	128
+
+static uint8_t rx_buffer[V5_BUF_SIZE];
+static uint8_t tx_buffer[V5_BUF_SIZE];
+static struct mqtt_client client;
+
+static uint8_t payload[] = {0x4f, 0x4b};
+
+/*
+ * MQTT 5.0 CONNECT msg:
+ * Clean session: 1	Client id: [6] 'zephyr'	Will flag: 0
+ * Keep alive: 60	Properties: none
+ */
+static uint8_t connect_v5[] = {0x10, 0x13, 0x00, 0x04, 0x4d, 0x51, 0x54, 0x54,
+			       0x05, 0x02, 0x00, 0x3c, 0x00, 0x00, 0x06, 0x7a,
+			       0x65, 0x70, 0x68, 0x79, 0x72};
+
+/*
+ * MQTT 5.0 CONNECT msg:
+ * Clean session: 1	Client id: [6] 'zephyr'	Will flag: 1
+ * Will QoS: 0		Will topic: [8] quitting	Will msg: [3] bye
+ * Keep alive: 60	Properties: none	Will properties: none
+ */
+static uint8_t connect_v5_will[] = {0x10, 0x23, 0x00, 0x04, 0x4d, 0x51, 0x54,
+				    0x54, 0x05, 0x06, 0x00, 0x3c, 0x00, 0x00,
+				    0x06, 0x7a, 0x65, 0x70, 0x68, 0x79, 0x72,
+				    0x00, 0x00, 0x08, 0x71, 0x75, 0x69, 0x74,
+				    0x74, 0x69, 0x6e, 0x67, 0x00, 0x03, 0x62,
+				    0x79, 0x65};
+
+/*
+ * MQTT 5.0 CONNACK msg:
+ * Session present: 0	Reason: success
+ * Receive Maximum: 1	Topic Alias Maximum: 1	Maximum Packet Size: 32
+ * Reason String: ok	User Property: a = b
+ */
+static uint8_t connack_v5[] = {0x20, 0x1a, 0x00, 0x00, 0x17, 0x21, 0x00, 0x01,
+			       0x22, 0x00, 0x01, 0x27, 0x00, 0x00, 0x00, 0x20,
+			       0x1f, 0x00, 0x02, 0x6f, 0x6b, 0x26, 0x00, 0x01,
+			       0x61, 0x00, 0x01, 0x62};
+
+/* MQTT 5.0 CONNACK msg without properties */
+static uint8_t connack_v5_empty[] = {0x20, 0x03, 0x01, 0x00, 0x00};
+
+/* MQTT 5.0 CONNACK msg with a Receive Maximum of 0, a protocol error */
+static uint8_t connack_v5_receive_max_0[] = {0x20, 0x06, 0x00, 0x00, 0x03,
+					     0x21, 0x00, 0x00};
+
+/* MQTT 5.0 CONNACK msg with an unknown property */
+static uint8_t connack_v5_unknown[] = {0x20, 0x05, 0x00, 0x00, 0x02,
+				       0x7f, 0x00};
+
+/* MQTT 5.0 CONNACK msg with properties longer than the message */
+static uint8_t connack_v5_truncated[] = {0x20, 0x06, 0x00, 0x00, 0x08,
+					 0x21, 0x00, 0x01};
+
+/*
+ * MQTT 5.0 PUBLISH msg:
+ * DUP: 0, QoS: 1, Retain: 0, topic: sensors, message id: 1, message: OK
+ * Topic Alias: 1
+ */
+static uint8_t publish_v5_alias[] = {0x32, 0x11, 0x00, 0x07, 0x73, 0x65, 0x6e,
+				     0x73, 0x6f, 0x72, 0x73, 0x00, 0x01, 0x03,
+				     0x23, 0x00, 0x01, 0x4f, 0x4b};
+
+/*
+ * MQTT 5.0 PUBACK msg:
+ * Message id: 1	Reason: no matching subscribers	Reason String: ok
+ */
+static uint8_t puback_v5[] = {0x40, 0x09, 0x00, 0x01, 0x10, 0x05, 0x1f, 0x00,
+			      0x02, 0x6f, 0x6b};
+
+/* MQTT 5.0 PUBACK msg with a success Reason Code omitted */
+static uint8_t puback_v5_short[] = {0x40, 0x02, 0x00, 0x01};
+
+/* MQTT 5.0 PUBACK msg with the Not authorized Reason Code, no properties */
+static uint8_t puback_v5_failure[] = {0x40, 0x03, 0x00, 0x01, 0x87};
+
+static void v5_client_init(struct mqtt_client *c)
+{
+	mqtt_client_init(c);
+
+	c->protocol_version = MQTT_VERSION_5_0;
+	c->clean_session = 1U;
+	c->keepalive = 60U;
+	c->client_id = MQTT_UTF8_LITERAL("zephyr");
+	c->tx_buf = tx_buffer;
+	c->tx_buf_size = sizeof(tx_buffer);
+}
+
+static void encode_check(const struct buf_ctx *buf, const uint8_t *expected,
+			 size_t len)
+{
+	zassert_equal(buf->end - buf->cur, len, "wrong encoded length");
+	zassert_mem_equal(buf->cur, expected, len, "wrong encoded message");
+}
+
+static int connack_decode(const uint8_t *data, size_t len,
+			  struct mqtt_connack_param *param)
+{
+	uint8_t type_and_flags;
+	struct buf_ctx buf;
+	uint32_t length;
+
+	buf.cur = (uint8_t *)data;
+	buf.end = (uint8_t *)data + len;
+
+	zassert_equal(fixed_header_decode(&buf, &type_and_flags, &length), 0,
+		      "fixed_header_decode failed");
+
+	return connect_ack_decode(&client, &buf, param);
+}
+
+static void test_v5_connect_encode(void)
+{
+	struct mqtt_topic will_topic = {
+		.topic = MQTT_UTF8_LITERAL("quitting"),
+		.qos = MQTT_QOS_0_AT_MOST_ONCE,
+	};
+	struct mqtt_utf8 will_msg = MQTT_UTF8_LITERAL("bye");
+	struct buf_ctx buf;
+
+	v5_client_init(&client);
+
+	buf.cur = client.tx_buf;
+	buf.end = client.tx_buf + client.tx_buf_size;
+
+	zassert_equal(connect_request_encode(&client, &buf), 0,
+		      "connect_request_encode failed");
+	encode_check(&buf, connect_v5, sizeof(connect_v5));
+
+	client.will_topic = &will_topic;
+	client.will_message = &will_msg;
+
+	buf.cur = client.tx_buf;
+	buf.end = client.tx_buf + client.tx_buf_size;
+
+	zassert_equal(connect_request_encode(&client, &buf), 0,
+		      "connect_request_encode failed");
+	encode_check(&buf, connect_v5_will, sizeof(connect_v5_will));
+}
+
+static void test_v5_connack_decode(void)
+{
+	struct mqtt_connack_param param;
+
+	v5_client_init(&client);
+
+	zassert_equal(connack_decode(connack_v5, sizeof(connack_v5), &param),
+		      0, "connect_ack_decode failed");
+	zassert_equal(param.return_code, MQTT_CONNECTION_ACCEPTED,
+		      "wrong reason code");
+	zassert_equal(param.receive_max, 1, "wrong Receive Maximum");
+	zassert_equal(param.topic_alias_max, 1, "wrong Topic Alias Maximum");
+	zassert_equal(param.max_packet_size, 32, "wrong Maximum Packet Size");
+
+	/* Absent properties take their default values */
+	zassert_equal(connack_decode(connack_v5_empty,
+				     sizeof(connack_v5_empty), &param),
+		      0, "connect_ack_decode failed");
+	zassert_equal(param.session_present_flag, 1, "wrong session flag");
+	zassert_equal(param.receive_max, MQTT_DEFAULT_RECEIVE_MAXIMUM,
+		      "wrong default Receive Maximum");
+	zassert_equal(param.topic_alias_max, 0,
+		      "wrong default Topic Alias Maximum");
+	zassert_equal(param.max_packet_size, 0,
+		      "wrong default Maximum Packet Size");
+
+	zassert_equal(connack_decode(connack_v5_receive_max_0,
+				     sizeof(connack_v5_receive_max_0), &param),
+		      -EINVAL, "Receive Maximum of 0 accepted");
+	zassert_equal(connack_decode(connack_v5_unknown,
+				     sizeof(connack_v5_unknown), &param),
+		      -EINVAL, "unknown property accepted");
+	zassert_equal(connack_decode(connack_v5_truncated,
+				     sizeof(connack_v5_truncated), &param),
+		      -EINVAL, "truncated properties accepted");
+}
+
+static int puback_decode(const uint8_t *data, size_t len,
+			 struct mqtt_puback_param *param)
+{
+	uint8_t type_and_flags;
+	struct buf_ctx buf;
+	uint32_t length;
+
+	buf.cur = (uint8_t *)data;
+	buf.end = (uint8_t *)data + len;
+
+	zassert_equal(fixed_header_decode(&buf, &type_and_flags, &length), 0,
+		      "fixed_header_decode failed");
+
+	return publish_ack_decode(&client, length, &buf, param);
+}
+
+static void test_v5_puback_decode(void)
+{
+	struct mqtt_puback_param param;
+
+	v5_client_init(&client);
+
+	zassert_equal(puback_decode(puback_v5, sizeof(puback_v5), &param), 0,
+		      "publish_ack_decode failed");
+	zassert_equal(param.message_id, 1, "wrong message id");
+	zassert_equal(param.reason_code, 0x10, "wrong reason code");
+
+	zassert_equal(puback_decode(puback_v5_short, sizeof(puback_v5_short),
+				    &param),
+		      0, "publish_ack_decode failed");
+	zassert_equal(param.reason_code, 0, "wrong default reason code");
+
+	zassert_equal(puback_decode(puback_v5_failure,
+				    sizeof(puback_v5_failure), &param),
+		      0, "publish_ack_decode failed");
+	zassert_equal(param.reason_code, 0x87, "wrong reason code");
+}
+
+static void test_v5_publish_encode(void)
+{
+	struct mqtt_publish_param param = {
+		.message.topic.qos = MQTT_QOS_1_AT_LEAST_ONCE,
+		.message.topic.topic = MQTT_UTF8_LITERAL("sensors"),
+		.message.payload.data = payload,
+		.message.payload.len = sizeof(payload),
+		.message_id = 1U,
+	};
+	struct mqtt_publish_param dec_param;
+	uint8_t type_and_flags;
+	struct buf_ctx buf;
+	uint32_t length;
+
+	v5_client_init(&client);
+
+	buf.cur = client.tx_buf;
+	buf.end = client.tx_buf + client.tx_buf_size;
+
+	zassert_equal(publish_encode(&client, &param, 1U, &buf), 0,
+		      "publish_encode failed");
+
+	/* Payload is not copied, copy it manually just after the header */
+	memcpy(buf.end, payload, sizeof(payload));
+	buf.end += sizeof(payload);
+
+	encode_check(&buf, publish_v5_alias, sizeof(publish_v5_alias));
+
+	/* The properties are skipped by the decoder */
+	(void)memset(&dec_param, 0, sizeof(dec_param));
+
+	zassert_equal(fixed_header_decode(&buf, &type_and_flags, &length), 0,
+		      "fixed_header_decode failed");
+	zassert_equal(publish_decode(&client, type_and_flags, length, &buf,
+				     &dec_param), 0, "publish_decode failed");
+	zassert_equal(dec_param.message_id, 1, "wrong message id");
+	zassert_equal(dec_param.message.payload.len, sizeof(payload),
+		      "wrong payload length");
+	zassert_mem_equal(buf.cur, payload, sizeof(payload), "wrong payload");
+}
+
+/* Accept the connection with the given server limits */
+static void broker_connack(uint16_t receive_max, uint16_t topic_alias_max,
+			   uint32_t max_packet_size)
+{
+	uint8_t connack[] = {
+		0x20, 0x0e, 0x00, 0x00, 0x0b,
+		MQTT_PROP_RECEIVE_MAXIMUM, 0x00, 0x00,
+		MQTT_PROP_TOPIC_ALIAS_MAXIMUM, 0x00, 0x00,
+		MQTT_PROP_MAXIMUM_PACKET_SIZE, 0x00, 0x00, 0x00, 0x00,
+	};
+
+	sys_put_be16(receive_max, &connack[6]);
+	sys_put_be16(topic_alias_max, &connack[9]);
+	sys_put_be32(max_packet_size, &connack[12]);
+
+	broker_send(&client, connack, sizeof(connack));
+}
+
+static int publish(const char *topic, uint8_t qos, uint16_t message_id,
+		   size_t len)
+{
+	static uint8_t data[CONFIG_MQTT_PUBLISH_QUEUE_BUF_SIZE];
+	struct mqtt_publish_param param = {
+		.message.topic.qos = qos,
+		.message.topic.topic.utf8 = (const uint8_t *)topic,
+		.message.topic.topic.size = strlen(topic),
+		.message.payload.data = data,
+		.message.payload.len = len,
+		.message_id = message_id,
+	};
+
+	return mqtt_publish(&client, &param);
+}
+
+static int enqueue(uint16_t message_id, size_t len)
+{
+	static uint8_t data[CONFIG_MQTT_PUBLISH_QUEUE_BUF_SIZE];
+	struct mqtt_publish_param param = {
+		.message.topic.qos = MQTT_QOS_1_AT_LEAST_ONCE,
+		.message.topic.topic = MQTT_UTF8_LITERAL("sensors"),
+		.message.payload.data = data,
+		.message.payload.len = len,
+		.message_id = message_id,
+	};
+
+	return mqtt_publish_enqueue(&client, &param, K_NO_WAIT);
+}
+
+/* Receive a QoS 0 PUBLISH and check its topic and topic alias */
+static void expect_alias(const char *topic, uint16_t alias)
+{
+	uint8_t type_and_flags;
+	struct buf_ctx buf;
+	uint16_t topic_len;
+	uint8_t props_len;
+
+	zassert_equal(broker_recv(&type_and_flags, &buf), 0, "no message");
+	zassert_equal(type_and_flags, MQTT_PKT_TYPE_PUBLISH,
+		      "not a QoS 0 PUBLISH message");
+
+	topic_len = sys_get_be16(buf.cur);
+	buf.cur += sizeof(uint16_t);
+
+	zassert_equal(topic_len, strlen(topic), "wrong topic length");
+	zassert_mem_equal(buf.cur, topic, topic_len, "wrong topic");
+	buf.cur += topic_len;
+
+	props_len = *buf.cur++;
+
+	if (alias == 0U) {
+		zassert_equal(props_len, 0, "unexpected properties");
+		return;
+	}
+
+	zassert_equal(props_len, 3, "wrong properties length");
+	zassert_equal(buf.cur[0], MQTT_PROP_TOPIC_ALIAS, "no topic alias");
+	zassert_equal(sys_get_be16(&buf.cur[1]), alias, "wrong topic alias");
+}
+
+static void expect_none(void)
+{
+	uint8_t type_and_flags;
+	struct buf_ctx buf;
+
+	zassert_equal(broker_recv(&type_and_flags, &buf), -EAGAIN,
+		      "unexpected message 0x%02x", type_and_flags);
+}
+
+static void v5_setup(void)
+{
+	broker_connect(&client, rx_buffer, tx_buffer, V5_BUF_SIZE);
+
+	client.protocol_version = MQTT_VERSION_5_0;
+}
+
+static void v5_teardown(void)
+{
+	mqtt_publish_queue_clear(&client);
+	broker_disconnect(&client);
+}
+
+static void test_v5_topic_alias(void)
+{
+	struct mqtt_publish_param param;
+
+	broker_connack(MQTT_DEFAULT_RECEIVE_MAXIMUM, 1U, 0U);
+
+	/* The first message assigns the alias, the next ones use it */
+	zassert_equal(publish("sensors", 0U, 0U, 2), 0, "publish failed");
+	expect_alias("sensors", 1U);
+
+	zassert_equal(publish("sensors", 0U, 0U, 2), 0, "publish failed");
+	expect_alias("", 1U);
+
+	/* The server accepts a single alias */
+	zassert_equal(publish("other", 0U, 0U, 2), 0, "publish failed");
+	expect_alias("other", 0U);
+
+	/* Queued messages are sent without alias */
+	zassert_equal(enqueue(1U, 2), 0, "enqueue failed");
+	zassert_equal(mqtt_publish_queue_flush(&client), 0, "flush failed");
+	broker_recv_publish(&client, 1U, &param);
+	zassert_equal(param.message.topic.topic.size, strlen("sensors"),
+		      "queued message without topic");
+	expect_none();
+}
+
+static void test_v5_receive_max(void)
+{
+	struct mqtt_publish_param param;
+
+	/* The window is smaller than CONFIG_MQTT_PUBLISH_QUEUE_INFLIGHT */
+	broker_connack(1U, 0U, 0U);
+
+	zassert_equal(enqueue(1U, 2), 0, "enqueue failed");
+	zassert_equal(enqueue(2U, 2), 0, "enqueue failed");
+	zassert_equal(mqtt_publish_queue_flush(&client), 0, "flush failed");
+
+	broker_recv_publish(&client, 1U, &param);
+	expect_none();
+
+	broker_ack(&client, MQTT_PKT_TYPE_PUBACK, 1U);
+	broker_recv_publish(&client, 2U, &param);
+	expect_none();
+
+	broker_ack(&client, MQTT_PKT_TYPE_PUBACK, 2U);
+	zassert_equal(client.internal.inflight_count, 0,
+		      "acknowledged message in flight");
+}
+
+static void test_v5_max_packet_size(void)
+{
+	struct mqtt_publish_param param;
+
+	/* Topic and message id take 11 bytes, properties 1 and the fixed
+	 * header 2, so 18 bytes of payload fit in 32 bytes.
+	 */
+	broker_connack(MQTT_DEFAULT_RECEIVE_MAXIMUM, 0U, 32U);
+
+	zassert_equal(publish("sensors", 1U, 1U, 19), -EMSGSIZE,
+		      "message above the limit published");
+	expect_none();
+
+	zassert_equal(publish("sensors", 1U, 1U, 18), 0, "publish failed");
+	broker_recv_publish(&client, 1U, &param);
+	zassert_equal(param.message.payload.len, 18, "wrong payload length");
+
+	/* A queued message above the limit is dropped when it is sent */
+	zassert_equal(enqueue(2U, 19), 0, "enqueue failed");
+	zassert_equal(enqueue(3U, 18), 0, "enqueue failed");
+	zassert_equal(mqtt_publish_queue_flush(&client), 0, "flush failed");
+
+	broker_recv_publish(&client, 3U, &param);
+	expect_none();
+	zassert_equal(client.internal.inflight_count, 1,
+		      "dropped message in flight");
+}
+
+static void test_v5_puback_failure(void)
+{
+	struct mqtt_publish_param param;
+
+	broker_connack(MQTT_DEFAULT_RECEIVE_MAXIMUM, 0U, 0U);
+
+	zassert_equal(enqueue(1U, 2), 0, "enqueue failed");
+	zassert_equal(mqtt_publish_queue_flush(&client), 0, "flush failed");
+	broker_recv_publish(&client, 1U, &param);
+
+	/* A failure Reason Code completes the message, it is not resent */
+	broker_send(&client, puback_v5_failure, sizeof(puback_v5_failure));
+	zassert_equal(client.internal.inflight_count, 0,
+		      "failed message in flight");
+
+	zassert_equal(mqtt_queue_resend(&client, true), 0, "resend failed");
+	expect_none();
+}
+
+void test_mqtt_v5(void)
+{
+	ztest_test_suite(test_mqtt_v5_fn,
+		ztest_unit_test(test_v5_connect_encode),
+		ztest_unit_test(test_v5_connack_decode),
+		ztest_unit_test(test_v5_puback_decode),
+		ztest_unit_test(test_v5_publish_encode),
+		ztest_unit_test_setup_teardown(test_v5_topic_alias,
+					       v5_setup, v5_teardown),
+		ztest_unit_test_setup_teardown(test_v5_receive_max,
+					       v5_setup, v5_teardown),
+		ztest_unit_test_setup_teardown(test_v5_max_packet_size,
+					       v5_setup, v5_teardown),
+		ztest_unit_test_setup_teardown(test_v5_puback_failure,
+					       v5_setup, v5_teardown));
+	ztest_run_test_suite(test_mqtt_v5_fn);
+}
@@ -269,6 +269,173 @@ static void test_recv_two_msg(void)
 	test_recv_2(sizeof(frame1) + FRAME1_HDR_SIZE / 2);
 }
 
+/* Unmasked text frame with the same payload as frame1 */
+static const unsigned char frame3[] = {
+	0x81, 0x0c, 't', 'e', 's', 't', ' ', 'm', 'e', 's', 's', 'a', 'g',
+	'e'
+};
+
+/* Zero length frames: a text frame and a ping */
+static const unsigned char empty_text[] = { 0x81, 0x00 };
+static const unsigned char empty_ping[] = { 0x89, 0x00 };
+
+static void init_recv_ctx(struct websocket_context *ctx)
+{
+	memset(ctx, 0, sizeof(*ctx));
+
+	ctx->tmp_buf = temp_recv_buf;
+	ctx->tmp_buf_len = sizeof(temp_recv_buf);
+}
+
+/* Feed the header alone so that the payload is read directly into the
+ * caller buffer, buf_len bytes at a time.
+ */
+static void test_recv_direct(const unsigned char *frame, size_t frame_len,
+			     size_t buf_len)
+{
+	struct websocket_context ctx;
+	size_t hdr_len = frame_len - (sizeof(frame1_msg) - 1);
+	uint32_t msg_type = 0;
+	uint64_t remaining = -1;
+	size_t total_read = 0;
+	int ret;
+
+	init_recv_ctx(&ctx);
+	memcpy(feed_buf, frame, frame_len);
+
+	ret = test_recv_buf(feed_buf, hdr_len, &ctx, &msg_type, &remaining,
+			    recv_buf, buf_len);
+	zassert_equal(ret, -EAGAIN, "Header parse failed (ret %d)", ret);
+	zassert_equal(msg_type, WEBSOCKET_FLAG_FINAL | WEBSOCKET_FLAG_TEXT,
+		      "Invalid message type 0x%x", msg_type);
+
+	while (total_read < sizeof(frame1_msg) - 1) {
+		ret = test_recv_buf(&feed_buf[hdr_len + total_read],
+				    frame_len - hdr_len - total_read,
+				    &ctx, &msg_type, &remaining,
+				    recv_buf + total_read, buf_len);
+		zassert_true(ret > 0 && ret <= buf_len,
+			     "Invalid number of bytes read (%d)", ret);
+
+		total_read += ret;
+		zassert_equal(remaining, sizeof(frame1_msg) - 1 - total_read,
+			      "Invalid remaining %d", (int)remaining);
+	}
+
+	zassert_mem_equal(recv_buf, frame1_msg, sizeof(frame1_msg) - 1,
+			  "Invalid message, should be '%s' was '%s'",
+			  frame1_msg, recv_buf);
+	zassert_false(ctx.header_received, "Frame not completed");
+}
+
+static void test_recv_direct_masked(void)
+{
+	/* Odd sizes make every read start at a different mask byte */
+	test_recv_direct(frame1, sizeof(frame1), sizeof(frame1_msg) - 1);
+	test_recv_direct(frame1, sizeof(frame1), 5);
+	test_recv_direct(frame1, sizeof(frame1), 3);
+	test_recv_direct(frame1, sizeof(frame1), 1);
+}
+
+static void test_recv_direct_unmasked(void)
+{
+	test_recv_direct(frame3, sizeof(frame3), sizeof(frame1_msg) - 1);
+	test_recv_direct(frame3, sizeof(frame3), 5);
+}
+
+static void test_recv_fallback_unmasked(void)
+{
+	struct websocket_context ctx;
+	uint32_t msg_type = 0;
+	uint64_t remaining = -1;
+	int ret;
+
+	init_recv_ctx(&ctx);
+	memcpy(feed_buf, frame3, sizeof(frame3));
+
+	/* Header and payload arrive together, so the payload is returned
+	 * from the temporary buffer.
+	 */
+	ret = test_recv_buf(feed_buf, sizeof(frame3), &ctx, &msg_type,
+			    &remaining, recv_buf, sizeof(recv_buf));
+	zassert_equal(ret, sizeof(frame1_msg) - 1,
+		      "Invalid number of bytes read (%d)", ret);
+	zassert_mem_equal(recv_buf, frame1_msg, sizeof(frame1_msg) - 1,
+			  "Invalid message, should be '%s' was '%s'",
+			  frame1_msg, recv_buf);
+	zassert_equal(remaining, 0, "Msg not empty");
+}
+
+static void test_recv_zero_len_direct(void)
+{
+	struct websocket_context ctx;
+	uint32_t msg_type = 0;
+	uint64_t remaining = -1;
+	int ret;
+
+	init_recv_ctx(&ctx);
+	memcpy(feed_buf, empty_text, sizeof(empty_text));
+	memcpy(&feed_buf[sizeof(empty_text)], frame1, sizeof(frame1));
+
+	/* Only the header of the empty frame is available */
+	ret = test_recv_buf(feed_buf, sizeof(empty_text), &ctx, &msg_type,
+			    &remaining, recv_buf, sizeof(recv_buf));
+	zassert_equal(ret, 0, "Empty frame not returned (ret %d)", ret);
+	zassert_equal(msg_type, WEBSOCKET_FLAG_FINAL | WEBSOCKET_FLAG_TEXT,
+		      "Invalid message type 0x%x", msg_type);
+	zassert_equal(remaining, 0, "Msg not empty");
+	zassert_false(ctx.header_received, "Empty frame not completed");
+
+	/* The next frame must be parsed from its own header */
+	msg_type = 0;
+	ret = test_recv_buf(&feed_buf[sizeof(empty_text)], sizeof(frame1),
+			    &ctx, &msg_type, &remaining, recv_buf,
+			    sizeof(recv_buf));
+	zassert_equal(ret, sizeof(frame1_msg) - 1,
+		      "Next frame not read (ret %d)", ret);
+	zassert_equal(msg_type, WEBSOCKET_FLAG_FINAL | WEBSOCKET_FLAG_TEXT,
+		      "Invalid message type 0x%x", msg_type);
+	zassert_mem_equal(recv_buf, frame1_msg, sizeof(frame1_msg) - 1,
+			  "Invalid message, should be '%s' was '%s'",
+			  frame1_msg, recv_buf);
+}
+
+static void test_recv_zero_len_fallback(void)
+{
+	struct websocket_context ctx;
+	uint32_t msg_type = 0;
+	uint64_t remaining = -1;
+	size_t part = FRAME1_HDR_SIZE / 2;
+	int ret;
+
+	init_recv_ctx(&ctx);
+	memcpy(feed_buf, empty_ping, sizeof(empty_ping));
+	memcpy(&feed_buf[sizeof(empty_ping)], frame1, sizeof(frame1));
+
+	/* The empty ping arrives together with part of the next header */
+	ret = test_recv_buf(feed_buf, sizeof(empty_ping) + part, &ctx,
+			    &msg_type, &remaining, recv_buf,
+			    sizeof(recv_buf));
+	zassert_equal(ret, 0, "Empty ping not returned (ret %d)", ret);
+	zassert_equal(msg_type, WEBSOCKET_FLAG_FINAL | WEBSOCKET_FLAG_PING,
+		      "Invalid message type 0x%x", msg_type);
+	zassert_equal(remaining, 0, "Msg not empty");
+	zassert_false(ctx.header_received, "Empty ping not completed");
+
+	msg_type = 0;
+	ret = test_recv_buf(&feed_buf[sizeof(empty_ping) + part],
+			    sizeof(frame1) - part, &ctx, &msg_type,
+			    &remaining, recv_buf, sizeof(recv_buf));
+	zassert_equal(ret, sizeof(frame1_msg) - 1,
+		      "Next frame not read (ret %d)", ret);
+	zassert_equal(msg_type, WEBSOCKET_FLAG_FINAL | WEBSOCKET_FLAG_TEXT,
+		      "Invalid message type 0x%x", msg_type);
+	zassert_mem_equal(recv_buf, frame1_msg, sizeof(frame1_msg) - 1,
+			  "Invalid message, should be '%s' was '%s'",
+			  frame1_msg, recv_buf);
+	zassert_equal(remaining, 0, "Msg not empty");
+}
+
 int verify_sent_and_received_msg(struct msghdr *msg, bool split_msg)
 {
 	static struct websocket_context ctx;
@@ -353,6 +520,28 @@ static void test_send_and_recv_lorem_ipsum(void)
 		      test_msg_len, ret);
 }
 
+static void test_send_and_recv_short_msg(void)
+{
+	static struct websocket_context ctx;
+	int ret;
+
+	memset(&ctx, 0, sizeof(ctx));
+
+	ctx.tmp_buf = temp_recv_buf;
+	ctx.tmp_buf_len = sizeof(temp_recv_buf);
+
+	/* Short masked payloads are not allocated from the heap */
+	test_msg_len = 61;
+
+	ret = websocket_send_msg(POINTER_TO_INT(&ctx),
+				 lorem_ipsum, test_msg_len,
+				 WEBSOCKET_OPCODE_DATA_BINARY, true, true,
+				 SYS_FOREVER_MS);
+	zassert_equal(ret, test_msg_len,
+		      "Should have sent %zd bytes but sent %d instead",
+		      test_msg_len, ret);
+}
+
 static void test_recv_two_large_split_msg(void)
 {
 	static struct websocket_context ctx;
@@ -389,7 +578,13 @@ void test_main(void)
 			 ztest_unit_test(test_recv_12_byte),
 			 ztest_unit_test(test_recv_whole_msg),
 			 ztest_unit_test(test_recv_two_msg),
+			 ztest_unit_test(test_recv_direct_masked),
+			 ztest_unit_test(test_recv_direct_unmasked),
+			 ztest_unit_test(test_recv_fallback_unmasked),
+			 ztest_unit_test(test_recv_zero_len_direct),
+			 ztest_unit_test(test_recv_zero_len_fallback),
 			 ztest_unit_test(test_send_and_recv_lorem_ipsum),
+			 ztest_unit_test(test_send_and_recv_short_msg),
 			 ztest_unit_test(test_recv_two_large_split_msg)
 		);
 
@@ -0,0 +1,309 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_TCP_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/printk.h>
+#include <sys/byteorder.h>
+#include <linker/sections.h>
+
+#include <ztest.h>
+
+#include <net/dummy.h>
+#include <net/buf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+
+#define NET_LOG_ENABLED 1
+#include "net_private.h"
+
+#include "ipv4.h"
+#include "tcp_internal.h"
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+
+#define MY_PORT 4242
+#define PEER_PORT 4243
+
+#define SEG_SIZE 1000
+#define DATA_LEN 2500
+#define SEG_COUNT 3
+#define SEQ 0xfffffe00
+#define HDR_LEN (NET_IPV4H_LEN + NET_TCPH_LEN)
+
+#define ALLOC_TIMEOUT K_MSEC(500)
+
+static struct net_if *iface1;
+
+static struct net_pkt *segs[SEG_COUNT + 1];
+static int seg_count;
+
+static struct net_pkt *delivered[SEG_COUNT];
+static int delivered_count;
+
+static int net_iface_dev_init(const struct device *dev)
+{
+	return 0;
+}
+
+static void net_iface_init(struct net_if *iface)
+{
+	static uint8_t mac[] = { 0x00, 0x00, 0x5E, 0x00, 0x53, 0x01 };
+
+	net_if_set_link_addr(iface, mac, sizeof(mac), NET_LINK_ETHERNET);
+}
+
+static int sender_iface(const struct device *dev, struct net_pkt *pkt)
+{
+	net_pkt_unref(pkt);
+
+	return 0;
+}
+
+static struct dummy_api net_iface_api = {
+	.iface_api.init = net_iface_init,
+	.send = sender_iface,
+};
+
+#define _ETH_L2_LAYER DUMMY_L2
+#define _ETH_L2_CTX_TYPE NET_L2_GET_CTX_TYPE(DUMMY_L2)
+
+NET_DEVICE_INIT_INSTANCE(net_iface1_test,
+			 "iface1",
+			 iface1,
+			 net_iface_dev_init,
+			 device_pm_control_nop,
+			 NULL,
+			 NULL,
+			 CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+			 &net_iface_api,
+			 _ETH_L2_LAYER,
+			 _ETH_L2_CTX_TYPE,
+			 1500);
+
+static struct net_tcp_hdr *tcp_hdr(struct net_pkt *pkt)
+{
+	return (struct net_tcp_hdr *)(pkt->buffer->data + NET_IPV4H_LEN);
+}
+
+static void check_payload(struct net_pkt *pkt, size_t offset, size_t len)
+{
+	uint8_t data;
+	size_t i;
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+	net_pkt_skip(pkt, HDR_LEN);
+
+	for (i = 0; i < len; i++) {
+		zassert_equal(net_pkt_read_u8(pkt, &data), 0, "Short pkt");
+		zassert_equal(data, (uint8_t)(offset + i),
+			      "Invalid data at %zd", offset + i);
+	}
+
+	zassert_equal(net_pkt_remaining_data(pkt), 0, "Extra data");
+}
+
+static struct net_pkt *create_gso_pkt(void)
+{
+	struct net_tcp_hdr hdr = { 0 };
+	struct net_pkt *pkt;
+	int i, ret;
+
+	pkt = net_pkt_alloc_with_buffer(iface1, DATA_LEN, AF_INET,
+					IPPROTO_TCP, ALLOC_TIMEOUT);
+	zassert_not_null(pkt, "packet");
+
+	ret = net_ipv4_create(pkt, &peer_addr, &my_addr);
+	zassert_equal(ret, 0, "Cannot create IPv4 header");
+
+	hdr.src_port = htons(PEER_PORT);
+	hdr.dst_port = htons(MY_PORT);
+	sys_put_be32(SEQ, hdr.seq);
+	sys_put_be32(1, hdr.ack);
+	hdr.offset = 5 << 4;
+	hdr.flags = NET_TCP_PSH | NET_TCP_ACK;
+	hdr.wnd[0] = 0x10;
+
+	ret = net_pkt_write(pkt, &hdr, sizeof(hdr));
+	zassert_equal(ret, 0, "Cannot create TCP header");
+
+	for (i = 0; i < DATA_LEN; i++) {
+		ret = net_pkt_write_u8(pkt, i);
+		zassert_equal(ret, 0, "Cannot append data");
+	}
+
+	net_pkt_cursor_init(pkt);
+	ret = net_ipv4_finalize(pkt, IPPROTO_TCP);
+	zassert_equal(ret, 0, "Cannot finalize");
+
+	net_pkt_set_tcp_gso_size(pkt, SEG_SIZE);
+
+	return pkt;
+}
+
+static int store_segment(struct net_pkt *seg, void *user_data)
+{
+	zassert_true(seg_count < SEG_COUNT, "Too many segments");
+
+	segs[seg_count++] = seg;
+
+	return 0;
+}
+
+static void deliver(struct net_pkt *pkt)
+{
+	zassert_true(delivered_count < SEG_COUNT, "Too many packets");
+
+	delivered[delivered_count++] = pkt;
+}
+
+static void create_segments(void)
+{
+	struct net_pkt *pkt = create_gso_pkt();
+	int ret;
+
+	seg_count = 0;
+
+	ret = net_tcp_gso_segment(pkt, store_segment, NULL);
+	zassert_equal(ret, 0, "Segmentation failed (%d)", ret);
+	zassert_equal(seg_count, SEG_COUNT, "Invalid segment count %d",
+		      seg_count);
+
+	net_pkt_unref(pkt);
+}
+
+static void release_packets(void)
+{
+	int i;
+
+	for (i = 0; i < delivered_count; i++) {
+		net_pkt_unref(delivered[i]);
+	}
+
+	delivered_count = 0;
+}
+
+static void test_setup(void)
+{
+	iface1 = net_if_get_by_index(1);
+	zassert_not_null(iface1, "Interface 1");
+
+	net_if_up(iface1);
+}
+
+static void test_gso_segment(void)
+{
+	int i;
+
+	create_segments();
+
+	for (i = 0; i < SEG_COUNT; i++) {
+		size_t len = MIN(DATA_LEN - i * SEG_SIZE, SEG_SIZE);
+		struct net_tcp_hdr *tcp = tcp_hdr(segs[i]);
+
+		zassert_equal(net_pkt_get_len(segs[i]), HDR_LEN + len,
+			      "Invalid length of segment %d", i);
+		zassert_equal(ntohs(NET_IPV4_HDR(segs[i])->len), HDR_LEN + len,
+			      "Invalid IP length of segment %d", i);
+		zassert_equal(net_calc_chksum_ipv4(segs[i]), 0,
+			      "Invalid IP checksum in segment %d", i);
+		zassert_equal(net_calc_chksum_tcp(segs[i]), 0,
+			      "Invalid TCP checksum in segment %d", i);
+
+		/* The sequence number wraps after the first segment */
+		zassert_equal(sys_get_be32(tcp->seq),
+			      (uint32_t)(SEQ + i * SEG_SIZE),
+			      "Invalid seq in segment %d", i);
+		zassert_equal(tcp->flags, i == SEG_COUNT - 1 ?
+			      NET_TCP_PSH | NET_TCP_ACK : NET_TCP_ACK,
+			      "Invalid flags in segment %d", i);
+
+		check_payload(segs[i], i * SEG_SIZE, len);
+
+		net_pkt_unref(segs[i]);
+	}
+}
+
+static void test_gro_coalesce(void)
+{
+	enum net_verdict verdict;
+	int i;
+
+	create_segments();
+
+	for (i = 0; i < SEG_COUNT; i++) {
+		verdict = net_tcp_gro_receive(segs[i], 0, deliver);
+		zassert_equal(verdict, NET_OK, "Segment %d not taken", i);
+	}
+
+	/* The pushed last segment delivers the coalesced packet */
+	zassert_equal(delivered_count, 1, "Packet not delivered");
+	zassert_equal(net_pkt_get_len(delivered[0]), HDR_LEN + DATA_LEN,
+		      "Invalid length");
+	zassert_equal(ntohs(NET_IPV4_HDR(delivered[0])->len),
+		      HDR_LEN + DATA_LEN, "Invalid IP length");
+	zassert_equal(net_calc_chksum_ipv4(delivered[0]), 0,
+		      "Invalid IP checksum");
+	zassert_true(net_pkt_is_tcp_chksum_ok(delivered[0]),
+		     "TCP checksum not verified");
+	zassert_true(tcp_hdr(delivered[0])->flags & NET_TCP_PSH,
+		     "PSH flag lost");
+
+	check_payload(delivered[0], 0, DATA_LEN);
+
+	release_packets();
+}
+
+static void test_gro_out_of_order(void)
+{
+	enum net_verdict verdict;
+
+	create_segments();
+
+	verdict = net_tcp_gro_receive(segs[0], 0, deliver);
+	zassert_equal(verdict, NET_OK, "First segment not taken");
+
+	/* A gap in the sequence numbers delivers the pending segment
+	 * before the new one is processed.
+	 */
+	verdict = net_tcp_gro_receive(segs[2], 0, deliver);
+	zassert_equal(verdict, NET_CONTINUE, "Pushed segment taken");
+	zassert_equal(delivered_count, 1, "Pending segment not delivered");
+	zassert_equal(delivered[0], segs[0], "Wrong packet delivered");
+	net_pkt_unref(segs[2]);
+
+	verdict = net_tcp_gro_receive(segs[1], 0, deliver);
+	zassert_equal(verdict, NET_OK, "Second segment not taken");
+	zassert_equal(delivered_count, 1, "Segment delivered too early");
+
+	net_tcp_gro_flush(0, deliver);
+	zassert_equal(delivered_count, 2, "Flush did not deliver");
+	zassert_equal(delivered[1], segs[1], "Wrong packet flushed");
+
+	release_packets();
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_tcp_offload_test,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_gso_segment),
+			 ztest_unit_test(test_gro_coalesce),
+			 ztest_unit_test(test_gro_out_of_order)
+			 );
+
+	ztest_run_test_suite(net_tcp_offload_test);
+}